@@ -82,6 +82,13 @@ protected:
   /** Evaluates the sum of squared differences from the histogram. */
   virtual MeasureType EvaluateMeasure(HistogramType & histogram) const;
 
+  typedef typename Superclass::JointFrequenciesType JointFrequenciesType;
+
+  /** Evaluates the derivatives of the correlation coefficient with respect to the
+   * frequencies of the joint histogram. */
+  virtual bool EvaluateMeasureFrequencyDerivatives(const JointFrequenciesType & frequencies,
+                                                   JointFrequenciesType & derivatives) const;
+
 private:
   /** Returns the mean in the x-direction. */
   MeasureType MeanX(HistogramType & histogram) const;
@@ -139,6 +139,92 @@ CorrelationCoefficientHistogramImageToImageMetric< TFixedImage, TMovingImage >
 
   return var;
 }
+
+template< class TFixedImage, class TMovingImage >
+bool
+CorrelationCoefficientHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::EvaluateMeasureFrequencyDerivatives(const JointFrequenciesType & frequencies,
+                                      JointFrequenciesType & derivatives) const
+{
+  const unsigned int sizeX = frequencies.rows();
+  const unsigned int sizeY = frequencies.cols();
+
+  derivatives.SetSize(sizeX, sizeY);
+  derivatives.Fill(0.0);
+
+  std::vector< double > freqX(sizeX, 0.0);
+  std::vector< double > freqY(sizeY, 0.0);
+  double                totalFreq = 0.0;
+  for ( unsigned int i = 0; i < sizeX; i++ )
+    {
+    for ( unsigned int j = 0; j < sizeY; j++ )
+      {
+      const double freq = frequencies(i, j);
+      freqX[i] += freq;
+      freqY[j] += freq;
+      totalFreq += freq;
+      }
+    }
+  if ( totalFreq <= 0.0 )
+    {
+    return true;
+    }
+
+  double meanX = 0.0;
+  double meanY = 0.0;
+  double meanXX = 0.0;
+  double meanYY = 0.0;
+  double meanXY = 0.0;
+  for ( unsigned int i = 0; i < sizeX; i++ )
+    {
+    const double valX = this->GetBinCenter(0, i);
+    meanX += freqX[i] * valX;
+    meanXX += freqX[i] * valX * valX;
+    for ( unsigned int j = 0; j < sizeY; j++ )
+      {
+      meanXY += frequencies(i, j) * valX * this->GetBinCenter(1, j);
+      }
+    }
+  for ( unsigned int j = 0; j < sizeY; j++ )
+    {
+    const double valY = this->GetBinCenter(1, j);
+    meanY += freqY[j] * valY;
+    meanYY += freqY[j] * valY * valY;
+    }
+  meanX /= totalFreq;
+  meanY /= totalFreq;
+  const double varianceX = meanXX / totalFreq - meanX * meanX;
+  const double varianceY = meanYY / totalFreq - meanY * meanY;
+  const double covariance = meanXY / totalFreq - meanX * meanY;
+
+  if ( varianceX <= 0.0 || varianceY <= 0.0 )
+    {
+    return true;
+    }
+
+  // Derivatives of the moments with respect to the frequencies, the total
+  // frequency being held fixed, and of the absolute value of the
+  // correlation coefficient.
+  const double deviation = vcl_sqrt(varianceX * varianceY);
+  const double correlation = covariance / deviation;
+  const double sign = correlation < 0.0 ? -1.0 : 1.0;
+  for ( unsigned int i = 0; i < sizeX; i++ )
+    {
+    const double valX = this->GetBinCenter(0, i);
+    const double dVarianceX = ( valX * valX - 2.0 * meanX * valX ) / totalFreq;
+    for ( unsigned int j = 0; j < sizeY; j++ )
+      {
+      const double valY = this->GetBinCenter(1, j);
+      const double dVarianceY = ( valY * valY - 2.0 * meanY * valY ) / totalFreq;
+      const double dCovariance = ( valX * valY - valX * meanY - meanX * valY ) / totalFreq;
+      derivatives(i, j) = sign * ( dCovariance / deviation
+                                   - 0.5 * correlation * ( dVarianceX / varianceX
+                                                           + dVarianceY / varianceY ) );
+      }
+    }
+
+  return true;
+}
 }
 
 #endif // itkCorrelationCoefficientHistogramImageToImageMetric_txx
@@ -24,6 +24,7 @@
 #include "itkPoint.h"
 #include "itkCastImageFilter.h"
 #include "itkResampleImageFilter.h"
+#include <vector>
 
 namespace itk
 {
@@ -50,6 +51,12 @@ namespace itk
  * Cerebral Angiograms,", IEEE Transactions on Medical Imaging,
  * 22(11):1417-1426.
  *
+ * The gradients are compared on several threads at the samples of the
+ * fixed image (see ImageToImageMetric), by default all the pixels of the
+ * fixed image region. The sums are accumulated per block of samples and
+ * added in the order of the blocks, so that the value does not depend on
+ * the number of threads.
+ *
  * \ingroup RegistrationMetrics
  */
 template< class TFixedImage, class TMovingImage >
@@ -160,6 +167,11 @@ protected:
   MeasureType ComputeMeasure(const TransformParametersType & parameters,
                              const double *subtractionFactor) const;
 
+  /** Compare the gradients at the samples of a thread. The samples are not
+   * mapped, the moved gradient images being already resampled on the grid
+   * of the fixed image. */
+  virtual void GetValueThread(unsigned int threadID) const;
+
   typedef NeighborhoodOperatorImageFilter<
     FixedGradientImageType, FixedGradientImageType > FixedSobelFilter;
 
@@ -207,6 +219,12 @@ private:
   typename MovedSobelFilter::Pointer m_MovedSobelFilters[itkGetStaticConstMacro(MovedImageDimension)];
 
   double m_DerivativeDelta;
+
+  /** The subtraction factors of the measure being computed. */
+  mutable double m_SubtractionFactor[FixedImageDimension];
+
+  /** Sum of the measure over the samples of each block. */
+  mutable std::vector< double > m_BlockSums;
 };
 } // end namespace itk
 
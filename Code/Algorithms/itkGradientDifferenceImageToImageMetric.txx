@@ -20,6 +20,7 @@ PURPOSE.  See the above copyright notices for more information.
 #include "itkGradientDifferenceImageToImageMetric.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkNumericTraits.h"
+#include <algorithm>
 
 #include <iostream>
 #include <iomanip>
@@ -45,6 +46,7 @@ GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
     m_MaxFixedGradient[iDimension] = 0;
 
     m_Variance[iDimension] = 0;
+    m_SubtractionFactor[iDimension] = 1.0;
     }
 
   for ( iDimension = 0; iDimension < MovedImageDimension; iDimension++ )
@@ -54,6 +56,14 @@ GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
     }
 
   this->m_DerivativeDelta = 0.001;
+
+  this->m_WithinThreadPreProcess = false;
+  this->m_WithinThreadPostProcess = false;
+  this->m_NumberOfSampleBlocks = Superclass::DefaultNumberOfSampleBlocks;
+
+  // The gradients were compared at all the pixels of the fixed image region
+  // before the metric was multithreaded, and still are by default.
+  this->SetUseAllPixels(true);
 }
 
 /**
@@ -75,6 +85,9 @@ throw ( ExceptionObject )
   // Initialise the base class
 
   Superclass::Initialize();
+  this->Superclass::MultiThreadingInitialize();
+
+  m_BlockSums.resize(this->m_NumberOfSampleBlocks);
 
   // Create the filter to resample the moving image
 
@@ -279,60 +292,88 @@ GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 {
   unsigned int iDimension;
 
+  if ( m_BlockSums.empty() )
+    {
+    itkExceptionMacro(<< "The metric has no samples, maybe you forgot to call Initialize()");
+    }
+
   this->SetTransformParameters(parameters);
   m_TransformMovingImageFilter->UpdateLargestPossibleRegion();
-  MeasureType measure = NumericTraits< MeasureType >::Zero;
 
+  // The gradient images are updated before the threads read them
   for ( iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
     {
-    if ( m_Variance[iDimension] == NumericTraits< MovedGradientPixelType >::Zero )
-      {
-      continue;
-      }
-    // Iterate over the fixed and moving gradient images
-    // calculating the similarity measure
-
-    MovedGradientPixelType movedGradient;
-    FixedGradientPixelType fixedGradient;
-
-    MovedGradientPixelType diff;
+    m_FixedSobelFilters[iDimension]->UpdateLargestPossibleRegion();
+    m_MovedSobelFilters[iDimension]->UpdateLargestPossibleRegion();
+    m_SubtractionFactor[iDimension] = subtractionFactor[iDimension];
+    }
 
-    typedef  itk::ImageRegionConstIteratorWithIndex< FixedGradientImageType >
-    FixedIteratorType;
+  std::fill(m_BlockSums.begin(), m_BlockSums.end(), 0.0);
 
-    FixedIteratorType fixedIterator( m_FixedSobelFilters[iDimension]->GetOutput(),
-                                     this->GetFixedImageRegion() );
+  // MUST BE CALLED TO INITIATE PROCESSING
+  this->GetValueMultiThreadedInitiate();
 
-    typedef  itk::ImageRegionConstIteratorWithIndex< MovedGradientImageType >
-    MovedIteratorType;
+  MeasureType measure = NumericTraits< MeasureType >::Zero;
+  for ( unsigned int b = 0; b < m_BlockSums.size(); b++ )
+    {
+    measure += m_BlockSums[b];
+    }
 
-    MovedIteratorType movedIterator( m_MovedSobelFilters[iDimension]->GetOutput(),
-                                     this->GetFixedImageRegion() );
+  return measure;
+}
 
-    m_FixedSobelFilters[iDimension]->UpdateLargestPossibleRegion();
-    m_MovedSobelFilters[iDimension]->UpdateLargestPossibleRegion();
+template< class TFixedImage, class TMovingImage >
+void
+GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueThread(unsigned int threadID) const
+{
+  unsigned long fixedImageSample;
+  unsigned long endSample;
 
-    this->m_NumberOfPixelsCounted = 0;
+  this->GetThreadSampleRange(threadID, fixedImageSample, endSample);
 
-    while ( !fixedIterator.IsAtEnd() )
-      {
-      // Get the moving and fixed image gradients
+  const FixedGradientImageType *fixedGradients[FixedImageDimension];
+  const MovedGradientImageType *movedGradients[FixedImageDimension];
+  for ( unsigned int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
+    {
+    fixedGradients[iDimension] = m_FixedSobelFilters[iDimension]->GetOutput();
+    movedGradients[iDimension] = m_MovedSobelFilters[iDimension]->GetOutput();
+    }
 
-      movedGradient = movedIterator.Get();
-      fixedGradient  = fixedIterator.Get();
+  typename FixedImageType::IndexType index;
+  unsigned long                      numSamples = 0;
 
-      // And calculate the gradient difference
+  for ( ; fixedImageSample < endSample; ++fixedImageSample )
+    {
+    this->m_FixedImage->TransformPhysicalPointToIndex(
+      this->m_FixedImageSamples[fixedImageSample].point, index);
 
-      diff = fixedGradient - subtractionFactor[iDimension] * movedGradient;
+    double & blockSum = m_BlockSums[this->GetSampleBlock(fixedImageSample)];
+    for ( unsigned int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
+      {
+      if ( m_Variance[iDimension] == NumericTraits< MovedGradientPixelType >::Zero )
+        {
+        continue;
+        }
 
-      measure += m_Variance[iDimension] / ( m_Variance[iDimension] + diff * diff );
+      // Calculate the gradient difference
+      const MovedGradientPixelType diff = fixedGradients[iDimension]->GetPixel(index)
+                                          - m_SubtractionFactor[iDimension]
+                                          * movedGradients[iDimension]->GetPixel(index);
 
-      ++fixedIterator;
-      ++movedIterator;
+      blockSum += m_Variance[iDimension] / ( m_Variance[iDimension] + diff * diff );
       }
+    ++numSamples;
     }
 
-  return measure;
+  if ( threadID > 0 )
+    {
+    this->m_ThreaderNumberOfMovingImageSamples[threadID - 1] = numSamples;
+    }
+  else
+    {
+    this->m_NumberOfPixelsCounted = numSamples;
+    }
 }
 
 /**
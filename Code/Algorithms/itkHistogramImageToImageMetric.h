@@ -19,6 +19,10 @@
 
 #include "itkHistogram.h"
 #include "itkImageToImageMetric.h"
+#include "itkArray2D.h"
+#include "itkBSplineKernelFunction.h"
+#include "itkBSplineDerivativeKernelFunction.h"
+#include <vector>
 
 namespace itk
 {
@@ -31,6 +35,20 @@ namespace itk
   The metric computes the similarity measure between pixels in the
   moving image and pixels in the fixed image using a histogram.
 
+  The joint histogram is filled on several threads from the samples of
+  the fixed image (see ImageToImageMetric), by default all the pixels of
+  the fixed image region. Each thread counts its samples in a histogram of
+  its own, and the histograms are added at the end.
+
+  The derivative is computed by finite differences, building the joint
+  histogram twice for each parameter. When UseParzenWindowDerivative is
+  on, and the subclass can differentiate its measure with respect to the
+  frequencies of the histogram (see EvaluateMeasureFrequencyDerivatives()),
+  the derivative is instead computed analytically in one more pass over the
+  samples: it is the derivative of the measure of the joint histogram whose
+  moving intensities are spread over the bins by a cubic B-spline Parzen
+  window, which is differentiable with respect to the parameters.
+
   \ingroup RegistrationMetrics */
 template< class TFixedImage, class TMovingImage >
 class ITK_EXPORT HistogramImageToImageMetric:
@@ -52,6 +70,7 @@ public:
   typedef typename Superclass::TransformPointer           TransformPointer;
   typedef typename Superclass::TransformParametersType    TransformParametersType;
   typedef typename Superclass::TransformJacobianType      TransformJacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
   typedef typename Superclass::GradientPixelType          GradientPixelType;
   typedef typename Superclass::InputPointType             InputPointType;
   typedef typename Superclass::OutputPointType            OutputPointType;
@@ -112,6 +131,15 @@ public:
   itkSetMacro(UsePaddingValue, bool);
   itkGetConstMacro(UsePaddingValue, bool);
 
+  /** Set whether the derivative is computed analytically, through a cubic
+   * B-spline Parzen window along the moving intensities, instead of by
+   * finite differences. Only the subclasses which reimplement
+   * EvaluateMeasureFrequencyDerivatives() support it; the others keep using
+   * finite differences. Default is off. */
+  itkSetMacro(UseParzenWindowDerivative, bool);
+  itkGetConstMacro(UseParzenWindowDerivative, bool);
+  itkBooleanMacro(UseParzenWindowDerivative);
+
   /** Sets the step length used to calculate the derivative. */
   itkSetMacro(DerivativeStepLength, double);
 
@@ -191,6 +219,29 @@ protected:
       subclasses must reimplement this method. */
   virtual MeasureType EvaluateMeasure(HistogramType & histogram) const = 0;
 
+  /** Real frequencies of a joint histogram, the rows being the bins of the
+   * fixed image and the columns those of the moving image. */
+  typedef Array2D< double > JointFrequenciesType;
+
+  /** Evaluates the derivatives of the similarity measure with respect to
+   * the frequencies of the given joint histogram, its total frequency being
+   * held fixed. The subclasses which can differentiate their measure
+   * reimplement this method and return true, which lets the derivative be
+   * computed analytically. The default implementation returns false. */
+  virtual bool EvaluateMeasureFrequencyDerivatives(const JointFrequenciesType & itkNotUsed(frequencies),
+                                                   JointFrequenciesType & itkNotUsed(derivatives) ) const
+  {
+    return false;
+  }
+
+  /** Returns the center of a bin of the histogram along the fixed (0) or
+   * moving (1) intensities. */
+  double GetBinCenter(unsigned int dimension, unsigned int bin) const
+  {
+    return m_LowerBound[dimension] + ( bin + 0.5 )
+           * ( m_UpperBound[dimension] - m_LowerBound[dimension] ) / m_HistogramSize[dimension];
+  }
+
   /** PrintSelf funtion */
   void PrintSelf(std::ostream & os, Indent indent) const;
 
@@ -215,6 +266,76 @@ private:
   /** Pointer to the joint histogram. This is updated during every call to
    * GetValue() */
   HistogramPointer m_Histogram;
+
+  bool m_UseParzenWindowDerivative;
+
+  typedef typename Superclass::MovingImagePointType MovingImagePointType;
+  typedef typename Superclass::ImageDerivativesType ImageDerivativesType;
+
+  /** Fills the joint histogram from the samples on the threads, and with
+   * withParzenWindow the real frequencies of the histogram smoothed along
+   * the moving intensities. */
+  void ComputeJointHistogram(const TransformParametersType & parameters,
+                             HistogramType & histogram,
+                             bool withParzenWindow) const;
+
+  /** Computes the derivative through the Parzen window, once the joint
+   * histogram of the parameters is computed. Returns false if the measure
+   * cannot be differentiated with respect to the frequencies. */
+  bool ComputeParzenWindowDerivative(DerivativeType & derivative) const;
+
+  /** Computes the derivative by finite differences. */
+  void ComputeFiniteDifferenceDerivative(const TransformParametersType & parameters,
+                                         DerivativeType & derivative) const;
+
+  /** Finds the bins of a sample in the joint histogram, which are stored in
+   * m_ThreadIndices. Returns false if the sample is outside of the
+   * histogram. */
+  bool GetSampleBins(unsigned int threadID, double fixedImageValue, double movingImageValue) const;
+
+  /** Position of a moving intensity along the centers of the bins. */
+  double GetMovingBinPosition(double movingImageValue) const
+  {
+    return ( movingImageValue - m_LowerBound[1] ) * m_HistogramSize[1]
+           / ( m_UpperBound[1] - m_LowerBound[1] ) - 0.5;
+  }
+
+  inline bool GetValueThreadProcessSample(unsigned int threadID,
+                                          unsigned long fixedImageSample,
+                                          const MovingImagePointType & mappedPoint,
+                                          double movingImageValue) const;
+
+  inline bool GetValueAndDerivativeThreadProcessSample(unsigned int threadID,
+                                                       unsigned long fixedImageSample,
+                                                       const MovingImagePointType & mappedPoint,
+                                                       double movingImageValue,
+                                                       const ImageDerivativesType &
+                                                       movingImageGradientValue) const;
+
+  /** Frequencies counted by each thread, indexed by the instance identifiers
+   * of the histogram. */
+  mutable std::vector< std::vector< double > > m_ThreadFrequencies;
+  mutable std::vector< std::vector< double > > m_ThreadParzenFrequencies;
+  mutable std::vector< DerivativeType >        m_ThreadDerivatives;
+
+  /** Measurement and bins of the current sample of each thread. */
+  mutable std::vector< MeasurementVectorType >           m_ThreadMeasurements;
+  mutable std::vector< typename HistogramType::IndexType > m_ThreadIndices;
+
+  /** The histogram filled by the threads, and whether they fill the Parzen
+   * window frequencies too. */
+  mutable const HistogramType *m_ThreaderHistogram;
+  mutable bool                 m_ThreaderUseParzenWindow;
+
+  /** Cubic B-spline Parzen window and its derivative. */
+  typedef BSplineKernelFunction< 3 >           CubicBSplineFunctionType;
+  typedef BSplineDerivativeKernelFunction< 3 > CubicBSplineDerivativeFunctionType;
+
+  typename CubicBSplineFunctionType::Pointer           m_CubicBSplineKernel;
+  typename CubicBSplineDerivativeFunctionType::Pointer m_CubicBSplineDerivativeKernel;
+
+  mutable JointFrequenciesType m_ParzenFrequencies;
+  mutable JointFrequenciesType m_FrequencyDerivatives;
 };
 } // end namespace itk
 
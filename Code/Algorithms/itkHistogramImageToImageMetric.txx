@@ -22,6 +22,7 @@
 #include "itkNumericTraits.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "vnl/vnl_math.h"
 
 namespace itk
 {
@@ -41,6 +42,15 @@ HistogramImageToImageMetric< TFixedImage, TMovingImage >
   m_Histogram->SetMeasurementVectorSize(2);
   m_LowerBoundSetByUser = false;
   m_UpperBoundSetByUser = false;
+  m_UseParzenWindowDerivative = false;
+  m_ThreaderHistogram = 0;
+  m_ThreaderUseParzenWindow = false;
+  m_CubicBSplineKernel = CubicBSplineFunctionType::New();
+  m_CubicBSplineDerivativeKernel = CubicBSplineDerivativeFunctionType::New();
+
+  // The histogram is built from all the pixels of the fixed image region,
+  // as the samples of the threads.
+  this->SetUseAllPixels(true);
 }
 
 template< class TFixedImage, class TMovingImage >
@@ -145,6 +155,24 @@ throw ( ExceptionObject )
         maxMoving + ( maxMoving - minMoving ) * m_UpperBoundIncreaseFactor;
       }
     }
+
+  this->Superclass::MultiThreadingInitialize();
+
+  // Each thread counts its samples in a histogram of its own.
+  const unsigned long numberOfBins = m_HistogramSize[0] * m_HistogramSize[1];
+  m_ThreadFrequencies.resize(this->m_NumberOfThreads);
+  m_ThreadParzenFrequencies.resize(this->m_NumberOfThreads);
+  m_ThreadDerivatives.resize(this->m_NumberOfThreads);
+  m_ThreadMeasurements.resize(this->m_NumberOfThreads);
+  m_ThreadIndices.resize(this->m_NumberOfThreads);
+  for ( unsigned int t = 0; t < this->m_NumberOfThreads; t++ )
+    {
+    m_ThreadFrequencies[t].assign(numberOfBins, 0.0);
+    m_ThreadParzenFrequencies[t].clear();
+    m_ThreadDerivatives[t].SetSize(this->m_NumberOfParameters);
+    m_ThreadMeasurements[t].SetSize(2);
+    m_ThreadIndices[t].SetSize(2);
+    }
 }
 
 template< class TFixedImage, class TMovingImage >
@@ -181,6 +209,52 @@ HistogramImageToImageMetric< TFixedImage, TMovingImage >
 {
   itkDebugMacro("GetDerivative( " << parameters << " ) ");
 
+  if ( m_UseParzenWindowDerivative )
+    {
+    typename HistogramType::Pointer pHistogram = HistogramType::New();
+    pHistogram->SetMeasurementVectorSize(2);
+    this->ComputeJointHistogram(parameters, *pHistogram, true);
+    if ( this->ComputeParzenWindowDerivative(derivative) )
+      {
+      return;
+      }
+    }
+
+  this->ComputeFiniteDifferenceDerivative(parameters, derivative);
+}
+
+template< class TFixedImage, class TMovingImage >
+void
+HistogramImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivative(const TransformParametersType & parameters,
+                        MeasureType & value,
+                        DerivativeType & derivative) const
+{
+  this->UpdateFixedImageSamples();
+
+  if ( m_UseParzenWindowDerivative )
+    {
+    this->ComputeJointHistogram(parameters, *m_Histogram, true);
+    value = this->EvaluateMeasure(*m_Histogram);
+    if ( this->ComputeParzenWindowDerivative(derivative) )
+      {
+      return;
+      }
+    }
+  else
+    {
+    value = GetValue(parameters);
+    }
+
+  this->ComputeFiniteDifferenceDerivative(parameters, derivative);
+}
+
+template< class TFixedImage, class TMovingImage >
+void
+HistogramImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeFiniteDifferenceDerivative(const TransformParametersType & parameters,
+                                    DerivativeType & derivative) const
+{
   const unsigned int ParametersDimension = this->GetNumberOfParameters();
 
   // Make sure the scales have been set
@@ -200,46 +274,57 @@ HistogramImageToImageMetric< TFixedImage, TMovingImage >
 
   typename HistogramType::Pointer pHistogram = HistogramType::New();
   pHistogram->SetMeasurementVectorSize(2);
-  this->ComputeHistogram(parameters, *pHistogram);
 
   for ( unsigned int i = 0; i < ParametersDimension; i++ )
     {
-    typename HistogramType::Pointer pHistogram2 = HistogramType::New();
-    pHistogram2->SetMeasurementVectorSize(2);
-    this->CopyHistogram(*pHistogram2, *pHistogram);
-
     TransformParametersType newParameters = parameters;
     newParameters[i] -=
       m_DerivativeStepLength / m_DerivativeStepLengthScales[i];
-    this->ComputeHistogram(newParameters, *pHistogram2);
+    this->ComputeHistogram(newParameters, *pHistogram);
 
-    MeasureType e0 = EvaluateMeasure(*pHistogram2);
-
-    pHistogram2 = HistogramType::New();
-    pHistogram2->SetMeasurementVectorSize(2);
-    this->CopyHistogram(*pHistogram2, *pHistogram);
+    MeasureType e0 = EvaluateMeasure(*pHistogram);
 
     newParameters = parameters;
     newParameters[i] +=
       m_DerivativeStepLength / m_DerivativeStepLengthScales[i];
-    this->ComputeHistogram(newParameters, *pHistogram2);
+    this->ComputeHistogram(newParameters, *pHistogram);
 
-    MeasureType e1 = EvaluateMeasure(*pHistogram2);
+    MeasureType e1 = EvaluateMeasure(*pHistogram);
 
     derivative[i] =
       ( e1 - e0 ) / ( 2 * m_DerivativeStepLength / m_DerivativeStepLengthScales[i] );
     }
+
+  this->SetTransformParameters(parameters);
 }
 
 template< class TFixedImage, class TMovingImage >
-void
+bool
 HistogramImageToImageMetric< TFixedImage, TMovingImage >
-::GetValueAndDerivative(const TransformParametersType & parameters,
-                        MeasureType & value,
-                        DerivativeType & derivative) const
+::ComputeParzenWindowDerivative(DerivativeType & derivative) const
 {
-  value = GetValue(parameters);
-  this->GetDerivative(parameters, derivative);
+  m_FrequencyDerivatives.SetSize( m_ParzenFrequencies.rows(), m_ParzenFrequencies.cols() );
+  m_FrequencyDerivatives.Fill(0.0);
+  if ( !this->EvaluateMeasureFrequencyDerivatives(m_ParzenFrequencies, m_FrequencyDerivatives) )
+    {
+    return false;
+    }
+
+  for ( unsigned int t = 0; t < this->m_NumberOfThreads; t++ )
+    {
+    m_ThreadDerivatives[t].Fill(0.0);
+    }
+
+  // The transform parameters are those of the joint histogram.
+  this->GetValueAndDerivativeMultiThreadedInitiate();
+
+  derivative = m_ThreadDerivatives[0];
+  for ( unsigned int t = 1; t < this->m_NumberOfThreads; t++ )
+    {
+    derivative += m_ThreadDerivatives[t];
+    }
+
+  return true;
 }
 
 template< class TFixedImage, class TMovingImage >
@@ -248,72 +333,71 @@ HistogramImageToImageMetric< TFixedImage, TMovingImage >
 ::ComputeHistogram(TransformParametersType const & parameters,
                    HistogramType & histogram) const
 {
-  FixedImageConstPointerType fixedImage = this->m_FixedImage;
+  this->ComputeJointHistogram(parameters, histogram, false);
+}
 
-  if ( !fixedImage )
+template< class TFixedImage, class TMovingImage >
+void
+HistogramImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeJointHistogram(const TransformParametersType & parameters,
+                        HistogramType & histogram,
+                        bool withParzenWindow) const
+{
+  if ( !this->m_FixedImage )
     {
     itkExceptionMacro(<< "Fixed image has not been assigned");
     }
 
-  typedef itk::ImageRegionConstIteratorWithIndex< FixedImageType >
-  FixedIteratorType;
-
-  typename FixedImageType::IndexType index;
-  typename FixedImageType::RegionType fixedRegion;
-
-  fixedRegion = this->GetFixedImageRegion();
-  FixedIteratorType ti(fixedImage, fixedRegion);
-
   this->m_NumberOfPixelsCounted = 0;
   this->SetTransformParameters(parameters);
 
   histogram.Initialize(m_HistogramSize, m_LowerBound, m_UpperBound);
 
-  ti.GoToBegin();
-  while ( !ti.IsAtEnd() )
+  const unsigned long numberOfBins = m_HistogramSize[0] * m_HistogramSize[1];
+  for ( unsigned int t = 0; t < this->m_NumberOfThreads; t++ )
     {
-    index = ti.GetIndex();
-
-    if ( fixedRegion.IsInside(index)
-         && ( !m_UsePaddingValue
-              || ( m_UsePaddingValue && ti.Get() > m_PaddingValue ) ) )
+    std::fill(m_ThreadFrequencies[t].begin(), m_ThreadFrequencies[t].end(), 0.0);
+    if ( withParzenWindow )
       {
-      InputPointType inputPoint;
-      fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
+      m_ThreadParzenFrequencies[t].assign(numberOfBins, 0.0);
+      }
+    }
 
-      if ( this->m_FixedImageMask
-           && !this->m_FixedImageMask->IsInside(inputPoint) )
-        {
-        ++ti;
-        continue;
-        }
+  m_ThreaderHistogram = &histogram;
+  m_ThreaderUseParzenWindow = withParzenWindow;
 
-      OutputPointType transformedPoint =
-        this->m_Transform->TransformPoint(inputPoint);
+  this->GetValueMultiThreadedInitiate();
 
-      if ( this->m_MovingImageMask
-           && !this->m_MovingImageMask->IsInside(transformedPoint) )
-        {
-        ++ti;
-        continue;
-        }
+  // Add the histograms of the threads. The frequencies are counts, which
+  // are exact whatever their order.
+  for ( unsigned long id = 0; id < numberOfBins; id++ )
+    {
+    double frequency = 0.0;
+    for ( unsigned int t = 0; t < this->m_NumberOfThreads; t++ )
+      {
+      frequency += m_ThreadFrequencies[t][id];
+      }
+    if ( frequency > 0.0 )
+      {
+      histogram.SetFrequency( id, static_cast< typename HistogramType::AbsoluteFrequencyType >( frequency ) );
+      }
+    }
 
-      if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
+  if ( withParzenWindow )
+    {
+    m_ParzenFrequencies.SetSize(m_HistogramSize[0], m_HistogramSize[1]);
+    m_ParzenFrequencies.Fill(0.0);
+    for ( unsigned int t = 0; t < this->m_NumberOfThreads; t++ )
+      {
+      const double *frequency = &m_ThreadParzenFrequencies[t][0];
+      for ( unsigned int i = 0; i < m_HistogramSize[0]; i++ )
         {
-        const RealType movingValue =
-          this->m_Interpolator->Evaluate(transformedPoint);
-        const RealType fixedValue = ti.Get();
-        this->m_NumberOfPixelsCounted++;
-
-        typename HistogramType::MeasurementVectorType sample;
-        sample.SetSize(2);
-        sample[0] = fixedValue;
-        sample[1] = movingValue;
-        histogram.IncreaseFrequency(sample, 1);
+        for ( unsigned int j = 0; j < m_HistogramSize[1]; j++ )
+          {
+          m_ParzenFrequencies(i, j) += *frequency++;
+          }
         }
       }
-
-    ++ti;
     }
 
   itkDebugMacro("NumberOfPixelsCounted = " << this->m_NumberOfPixelsCounted);
@@ -324,6 +408,126 @@ HistogramImageToImageMetric< TFixedImage, TMovingImage >
     }
 }
 
+template< class TFixedImage, class TMovingImage >
+bool
+HistogramImageToImageMetric< TFixedImage, TMovingImage >
+::GetSampleBins(unsigned int threadID, double fixedImageValue, double movingImageValue) const
+{
+  MeasurementVectorType & measurement = m_ThreadMeasurements[threadID];
+
+  measurement[0] = fixedImageValue;
+  measurement[1] = movingImageValue;
+  return m_ThreaderHistogram->GetIndex(measurement, m_ThreadIndices[threadID]);
+}
+
+template< class TFixedImage, class TMovingImage >
+inline bool
+HistogramImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueThreadProcessSample(unsigned int threadID,
+                              unsigned long fixedImageSample,
+                              const MovingImagePointType & itkNotUsed(mappedPoint),
+                              double movingImageValue) const
+{
+  const double fixedImageValue = this->m_FixedImageSamples[fixedImageSample].value;
+
+  if ( m_UsePaddingValue && !( fixedImageValue > m_PaddingValue ) )
+    {
+    return false;
+    }
+
+  // The samples outside of the histogram are counted, but not binned.
+  if ( !this->GetSampleBins(threadID, fixedImageValue, movingImageValue) )
+    {
+    return true;
+    }
+
+  const typename HistogramType::IndexType & index = m_ThreadIndices[threadID];
+  const unsigned int fixedBin = static_cast< unsigned int >( index[0] );
+
+  m_ThreadFrequencies[threadID][fixedBin + index[1] * m_HistogramSize[0]] += 1.0;
+
+  if ( m_ThreaderUseParzenWindow )
+    {
+    // Spread the sample over the moving bins whose centers are within the
+    // support of the window, the weights outside of the histogram being
+    // added to its first and last bins.
+    const long   lastBin = static_cast< long >( m_HistogramSize[1] ) - 1;
+    const double position = this->GetMovingBinPosition(movingImageValue);
+    const long   firstBin = static_cast< long >( vcl_floor(position) ) - 1;
+    double *     frequencies = &m_ThreadParzenFrequencies[threadID][fixedBin * m_HistogramSize[1]];
+    for ( long j = firstBin; j < firstBin + 4; j++ )
+      {
+      const long bin = vnl_math_max( 0L, vnl_math_min(j, lastBin) );
+      frequencies[bin] += m_CubicBSplineKernel->Evaluate(position - j);
+      }
+    }
+
+  return true;
+}
+
+template< class TFixedImage, class TMovingImage >
+inline bool
+HistogramImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivativeThreadProcessSample(unsigned int threadID,
+                                           unsigned long fixedImageSample,
+                                           const MovingImagePointType & itkNotUsed(mappedPoint),
+                                           double movingImageValue,
+                                           const ImageDerivativesType &
+                                           movingImageGradientValue) const
+{
+  const double fixedImageValue = this->m_FixedImageSamples[fixedImageSample].value;
+
+  if ( m_UsePaddingValue && !( fixedImageValue > m_PaddingValue ) )
+    {
+    return false;
+    }
+
+  if ( !this->GetSampleBins(threadID, fixedImageValue, movingImageValue) )
+    {
+    return true;
+    }
+
+  // Derivative of the measure with respect to the moving value of the
+  // sample, through the Parzen window frequencies of its fixed bin.
+  const unsigned int fixedBin = static_cast< unsigned int >( m_ThreadIndices[threadID][0] );
+  const long         lastBin = static_cast< long >( m_HistogramSize[1] ) - 1;
+  const double       position = this->GetMovingBinPosition(movingImageValue);
+  const long         firstBin = static_cast< long >( vcl_floor(position) ) - 1;
+  double             weight = 0.0;
+  for ( long j = firstBin; j < firstBin + 4; j++ )
+    {
+    const long bin = vnl_math_max( 0L, vnl_math_min(j, lastBin) );
+    weight += m_FrequencyDerivatives(fixedBin, bin)
+              * m_CubicBSplineDerivativeKernel->Evaluate(position - j);
+    }
+  weight *= m_HistogramSize[1] / ( m_UpperBound[1] - m_LowerBound[1] );
+
+  if ( weight == 0.0 )
+    {
+    return true;
+    }
+
+  // Only the parameters of the non-zero columns of the Jacobian of the
+  // transform at the (fixed image) point of the sample have a derivative.
+  this->ComputeNonZeroJacobian(fixedImageSample, threadID);
+  const TransformJacobianType &      jacobian = this->m_ThreaderNonZeroJacobian[threadID];
+  const NonZeroJacobianIndicesType & nonZeroJacobianIndices =
+    this->m_ThreaderNonZeroJacobianIndices[threadID];
+
+  DerivativeType & derivative = m_ThreadDerivatives[threadID];
+  for ( unsigned int k = 0; k < nonZeroJacobianIndices.GetSize(); k++ )
+    {
+    double differential = 0.0;
+    for ( unsigned int dim = 0; dim < MovingImageType::ImageDimension; dim++ )
+      {
+      differential += jacobian(dim, k) * movingImageGradientValue[dim];
+      }
+    derivative[nonZeroJacobianIndices[k]] += weight * differential;
+    }
+
+  return true;
+}
+
 template< class TFixedImage, class TMovingImage >
 void
 HistogramImageToImageMetric< TFixedImage, TMovingImage >
@@ -380,6 +584,7 @@ HistogramImageToImageMetric< TFixedImage, TMovingImage >
     m_PaddingValue )
      << std::endl;
   os << indent << "Use padding value?: " << m_UsePaddingValue << std::endl;
+  os << indent << "Use Parzen window derivative?: " << m_UseParzenWindowDerivative << std::endl;
   os << indent << "Derivative step length: " << m_DerivativeStepLength
      << std::endl;
   os << indent << "Derivative step length scales: ";
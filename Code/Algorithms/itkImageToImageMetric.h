@@ -23,6 +23,7 @@
 #include "itkInterpolateImageFunction.h"
 #include "itkExceptionObject.h"
 #include "itkGradientRecursiveGaussianImageFilter.h"
+#include "itkGradientImageFilter.h"
 #include "itkSpatialObject.h"
 #include "itkBSplineDeformableTransform.h"
 #include "itkCentralDifferenceImageFunction.h"
@@ -31,6 +32,7 @@
 #include "itkMultiThreader.h"
 
 #include "itkBSplineInterpolateImageFunction.h"
+#include "itkLinearInterpolateImageFunction.h"
 
 namespace itk
 {
@@ -101,6 +103,8 @@ public:
   typedef typename TransformType::ParametersType  TransformParametersType;
   typedef typename TransformType::JacobianType    TransformJacobianType;
 
+  typedef typename TransformType::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+
   /** Index and Point typedef support. */
   typedef typename FixedImageType::IndexType           FixedImageIndexType;
   typedef typename FixedImageIndexType::IndexValueType FixedImageIndexValueType;
@@ -320,6 +324,39 @@ public:
   itkGetConstReferenceMacro(UseCachingOfBSplineWeights, bool);
   itkBooleanMacro(UseCachingOfBSplineWeights);
 
+  /** Select a faster evaluation of the samples, used when the
+   * interpolator is a LinearInterpolateImageFunction and the transform is
+   * not a BSplineDeformableTransform. The fixed image samples are then
+   * ordered along the fixed image, their coordinates are cached in one
+   * array per dimension, and they are mapped by chunks, through a single
+   * affine map when the transform is linear. The moving image value and
+   * gradient at a mapped point are interpolated together from the image
+   * buffers with the same weights. The gradient is taken from a gradient
+   * image computed at initialization: the smoothed gradient of
+   * ComputeGradient() when ComputeGradient is on, the central differences
+   * otherwise. Since this gradient is interpolated linearly instead of
+   * being taken at the nearest pixel, the derivatives differ slightly from
+   * those of the default evaluation. Off by default. */
+  itkSetMacro(UseFastSampleEvaluation, bool);
+  itkGetConstReferenceMacro(UseFastSampleEvaluation, bool);
+  itkBooleanMacro(UseFastSampleEvaluation);
+
+  /** Select whether a new random set of NumberOfFixedImageSamples samples
+   * is drawn at each GetValueAndDerivative(), instead of the set drawn
+   * once by Initialize(). Each iteration of the optimizer then only
+   * touches a small number of pixels, and the derivatives are noisy
+   * estimates which average out over the iterations: the optimizer should
+   * be a stochastic gradient descent, such as a GradientDescentOptimizer
+   * with a decaying learning rate. GetValue() evaluates the samples of the
+   * last GetValueAndDerivative(). The samples are drawn from the
+   * MersenneTwisterRandomVariateGenerator, and are reproducible after
+   * ReinitializeSeed() with a seed. This is ignored with UseAllPixels,
+   * UseSequentialSampling or fixed image indexes. The BSpline weights of
+   * the samples are not cached then. Off by default. */
+  itkSetMacro(UseStochasticSampling, bool);
+  itkGetConstReferenceMacro(UseStochasticSampling, bool);
+  itkBooleanMacro(UseStochasticSampling);
+
   typedef MultiThreader MultiThreaderType;
   /** Get the Threader. */
   itkGetConstObjectMacro(Threader, MultiThreaderType);
@@ -454,6 +491,15 @@ public:
   typedef BSplineInterpolateImageFunction< MovingImageType,
                                            CoordinateRepresentationType >
   BSplineInterpolatorType;
+  /** Interpolator evaluated directly by the fast evaluation of the
+   * samples. */
+  typedef LinearInterpolateImageFunction< MovingImageType,
+                                          CoordinateRepresentationType >
+  LinearInterpolatorType;
+  /** Filter computing the central differences of the moving image for
+   * the fast evaluation of the samples. */
+  typedef GradientImageFilter< MovingImageType, RealType, RealType >
+  CentralDifferenceGradientFilterType;
   /** Typedefs for using central difference calculator. */
   typedef CentralDifferenceImageFunction< MovingImageType,
                                           CoordinateRepresentationType >
@@ -472,8 +518,10 @@ public:
   BSplineParametersOffsetType m_BSplineParametersOffset;
 
   // Variables needed for optionally caching values when using a BSpline
-  // transform.
+  // transform. m_CachingOfBSplineWeights is set by
+  // MultiThreadingInitialize() when the weights are cached.
   bool                                   m_UseCachingOfBSplineWeights;
+  bool                                   m_CachingOfBSplineWeights;
   mutable BSplineTransformWeightsType    m_BSplineTransformWeights;
   mutable BSplineTransformIndexArrayType m_BSplineTransformIndices;
 
@@ -482,6 +530,22 @@ public:
 
   virtual void PreComputeTransformValues(void);
 
+  /** Non-zero columns of the Jacobian of the transform at a sample, and
+   * their parameters, per thread. */
+  mutable TransformJacobianType *     m_ThreaderNonZeroJacobian;
+  mutable NonZeroJacobianIndicesType *m_ThreaderNonZeroJacobianIndices;
+
+  /** Compute, into m_ThreaderNonZeroJacobian[threadID] and
+   * m_ThreaderNonZeroJacobianIndices[threadID], the columns of the
+   * Jacobian of the transform at the fixed image point of a sample which
+   * may not be zero. The derivative of a metric only needs to be
+   * accumulated over these parameters. For a BSplineDeformableTransform,
+   * the weights computed by TransformPoint() or
+   * TransformPointWithDerivatives() for the sample in the same thread are
+   * used. */
+  void ComputeNonZeroJacobian(unsigned int sampleNumber,
+                              unsigned int threadID) const;
+
   /** Transform a point from FixedImage domain to MovingImage domain.
    * This function also checks if mapped point is within support region. */
   virtual void TransformPoint(unsigned int sampleNumber,
@@ -497,6 +561,59 @@ public:
                                              ImageDerivativesType & gradient,
                                              unsigned int threadID) const;
 
+  /** Variables of the fast evaluation of the samples. The fast evaluation
+   * is used when m_FastSampleEvaluation is set by
+   * MultiThreadingInitialize(). The coordinates of dimension d of the
+   * samples are m_FixedImageSampleCoordinates[d *
+   * m_NumberOfFixedImageSamples + sample]. */
+  bool                                        m_UseFastSampleEvaluation;
+  bool                                        m_FastSampleEvaluation;
+  std::vector< CoordinateRepresentationType > m_FixedImageSampleCoordinates;
+  typename MovingImageType::DirectionType     m_MovingImagePhysicalPointToIndex;
+
+  /** Maximum number of samples mapped at once by the fast evaluation. */
+  itkStaticConstMacro(FastSampleChunkSize, unsigned int, 128);
+
+  /** Order of the samples of the fast evaluation: along the last
+   * dimension, then the previous ones. The samples mapped at once then
+   * read nearby pixels of the moving image, instead of pixels all over it
+   * as the random samples do. */
+  static bool FixedImageSampleIsBefore(const FixedImageSamplePoint & first,
+                                       const FixedImageSamplePoint & second);
+
+  /** Copy the coordinates of m_FixedImageSamples into
+   * m_FixedImageSampleCoordinates. */
+  void CacheFixedImageSampleCoordinates();
+
+  /** Map the samples [firstSample, endSample), at most FastSampleChunkSize
+   * of them, to the moving image, and interpolate the moving image there
+   * in one pass. The gradient is interpolated too when
+   * movingImageGradients is not NULL. This is the fast evaluation of the
+   * samples of TransformPoint() and TransformPointWithDerivatives(). */
+  void FastTransformPoints(unsigned long firstSample,
+                           unsigned long endSample,
+                           MovingImagePointType *mappedPoints,
+                           bool *samplesOk,
+                           double *movingImageValues,
+                           ImageDerivativesType *movingImageGradients,
+                           unsigned int threadID) const;
+
+  /** Variables of the stochastic sampling. m_StochasticSampling is set by
+   * MultiThreadingInitialize() when new samples are drawn at each
+   * GetValueAndDerivative(). */
+  bool m_UseStochasticSampling;
+  bool m_StochasticSampling;
+
+  /** Draw a new set of samples when m_StochasticSampling is set. The
+   * metrics call it at the start of GetValueAndDerivative(), before
+   * processing the samples. */
+  void UpdateFixedImageSamples() const;
+
+  /** Draw a new random set of samples over the fixed image region, and
+   * prepare them for the evaluation as MultiThreadingInitialize() does.
+   * Metrics precomputing values of the samples extend it. */
+  virtual void ResampleFixedImageRegion();
+
   /** Boolean to indicate if the interpolator BSpline. */
   bool m_InterpolatorIsBSpline;
   /** Pointer to BSplineInterpolator. */
@@ -524,6 +641,27 @@ public:
   bool                       m_WithinThreadPreProcess;
   bool                       m_WithinThreadPostProcess;
 
+  /** When not zero, the samples are split into this number of blocks of
+   * consecutive samples, and each thread processes whole blocks. A metric
+   * which accumulates its sums per block, and adds the sums of the blocks
+   * in their order, then computes the same value whatever the number of
+   * threads. Zero, the default, gives each thread an equal share of the
+   * samples. */
+  unsigned int  m_NumberOfSampleBlocks;
+  unsigned long m_SampleBlockSize;
+
+  itkStaticConstMacro(DefaultNumberOfSampleBlocks, unsigned int, 64);
+
+  /** Get the samples [first, end) processed by a thread. */
+  void GetThreadSampleRange(unsigned int threadID,
+                            unsigned long & first, unsigned long & end) const;
+
+  /** Get the block of a sample, when the samples are split into blocks. */
+  unsigned int GetSampleBlock(unsigned long fixedImageSample) const
+  {
+    return static_cast< unsigned int >( fixedImageSample / m_SampleBlockSize );
+  }
+
   void                           GetValueMultiThreadedPreProcessInitiate(void) const;
 
   void                           GetValueMultiThreadedInitiate(void) const;
@@ -20,6 +20,7 @@
 #include "itkImageToImageMetric.h"
 #include "itkImageRandomConstIteratorWithIndex.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -48,6 +49,8 @@ ImageToImageMetric< TFixedImage, TMovingImage >
   m_ThreaderNumberOfMovingImageSamples = NULL;
   m_WithinThreadPreProcess = false;
   m_WithinThreadPostProcess = false;
+  m_NumberOfSampleBlocks = 0;
+  m_SampleBlockSize = 1;
 
   m_FixedImage    = 0; // has to be provided by the user.
   m_FixedImageMask = 0;
@@ -75,6 +78,17 @@ ImageToImageMetric< TFixedImage, TMovingImage >
   this->m_ThreaderBSplineTransformIndices = NULL;
 
   this->m_UseCachingOfBSplineWeights = true;
+  this->m_CachingOfBSplineWeights = false;
+
+  this->m_ThreaderNonZeroJacobian = NULL;
+  this->m_ThreaderNonZeroJacobianIndices = NULL;
+
+  this->m_UseFastSampleEvaluation = false;
+  this->m_FastSampleEvaluation = false;
+  this->m_MovingImagePhysicalPointToIndex.SetIdentity();
+
+  this->m_UseStochasticSampling = false;
+  this->m_StochasticSampling = false;
 
   /* if 100% backward compatible, we should include this...but...
   typename BSplineTransformType::Pointer transformer =
@@ -114,6 +128,18 @@ ImageToImageMetric< TFixedImage, TMovingImage >
     delete[] this->m_ThreaderBSplineTransformIndices;
     }
   this->m_ThreaderBSplineTransformIndices = NULL;
+
+  if ( this->m_ThreaderNonZeroJacobian != NULL )
+    {
+    delete[] this->m_ThreaderNonZeroJacobian;
+    }
+  this->m_ThreaderNonZeroJacobian = NULL;
+
+  if ( this->m_ThreaderNonZeroJacobianIndices != NULL )
+    {
+    delete[] this->m_ThreaderNonZeroJacobianIndices;
+    }
+  this->m_ThreaderNonZeroJacobianIndices = NULL;
 }
 
 /**
@@ -387,7 +413,39 @@ throw ( ExceptionObject )
     this->m_ThreaderTransform[ithread] = transformCopy;
     }
 
+  if ( m_UseAllPixels && m_FixedImageMask.IsNotNull() )
+    {
+    // Take each pixel of the region inside the mask once, instead of going
+    // around the masked pixels until there are as many samples as pixels
+    // in the region.
+    typedef ImageRegionConstIteratorWithIndex< FixedImageType > RegionIterator;
+    RegionIterator regionIter( m_FixedImage, this->GetFixedImageRegion() );
+    InputPointType inputPoint;
+    m_NumberOfFixedImageSamples = 0;
+    for ( regionIter.GoToBegin(); !regionIter.IsAtEnd(); ++regionIter )
+      {
+      m_FixedImage->TransformIndexToPhysicalPoint(regionIter.GetIndex(), inputPoint);
+      if ( m_FixedImageMask->IsInside(inputPoint) )
+        {
+        ++m_NumberOfFixedImageSamples;
+        }
+      }
+    if ( m_NumberOfFixedImageSamples == 0 )
+      {
+      itkExceptionMacro(<< "No pixel of the FixedImageRegion is inside the FixedImageMask");
+      }
+    }
+
   m_FixedImageSamples.resize(m_NumberOfFixedImageSamples);
+  if ( m_NumberOfSampleBlocks > 0 )
+    {
+    m_SampleBlockSize = ( m_NumberOfFixedImageSamples + m_NumberOfSampleBlocks - 1 )
+                        / m_NumberOfSampleBlocks;
+    if ( m_SampleBlockSize == 0 )
+      {
+      m_SampleBlockSize = 1;
+      }
+    }
   if ( m_UseSequentialSampling )
     {
     //
@@ -416,6 +474,11 @@ throw ( ExceptionObject )
       }
     }
 
+  // Only the samples drawn at random are drawn again at each evaluation
+  this->m_StochasticSampling = this->m_UseStochasticSampling
+                               && !m_UseSequentialSampling
+                               && !m_UseFixedImageIndexes;
+
   //
   //  Check if the interpolator is of type BSplineInterpolateImageFunction.
   //  If so, we can make use of its EvaluateDerivatives method.
@@ -498,7 +561,11 @@ throw ( ExceptionObject )
       }
     this->m_ThreaderBSplineTransformIndices = NULL;
 
-    if ( this->m_UseCachingOfBSplineWeights )
+    // The weights of samples drawn at each evaluation are computed when
+    // they are mapped
+    this->m_CachingOfBSplineWeights = this->m_UseCachingOfBSplineWeights
+                                      && !this->m_StochasticSampling;
+    if ( this->m_CachingOfBSplineWeights )
       {
       m_BSplineTransformWeightsArray.SetSize(
         m_NumberOfFixedImageSamples, m_NumBSplineWeights);
@@ -529,6 +596,412 @@ throw ( ExceptionObject )
       this->m_BSplineParametersOffset[j] = j * this->m_BSplineTransform->GetNumberOfParametersPerDimension();
       }
     }
+
+  //
+  //  Check if the samples can be evaluated by FastTransformPoints(): it
+  //  reproduces the evaluation of a LinearInterpolateImageFunction, and
+  //  leaves the BSplineDeformableTransform to its own caching.
+  //
+  this->m_FastSampleEvaluation = false;
+  this->m_FixedImageSampleCoordinates.clear();
+  if ( this->m_UseFastSampleEvaluation && !this->m_TransformIsBSpline
+       && dynamic_cast< LinearInterpolatorType * >( this->m_Interpolator.GetPointer() ) )
+    {
+    if ( !this->m_ComputeGradient )
+      {
+      typename CentralDifferenceGradientFilterType::Pointer gradientFilter =
+        CentralDifferenceGradientFilterType::New();
+      gradientFilter->SetInput(m_MovingImage);
+      gradientFilter->SetNumberOfThreads(m_NumberOfThreads);
+      gradientFilter->SetUseImageDirection(true);
+      gradientFilter->Update();
+      m_GradientImage = gradientFilter->GetOutput();
+      }
+
+    // The gradient is read at the offsets of the moving image pixels
+    if ( m_GradientImage.IsNotNull()
+         && m_GradientImage->GetBufferedRegion() == m_MovingImage->GetBufferedRegion() )
+      {
+      typename MovingImageType::DirectionType indexToPhysicalPoint = m_MovingImage->GetDirection();
+      for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+        {
+        for ( unsigned int j = 0; j < MovingImageDimension; j++ )
+          {
+          indexToPhysicalPoint[i][j] *= m_MovingImage->GetSpacing()[j];
+          }
+        }
+      this->m_MovingImagePhysicalPointToIndex = indexToPhysicalPoint.GetInverse();
+
+      // Neighboring samples read neighboring moving image pixels
+      std::sort(m_FixedImageSamples.begin(), m_FixedImageSamples.end(), FixedImageSampleIsBefore);
+      this->CacheFixedImageSampleCoordinates();
+      this->m_FastSampleEvaluation = true;
+      itkDebugMacro("Samples are evaluated from the cached coordinates");
+      }
+    }
+
+  // Allocate the non-zero columns of the Jacobian of each thread. Those
+  // of the BSplineDeformableTransform are filled from its weights, and
+  // their other elements stay zero.
+  if ( this->m_ThreaderNonZeroJacobian != NULL )
+    {
+    delete[] this->m_ThreaderNonZeroJacobian;
+    }
+  this->m_ThreaderNonZeroJacobian = new TransformJacobianType[m_NumberOfThreads];
+
+  if ( this->m_ThreaderNonZeroJacobianIndices != NULL )
+    {
+    delete[] this->m_ThreaderNonZeroJacobianIndices;
+    }
+  this->m_ThreaderNonZeroJacobianIndices = new NonZeroJacobianIndicesType[m_NumberOfThreads];
+
+  const unsigned long numberOfNonZeroJacobianIndices = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
+  for ( unsigned int ithread = 0; ithread < m_NumberOfThreads; ++ithread )
+    {
+    this->m_ThreaderNonZeroJacobian[ithread].SetSize(FixedImageDimension, numberOfNonZeroJacobianIndices);
+    this->m_ThreaderNonZeroJacobian[ithread].Fill(0.0);
+    this->m_ThreaderNonZeroJacobianIndices[ithread].SetSize(numberOfNonZeroJacobianIndices);
+    }
+}
+
+/**
+ * Compute the non-zero columns of the Jacobian at a sample
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeNonZeroJacobian(unsigned int sampleNumber, unsigned int threadID) const
+{
+  TransformJacobianType &      jacobian = this->m_ThreaderNonZeroJacobian[threadID];
+  NonZeroJacobianIndicesType & nonZeroJacobianIndices = this->m_ThreaderNonZeroJacobianIndices[threadID];
+
+  if ( !m_TransformIsBSpline )
+    {
+    // Need to use one of the threader transforms if we're
+    // not in thread 0.
+    const TransformType *transform;
+    if ( threadID > 0 )
+      {
+      transform = this->m_ThreaderTransform[threadID - 1];
+      }
+    else
+      {
+      transform = this->m_Transform;
+      }
+
+    // Jacobian should be evaluated at the unmapped (fixed image) point.
+    transform->GetNonZeroJacobian(m_FixedImageSamples[sampleNumber].point,
+                                  jacobian, nonZeroJacobianIndices);
+    return;
+    }
+
+  // The weights of the BSplineDeformableTransform are those computed when
+  // the sample was mapped
+  const WeightsValueType *weights;
+  const IndexValueType *  indices;
+  if ( this->m_CachingOfBSplineWeights )
+    {
+    weights = m_BSplineTransformWeightsArray[sampleNumber];
+    indices = m_BSplineTransformIndicesArray[sampleNumber];
+    }
+  else if ( threadID > 0 )
+    {
+    weights = this->m_ThreaderBSplineTransformWeights[threadID - 1].data_block();
+    indices = this->m_ThreaderBSplineTransformIndices[threadID - 1].data_block();
+    }
+  else
+    {
+    weights = this->m_BSplineTransformWeights.data_block();
+    indices = this->m_BSplineTransformIndices.data_block();
+    }
+
+  unsigned long column = 0;
+  for ( unsigned int j = 0; j < FixedImageDimension; j++ )
+    {
+    for ( unsigned long k = 0; k < m_NumBSplineWeights; k++ )
+      {
+      jacobian(j, column) = weights[k];
+      nonZeroJacobianIndices[column] = indices[k] + m_BSplineParametersOffset[j];
+      ++column;
+      }
+    }
+}
+
+/**
+ * Order the samples for the fast evaluation
+ */
+template< class TFixedImage, class TMovingImage >
+bool
+ImageToImageMetric< TFixedImage, TMovingImage >
+::FixedImageSampleIsBefore(const FixedImageSamplePoint & first,
+                           const FixedImageSamplePoint & second)
+{
+  for ( unsigned int j = FixedImageDimension; j > 0; j-- )
+    {
+    if ( first.point[j - 1] != second.point[j - 1] )
+      {
+      return first.point[j - 1] < second.point[j - 1];
+      }
+    }
+  return false;
+}
+
+/**
+ * Cache the coordinates of the samples for the fast evaluation
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::CacheFixedImageSampleCoordinates()
+{
+  m_FixedImageSampleCoordinates.resize(FixedImageDimension * m_NumberOfFixedImageSamples);
+  for ( unsigned int j = 0; j < FixedImageDimension; j++ )
+    {
+    CoordinateRepresentationType *coordinates =
+      &m_FixedImageSampleCoordinates[j * m_NumberOfFixedImageSamples];
+    for ( unsigned long sample = 0; sample < m_NumberOfFixedImageSamples; sample++ )
+      {
+      coordinates[sample] = m_FixedImageSamples[sample].point[j];
+      }
+    }
+}
+
+/**
+ * Draw new samples when they are drawn at each evaluation
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::UpdateFixedImageSamples() const
+{
+  if ( this->m_StochasticSampling )
+    {
+    const_cast< Self * >( this )->ResampleFixedImageRegion();
+    }
+}
+
+/**
+ * Draw a new random set of samples
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::ResampleFixedImageRegion()
+{
+  this->SampleFixedImageRegion(m_FixedImageSamples);
+
+  if ( this->m_FastSampleEvaluation )
+    {
+    std::sort(m_FixedImageSamples.begin(), m_FixedImageSamples.end(), FixedImageSampleIsBefore);
+    this->CacheFixedImageSampleCoordinates();
+    }
+}
+
+/**
+ * Map a chunk of samples and interpolate the moving image at them
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::FastTransformPoints(unsigned long firstSample,
+                      unsigned long endSample,
+                      MovingImagePointType *mappedPoints,
+                      bool *samplesOk,
+                      double *movingImageValues,
+                      ImageDerivativesType *movingImageGradients,
+                      unsigned int threadID) const
+{
+  const unsigned int numberOfSamples = static_cast< unsigned int >( endSample - firstSample );
+  const CoordinateRepresentationType *coordinates = &m_FixedImageSampleCoordinates[firstSample];
+
+  TransformType *transform;
+  if ( threadID > 0 )
+    {
+    transform = this->m_ThreaderTransform[threadID - 1];
+    }
+  else
+    {
+    transform = this->m_Transform;
+    }
+
+  // The mapped points and their continuous indices, one array per dimension
+  double mapped[MovingImageDimension][FastSampleChunkSize];
+  double continuousIndex[MovingImageDimension][FastSampleChunkSize];
+
+  FixedImagePointType point;
+  if ( transform->IsLinear() )
+    {
+    // As in ResampleImageFilter, the affine map of a linear transform is
+    // taken from the mapping of the origin and of the unit vectors.
+    point.Fill(0.0);
+    const MovingImagePointType offset = transform->TransformPoint(point);
+    for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+      {
+      for ( unsigned int s = 0; s < numberOfSamples; s++ )
+        {
+        mapped[i][s] = offset[i];
+        }
+      }
+    for ( unsigned int j = 0; j < FixedImageDimension; j++ )
+      {
+      point[j] = 1.0;
+      const MovingImagePointType column = transform->TransformPoint(point);
+      point[j] = 0.0;
+
+      const CoordinateRepresentationType *x = coordinates + j * m_NumberOfFixedImageSamples;
+      for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+        {
+        const double a = column[i] - offset[i];
+        double *     y = mapped[i];
+        for ( unsigned int s = 0; s < numberOfSamples; s++ )
+          {
+          y[s] += a * x[s];
+          }
+        }
+      }
+    }
+  else
+    {
+    for ( unsigned int s = 0; s < numberOfSamples; s++ )
+      {
+      for ( unsigned int j = 0; j < FixedImageDimension; j++ )
+        {
+        point[j] = coordinates[j * m_NumberOfFixedImageSamples + s];
+        }
+      const MovingImagePointType mappedPoint = transform->TransformPoint(point);
+      for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+        {
+        mapped[i][s] = mappedPoint[i];
+        }
+      }
+    }
+
+  // Continuous indices relative to the start of the buffer
+  const typename MovingImageType::PointType &  origin = m_MovingImage->GetOrigin();
+  const typename MovingImageType::RegionType & region = m_MovingImage->GetBufferedRegion();
+  for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+    {
+    double *c = continuousIndex[i];
+    for ( unsigned int s = 0; s < numberOfSamples; s++ )
+      {
+      c[s] = -static_cast< double >( region.GetIndex(i) );
+      }
+    for ( unsigned int j = 0; j < MovingImageDimension; j++ )
+      {
+      const double  a = m_MovingImagePhysicalPointToIndex[i][j];
+      const double  o = origin[j];
+      const double *y = mapped[j];
+      for ( unsigned int s = 0; s < numberOfSamples; s++ )
+        {
+        c[s] += a * ( y[s] - o );
+        }
+      }
+    }
+
+  // The neighbors of a point are taken from the base pixel of its
+  // interpolation, which is moved inside the buffer near the border the
+  // way LinearInterpolateImageFunction clamps the neighbors.
+  const unsigned int numberOfNeighbors = 1 << MovingImageDimension;
+  const typename MovingImageType::OffsetValueType *offsetTable = m_MovingImage->GetOffsetTable();
+  double upperBound[MovingImageDimension];
+  long   maximumBase[MovingImageDimension];
+  long   neighborOffsets[1 << MovingImageDimension];
+  for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+    {
+    const long size = static_cast< long >( region.GetSize(i) );
+    upperBound[i] = size - 0.5;
+    maximumBase[i] = ( size > 1 ) ? size - 2 : 0;
+    }
+  for ( unsigned int n = 0; n < numberOfNeighbors; n++ )
+    {
+    neighborOffsets[n] = 0;
+    for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+      {
+      if ( ( ( n >> i ) & 1 ) && region.GetSize(i) > 1 )
+        {
+        neighborOffsets[n] += offsetTable[i];
+        }
+      }
+    }
+
+  const MovingImagePixelType *movingBuffer = m_MovingImage->GetBufferPointer();
+  const GradientPixelType *   gradientBuffer = m_GradientImage->GetBufferPointer();
+  for ( unsigned int s = 0; s < numberOfSamples; s++ )
+    {
+    for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+      {
+      mappedPoints[s][i] = mapped[i][s];
+      }
+
+    bool sampleOk = true;
+    for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+      {
+      sampleOk = sampleOk && continuousIndex[i][s] >= -0.5 && continuousIndex[i][s] < upperBound[i];
+      }
+    if ( sampleOk && m_MovingImageMask )
+      {
+      sampleOk = m_MovingImageMask->IsInside(mappedPoints[s]);
+      }
+    samplesOk[s] = sampleOk;
+    if ( !sampleOk )
+      {
+      continue;
+      }
+
+    long   offset = 0;
+    double distance[MovingImageDimension];
+    for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+      {
+      long base = Math::Floor< long >(continuousIndex[i][s]);
+      distance[i] = continuousIndex[i][s] - base;
+      if ( base < 0 )
+        {
+        base = 0;
+        distance[i] = 0.0;
+        }
+      else if ( base > maximumBase[i] )
+        {
+        base = maximumBase[i];
+        distance[i] = 1.0;
+        }
+      offset += base * offsetTable[i];
+      }
+
+    double value = 0.0;
+    if ( movingImageGradients )
+      {
+      ImageDerivativesType & gradient = movingImageGradients[s];
+      gradient.Fill(0.0);
+      for ( unsigned int n = 0; n < numberOfNeighbors; n++ )
+        {
+        double weight = 1.0;
+        for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+          {
+          weight *= ( ( n >> i ) & 1 ) ? distance[i] : 1.0 - distance[i];
+          }
+        const long neighbor = offset + neighborOffsets[n];
+        value += weight * static_cast< double >( movingBuffer[neighbor] );
+        const GradientPixelType & neighborGradient = gradientBuffer[neighbor];
+        for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+          {
+          gradient[i] += weight * neighborGradient[i];
+          }
+        }
+      }
+    else
+      {
+      for ( unsigned int n = 0; n < numberOfNeighbors; n++ )
+        {
+        double weight = 1.0;
+        for ( unsigned int i = 0; i < MovingImageDimension; i++ )
+          {
+          weight *= ( ( n >> i ) & 1 ) ? distance[i] : 1.0 - distance[i];
+          }
+        value += weight * static_cast< double >( movingBuffer[offset + neighborOffsets[n]] );
+        }
+      }
+    movingImageValues[s] = value;
+    }
 }
 
 /**
@@ -924,7 +1397,7 @@ ImageToImageMetric< TFixedImage, TMovingImage >
     }
   else
     {
-    if ( this->m_UseCachingOfBSplineWeights )
+    if ( this->m_CachingOfBSplineWeights )
       {
       sampleOk = m_WithinBSplineSupportRegionArray[sampleNumber];
 
@@ -1042,7 +1515,7 @@ ImageToImageMetric< TFixedImage, TMovingImage >
     }
   else
     {
-    if ( this->m_UseCachingOfBSplineWeights )
+    if ( this->m_CachingOfBSplineWeights )
       {
       sampleOk = m_WithinBSplineSupportRegionArray[sampleNumber];
 
@@ -1271,21 +1744,34 @@ ImageToImageMetric< TFixedImage, TMovingImage >
 template< class TFixedImage, class TMovingImage  >
 void
 ImageToImageMetric< TFixedImage, TMovingImage >
-::GetValueThread(unsigned int threadID) const
+::GetThreadSampleRange(unsigned int threadID,
+                       unsigned long & first, unsigned long & end) const
 {
-  // Figure out how many samples to process
-  int chunkSize = m_NumberOfFixedImageSamples / m_NumberOfThreads;
-
-  // Skip to this thread's samples to process
-  unsigned int fixedImageSample = threadID * chunkSize;
-
-  if ( threadID == m_NumberOfThreads - 1 )
+  if ( m_NumberOfSampleBlocks == 0 )
     {
-    chunkSize = m_NumberOfFixedImageSamples
-                - ( ( m_NumberOfThreads - 1 )
-                    * chunkSize );
+    const unsigned long chunkSize = m_NumberOfFixedImageSamples / m_NumberOfThreads;
+    first = threadID * chunkSize;
+    end = ( threadID == m_NumberOfThreads - 1 ) ? m_NumberOfFixedImageSamples : first + chunkSize;
+    return;
     }
 
+  // Whole blocks, the same for any number of threads
+  const unsigned long firstBlock = threadID * m_NumberOfSampleBlocks / m_NumberOfThreads;
+  const unsigned long endBlock = ( threadID + 1 ) * m_NumberOfSampleBlocks / m_NumberOfThreads;
+  first = vnl_math_min(firstBlock * m_SampleBlockSize, m_NumberOfFixedImageSamples);
+  end = vnl_math_min(endBlock * m_SampleBlockSize, m_NumberOfFixedImageSamples);
+}
+
+template< class TFixedImage, class TMovingImage  >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueThread(unsigned int threadID) const
+{
+  // Figure out which samples to process
+  unsigned long fixedImageSample;
+  unsigned long endSample;
+  this->GetThreadSampleRange(threadID, fixedImageSample, endSample);
+
   int numSamples = 0;
 
   if ( m_WithinThreadPreProcess )
@@ -1297,7 +1783,31 @@ ImageToImageMetric< TFixedImage, TMovingImage >
   MovingImagePointType mappedPoint;
   bool                 sampleOk;
   double               movingImageValue;
-  for ( int count = 0; count < chunkSize; ++count, ++fixedImageSample )
+  if ( m_FastSampleEvaluation )
+    {
+    MovingImagePointType mappedPoints[FastSampleChunkSize];
+    bool                 samplesOk[FastSampleChunkSize];
+    double               movingImageValues[FastSampleChunkSize];
+    while ( fixedImageSample < endSample )
+      {
+      const unsigned long chunkStart = fixedImageSample;
+      const unsigned long chunkEnd = vnl_math_min(chunkStart + FastSampleChunkSize, endSample);
+      this->FastTransformPoints(chunkStart, chunkEnd, mappedPoints, samplesOk,
+                                movingImageValues, NULL, threadID);
+      for ( ; fixedImageSample < chunkEnd; ++fixedImageSample )
+        {
+        const unsigned int s = fixedImageSample - chunkStart;
+        if ( samplesOk[s]
+             && GetValueThreadProcessSample(threadID, fixedImageSample,
+                                            mappedPoints[s], movingImageValues[s]) )
+          {
+          ++numSamples;
+          }
+        }
+      }
+    }
+  // Otherwise, one sample at a time
+  for ( ; fixedImageSample < endSample; ++fixedImageSample )
     {
     // Get moving image value
     this->TransformPoint(fixedImageSample, mappedPoint, sampleOk, movingImageValue,
@@ -1436,18 +1946,10 @@ void
 ImageToImageMetric< TFixedImage, TMovingImage >
 ::GetValueAndDerivativeThread(unsigned int threadID) const
 {
-  // Figure out how many samples to process
-  int chunkSize = m_NumberOfFixedImageSamples / m_NumberOfThreads;
-
-  // Skip to this thread's samples to process
-  unsigned int fixedImageSample = threadID * chunkSize;
-
-  if ( threadID == m_NumberOfThreads - 1 )
-    {
-    chunkSize = m_NumberOfFixedImageSamples
-                - ( ( m_NumberOfThreads - 1 )
-                    * chunkSize );
-    }
+  // Figure out which samples to process
+  unsigned long fixedImageSample;
+  unsigned long endSample;
+  this->GetThreadSampleRange(threadID, fixedImageSample, endSample);
 
   int numSamples = 0;
 
@@ -1461,7 +1963,35 @@ ImageToImageMetric< TFixedImage, TMovingImage >
   bool                 sampleOk;
   double               movingImageValue;
   ImageDerivativesType movingImageGradientValue;
-  for ( int count = 0; count < chunkSize; ++count, ++fixedImageSample )
+  if ( m_FastSampleEvaluation )
+    {
+    MovingImagePointType mappedPoints[FastSampleChunkSize];
+    bool                 samplesOk[FastSampleChunkSize];
+    double               movingImageValues[FastSampleChunkSize];
+    ImageDerivativesType movingImageGradientValues[FastSampleChunkSize];
+    while ( fixedImageSample < endSample )
+      {
+      const unsigned long chunkStart = fixedImageSample;
+      const unsigned long chunkEnd = vnl_math_min(chunkStart + FastSampleChunkSize, endSample);
+      this->FastTransformPoints(chunkStart, chunkEnd, mappedPoints, samplesOk,
+                                movingImageValues, movingImageGradientValues, threadID);
+      for ( ; fixedImageSample < chunkEnd; ++fixedImageSample )
+        {
+        const unsigned int s = fixedImageSample - chunkStart;
+        if ( samplesOk[s]
+             && this->GetValueAndDerivativeThreadProcessSample(threadID,
+                                                               fixedImageSample,
+                                                               mappedPoints[s],
+                                                               movingImageValues[s],
+                                                               movingImageGradientValues[s]) )
+          {
+          ++numSamples;
+          }
+        }
+      }
+    }
+  // Otherwise, one sample at a time
+  for ( ; fixedImageSample < endSample; ++fixedImageSample )
     {
     // Get moving image value
     TransformPointWithDerivatives(fixedImageSample, mappedPoint, sampleOk,
@@ -1542,6 +2072,7 @@ ImageToImageMetric< TFixedImage, TMovingImage >
 
   os << indent << "Threader: " << m_Threader << std::endl;
   os << indent << "Number of Threads: " << m_NumberOfThreads << std::endl;
+  os << indent << "Number of Sample Blocks: " << m_NumberOfSampleBlocks << std::endl;
   os << indent << "ThreaderParameter: " << std::endl;
   os << indent << "ThreaderNumberOfMovingImageSamples: " << std::endl;
   if ( m_ThreaderNumberOfMovingImageSamples )
@@ -1571,6 +2102,12 @@ ImageToImageMetric< TFixedImage, TMovingImage >
 
   os << indent << "UseCachingOfBSplineWeights: ";
   os << this->m_UseCachingOfBSplineWeights << std::endl;
+
+  os << indent << "UseFastSampleEvaluation: ";
+  os << this->m_UseFastSampleEvaluation << std::endl;
+
+  os << indent << "UseStochasticSampling: ";
+  os << this->m_UseStochasticSampling << std::endl;
 }
 
 /** This method can be const because we are not altering the m_ThreaderTransform
@@ -17,15 +17,9 @@
 #ifndef __itkMatchCardinalityImageToImageMetric_h
 #define __itkMatchCardinalityImageToImageMetric_h
 
-/**
- *  TODO: This class needs to be more tightly integrated with the new
- *  multi-threaded ImageToImageMetric.
- */
-
 #include "itkImageToImageMetric.h"
 #include "itkCovariantVector.h"
 #include "itkPoint.h"
-#include "itkMultiThreader.h"
 #include <vector>
 
 namespace itk
@@ -61,6 +55,11 @@ namespace itk
  * number of pixels in the overlap of the fixed and moving image
  * buffers conditional on any assigned masks.
  *
+ * The value is computed on several threads over the samples of the fixed
+ * image (see ImageToImageMetric), by default all the pixels of the fixed
+ * image region. The matches are counted per block of samples, so that the
+ * value does not depend on the number of threads.
+ *
  * \ingroup RegistrationMetrics
  */
 template< class TFixedImage, class TMovingImage >
@@ -96,6 +95,12 @@ public:
   typedef typename Superclass::FixedImageConstPointer  FixedImageConstPointer;
   typedef typename Superclass::MovingImageConstPointer MovingImageConstPointer;
   typedef typename Superclass::FixedImageRegionType    FixedImageRegionType;
+  typedef typename Superclass::MovingImagePointType    MovingImagePointType;
+
+  /** Initialize the Metric by making sure that all the components are
+   *  present and plugged together correctly, and select the samples. */
+  virtual void Initialize(void)
+  throw ( ExceptionObject );
 
   /** Get the derivatives of the match measure. */
   void GetDerivative(const TransformParametersType &,
@@ -125,56 +130,25 @@ public:
 
   /** Return the multithreader used by this class. */
   MultiThreader * GetMultiThreader()
-  { return m_Threader; }
+  { return this->m_Threader; }
 protected:
   MatchCardinalityImageToImageMetric();
   virtual ~MatchCardinalityImageToImageMetric() {}
   void PrintSelf(std::ostream & os, Indent indent) const;
 
-  /**
-   * Non-const version of GetValue().  This is a hack around various
-   * const issues with trying to spawn threads from the const version
-   * of GetValue().
-   */
-  MeasureType GetNonconstValue(const TransformParametersType & parameters);
-
-  /**
-   * Thread worker routine to calculate the contribution of the a
-   * subregion to the overall metric.  Can only be called from
-   * GetValue(). */
-  virtual
-  void ThreadedGetValue(const FixedImageRegionType & outputRegionForThread,
-                        int threadId);
-
-  /** Split the FixedImageRegion into "num" pieces, returning
-   * region "i" as "splitRegion". This method is called "num" times. The
-   * regions must not overlap. The method returns the number of pieces that
-   * the routine is capable of splitting the FixedImageRegion,
-   * i.e. return value is less than or equal to "num". */
-  virtual
-  int SplitFixedRegion(int i, int num, FixedImageRegionType & splitRegion);
-
-  /** Static function used as a "callback" by the MultiThreader.  The threading
-   * library will call this routine for each thread, which will delegate the
-   * control to ThreadedGetValue(). */
-  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
-
-  /** Internal structure used for passing image data into the threading library
-    */
-  struct ThreadStruct {
-    Pointer Metric;
-  };
 private:
   MatchCardinalityImageToImageMetric(const Self &); //purposely not implemented
   void operator=(const Self &);                     //purposely not implemented
 
-  bool                         m_MeasureMatches;
-  std::vector< MeasureType >   m_ThreadMatches;
-  std::vector< unsigned long > m_ThreadCounts;
+  inline bool GetValueThreadProcessSample(unsigned int threadID,
+                                          unsigned long fixedImageSample,
+                                          const MovingImagePointType & mappedPoint,
+                                          double movingImageValue) const;
+
+  bool m_MeasureMatches;
 
-  /** Support processing data in multiple threads. Used by subclasses
-   * (e.g., ImageSource). */
-  MultiThreader::Pointer m_Threader;
+  /** Number of matches (or mismatches) among the samples of each block. */
+  mutable std::vector< unsigned long > m_BlockMatches;
 };
 } // end namespace itk
 
@@ -18,7 +18,7 @@
 #define __itkMatchCardinalityImageToImageMetric_txx
 
 #include "itkMatchCardinalityImageToImageMetric.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -35,254 +35,88 @@ MatchCardinalityImageToImageMetric< TFixedImage, TMovingImage >
   m_MeasureMatches = true;         // default to measure percentage of pixel
                                    // matches
 
-  m_Threader = MultiThreader::New();
-}
+  this->m_WithinThreadPreProcess = false;
+  this->m_WithinThreadPostProcess = false;
+  this->m_NumberOfSampleBlocks = Superclass::DefaultNumberOfSampleBlocks;
 
-/*
- * Get the match Measure
- */
-template< class TFixedImage, class TMovingImage >
-typename MatchCardinalityImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
-MatchCardinalityImageToImageMetric< TFixedImage, TMovingImage >
-::GetValue(const TransformParametersType & parameters) const
-{
-  return const_cast< Self * >( this )->GetNonconstValue(parameters);
+  // The matches were counted over all the pixels of the fixed image region
+  // before the metric used the threads of ImageToImageMetric, and still are
+  // by default.
+  this->SetUseAllPixels(true);
 }
 
 /**
- * Get the match Measure (non const version. spawns threads).
+ * Initialize
  */
 template< class TFixedImage, class TMovingImage >
-typename MatchCardinalityImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
+void
 MatchCardinalityImageToImageMetric< TFixedImage, TMovingImage >
-::GetNonconstValue(const TransformParametersType & parameters)
+::Initialize(void)
+throw ( ExceptionObject )
 {
-  itkDebugMacro("GetValue( " << parameters << " ) ");
-
-  FixedImageConstPointer fixedImage = this->m_FixedImage;
-  if ( !fixedImage )
-    {
-    itkExceptionMacro(<< "Fixed image has not been assigned");
-    }
-
-  // Initialize some variables before spawning threads
-  //
-  //
-  MeasureType measure = NumericTraits< MeasureType >::Zero;
-  this->m_NumberOfPixelsCounted = 0;
-
-  m_ThreadMatches.clear();
-  m_ThreadCounts.clear();
-  m_ThreadMatches.resize( this->GetNumberOfThreads() );
-  m_ThreadCounts.resize( this->GetNumberOfThreads() );
+  this->Superclass::Initialize();
+  this->Superclass::MultiThreadingInitialize();
 
-  typename std::vector< MeasureType >::iterator mIt;
-  std::vector< unsigned long >::iterator cIt;
-  for ( mIt = m_ThreadMatches.begin(), cIt = m_ThreadCounts.begin();
-        mIt != m_ThreadMatches.end(); ++mIt, ++cIt )
-    {
-    *mIt = NumericTraits< MeasureType >::Zero;
-    *cIt = 0;
-    }
-
-  // store the parameters in the transform so all threads can access them
-  this->SetTransformParameters(parameters);
-
-  // Set up the multithreaded processing
-  //
-  //
-  ThreadStruct str;
-  str.Metric = this;
-
-  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
-  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
-
-  // multithread the execution
-  //
-  //
-  this->GetMultiThreader()->SingleMethodExecute();
-
-  // Collect the contribution to the metric for each thread
-  //
-  //
-  for ( mIt = m_ThreadMatches.begin(), cIt = m_ThreadCounts.begin();
-        mIt != m_ThreadMatches.end(); ++mIt, ++cIt )
-    {
-    measure += *mIt;
-    this->m_NumberOfPixelsCounted += *cIt;
-    }
-
-  if ( !this->m_NumberOfPixelsCounted )
-    {
-    itkExceptionMacro(<< "All the points mapped to outside of the moving image");
-    }
-  else
-    {
-    measure /= this->m_NumberOfPixelsCounted;
-    }
-
-  return measure;
+  m_BlockMatches.resize(this->m_NumberOfSampleBlocks);
 }
 
 template< class TFixedImage, class TMovingImage >
-void
+inline bool
 MatchCardinalityImageToImageMetric< TFixedImage, TMovingImage >
-::ThreadedGetValue(const FixedImageRegionType & regionForThread,
-                   int threadId)
+::GetValueThreadProcessSample(unsigned int itkNotUsed(threadID),
+                              unsigned long fixedImageSample,
+                              const MovingImagePointType & itkNotUsed(mappedPoint),
+                              double movingImageValue) const
 {
-  FixedImageConstPointer fixedImage = this->GetFixedImage();
-
-  if ( !fixedImage )
-    {
-    itkExceptionMacro(<< "Fixed image has not been assigned");
-    }
-
-  typedef  ImageRegionConstIteratorWithIndex< FixedImageType > FixedIteratorType;
-  typename FixedImageType::IndexType index;
-  FixedIteratorType ti(fixedImage, regionForThread);
-
-  MeasureType   threadMeasure = NumericTraits< MeasureType >::Zero;
-  unsigned long threadNumberOfPixelsCounted = 0;
+  const bool match = ( movingImageValue == this->m_FixedImageSamples[fixedImageSample].value );
 
-  while ( !ti.IsAtEnd() )
+  if ( match == m_MeasureMatches )
     {
-    index = ti.GetIndex();
-
-    typename Superclass::InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
-
-    if ( this->GetFixedImageMask() && !this->GetFixedImageMask()->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    typename Superclass::OutputPointType
-    transformedPoint = this->GetTransform()->TransformPoint(inputPoint);
-
-    if ( this->GetMovingImageMask() && !this->GetMovingImageMask()->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    if ( this->GetInterpolator()->IsInsideBuffer(transformedPoint) )
-      {
-      const RealType movingValue = this->GetInterpolator()->Evaluate(transformedPoint);
-      const RealType fixedValue = ti.Get();
-      RealType       diff;
-
-      threadNumberOfPixelsCounted++;
-
-      if ( m_MeasureMatches )
-        {
-        diff = ( movingValue == fixedValue ); // count matches
-        }
-      else
-        {
-        diff = ( movingValue != fixedValue ); // count mismatches
-        }
-      threadMeasure += diff;
-      }
-
-    ++ti;
+    ++m_BlockMatches[this->GetSampleBlock(fixedImageSample)];
     }
 
-  m_ThreadMatches[threadId] = threadMeasure;
-  m_ThreadCounts[threadId] = threadNumberOfPixelsCounted;
+  return true;
 }
 
-//----------------------------------------------------------------------------
+/*
+ * Get the match Measure
+ */
 template< class TFixedImage, class TMovingImage >
-int
+typename MatchCardinalityImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
 MatchCardinalityImageToImageMetric< TFixedImage, TMovingImage >
-::SplitFixedRegion(int i, int num, FixedImageRegionType & splitRegion)
+::GetValue(const TransformParametersType & parameters) const
 {
-  // Get the output pointer
-  const typename FixedImageRegionType::SizeType & fixedRegionSize =
-    this->GetFixedImageRegion().GetSize();
-
-  int splitAxis;
-  typename FixedImageRegionType::IndexType splitIndex;
-  typename FixedImageRegionType::SizeType splitSize;
-
-  // Initialize the splitRegion to the output requested region
-  splitRegion = this->GetFixedImageRegion();
-  splitIndex = splitRegion.GetIndex();
-  splitSize = splitRegion.GetSize();
-
-  // split on the outermost dimension available
-  splitAxis = this->GetFixedImage()->GetImageDimension() - 1;
-  while ( fixedRegionSize[splitAxis] == 1 )
-    {
-    --splitAxis;
-    if ( splitAxis < 0 )
-      { // cannot split
-      itkDebugMacro("  Cannot Split");
-      return 1;
-      }
-    }
-
-  // determine the actual number of pieces that will be generated
-  typename FixedImageRegionType::SizeType::SizeValueType range = fixedRegionSize[splitAxis];
-  int valuesPerThread = Math::Ceil< int >(range / (double)num);
-  int maxThreadIdUsed = Math::Ceil< int >(range / (double)valuesPerThread) - 1;
+  itkDebugMacro("GetValue( " << parameters << " ) ");
 
-  // Split the region
-  if ( i < maxThreadIdUsed )
+  if ( !this->m_FixedImage )
     {
-    splitIndex[splitAxis] += i * valuesPerThread;
-    splitSize[splitAxis] = valuesPerThread;
+    itkExceptionMacro(<< "Fixed image has not been assigned");
     }
-  if ( i == maxThreadIdUsed )
+  if ( m_BlockMatches.empty() )
     {
-    splitIndex[splitAxis] += i * valuesPerThread;
-    // last thread needs to process the "rest" dimension being split
-    splitSize[splitAxis] = splitSize[splitAxis] - i * valuesPerThread;
+    itkExceptionMacro(<< "The metric has no samples, maybe you forgot to call Initialize()");
     }
 
-  // set the split region ivars
-  splitRegion.SetIndex(splitIndex);
-  splitRegion.SetSize(splitSize);
-
-  itkDebugMacro("  Split Piece: " << splitRegion);
+  std::fill(m_BlockMatches.begin(), m_BlockMatches.end(), 0);
 
-  return maxThreadIdUsed + 1;
-}
-
-// Callback routine used by the threading library. This routine just calls
-// the ThreadedGenerateData method after setting the correct region for this
-// thread.
-template< class TFixedImage, class TMovingImage >
-ITK_THREAD_RETURN_TYPE
-MatchCardinalityImageToImageMetric< TFixedImage, TMovingImage >
-::ThreaderCallback(void *arg)
-{
-  ThreadStruct *str;
-  int           total, threadId, threadCount;
-
-  threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
-  threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+  // store the parameters in the transform so all threads can access them
+  this->SetTransformParameters(parameters);
 
-  str = (ThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+  // MUST BE CALLED TO INITIATE PROCESSING
+  this->GetValueMultiThreadedInitiate();
 
-  // execute the actual method with appropriate computation region
-  // first find out how many pieces extent can be split into.
-  FixedImageRegionType splitRegion;
-  total = str->Metric->SplitFixedRegion(threadId, threadCount, splitRegion);
+  if ( !this->m_NumberOfPixelsCounted )
+    {
+    itkExceptionMacro(<< "All the points mapped to outside of the moving image");
+    }
 
-  if ( threadId < total )
+  unsigned long matches = 0;
+  for ( unsigned int b = 0; b < m_BlockMatches.size(); b++ )
     {
-    str->Metric->ThreadedGetValue(splitRegion, threadId);
+    matches += m_BlockMatches[b];
     }
-  // else
-  //   {
-  //   otherwise don't use this thread. Sometimes the threads dont
-  //   break up very well and it is just as efficient to leave a
-  //   few threads idle.
-  //   }
 
-  return ITK_THREAD_RETURN_VALUE;
+  return static_cast< MeasureType >( matches ) / this->m_NumberOfPixelsCounted;
 }
 
 /**
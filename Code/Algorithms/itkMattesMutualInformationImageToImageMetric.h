@@ -135,6 +135,7 @@ public:
   typedef typename Superclass::TransformType                  TransformType;
   typedef typename Superclass::TransformPointer               TransformPointer;
   typedef typename Superclass::TransformJacobianType          TransformJacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType     NonZeroJacobianIndicesType;
   typedef typename Superclass::InterpolatorType               InterpolatorType;
   typedef typename Superclass::MeasureType                    MeasureType;
   typedef typename Superclass::DerivativeType                 DerivativeType;
@@ -294,6 +295,9 @@ private:
   virtual void ComputeFixedImageParzenWindowIndices(
     FixedImageSampleContainer & samples);
 
+  /** Draw new samples, and compute their parzen window indices. */
+  virtual void ResampleFixedImageRegion();
+
   /** Compute PDF derivative contribution for each parameter. */
   virtual void ComputePDFDerivatives(unsigned int threadID,
                                      unsigned int sampleNumber,
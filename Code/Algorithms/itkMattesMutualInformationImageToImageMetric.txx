@@ -477,6 +477,18 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     }
 }
 
+/**
+ * Draw new samples at an evaluation
+ */
+template< class TFixedImage, class TMovingImage >
+void
+MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ResampleFixedImageRegion()
+{
+  this->Superclass::ResampleFixedImageRegion();
+  this->ComputeFixedImageParzenWindowIndices(this->m_FixedImageSamples);
+}
+
 template< class TFixedImage, class TMovingImage  >
 inline void
 MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
@@ -900,6 +912,13 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   double movingImageParzenWindowArg = static_cast< double >( pdfMovingIndex )
                                       - static_cast< double >( movingImageParzenWindowTerm );
 
+  // The Jacobian of the transform at the sample is the same for the
+  // four bins
+  if ( this->m_UseExplicitPDFDerivatives || this->m_ImplicitDerivativesSecondPass )
+    {
+    this->ComputeNonZeroJacobian(fixedImageSample, threadID);
+    }
+
   while ( pdfMovingIndex <= pdfMovingIndexMax )
     {
     *( pdfPtr++ ) += static_cast< PDFValueType >( m_CubicBSplineKernel
@@ -987,6 +1006,8 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
                         MeasureType & value,
                         DerivativeType & derivative) const
 {
+  this->UpdateFixedImageSamples();
+
   // Set output values to zero
   value = NumericTraits< MeasureType >::Zero;
 
@@ -1226,130 +1247,34 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
       }
     }
 
-  if ( !this->m_TransformIsBSpline )
-    {
-    /**
-     * Generic version which works for all transforms.
-     */
-
-    // Compute the transform Jacobian.
-    // Should pre-compute
-    typedef typename TransformType::JacobianType JacobianType;
+  // Only the parameters of the non-zero columns of the Jacobian of the
+  // transform at the sample have a derivative. For a
+  // BSplineDeformableTransform, they are those of the support region.
+  const TransformJacobianType &      jacobian = this->m_ThreaderNonZeroJacobian[threadID];
+  const NonZeroJacobianIndicesType & nonZeroJacobianIndices =
+    this->m_ThreaderNonZeroJacobianIndices[threadID];
+  const unsigned int numberOfNonZeroJacobianIndices = nonZeroJacobianIndices.GetSize();
 
-    // Need to use one of the threader transforms if we're
-    // not in thread 0.
-    //
-    // Use a raw pointer here to avoid the overhead of smart pointers.
-    // For instance, Register and UnRegister have mutex locks around
-    // the reference counts.
-    TransformType *transform;
-
-    if ( threadID > 0 )
-      {
-      transform = this->m_ThreaderTransform[threadID - 1];
-      }
-    else
-      {
-      transform = this->m_Transform;
-      }
-
-    const JacobianType & jacobian =
-      transform->GetJacobian(this->m_FixedImageSamples[sampleNumber].point);
-
-    for ( unsigned int mu = 0; mu < this->m_NumberOfParameters; mu++ )
+  for ( unsigned int k = 0; k < numberOfNonZeroJacobianIndices; k++ )
+    {
+    double innerProduct = 0.0;
+    for ( unsigned int dim = 0; dim < Superclass::FixedImageDimension; dim++ )
       {
-      double innerProduct = 0.0;
-      for ( unsigned int dim = 0; dim < Superclass::FixedImageDimension; dim++ )
-        {
-        innerProduct += jacobian[dim][mu] * movingImageGradientValue[dim];
-        }
-
-      const double derivativeContribution = innerProduct * cubicBSplineDerivativeValue;
-
-      if ( this->m_UseExplicitPDFDerivatives )
-        {
-        *( derivPtr ) -= derivativeContribution;
-        ++derivPtr;
-        }
-      else
-        {
-        ( *derivativeHelperArray )[mu] += precomputedWeight * derivativeContribution;
-        }
+      innerProduct += jacobian[dim][k] * movingImageGradientValue[dim];
       }
-    }
-  else
-    {
-    const WeightsValueType *weights = NULL;
-    const IndexValueType *  indices = NULL;
 
-    BSplineTransformWeightsType *   weightsHelper = NULL;
-    BSplineTransformIndexArrayType *indicesHelper = NULL;
+    const double        derivativeContribution = innerProduct * cubicBSplineDerivativeValue;
+    const unsigned long mu = nonZeroJacobianIndices[k];
 
-    if ( this->m_UseCachingOfBSplineWeights )
+    if ( this->m_UseExplicitPDFDerivatives )
       {
-      //
-      // If the transform is of type BSplineDeformableTransform, we can obtain
-      // a speed up by only processing the affected parameters.  Note that
-      // these pointers are just pointing to pre-allocated rows of the caching
-      // arrays. There is therefore, no need to free this memory.
-      //
-      weights = this->m_BSplineTransformWeightsArray[sampleNumber];
-      indices = this->m_BSplineTransformIndicesArray[sampleNumber];
+      *( derivPtr + mu ) -= derivativeContribution;
       }
     else
       {
-      if ( threadID > 0 )
-        {
-        weightsHelper = &( this->m_ThreaderBSplineTransformWeights[threadID - 1] );
-        indicesHelper = &( this->m_ThreaderBSplineTransformIndices[threadID - 1] );
-        }
-      else
-        {
-        weightsHelper = &( this->m_BSplineTransformWeights );
-        indicesHelper = &( this->m_BSplineTransformIndices );
-        }
-
-      this->m_BSplineTransform->GetJacobian(
-        this->m_FixedImageSamples[sampleNumber].point,
-        *weightsHelper, *indicesHelper);
+      ( *derivativeHelperArray )[mu] += precomputedWeight * derivativeContribution;
       }
-
-    for ( unsigned int dim = 0; dim < Superclass::FixedImageDimension; dim++ )
-      {
-      double innerProduct;
-      int    parameterIndex;
-
-      for ( unsigned int mu = 0; mu < this->m_NumBSplineWeights; mu++ )
-        {
-        /* The array weights contains the Jacobian values in a 1-D array
-         * (because for each parameter the Jacobian is non-zero in only 1 of the
-         * possible dimensions) which is multiplied by the moving image
-         * gradient. */
-        if ( this->m_UseCachingOfBSplineWeights )
-          {
-          innerProduct = movingImageGradientValue[dim] * weights[mu];
-          parameterIndex = indices[mu] + this->m_BSplineParametersOffset[dim];
-          }
-        else
-          {
-          innerProduct = movingImageGradientValue[dim] * ( *weightsHelper )[mu];
-          parameterIndex = ( *indicesHelper )[mu] + this->m_BSplineParametersOffset[dim];
-          }
-
-        const double derivativeContribution = innerProduct * cubicBSplineDerivativeValue;
-
-        if ( this->m_UseExplicitPDFDerivatives )
-          {
-          JointPDFValueType *ptr = derivPtr + parameterIndex;
-          *( ptr ) -= derivativeContribution;
-          }
-        else
-          {
-          ( *derivativeHelperArray )[parameterIndex] += precomputedWeight * derivativeContribution;
-          }
-        } //end mu for loop
-      }   //end dim for loop
-    }     // end if-block transform is BSpline
+    }
 }
 } // end namespace itk
 
@@ -20,6 +20,7 @@
 #include "itkImageToImageMetric.h"
 #include "itkCovariantVector.h"
 #include "itkPoint.h"
+#include <vector>
 
 namespace itk
 {
@@ -39,6 +40,12 @@ namespace itk
  * on it. Values at these non-grid position of the Fixed image are interpolated
  * using a user-selected Interpolator.
  *
+ * The value is computed on several threads over the samples of the fixed
+ * image (see ImageToImageMetric), by default all the pixels of the fixed
+ * image region. The sums are accumulated per block of samples and added in
+ * the order of the blocks, so that the value does not depend on the number
+ * of threads.
+ *
  * \ingroup RegistrationMetrics
  */
 template< class TFixedImage, class TMovingImage >
@@ -73,6 +80,12 @@ public:
   typedef typename Superclass::MovingImageType         MovingImageType;
   typedef typename Superclass::FixedImageConstPointer  FixedImageConstPointer;
   typedef typename Superclass::MovingImageConstPointer MovingImageConstPointer;
+  typedef typename Superclass::MovingImagePointType    MovingImagePointType;
+
+  /** Initialize the Metric by making sure that all the components are
+   *  present and plugged together correctly, and select the samples. */
+  virtual void Initialize(void)
+  throw ( ExceptionObject );
 
   /** Get the derivatives of the match measure. */
   void GetDerivative(const TransformParametersType & parameters,
@@ -107,8 +120,16 @@ private:
                                                                   // not
                                                                   // implemented
 
+  inline bool GetValueThreadProcessSample(unsigned int threadID,
+                                          unsigned long fixedImageSample,
+                                          const MovingImagePointType & mappedPoint,
+                                          double movingImageValue) const;
+
   double m_Lambda;
   double m_Delta;
+
+  /** Sum of the measure over the samples of each block. */
+  mutable std::vector< double > m_BlockSums;
 };
 } // end namespace itk
 
@@ -18,7 +18,7 @@
 #define __itkMeanReciprocalSquareDifferenceImageToImageMetric_txx
 
 #include "itkMeanReciprocalSquareDifferenceImageToImageMetric.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -31,6 +31,14 @@ MeanReciprocalSquareDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 {
   m_Lambda = 1.0;
   m_Delta  = 0.00011;
+
+  this->m_WithinThreadPreProcess = false;
+  this->m_WithinThreadPostProcess = false;
+  this->m_NumberOfSampleBlocks = Superclass::DefaultNumberOfSampleBlocks;
+
+  // The measure was summed over all the pixels of the fixed image region
+  // before it was multithreaded, and still is by default.
+  this->SetUseAllPixels(true);
 }
 
 /**
@@ -46,6 +54,36 @@ MeanReciprocalSquareDifferenceImageToImageMetric< TFixedImage, TMovingImage >
   os << "Delta  value  = " << m_Delta  << std::endl;
 }
 
+/**
+ * Initialize
+ */
+template< class TFixedImage, class TMovingImage >
+void
+MeanReciprocalSquareDifferenceImageToImageMetric< TFixedImage, TMovingImage >
+::Initialize(void)
+throw ( ExceptionObject )
+{
+  this->Superclass::Initialize();
+  this->Superclass::MultiThreadingInitialize();
+
+  m_BlockSums.resize(this->m_NumberOfSampleBlocks);
+}
+
+template< class TFixedImage, class TMovingImage >
+inline bool
+MeanReciprocalSquareDifferenceImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueThreadProcessSample(unsigned int itkNotUsed(threadID),
+                              unsigned long fixedImageSample,
+                              const MovingImagePointType & itkNotUsed(mappedPoint),
+                              double movingImageValue) const
+{
+  const double diff = movingImageValue - this->m_FixedImageSamples[fixedImageSample].value;
+
+  m_BlockSums[this->GetSampleBlock(fixedImageSample)] += 1.0 / ( 1.0 + m_Lambda * ( diff * diff ) );
+
+  return true;
+}
+
 /*
  * Get the match Measure
  */
@@ -54,63 +92,26 @@ typename MeanReciprocalSquareDifferenceImageToImageMetric< TFixedImage, TMovingI
 MeanReciprocalSquareDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 ::GetValue(const TransformParametersType & parameters) const
 {
-  FixedImageConstPointer fixedImage = this->m_FixedImage;
-
-  if ( !fixedImage )
+  if ( !this->m_FixedImage )
     {
     itkExceptionMacro(<< "Fixed image has not been assigned");
     }
+  if ( m_BlockSums.empty() )
+    {
+    itkExceptionMacro(<< "The metric has no samples, maybe you forgot to call Initialize()");
+    }
 
-  const unsigned int              dimension = FixedImageType::ImageDimension;
-  itk::Point< double, dimension > Point;
-
-  double MovingValue;
-  double FixedValue;
-
-  typedef  itk::ImageRegionConstIteratorWithIndex< FixedImageType > FixedIteratorType;
+  std::fill(m_BlockSums.begin(), m_BlockSums.end(), 0.0);
 
-  FixedIteratorType ti( fixedImage, this->GetFixedImageRegion() );
+  this->SetTransformParameters(parameters);
 
-  typename FixedImageType::IndexType index;
+  // MUST BE CALLED TO INITIATE PROCESSING
+  this->GetValueMultiThreadedInitiate();
 
   MeasureType measure = NumericTraits< MeasureType >::Zero;
-
-  this->m_NumberOfPixelsCounted = 0;
-
-  this->SetTransformParameters(parameters);
-
-  while ( !ti.IsAtEnd() )
+  for ( unsigned int b = 0; b < m_BlockSums.size(); b++ )
     {
-    index = ti.GetIndex();
-
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
-
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    TransformType const *transform = this->m_Transform;
-    OutputPointType      transformedPoint = transform->TransformPoint(inputPoint);
-
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-      {
-      MovingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      FixedValue     = ti.Get();
-      this->m_NumberOfPixelsCounted++;
-      const double diff = MovingValue - FixedValue;
-      measure += 1.0f / ( 1.0f + m_Lambda * ( diff * diff ) );
-      }
-
-    ++ti;
+    measure += m_BlockSums[b];
     }
 
   return measure;
@@ -152,6 +153,8 @@ MeanReciprocalSquareDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 ::GetValueAndDerivative(const TransformParametersType & parameters,
                         MeasureType & Value, DerivativeType  & Derivative) const
 {
+  this->UpdateFixedImageSamples();
+
   Value      = this->GetValue(parameters);
   this->GetDerivative(parameters, Derivative);
 }
@@ -78,6 +78,13 @@ protected:
   /** Evaluates the sum of squared differences from the histogram. */
   virtual MeasureType EvaluateMeasure(HistogramType & histogram) const;
 
+  typedef typename Superclass::JointFrequenciesType JointFrequenciesType;
+
+  /** Evaluates the derivatives of the mean of the squared differences with respect to the
+   * frequencies of the joint histogram. */
+  virtual bool EvaluateMeasureFrequencyDerivatives(const JointFrequenciesType & frequencies,
+                                                   JointFrequenciesType & derivatives) const;
+
 private:
   MeanSquaresHistogramImageToImageMetric(Self const &); // Purposely not
                                                         // implemented.
@@ -49,6 +49,44 @@ MeanSquaresHistogramImageToImageMetric< TFixedImage, TMovingImage >
 
   return measure;
 }
+
+template< class TFixedImage, class TMovingImage >
+bool
+MeanSquaresHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::EvaluateMeasureFrequencyDerivatives(const JointFrequenciesType & frequencies,
+                                      JointFrequenciesType & derivatives) const
+{
+  const unsigned int sizeX = frequencies.rows();
+  const unsigned int sizeY = frequencies.cols();
+
+  derivatives.SetSize(sizeX, sizeY);
+  derivatives.Fill(0.0);
+
+  double totalFreq = 0.0;
+  for ( unsigned int i = 0; i < sizeX; i++ )
+    {
+    for ( unsigned int j = 0; j < sizeY; j++ )
+      {
+      totalFreq += frequencies(i, j);
+      }
+    }
+  if ( totalFreq <= 0.0 )
+    {
+    return true;
+    }
+
+  for ( unsigned int i = 0; i < sizeX; i++ )
+    {
+    const double valX = this->GetBinCenter(0, i);
+    for ( unsigned int j = 0; j < sizeY; j++ )
+      {
+      const double difference = valX - this->GetBinCenter(1, j);
+      derivatives(i, j) = difference * difference / totalFreq;
+      }
+    }
+
+  return true;
+}
 } // End namespace itk
 
 #endif // itkMeanSquaresHistogramImageToImageMetric_txx
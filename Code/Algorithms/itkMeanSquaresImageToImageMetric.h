@@ -48,6 +48,7 @@ public:
   typedef typename Superclass::TransformType                TransformType;
   typedef typename Superclass::TransformPointer             TransformPointer;
   typedef typename Superclass::TransformJacobianType        TransformJacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType   NonZeroJacobianIndicesType;
   typedef typename Superclass::InterpolatorType             InterpolatorType;
   typedef typename Superclass::MeasureType                  MeasureType;
   typedef typename Superclass::DerivativeType               DerivativeType;
@@ -181,37 +181,21 @@ MeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 
   m_ThreaderMSE[threadID] += diff * diff;
 
-  FixedImagePointType fixedImagePoint = this->m_FixedImageSamples[fixedImageSample].point;
-
-  // Need to use one of the threader transforms if we're
-  // not in thread 0.
-  //
-  // Use a raw pointer here to avoid the overhead of smart pointers.
-  // For instance, Register and UnRegister have mutex locks around
-  // the reference counts.
-  TransformType *transform;
-
-  if ( threadID > 0 )
-    {
-    transform = this->m_ThreaderTransform[threadID - 1];
-    }
-  else
-    {
-    transform = this->m_Transform;
-    }
-
-  // Jacobian should be evaluated at the unmapped (fixed image) point.
-  const TransformJacobianType & jacobian = transform
-                                           ->GetJacobian(fixedImagePoint);
-
-  for ( unsigned int par = 0; par < this->m_NumberOfParameters; par++ )
+  // Only the parameters of the non-zero columns of the Jacobian of the
+  // transform at the (fixed image) point of the sample have a derivative.
+  this->ComputeNonZeroJacobian(fixedImageSample, threadID);
+  const TransformJacobianType &      jacobian = this->m_ThreaderNonZeroJacobian[threadID];
+  const NonZeroJacobianIndicesType & nonZeroJacobianIndices =
+    this->m_ThreaderNonZeroJacobianIndices[threadID];
+
+  for ( unsigned int k = 0; k < nonZeroJacobianIndices.GetSize(); k++ )
     {
     double sum = 0.0;
     for ( unsigned int dim = 0; dim < MovingImageDimension; dim++ )
       {
-      sum += 2.0 *diff *jacobian(dim, par) * movingImageGradientValue[dim];
+      sum += 2.0 *diff *jacobian(dim, k) * movingImageGradientValue[dim];
       }
-    m_ThreaderMSEDerivatives[threadID][par] += sum;
+    m_ThreaderMSEDerivatives[threadID][nonZeroJacobianIndices[k]] += sum;
     }
 
   return true;
@@ -232,6 +216,8 @@ MeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
     itkExceptionMacro(<< "Fixed image has not been assigned");
     }
 
+  this->UpdateFixedImageSamples();
+
   // Set up the parameters in the transform
   this->m_Transform->SetParameters(parameters);
   this->m_Parameters = parameters;
@@ -77,6 +77,13 @@ protected:
   /** Evaluates the mutual information from the histogram. */
   virtual MeasureType EvaluateMeasure(HistogramType & histogram) const;
 
+  typedef typename Superclass::JointFrequenciesType JointFrequenciesType;
+
+  /** Evaluates the derivatives of the mutual information with respect to the
+   * frequencies of the joint histogram. */
+  virtual bool EvaluateMeasureFrequencyDerivatives(const JointFrequenciesType & frequencies,
+                                                   JointFrequenciesType & derivatives) const;
+
 private:
   // Purposely not implemented.
   MutualInformationHistogramImageToImageMetric(Self const &);
@@ -78,6 +78,55 @@ MutualInformationHistogramImageToImageMetric< TFixedImage, TMovingImage >
 
   return entropyX + entropyY - jointEntropy;
 }
+
+template< class TFixedImage, class TMovingImage >
+bool
+MutualInformationHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::EvaluateMeasureFrequencyDerivatives(const JointFrequenciesType & frequencies,
+                                      JointFrequenciesType & derivatives) const
+{
+  const unsigned int sizeX = frequencies.rows();
+  const unsigned int sizeY = frequencies.cols();
+
+  derivatives.SetSize(sizeX, sizeY);
+  derivatives.Fill(0.0);
+
+  std::vector< double > freqX(sizeX, 0.0);
+  std::vector< double > freqY(sizeY, 0.0);
+  double                totalFreq = 0.0;
+  for ( unsigned int i = 0; i < sizeX; i++ )
+    {
+    for ( unsigned int j = 0; j < sizeY; j++ )
+      {
+      const double freq = frequencies(i, j);
+      freqX[i] += freq;
+      freqY[j] += freq;
+      totalFreq += freq;
+      }
+    }
+  if ( totalFreq <= 0.0 )
+    {
+    return true;
+    }
+
+  // The total frequency being held fixed, the derivative of an entropy
+  // -sum(f log f) / N + log N with respect to a frequency f is
+  // -(log f + 1) / N.
+  for ( unsigned int i = 0; i < sizeX; i++ )
+    {
+    for ( unsigned int j = 0; j < sizeY; j++ )
+      {
+      const double freq = frequencies(i, j);
+      if ( freq > 0 )
+        {
+        derivatives(i, j) = ( vcl_log(freq) - vcl_log(freqX[i]) - vcl_log(freqY[j]) - 1.0 )
+                            / totalFreq;
+        }
+      }
+    }
+
+  return true;
+}
 } // End namespace itk
 
 #endif // itkMutualInformationHistogramImageToImageMetric_txx
@@ -20,6 +20,7 @@
 #include "itkImageToImageMetric.h"
 #include "itkCovariantVector.h"
 #include "itkPoint.h"
+#include <vector>
 
 namespace itk
 {
@@ -35,6 +36,12 @@ namespace itk
  * Interpolator. The correlation is normalized by the autocorrelations of both
  * the fixed and moving images.
  *
+ * The metric is computed on several threads over the samples of the fixed
+ * image (see ImageToImageMetric), by default all the pixels of the fixed
+ * image region. The sums are accumulated per block of samples and added in
+ * the order of the blocks, so that the value does not depend on the number
+ * of threads.
+ *
  * \ingroup RegistrationMetrics
  */
 template< class TFixedImage, class TMovingImage >
@@ -61,6 +68,7 @@ public:
   typedef typename Superclass::TransformPointer        TransformPointer;
   typedef typename Superclass::TransformParametersType TransformParametersType;
   typedef typename Superclass::TransformJacobianType   TransformJacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
   typedef typename Superclass::GradientPixelType       GradientPixelType;
   typedef typename Superclass::OutputPointType         OutputPointType;
   typedef typename Superclass::InputPointType          InputPointType;
@@ -71,6 +79,17 @@ public:
   typedef typename Superclass::MovingImageType         MovingImageType;
   typedef typename Superclass::FixedImageConstPointer  FixedImageConstPointer;
   typedef typename Superclass::MovingImageConstPointer MovingImageConstPointer;
+  typedef typename Superclass::MovingImagePointType    MovingImagePointType;
+  typedef typename Superclass::ImageDerivativesType    ImageDerivativesType;
+
+  /** The moving image dimension. */
+  itkStaticConstMacro(MovingImageDimension, unsigned int,
+                      MovingImageType::ImageDimension);
+
+  /** Initialize the Metric by making sure that all the components are
+   *  present and plugged together correctly, and select the samples. */
+  virtual void Initialize(void)
+  throw ( ExceptionObject );
 
   /** Get the derivatives of the match measure. */
   void GetDerivative(const TransformParametersType & parameters,
@@ -101,7 +120,45 @@ private:
   void operator=(const Self &);                          //purposely not
                                                          // implemented
 
+  inline bool GetValueThreadProcessSample(unsigned int threadID,
+                                          unsigned long fixedImageSample,
+                                          const MovingImagePointType & mappedPoint,
+                                          double movingImageValue) const;
+
+  inline bool GetValueAndDerivativeThreadProcessSample(unsigned int threadID,
+                                                       unsigned long fixedImageSample,
+                                                       const MovingImagePointType & mappedPoint,
+                                                       double movingImageValue,
+                                                       const ImageDerivativesType &
+                                                       movingImageGradientValue) const;
+
+  /** Reset the sums of the blocks before processing the samples. */
+  void ResetSampleBlocks(bool withDerivatives) const;
+
+  /** Add the sums of the blocks, in their order. */
+  void SumSampleBlocks(bool withDerivatives) const;
+
   bool m_SubtractMean;
+
+  /** Sums over the samples of a block, and over all the samples once the
+   * blocks are added. */
+  struct SampleSums {
+    double sff;
+    double smm;
+    double sfm;
+    double sf;
+    double sm;
+  };
+
+  mutable std::vector< SampleSums >     m_BlockSums;
+  mutable std::vector< DerivativeType > m_BlockDerivativeF;
+  mutable std::vector< DerivativeType > m_BlockDerivativeM;
+  mutable std::vector< DerivativeType > m_BlockDifferential;
+
+  mutable SampleSums     m_Sums;
+  mutable DerivativeType m_DerivativeF;
+  mutable DerivativeType m_DerivativeM;
+  mutable DerivativeType m_Differential;
 };
 } // end namespace itk
 
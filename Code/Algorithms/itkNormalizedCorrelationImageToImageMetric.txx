@@ -18,7 +18,6 @@
 #define __itkNormalizedCorrelationImageToImageMetric_txx
 
 #include "itkNormalizedCorrelationImageToImageMetric.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
 
 namespace itk
 {
@@ -30,287 +29,233 @@ NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
 ::NormalizedCorrelationImageToImageMetric()
 {
   m_SubtractMean = false;
+
+  this->m_WithinThreadPreProcess = false;
+  this->m_WithinThreadPostProcess = false;
+  this->m_NumberOfSampleBlocks = Superclass::DefaultNumberOfSampleBlocks;
+
+  // The correlation was computed over all the pixels of the fixed image
+  // region before it was multithreaded, and still is by default.
+  this->SetUseAllPixels(true);
 }
 
 /**
- * Get the match Measure
+ * Initialize
  */
 template< class TFixedImage, class TMovingImage >
-typename NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
+void
 NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
-::GetValue(const TransformParametersType & parameters) const
+::Initialize(void)
+throw ( ExceptionObject )
 {
-  FixedImageConstPointer fixedImage = this->m_FixedImage;
-
-  if ( !fixedImage )
-    {
-    itkExceptionMacro(<< "Fixed image has not been assigned");
-    }
-
-  typedef  itk::ImageRegionConstIteratorWithIndex< FixedImageType > FixedIteratorType;
-
-  FixedIteratorType ti( fixedImage, this->GetFixedImageRegion() );
+  this->Superclass::Initialize();
+  this->Superclass::MultiThreadingInitialize();
 
-  typename FixedImageType::IndexType index;
+  m_BlockSums.resize(this->m_NumberOfSampleBlocks);
 
-  MeasureType measure;
-
-  this->m_NumberOfPixelsCounted = 0;
-
-  this->SetTransformParameters(parameters);
-
-  typedef  typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
-
-  AccumulateType sff = NumericTraits< AccumulateType >::Zero;
-  AccumulateType smm = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sfm = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sf  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sm  = NumericTraits< AccumulateType >::Zero;
+  // The sums of the derivatives are only allocated when first needed
+  m_BlockDerivativeF.clear();
+  m_BlockDerivativeM.clear();
+  m_BlockDifferential.clear();
+}
 
-  while ( !ti.IsAtEnd() )
+template< class TFixedImage, class TMovingImage >
+void
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::ResetSampleBlocks(bool withDerivatives) const
+{
+  if ( m_BlockSums.empty() )
     {
-    index = ti.GetIndex();
+    itkExceptionMacro(<< "The metric has no samples, maybe you forgot to call Initialize()");
+    }
 
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
+  for ( unsigned int b = 0; b < m_BlockSums.size(); b++ )
+    {
+    m_BlockSums[b].sff = 0.0;
+    m_BlockSums[b].smm = 0.0;
+    m_BlockSums[b].sfm = 0.0;
+    m_BlockSums[b].sf = 0.0;
+    m_BlockSums[b].sm = 0.0;
+    }
 
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
+  if ( withDerivatives )
+    {
+    if ( m_BlockDerivativeF.size() != m_BlockSums.size()
+         || m_BlockDerivativeF[0].GetSize() != this->m_NumberOfParameters )
+      {
+      m_BlockDerivativeF.resize( m_BlockSums.size() );
+      m_BlockDerivativeM.resize( m_BlockSums.size() );
+      m_BlockDifferential.resize( m_BlockSums.size() );
+      for ( unsigned int b = 0; b < m_BlockSums.size(); b++ )
+        {
+        m_BlockDerivativeF[b].SetSize(this->m_NumberOfParameters);
+        m_BlockDerivativeM[b].SetSize(this->m_NumberOfParameters);
+        m_BlockDifferential[b].SetSize(this->m_NumberOfParameters);
+        }
+      }
+    for ( unsigned int b = 0; b < m_BlockSums.size(); b++ )
       {
-      ++ti;
-      continue;
+      m_BlockDerivativeF[b].Fill(0.0);
+      m_BlockDerivativeM[b].Fill(0.0);
+      m_BlockDifferential[b].Fill(0.0);
       }
+    }
+}
 
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
+template< class TFixedImage, class TMovingImage >
+void
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::SumSampleBlocks(bool withDerivatives) const
+{
+  m_Sums = m_BlockSums[0];
+  for ( unsigned int b = 1; b < m_BlockSums.size(); b++ )
+    {
+    m_Sums.sff += m_BlockSums[b].sff;
+    m_Sums.smm += m_BlockSums[b].smm;
+    m_Sums.sfm += m_BlockSums[b].sfm;
+    m_Sums.sf += m_BlockSums[b].sf;
+    m_Sums.sm += m_BlockSums[b].sm;
+    }
 
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
+  if ( withDerivatives )
+    {
+    m_DerivativeF = m_BlockDerivativeF[0];
+    m_DerivativeM = m_BlockDerivativeM[0];
+    m_Differential = m_BlockDifferential[0];
+    for ( unsigned int b = 1; b < m_BlockSums.size(); b++ )
       {
-      ++ti;
-      continue;
+      m_DerivativeF += m_BlockDerivativeF[b];
+      m_DerivativeM += m_BlockDerivativeM[b];
+      m_Differential += m_BlockDifferential[b];
       }
+    }
 
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
+  if ( m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
+    {
+    const double numberOfPixels = static_cast< double >( this->m_NumberOfPixelsCounted );
+    m_Sums.sff -= ( m_Sums.sf * m_Sums.sf / numberOfPixels );
+    m_Sums.smm -= ( m_Sums.sm * m_Sums.sm / numberOfPixels );
+    m_Sums.sfm -= ( m_Sums.sf * m_Sums.sm / numberOfPixels );
+    if ( withDerivatives )
       {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      const RealType fixedValue   = ti.Get();
-      sff += fixedValue  * fixedValue;
-      smm += movingValue * movingValue;
-      sfm += fixedValue  * movingValue;
-      if ( this->m_SubtractMean )
+      for ( unsigned int par = 0; par < this->m_NumberOfParameters; par++ )
         {
-        sf += fixedValue;
-        sm += movingValue;
+        m_DerivativeF[par] -= m_Differential[par] * m_Sums.sf / numberOfPixels;
+        m_DerivativeM[par] -= m_Differential[par] * m_Sums.sm / numberOfPixels;
         }
-      this->m_NumberOfPixelsCounted++;
       }
-
-    ++ti;
-    }
-
-  if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
-    {
-    sff -= ( sf * sf / this->m_NumberOfPixelsCounted );
-    smm -= ( sm * sm / this->m_NumberOfPixelsCounted );
-    sfm -= ( sf * sm / this->m_NumberOfPixelsCounted );
     }
+}
 
-  const RealType denom = -1.0 * vcl_sqrt(sff * smm);
+template< class TFixedImage, class TMovingImage >
+inline bool
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueThreadProcessSample(unsigned int itkNotUsed(threadID),
+                              unsigned long fixedImageSample,
+                              const MovingImagePointType & itkNotUsed(mappedPoint),
+                              double movingImageValue) const
+{
+  const double fixedValue = this->m_FixedImageSamples[fixedImageSample].value;
+  SampleSums & sums = m_BlockSums[this->GetSampleBlock(fixedImageSample)];
 
-  if ( this->m_NumberOfPixelsCounted > 0 && denom != 0.0 )
-    {
-    measure = sfm / denom;
-    }
-  else
-    {
-    measure = NumericTraits< MeasureType >::Zero;
-    }
+  sums.sff += fixedValue * fixedValue;
+  sums.smm += movingImageValue * movingImageValue;
+  sums.sfm += fixedValue * movingImageValue;
+  sums.sf += fixedValue;
+  sums.sm += movingImageValue;
 
-  return measure;
+  return true;
 }
 
 /**
- * Get the Derivative Measure
+ * Get the match Measure
  */
 template< class TFixedImage, class TMovingImage >
-void
+typename NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
 NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
-::GetDerivative(const TransformParametersType & parameters,
-                DerivativeType & derivative) const
+::GetValue(const TransformParametersType & parameters) const
 {
-  if ( !this->GetGradientImage() )
-    {
-    itkExceptionMacro(<< "The gradient image is null, maybe you forgot to call Initialize()");
-    }
-
-  FixedImageConstPointer fixedImage = this->m_FixedImage;
-
-  if ( !fixedImage )
+  if ( !this->m_FixedImage )
     {
     itkExceptionMacro(<< "Fixed image has not been assigned");
     }
 
-  const unsigned int dimension = FixedImageType::ImageDimension;
-
-  typedef  itk::ImageRegionConstIteratorWithIndex< FixedImageType > FixedIteratorType;
-
-  FixedIteratorType ti( fixedImage, this->GetFixedImageRegion() );
-
-  typename FixedImageType::IndexType index;
-
-  this->m_NumberOfPixelsCounted = 0;
+  this->ResetSampleBlocks(false);
 
   this->SetTransformParameters(parameters);
 
-  typedef  typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
+  // MUST BE CALLED TO INITIATE PROCESSING
+  this->GetValueMultiThreadedInitiate();
 
-  AccumulateType sff  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType smm  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sfm = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sf  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sm  = NumericTraits< AccumulateType >::Zero;
+  this->SumSampleBlocks(false);
 
-  const unsigned int ParametersDimension = this->GetNumberOfParameters();
-  derivative = DerivativeType(ParametersDimension);
-  derivative.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
-
-  DerivativeType derivativeF = DerivativeType(ParametersDimension);
-  derivativeF.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
+  const RealType denom = -1.0 * vcl_sqrt(m_Sums.sff * m_Sums.smm);
 
-  DerivativeType derivativeM = DerivativeType(ParametersDimension);
-  derivativeM.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
-
-  ti.GoToBegin();
-  // First compute the sums
-  while ( !ti.IsAtEnd() )
+  if ( this->m_NumberOfPixelsCounted > 0 && denom != 0.0 )
     {
-    index = ti.GetIndex();
-
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
-
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
-
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-      {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      const RealType fixedValue   = ti.Get();
-      sff += fixedValue  * fixedValue;
-      smm += movingValue * movingValue;
-      sfm += fixedValue  * movingValue;
-      if ( this->m_SubtractMean )
-        {
-        sf += fixedValue;
-        sm += movingValue;
-        }
-      this->m_NumberOfPixelsCounted++;
-      }
-
-    ++ti;
+    return m_Sums.sfm / denom;
     }
+  return NumericTraits< MeasureType >::Zero;
+}
 
-  // Compute contributions to derivatives
-  ti.GoToBegin();
-  while ( !ti.IsAtEnd() )
-    {
-    index = ti.GetIndex();
+template< class TFixedImage, class TMovingImage >
+inline bool
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivativeThreadProcessSample(unsigned int threadID,
+                                           unsigned long fixedImageSample,
+                                           const MovingImagePointType & mappedPoint,
+                                           double movingImageValue,
+                                           const ImageDerivativesType &
+                                           movingImageGradientValue) const
+{
+  this->GetValueThreadProcessSample(threadID, fixedImageSample, mappedPoint, movingImageValue);
 
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
+  const double fixedValue = this->m_FixedImageSamples[fixedImageSample].value;
+  const unsigned int block = this->GetSampleBlock(fixedImageSample);
 
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
+  // Only the parameters of the non-zero columns of the Jacobian of the
+  // transform at the (fixed image) point of the sample have a derivative.
+  this->ComputeNonZeroJacobian(fixedImageSample, threadID);
+  const TransformJacobianType &      jacobian = this->m_ThreaderNonZeroJacobian[threadID];
+  const NonZeroJacobianIndicesType & nonZeroJacobianIndices =
+    this->m_ThreaderNonZeroJacobianIndices[threadID];
 
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
+  DerivativeType & derivativeF = m_BlockDerivativeF[block];
+  DerivativeType & derivativeM = m_BlockDerivativeM[block];
+  DerivativeType & differentials = m_BlockDifferential[block];
 
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
+  for ( unsigned int k = 0; k < nonZeroJacobianIndices.GetSize(); k++ )
+    {
+    const unsigned long par = nonZeroJacobianIndices[k];
+    RealType            differential = NumericTraits< RealType >::Zero;
+    for ( unsigned int dim = 0; dim < MovingImageDimension; dim++ )
       {
-      ++ti;
-      continue;
+      differential += jacobian(dim, k) * movingImageGradientValue[dim];
       }
-
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
+    derivativeF[par] += fixedValue * differential;
+    derivativeM[par] += movingImageValue * differential;
+    if ( m_SubtractMean )
       {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      const RealType fixedValue     = ti.Get();
-
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
-
-      // Get the gradient by NearestNeighboorInterpolation:
-      // which is equivalent to round up the point components.
-      typedef typename OutputPointType::CoordRepType CoordRepType;
-      typedef ContinuousIndex< CoordRepType, MovingImageType::ImageDimension >
-      MovingImageContinuousIndexType;
-
-      MovingImageContinuousIndexType tempIndex;
-      this->m_MovingImage->TransformPhysicalPointToContinuousIndex(transformedPoint, tempIndex);
-
-      typename MovingImageType::IndexType mappedIndex;
-      mappedIndex.CopyWithRound(tempIndex);
-
-      const GradientPixelType gradient =
-        this->GetGradientImage()->GetPixel(mappedIndex);
-
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
-        {
-        RealType sumF = NumericTraits< RealType >::Zero;
-        RealType sumM = NumericTraits< RealType >::Zero;
-        for ( unsigned int dim = 0; dim < dimension; dim++ )
-          {
-          const RealType differential = jacobian(dim, par) * gradient[dim];
-          sumF += fixedValue  * differential;
-          sumM += movingValue * differential;
-          if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
-            {
-            sumF -= differential * sf / this->m_NumberOfPixelsCounted;
-            sumM -= differential * sm / this->m_NumberOfPixelsCounted;
-            }
-          }
-        derivativeF[par] += sumF;
-        derivativeM[par] += sumM;
-        }
+      differentials[par] += differential;
       }
-
-    ++ti;
     }
 
-  if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
-    {
-    sff -= ( sf * sf / this->m_NumberOfPixelsCounted );
-    smm -= ( sm * sm / this->m_NumberOfPixelsCounted );
-    sfm -= ( sf * sm / this->m_NumberOfPixelsCounted );
-    }
+  return true;
+}
 
-  const RealType denom = -1.0 * vcl_sqrt(sff * smm);
+/**
+ * Get the Derivative Measure
+ */
+template< class TFixedImage, class TMovingImage >
+void
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::GetDerivative(const TransformParametersType & parameters,
+                DerivativeType & derivative) const
+{
+  MeasureType value;
 
-  if ( this->m_NumberOfPixelsCounted > 0 && denom != 0.0 )
-    {
-    for ( unsigned int i = 0; i < ParametersDimension; i++ )
-      {
-      derivative[i] = ( derivativeF[i] - ( sfm / smm ) * derivativeM[i] ) / denom;
-      }
-    }
-  else
-    {
-    for ( unsigned int i = 0; i < ParametersDimension; i++ )
-      {
-      derivative[i] = NumericTraits< MeasureType >::Zero;
-      }
-    }
+  // call the combined version
+  this->GetValueAndDerivative(parameters, value, derivative);
 }
 
 /*
@@ -322,183 +267,38 @@ NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
 ::GetValueAndDerivative(const TransformParametersType & parameters,
                         MeasureType & value, DerivativeType  & derivative) const
 {
-  if ( !this->GetGradientImage() )
-    {
-    itkExceptionMacro(<< "The gradient image is null, maybe you forgot to call Initialize()");
-    }
-
-  FixedImageConstPointer fixedImage = this->m_FixedImage;
-
-  if ( !fixedImage )
+  if ( !this->m_FixedImage )
     {
     itkExceptionMacro(<< "Fixed image has not been assigned");
     }
 
-  const unsigned int dimension = FixedImageType::ImageDimension;
+  this->UpdateFixedImageSamples();
 
-  typedef  itk::ImageRegionConstIteratorWithIndex< FixedImageType > FixedIteratorType;
-
-  FixedIteratorType ti( fixedImage, this->GetFixedImageRegion() );
-
-  typename FixedImageType::IndexType index;
-
-  this->m_NumberOfPixelsCounted = 0;
+  this->ResetSampleBlocks(true);
 
   this->SetTransformParameters(parameters);
 
-  typedef  typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
+  // MUST BE CALLED TO INITIATE PROCESSING
+  this->GetValueAndDerivativeMultiThreadedInitiate();
 
-  AccumulateType sff  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType smm  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sfm = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sf  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sm  = NumericTraits< AccumulateType >::Zero;
+  this->SumSampleBlocks(true);
 
   const unsigned int ParametersDimension = this->GetNumberOfParameters();
   derivative = DerivativeType(ParametersDimension);
-  derivative.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
-
-  DerivativeType derivativeF = DerivativeType(ParametersDimension);
-  derivativeF.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
-
-  DerivativeType derivativeM = DerivativeType(ParametersDimension);
-  derivativeM.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
 
-  DerivativeType derivativeM1 = DerivativeType(ParametersDimension);
-  derivativeM1.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
-
-  ti.GoToBegin();
-  // First compute the sums
-  while ( !ti.IsAtEnd() )
-    {
-    index = ti.GetIndex();
-
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
-
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
-
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-      {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      const RealType fixedValue   = ti.Get();
-      sff += fixedValue  * fixedValue;
-      smm += movingValue * movingValue;
-      sfm += fixedValue  * movingValue;
-      if ( this->m_SubtractMean )
-        {
-        sf += fixedValue;
-        sm += movingValue;
-        }
-      this->m_NumberOfPixelsCounted++;
-      }
-
-    ++ti;
-    }
-
-  // Compute contributions to derivatives
-  ti.GoToBegin();
-  while ( !ti.IsAtEnd() )
-    {
-    index = ti.GetIndex();
-
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
-
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
-
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-      {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      const RealType fixedValue     = ti.Get();
-
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
-
-      // Get the gradient by NearestNeighboorInterpolation:
-      // which is equivalent to round up the point components.
-      typedef typename OutputPointType::CoordRepType CoordRepType;
-      typedef ContinuousIndex< CoordRepType, MovingImageType::ImageDimension >
-      MovingImageContinuousIndexType;
-
-      MovingImageContinuousIndexType tempIndex;
-      this->m_MovingImage->TransformPhysicalPointToContinuousIndex(transformedPoint, tempIndex);
-
-      typename MovingImageType::IndexType mappedIndex;
-      mappedIndex.CopyWithRound(tempIndex);
-
-      const GradientPixelType gradient =
-        this->GetGradientImage()->GetPixel(mappedIndex);
-
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
-        {
-        RealType sumF = NumericTraits< RealType >::Zero;
-        RealType sumM = NumericTraits< RealType >::Zero;
-        for ( unsigned int dim = 0; dim < dimension; dim++ )
-          {
-          const RealType differential = jacobian(dim, par) * gradient[dim];
-          sumF += fixedValue  * differential;
-          sumM += movingValue * differential;
-          if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
-            {
-            sumF -= differential * sf / this->m_NumberOfPixelsCounted;
-            sumM -= differential * sm / this->m_NumberOfPixelsCounted;
-            }
-          }
-        derivativeF[par] += sumF;
-        derivativeM[par] += sumM;
-        }
-      }
-    ++ti;
-    }
-
-  if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
-    {
-    sff -= ( sf * sf / this->m_NumberOfPixelsCounted );
-    smm -= ( sm * sm / this->m_NumberOfPixelsCounted );
-    sfm -= ( sf * sm / this->m_NumberOfPixelsCounted );
-    }
-
-  const RealType denom = -1.0 * vcl_sqrt(sff * smm);
+  const RealType denom = -1.0 * vcl_sqrt(m_Sums.sff * m_Sums.smm);
 
   if ( this->m_NumberOfPixelsCounted > 0 && denom != 0.0 )
     {
     for ( unsigned int i = 0; i < ParametersDimension; i++ )
       {
-      derivative[i] = ( derivativeF[i] - ( sfm / smm ) * derivativeM[i] ) / denom;
+      derivative[i] = ( m_DerivativeF[i] - ( m_Sums.sfm / m_Sums.smm ) * m_DerivativeM[i] ) / denom;
       }
-    value = sfm / denom;
+    value = m_Sums.sfm / denom;
     }
   else
     {
-    for ( unsigned int i = 0; i < ParametersDimension; i++ )
-      {
-      derivative[i] = NumericTraits< MeasureType >::Zero;
-      }
+    derivative.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
     value = NumericTraits< MeasureType >::Zero;
     }
 }
@@ -83,6 +83,93 @@ NormalizedMutualInformationHistogramImageToImageMetric< TFixedImage, \
 
   return ( entropyX + entropyY ) / jointEntropy;
 }
+
+template< class TFixedImage, class TMovingImage >
+bool
+NormalizedMutualInformationHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::EvaluateMeasureFrequencyDerivatives(const JointFrequenciesType & frequencies,
+                                      JointFrequenciesType & derivatives) const
+{
+  const unsigned int sizeX = frequencies.rows();
+  const unsigned int sizeY = frequencies.cols();
+
+  derivatives.SetSize(sizeX, sizeY);
+  derivatives.Fill(0.0);
+
+  std::vector< double > freqX(sizeX, 0.0);
+  std::vector< double > freqY(sizeY, 0.0);
+  double                totalFreq = 0.0;
+  for ( unsigned int i = 0; i < sizeX; i++ )
+    {
+    for ( unsigned int j = 0; j < sizeY; j++ )
+      {
+      const double freq = frequencies(i, j);
+      freqX[i] += freq;
+      freqY[j] += freq;
+      totalFreq += freq;
+      }
+    }
+  if ( totalFreq <= 0.0 )
+    {
+    return true;
+    }
+
+  double entropyX = 0.0;
+  double entropyY = 0.0;
+  double jointEntropy = 0.0;
+  for ( unsigned int i = 0; i < sizeX; i++ )
+    {
+    if ( freqX[i] > 0 )
+      {
+      entropyX += freqX[i] * vcl_log(freqX[i]);
+      }
+    for ( unsigned int j = 0; j < sizeY; j++ )
+      {
+      const double freq = frequencies(i, j);
+      if ( freq > 0 )
+        {
+        jointEntropy += freq * vcl_log(freq);
+        }
+      }
+    }
+  for ( unsigned int j = 0; j < sizeY; j++ )
+    {
+    if ( freqY[j] > 0 )
+      {
+      entropyY += freqY[j] * vcl_log(freqY[j]);
+      }
+    }
+  entropyX = -entropyX / totalFreq + vcl_log(totalFreq);
+  entropyY = -entropyY / totalFreq + vcl_log(totalFreq);
+  jointEntropy = -jointEntropy / totalFreq + vcl_log(totalFreq);
+
+  if ( jointEntropy <= 0.0 )
+    {
+    return true;
+    }
+
+  // The total frequency being held fixed, the derivative of an entropy
+  // -sum(f log f) / N + log N with respect to a frequency f is
+  // -(log f + 1) / N.
+  for ( unsigned int i = 0; i < sizeX; i++ )
+    {
+    for ( unsigned int j = 0; j < sizeY; j++ )
+      {
+      const double freq = frequencies(i, j);
+      if ( freq > 0 )
+        {
+        const double dEntropyX = -( vcl_log(freqX[i]) + 1.0 ) / totalFreq;
+        const double dEntropyY = -( vcl_log(freqY[j]) + 1.0 ) / totalFreq;
+        const double dJointEntropy = -( vcl_log(freq) + 1.0 ) / totalFreq;
+        derivatives(i, j) = ( ( dEntropyX + dEntropyY ) * jointEntropy
+                              - ( entropyX + entropyY ) * dJointEntropy )
+                            / ( jointEntropy * jointEntropy );
+        }
+      }
+    }
+
+  return true;
+}
 } // End namespace itk
 
 #endif // itkNormalizedMutualInformationHistogramImageToImageMetric_txx
@@ -19,6 +19,7 @@
 
 #include "itkInPlaceImageFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkPixelBufferTraits.h"
 
 namespace itk
 {
@@ -112,6 +113,15 @@ public:
   itkStaticConstMacro(
     OutputImageDimension, unsigned int, TOutputImage::ImageDimension);
 
+  /** Whether the input and output images store their pixels directly
+   * in their buffers (see PixelBufferTraits). ThreadedGenerateData()
+   * then walks each scanline of the region with raw pointers, a loop
+   * the compiler can vectorize, instead of using region iterators. */
+  itkStaticConstMacro( ScanlineFastPath, bool,
+                       ( PixelBufferTraits< TInputImage1 >::IsDirect
+                         && PixelBufferTraits< TInputImage2 >::IsDirect
+                         && PixelBufferTraits< TOutputImage >::IsDirect ) );
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( SameDimensionCheck1,
@@ -143,6 +153,23 @@ private:
   BinaryFunctorImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);           //purposely not implemented
 
+  /** Helpers selecting at compile time the implementation of
+   * ThreadedGenerateData(). */
+  struct DispatchBase {};
+  template< bool VScanlineFastPath >
+  struct Dispatch:public DispatchBase {};
+
+  /** Generic implementation, walking the region with iterators. */
+  void ThreadedGenerateDataDispatch(const DispatchBase &,
+                                    const OutputImageRegionType & outputRegionForThread,
+                                    int threadId);
+
+  /** Implementation applying the functor to whole scanlines through
+   * raw buffer pointers. */
+  void ThreadedGenerateDataDispatch(const Dispatch< true > &,
+                                    const OutputImageRegionType & outputRegionForThread,
+                                    int threadId);
+
   FunctorType m_Functor;
 };
 } // end namespace itk
@@ -70,6 +70,20 @@ void
 BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        int threadId)
+{
+  this->ThreadedGenerateDataDispatch(Dispatch< ScanlineFastPath >(),
+                                     outputRegionForThread, threadId);
+}
+
+/**
+ * Generic implementation using region iterators
+ */
+template< class TInputImage1, class TInputImage2, class TOutputImage, class TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::ThreadedGenerateDataDispatch(const DispatchBase &,
+                               const OutputImageRegionType & outputRegionForThread,
+                               int threadId)
 {
   // We use dynamic_cast since inputs are stored as DataObjects.  The
   // ImageToImageFilter::GetInput(int) always returns a pointer to a
@@ -100,6 +114,63 @@ BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
     progress.CompletedPixel(); // potential exception thrown here
     }
 }
+
+/**
+ * Scanline implementation using raw buffer pointers
+ */
+template< class TInputImage1, class TInputImage2, class TOutputImage, class TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::ThreadedGenerateDataDispatch(const Dispatch< true > &,
+                               const OutputImageRegionType & outputRegionForThread,
+                               int threadId)
+{
+  Input1ImagePointer inputPtr1 =
+    dynamic_cast< const TInputImage1 * >( ProcessObject::GetInput(0) );
+  Input2ImagePointer inputPtr2 =
+    dynamic_cast< const TInputImage2 * >( ProcessObject::GetInput(1) );
+  OutputImagePointer outputPtr = this->GetOutput(0);
+
+  const typename OutputImageRegionType::IndexType & start = outputRegionForThread.GetIndex();
+  const typename OutputImageRegionType::SizeType &  size = outputRegionForThread.GetSize();
+
+  if ( outputRegionForThread.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  const unsigned long lineLength = size[0];
+  const unsigned long numberOfLines = outputRegionForThread.GetNumberOfPixels() / lineLength;
+
+  const Input1ImagePixelType *inputBuffer1 = inputPtr1->GetBufferPointer();
+  const Input2ImagePixelType *inputBuffer2 = inputPtr2->GetBufferPointer();
+  OutputImagePixelType *      outputBuffer = outputPtr->GetBufferPointer();
+
+  ProgressReporter progress(this, threadId, numberOfLines);
+
+  typename OutputImageRegionType::IndexType index = start;
+  for ( unsigned long line = 0; line < numberOfLines; ++line )
+    {
+    const Input1ImagePixelType *in1 = inputBuffer1 + inputPtr1->ComputeOffset(index);
+    const Input2ImagePixelType *in2 = inputBuffer2 + inputPtr2->ComputeOffset(index);
+    OutputImagePixelType *      out = outputBuffer + outputPtr->ComputeOffset(index);
+    for ( unsigned long i = 0; i < lineLength; ++i )
+      {
+      out[i] = m_Functor(in1[i], in2[i]);
+      }
+
+    // move to the beginning of the next line
+    for ( unsigned int d = 1; d < OutputImageRegionType::ImageDimension; ++d )
+      {
+      if ( ++index[d] < start[d] + static_cast< long >( size[d] ) )
+        {
+        break;
+        }
+      index[d] = start[d];
+      }
+    progress.CompletedPixel(); // potential exception thrown here
+    }
+}
 } // end namespace itk
 
 #endif
@@ -0,0 +1,193 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkFunctorComposition.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkFunctorComposition_h
+#define __itkFunctorComposition_h
+
+namespace itk
+{
+/** \file itkFunctorComposition.h
+ * \brief Pixel functors made of other pixel functors.
+ *
+ * A pipeline of functor filters (CastImageFilter, SigmoidImageFilter,
+ * MaskImageFilter, ...) reads and writes a whole image at every stage.
+ * The functors below combine the functors of such a chain into a single
+ * functor. Used as the functor of a UnaryFunctorImageFilter or a
+ * BinaryFunctorImageFilter, they evaluate the whole chain in one pass,
+ * with one read per input pixel and one write per output pixel, and no
+ * intermediate image. The composition is resolved at compile time, so
+ * the compiler can inline the combined kernel.
+ *
+ * Compositions nest: the first functor of a UnaryComposition may itself
+ * be a UnaryComposition. For example, Cast -> IntensityLinearTransform
+ * -> Sigmoid -> Mask is written
+ *
+ * \code
+ * typedef Functor::Cast< short, float >                         CastType;
+ * typedef Functor::IntensityLinearTransform< float, float >     ShiftScaleType;
+ * typedef Function::Sigmoid< float, float >                     SigmoidType;
+ * typedef Functor::MaskInput< float, unsigned char, float >     MaskType;
+ *
+ * typedef Functor::UnaryComposition< short, float, CastType, ShiftScaleType >    CastShiftScaleType;
+ * typedef Functor::UnaryComposition< short, float, CastShiftScaleType, SigmoidType > ChainType;
+ * typedef Functor::BinaryComposition< short, unsigned char, float, MaskType, ChainType > ExpressionType;
+ *
+ * typedef BinaryFunctorImageFilter< ShortImageType, MaskImageType, FloatImageType,
+ *                                   ExpressionType > ExpressionFilterType;
+ * \endcode
+ *
+ * and the parameters of each stage are reached through
+ * GetFunctor().GetFirstFunctor() and GetFunctor().GetSecondFunctor().
+ * Call Modified() on the filter after changing them this way.
+ *
+ * The intermediate values keep the output type of each functor, so the
+ * result matches the chained filters exactly.
+ *
+ * \ingroup IntensityImageFilters
+ */
+namespace Functor
+{
+/** \class Identity
+ * \brief Functor returning its argument, converted to TOutput. */
+template< class TInput, class TOutput = TInput >
+class Identity
+{
+public:
+  Identity() {}
+  ~Identity() {}
+  bool operator!=(const Identity &) const
+  {
+    return false;
+  }
+
+  bool operator==(const Identity & other) const
+  {
+    return !( *this != other );
+  }
+
+  inline TOutput operator()(const TInput & A) const
+  {
+    return static_cast< TOutput >( A );
+  }
+};
+
+/** \class UnaryComposition
+ * \brief Functor applying TSecondFunctor to the result of TFirstFunctor.
+ *
+ * TInput is the input type of TFirstFunctor, and TOutput the output
+ * type of TSecondFunctor. */
+template< class TInput, class TOutput, class TFirstFunctor, class TSecondFunctor >
+class UnaryComposition
+{
+public:
+  typedef TFirstFunctor  FirstFunctorType;
+  typedef TSecondFunctor SecondFunctorType;
+
+  UnaryComposition() {}
+  ~UnaryComposition() {}
+
+  bool operator!=(const UnaryComposition & other) const
+  {
+    return m_FirstFunctor != other.m_FirstFunctor
+           || m_SecondFunctor != other.m_SecondFunctor;
+  }
+
+  bool operator==(const UnaryComposition & other) const
+  {
+    return !( *this != other );
+  }
+
+  inline TOutput operator()(const TInput & A) const
+  {
+    return static_cast< TOutput >( m_SecondFunctor( m_FirstFunctor(A) ) );
+  }
+
+  /** Get/Set the functor applied first. */
+  FirstFunctorType & GetFirstFunctor() { return m_FirstFunctor; }
+  const FirstFunctorType & GetFirstFunctor() const { return m_FirstFunctor; }
+  void SetFirstFunctor(const FirstFunctorType & functor) { m_FirstFunctor = functor; }
+
+  /** Get/Set the functor applied to the result of the first one. */
+  SecondFunctorType & GetSecondFunctor() { return m_SecondFunctor; }
+  const SecondFunctorType & GetSecondFunctor() const { return m_SecondFunctor; }
+  void SetSecondFunctor(const SecondFunctorType & functor) { m_SecondFunctor = functor; }
+
+private:
+  FirstFunctorType  m_FirstFunctor;
+  SecondFunctorType m_SecondFunctor;
+};
+
+/** \class BinaryComposition
+ * \brief Functor applying a binary functor to the results of two unary
+ * functors, one per argument.
+ *
+ * TInput1 and TInput2 are the input types of the two unary functors, and
+ * TOutput the output type of TBinaryFunctor. The unary functors default
+ * to Identity, so that only one argument needs to be transformed. */
+template< class TInput1, class TInput2, class TOutput, class TBinaryFunctor,
+          class TInput1Functor = Identity< TInput1 >,
+          class TInput2Functor = Identity< TInput2 > >
+class BinaryComposition
+{
+public:
+  typedef TBinaryFunctor BinaryFunctorType;
+  typedef TInput1Functor Input1FunctorType;
+  typedef TInput2Functor Input2FunctorType;
+
+  BinaryComposition() {}
+  ~BinaryComposition() {}
+
+  bool operator!=(const BinaryComposition & other) const
+  {
+    return m_BinaryFunctor != other.m_BinaryFunctor
+           || m_Input1Functor != other.m_Input1Functor
+           || m_Input2Functor != other.m_Input2Functor;
+  }
+
+  bool operator==(const BinaryComposition & other) const
+  {
+    return !( *this != other );
+  }
+
+  inline TOutput operator()(const TInput1 & A, const TInput2 & B) const
+  {
+    return static_cast< TOutput >( m_BinaryFunctor( m_Input1Functor(A), m_Input2Functor(B) ) );
+  }
+
+  /** Get/Set the functor combining the two transformed arguments. */
+  BinaryFunctorType & GetBinaryFunctor() { return m_BinaryFunctor; }
+  const BinaryFunctorType & GetBinaryFunctor() const { return m_BinaryFunctor; }
+  void SetBinaryFunctor(const BinaryFunctorType & functor) { m_BinaryFunctor = functor; }
+
+  /** Get/Set the functor applied to the first argument. */
+  Input1FunctorType & GetInput1Functor() { return m_Input1Functor; }
+  const Input1FunctorType & GetInput1Functor() const { return m_Input1Functor; }
+  void SetInput1Functor(const Input1FunctorType & functor) { m_Input1Functor = functor; }
+
+  /** Get/Set the functor applied to the second argument. */
+  Input2FunctorType & GetInput2Functor() { return m_Input2Functor; }
+  const Input2FunctorType & GetInput2Functor() const { return m_Input2Functor; }
+  void SetInput2Functor(const Input2FunctorType & functor) { m_Input2Functor = functor; }
+
+private:
+  BinaryFunctorType m_BinaryFunctor;
+  Input1FunctorType m_Input1Functor;
+  Input2FunctorType m_Input2Functor;
+};
+} // end namespace Functor
+} // end namespace itk
+
+#endif
@@ -18,7 +18,7 @@
 #define __itkMinimumMaximumImageCalculator_txx
 
 #include "itkMinimumMaximumImageCalculator.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageScanlineConstIterator.h"
 #include "itkNumericTraits.h"
 
 namespace itk
@@ -51,24 +51,32 @@ MinimumMaximumImageCalculator< TInputImage >
     m_Region = m_Image->GetRequestedRegion();
     }
 
-  ImageRegionConstIteratorWithIndex< TInputImage > it(m_Image, m_Region);
+  ImageScanlineConstIterator< TInputImage > it(m_Image, m_Region);
   m_Maximum = NumericTraits< PixelType >::NonpositiveMin();
   m_Minimum = NumericTraits< PixelType >::max();
 
+  // The index of an extremum is the index of the first pixel of its line
+  // shifted along the line
   while ( !it.IsAtEnd() )
     {
-    const PixelType value = it.Get();
-    if ( value > m_Maximum )
+    const IndexType lineIndex = it.GetIndex();
+    for ( typename IndexType::IndexValueType i = 0; !it.IsAtEndOfLine(); ++i, ++it )
       {
-      m_Maximum = value;
-      m_IndexOfMaximum = it.GetIndex();
+      const PixelType value = it.Get();
+      if ( value > m_Maximum )
+        {
+        m_Maximum = value;
+        m_IndexOfMaximum = lineIndex;
+        m_IndexOfMaximum[0] += i;
+        }
+      if ( value < m_Minimum )
+        {
+        m_Minimum = value;
+        m_IndexOfMinimum = lineIndex;
+        m_IndexOfMinimum[0] += i;
+        }
       }
-    if ( value < m_Minimum )
-      {
-      m_Minimum = value;
-      m_IndexOfMinimum = it.GetIndex();
-      }
-    ++it;
+    it.NextLine();
     }
 }
 
@@ -84,18 +92,23 @@ MinimumMaximumImageCalculator< TInputImage >
     {
     m_Region = m_Image->GetRequestedRegion();
     }
-  ImageRegionConstIteratorWithIndex< TInputImage > it(m_Image,  m_Region);
+  ImageScanlineConstIterator< TInputImage > it(m_Image,  m_Region);
   m_Minimum = NumericTraits< PixelType >::max();
 
   while ( !it.IsAtEnd() )
     {
-    const PixelType value = it.Get();
-    if ( value < m_Minimum )
+    const IndexType lineIndex = it.GetIndex();
+    for ( typename IndexType::IndexValueType i = 0; !it.IsAtEndOfLine(); ++i, ++it )
       {
-      m_Minimum = value;
-      m_IndexOfMinimum = it.GetIndex();
+      const PixelType value = it.Get();
+      if ( value < m_Minimum )
+        {
+        m_Minimum = value;
+        m_IndexOfMinimum = lineIndex;
+        m_IndexOfMinimum[0] += i;
+        }
       }
-    ++it;
+    it.NextLine();
     }
 }
 
@@ -111,18 +124,23 @@ MinimumMaximumImageCalculator< TInputImage >
     {
     m_Region = m_Image->GetRequestedRegion();
     }
-  ImageRegionConstIteratorWithIndex< TInputImage > it(m_Image,  m_Region);
+  ImageScanlineConstIterator< TInputImage > it(m_Image,  m_Region);
   m_Maximum = NumericTraits< PixelType >::NonpositiveMin();
 
   while ( !it.IsAtEnd() )
     {
-    const PixelType value = it.Get();
-    if ( value > m_Maximum )
+    const IndexType lineIndex = it.GetIndex();
+    for ( typename IndexType::IndexValueType i = 0; !it.IsAtEndOfLine(); ++i, ++it )
       {
-      m_Maximum = value;
-      m_IndexOfMaximum = it.GetIndex();
+      const PixelType value = it.Get();
+      if ( value > m_Maximum )
+        {
+        m_Maximum = value;
+        m_IndexOfMaximum = lineIndex;
+        m_IndexOfMaximum[0] += i;
+        }
       }
-    ++it;
+    it.NextLine();
     }
 }
 
@@ -19,7 +19,7 @@
 #include "itkMinimumMaximumImageFilter.h"
 
 #include "itkImageRegionIterator.h"
-#include "itkImageRegionConstIterator.h"
+#include "itkImageScanlineConstIterator.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
 
@@ -190,26 +190,40 @@ MinimumMaximumImageFilter< TInputImage >
 {
   PixelType value;
 
-  ImageRegionConstIterator< TInputImage > it (this->GetInput(), outputRegionForThread);
+  // accumulate in locals, so that the threads do not share cache lines
+  // in the inner loop
+  PixelType minimum = m_ThreadMin[threadId];
+  PixelType maximum = m_ThreadMax[threadId];
+
+  ImageScanlineConstIterator< TInputImage > it (this->GetInput(), outputRegionForThread);
 
   // support progress methods/callbacks
-  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+  const unsigned long numberOfLines = ( outputRegionForThread.GetNumberOfPixels() > 0 ) ?
+    outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize()[0] : 0;
+  ProgressReporter progress(this, threadId, numberOfLines);
 
   // do the work
   while ( !it.IsAtEnd() )
     {
-    value = static_cast< PixelType >( it.Get() );
-    if ( value < m_ThreadMin[threadId] )
-      {
-      m_ThreadMin[threadId] = value;
-      }
-    if ( value > m_ThreadMax[threadId] )
+    while ( !it.IsAtEndOfLine() )
       {
-      m_ThreadMax[threadId] = value;
+      value = static_cast< PixelType >( it.Get() );
+      if ( value < minimum )
+        {
+        minimum = value;
+        }
+      if ( value > maximum )
+        {
+        maximum = value;
+        }
+      ++it;
       }
-    ++it;
+    it.NextLine();
     progress.CompletedPixel();
     }
+
+  m_ThreadMin[threadId] = minimum;
+  m_ThreadMax[threadId] = maximum;
 }
 
 template< class TImage >
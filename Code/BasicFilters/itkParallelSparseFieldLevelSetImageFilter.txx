@@ -1242,6 +1242,10 @@ ParallelSparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
     str->Filter->m_Data[ThreadId].TimeStep =
       str->Filter->ThreadedCalculateChange(ThreadId);
 
+    // The active layer of the thread is its share of the work
+    ( (MultiThreader::ThreadInfoStruct *)( arg ) )->WorkSize =
+      str->Filter->m_Data[ThreadId].m_Layers[0]->Size();
+
     str->Filter->WaitForAll();
 
     // Handle AbortGenerateData()
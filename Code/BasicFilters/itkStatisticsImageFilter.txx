@@ -19,7 +19,7 @@
 #include "itkStatisticsImageFilter.h"
 
 #include "itkImageRegionIterator.h"
-#include "itkImageRegionConstIterator.h"
+#include "itkImageScanlineConstIterator.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
 
@@ -307,31 +307,49 @@ StatisticsImageFilter< TInputImage >
   RealType  realValue;
   PixelType value;
 
-  ImageRegionConstIterator< TInputImage > it (this->GetInput(), outputRegionForThread);
+  // accumulate in locals, so that the threads do not share cache lines
+  // in the inner loop
+  PixelType minimum = m_ThreadMin[threadId];
+  PixelType maximum = m_ThreadMax[threadId];
+  RealType  sum = m_ThreadSum[threadId];
+  RealType  sumOfSquares = m_SumOfSquares[threadId];
+
+  ImageScanlineConstIterator< TInputImage > it (this->GetInput(), outputRegionForThread);
 
   // support progress methods/callbacks
-  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+  const unsigned long numberOfLines = ( outputRegionForThread.GetNumberOfPixels() > 0 ) ?
+    outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize()[0] : 0;
+  ProgressReporter progress(this, threadId, numberOfLines);
 
   // do the work
   while ( !it.IsAtEnd() )
     {
-    value = it.Get();
-    realValue = static_cast< RealType >( value );
-    if ( value < m_ThreadMin[threadId] )
-      {
-      m_ThreadMin[threadId] = value;
-      }
-    if ( value > m_ThreadMax[threadId] )
+    while ( !it.IsAtEndOfLine() )
       {
-      m_ThreadMax[threadId] = value;
+      value = it.Get();
+      realValue = static_cast< RealType >( value );
+      if ( value < minimum )
+        {
+        minimum = value;
+        }
+      if ( value > maximum )
+        {
+        maximum = value;
+        }
+
+      sum += realValue;
+      sumOfSquares += ( realValue * realValue );
+      ++it;
       }
-
-    m_ThreadSum[threadId] += realValue;
-    m_SumOfSquares[threadId] += ( realValue * realValue );
-    m_Count[threadId]++;
-    ++it;
+    it.NextLine();
     progress.CompletedPixel();
     }
+
+  m_ThreadMin[threadId] = minimum;
+  m_ThreadMax[threadId] = maximum;
+  m_ThreadSum[threadId] = sum;
+  m_SumOfSquares[threadId] = sumOfSquares;
+  m_Count[threadId] += outputRegionForThread.GetNumberOfPixels();
 }
 
 template< class TImage >
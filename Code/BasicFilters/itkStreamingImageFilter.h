@@ -20,6 +20,7 @@
 #include "itkImageSource.h"
 #include "itkImageToImageFilter.h"
 #include "itkImageRegionSplitter.h"
+#include "itkStreamingPrefetcher.h"
 
 namespace itk
 {
@@ -36,6 +37,11 @@ namespace itk
  * This filter will produce the entire output as one image, but the upstream
  * filters will do their processing in pieces.
  *
+ * By default the upstream pipeline is updated for a piece once the
+ * previous piece is copied. With NumberOfPiecesInFlight set to 2 or
+ * more, it is updated for the next pieces on another thread while the
+ * previous ones are copied (see StreamingPrefetcher).
+ *
  * \ingroup ITKSystemObjects
  * \ingroup DataProcessing
  */
@@ -86,6 +92,13 @@ public:
    * will be executed this many times. */
   itkGetConstReferenceMacro(NumberOfStreamDivisions, unsigned int);
 
+  /** Set/Get the largest number of pieces requested from the upstream
+   * pipeline and not copied yet, including the piece being copied. The
+   * default, 1, updates the pipeline for a piece once the previous one
+   * is copied; 2 double buffers the pieces. */
+  itkSetClampMacro(NumberOfPiecesInFlight, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfPiecesInFlight, unsigned int);
+
   /** Set the helper class for dividing the input into chunks. */
   itkSetObjectMacro(RegionSplitter, SplitterType);
 
@@ -126,6 +139,7 @@ private:
   // implemented
 
   unsigned int          m_NumberOfStreamDivisions;
+  unsigned int          m_NumberOfPiecesInFlight;
   RegionSplitterPointer m_RegionSplitter;
 };
 } // end namespace itk
@@ -31,6 +31,7 @@ StreamingImageFilter< TInputImage, TOutputImage >
 {
   // default to 10 divisions
   m_NumberOfStreamDivisions = 10;
+  m_NumberOfPiecesInFlight = 1;
 
   // create default region splitter
   m_RegionSplitter = ImageRegionSplitter< InputImageDimension >::New();
@@ -56,6 +57,8 @@ StreamingImageFilter< TInputImage, TOutputImage >
 
   os << indent << "Number of stream divisions: " << m_NumberOfStreamDivisions
      << std::endl;
+  os << indent << "Number of pieces in flight: " << m_NumberOfPiecesInFlight
+     << std::endl;
   if ( m_RegionSplitter )
     {
     os << indent << "Region splitter:" << m_RegionSplitter << std::endl;
@@ -182,26 +185,34 @@ StreamingImageFilter< TInputImage, TOutputImage >
 
   /**
    * Loop over the number of pieces, execute the upstream pipeline on each
-   * piece, and copy the results into the output image.
+   * piece, and copy the results into the output image. The prefetcher
+   * executes the pipeline, ahead of the copies if pieces may be in
+   * flight.
    */
-  unsigned int         piece;
-  InputImageRegionType streamRegion;
+  typedef StreamingPrefetcher< InputImageType > PrefetcherType;
+  typename PrefetcherType::RegionListType streamRegions(numDivisions);
+  for ( unsigned int i = 0; i < numDivisions; i++ )
+    {
+    streamRegions[i] = m_RegionSplitter->GetSplit(i, numDivisions, outputRegion);
+    }
+  typename PrefetcherType::Pointer prefetcher = PrefetcherType::New();
+  prefetcher->SetInput(inputPtr);
+  prefetcher->SetNumberOfPiecesInFlight(m_NumberOfPiecesInFlight);
+  prefetcher->Start(streamRegions);
+
+  unsigned int piece;
   for ( piece = 0;
         piece < numDivisions && !this->GetAbortGenerateData();
         piece++ )
     {
-    streamRegion = m_RegionSplitter->GetSplit(piece, numDivisions,
-                                              outputRegion);
-
-    inputPtr->SetRequestedRegion(streamRegion);
-    inputPtr->PropagateRequestedRegion();
-    inputPtr->UpdateOutputData();
+    InputImagePointer          pieceImage = prefetcher->GetNextPiece();
+    const InputImageRegionType streamRegion = streamRegions[piece];
 
     // copy the result to the proper place in the output. the input
     // requested region determined by the RegionSplitter (as opposed
     // to what the pipeline might have enlarged it to) is used to
     // construct the iterators for both the input and output
-    ImageRegionIterator< InputImageType >  inIt(inputPtr, streamRegion);
+    ImageRegionIterator< InputImageType >  inIt(pieceImage, streamRegion);
     ImageRegionIterator< OutputImageType > outIt(outputPtr, streamRegion);
 
     for ( inIt.GoToBegin(), outIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt, ++outIt )
@@ -211,6 +222,7 @@ StreamingImageFilter< TInputImage, TOutputImage >
 
     this->UpdateProgress( (float)piece / numDivisions );
     }
+  prefetcher->Stop();
 
   /**
    * If we ended due to aborting, push the progress up to 1.0 (since
@@ -21,8 +21,7 @@
 #define __itkThresholdImageFilter_txx
 
 #include "itkThresholdImageFilter.h"
-#include "itkImageRegionIterator.h"
-#include "itkImageRegionConstIterator.h"
+#include "itkImageScanlineIterator.h"
 #include "itkNumericTraits.h"
 #include "itkObjectFactory.h"
 #include "itkProgressReporter.h"
@@ -135,31 +134,42 @@ ThresholdImageFilter< TImage >
 
   // Define/declare an iterator that will walk the output region for this
   // thread.
-  typedef ImageRegionConstIterator< TImage > InputIterator;
-  typedef ImageRegionIterator< TImage >      OutputIterator;
+  typedef ImageScanlineConstIterator< TImage > InputIterator;
+  typedef ImageScanlineIterator< TImage >      OutputIterator;
 
   InputIterator  inIt(inputPtr, outputRegionForThread);
   OutputIterator outIt(outputPtr, outputRegionForThread);
 
   // support progress methods/callbacks
-  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+  const unsigned long numberOfLines = ( outputRegionForThread.GetNumberOfPixels() > 0 ) ?
+    outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize()[0] : 0;
+  ProgressReporter progress(this, threadId, numberOfLines);
+
+  const PixelType lower = m_Lower;
+  const PixelType upper = m_Upper;
+  const PixelType outsideValue = m_OutsideValue;
 
   // walk the regions, threshold each pixel
   while ( !outIt.IsAtEnd() )
     {
-    const PixelType value = inIt.Get();
-    if ( m_Lower <= value && value <= m_Upper )
-      {
-      // pixel passes to output unchanged and is replaced by m_OutsideValue in
-      // the inverse output image
-      outIt.Set( inIt.Get() );
-      }
-    else
+    while ( !outIt.IsAtEndOfLine() )
       {
-      outIt.Set(m_OutsideValue);
+      const PixelType value = inIt.Get();
+      if ( lower <= value && value <= upper )
+        {
+        // pixel passes to output unchanged and is replaced by m_OutsideValue in
+        // the inverse output image
+        outIt.Set(value);
+        }
+      else
+        {
+        outIt.Set(outsideValue);
+        }
+      ++inIt;
+      ++outIt;
       }
-    ++inIt;
-    ++outIt;
+    inIt.NextLine();
+    outIt.NextLine();
     progress.CompletedPixel();
     }
 }
@@ -19,6 +19,7 @@
 
 #include "itkInPlaceImageFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkPixelBufferTraits.h"
 
 namespace itk
 {
@@ -89,6 +90,16 @@ public:
       }
   }
 
+  /** Whether the input and output images store their pixels directly
+   * in their buffers (see PixelBufferTraits). ThreadedGenerateData()
+   * then walks each scanline of the region with raw pointers, a loop
+   * the compiler can vectorize, instead of using region iterators. */
+  itkStaticConstMacro( ScanlineFastPath, bool,
+                       ( PixelBufferTraits< TInputImage >::IsDirect
+                         && PixelBufferTraits< TOutputImage >::IsDirect
+                         && static_cast< unsigned int >( TInputImage::ImageDimension )
+                         == static_cast< unsigned int >( TOutputImage::ImageDimension ) ) );
+
 protected:
   UnaryFunctorImageFilter();
   virtual ~UnaryFunctorImageFilter() {}
@@ -120,6 +131,23 @@ private:
   UnaryFunctorImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);          //purposely not implemented
 
+  /** Helpers selecting at compile time the implementation of
+   * ThreadedGenerateData(). */
+  struct DispatchBase {};
+  template< bool VScanlineFastPath >
+  struct Dispatch:public DispatchBase {};
+
+  /** Generic implementation, walking the region with iterators. */
+  void ThreadedGenerateDataDispatch(const DispatchBase &,
+                                    const OutputImageRegionType & outputRegionForThread,
+                                    int threadId);
+
+  /** Implementation applying the functor to whole scanlines through
+   * raw buffer pointers. */
+  void ThreadedGenerateDataDispatch(const Dispatch< true > &,
+                                    const OutputImageRegionType & outputRegionForThread,
+                                    int threadId);
+
   FunctorType m_Functor;
 };
 } // end namespace itk
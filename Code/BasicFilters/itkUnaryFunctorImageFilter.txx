@@ -150,6 +150,20 @@ void
 UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        int threadId)
+{
+  this->ThreadedGenerateDataDispatch(Dispatch< ScanlineFastPath >(),
+                                     outputRegionForThread, threadId);
+}
+
+/**
+ * Generic implementation using region iterators
+ */
+template< class TInputImage, class TOutputImage, class TFunction  >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::ThreadedGenerateDataDispatch(const DispatchBase &,
+                               const OutputImageRegionType & outputRegionForThread,
+                               int threadId)
 {
   InputImagePointer  inputPtr = this->GetInput();
   OutputImagePointer outputPtr = this->GetOutput(0);
@@ -178,6 +192,60 @@ UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
     progress.CompletedPixel();  // potential exception thrown here
     }
 }
+
+/**
+ * Scanline implementation using raw buffer pointers
+ */
+template< class TInputImage, class TOutputImage, class TFunction  >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::ThreadedGenerateDataDispatch(const Dispatch< true > &,
+                               const OutputImageRegionType & outputRegionForThread,
+                               int threadId)
+{
+  InputImagePointer  inputPtr = this->GetInput();
+  OutputImagePointer outputPtr = this->GetOutput(0);
+
+  // Input and output have the same dimension here, so the input
+  // region for this thread is the output region.
+  const typename OutputImageRegionType::IndexType & start = outputRegionForThread.GetIndex();
+  const typename OutputImageRegionType::SizeType &  size = outputRegionForThread.GetSize();
+
+  if ( outputRegionForThread.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  const unsigned long lineLength = size[0];
+  const unsigned long numberOfLines = outputRegionForThread.GetNumberOfPixels() / lineLength;
+
+  const InputImagePixelType *inputBuffer = inputPtr->GetBufferPointer();
+  OutputImagePixelType *     outputBuffer = outputPtr->GetBufferPointer();
+
+  ProgressReporter progress(this, threadId, numberOfLines);
+
+  typename OutputImageRegionType::IndexType index = start;
+  for ( unsigned long line = 0; line < numberOfLines; ++line )
+    {
+    const InputImagePixelType *in = inputBuffer + inputPtr->ComputeOffset(index);
+    OutputImagePixelType *     out = outputBuffer + outputPtr->ComputeOffset(index);
+    for ( unsigned long i = 0; i < lineLength; ++i )
+      {
+      out[i] = m_Functor(in[i]);
+      }
+
+    // move to the beginning of the next line
+    for ( unsigned int d = 1; d < OutputImageRegionType::ImageDimension; ++d )
+      {
+      if ( ++index[d] < start[d] + static_cast< long >( size[d] ) )
+        {
+        break;
+        }
+      index[d] = start[d];
+      }
+    progress.CompletedPixel();  // potential exception thrown here
+    }
+}
 } // end namespace itk
 
 #endif
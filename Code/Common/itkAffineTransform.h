@@ -133,6 +133,7 @@ public:
   /** Parameters Type   */
   typedef typename Superclass::ParametersType            ParametersType;
   typedef typename Superclass::JacobianType              JacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
   typedef typename Superclass::ScalarType                ScalarType;
   typedef typename Superclass::InputPointType            InputPointType;
   typedef typename Superclass::OutputPointType           OutputPointType;
@@ -289,6 +290,13 @@ public:
    * of the Metric() method. */
   ScalarType Metric(void) const;
 
+  /** Compute the Jacobian at a point into jacobian, which GetJacobian()
+   * does into the transform. Every parameter may act on the point, so all
+   * the columns are returned. */
+  virtual void GetNonZeroJacobian(const InputPointType & point,
+                                  JacobianType & jacobian,
+                                  NonZeroJacobianIndicesType & nonZeroJacobianIndices) const;
+
 protected:
   /** Construct an AffineTransform object
    *
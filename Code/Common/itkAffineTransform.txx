@@ -308,6 +308,20 @@ AffineTransform< TScalarType, NDimensions >
   return this->GetInverse(inv) ? inv.GetPointer() : NULL;
 }
 
+/** Compute the Jacobian in one position, without writing into the
+ * transform */
+template< class TScalarType, unsigned int NDimensions >
+void
+AffineTransform< TScalarType, NDimensions >
+::GetNonZeroJacobian(const InputPointType & p,
+                     JacobianType & jacobian,
+                     NonZeroJacobianIndicesType & nonZeroJacobianIndices) const
+{
+  jacobian.SetSize( this->m_Jacobian.rows(), this->m_Jacobian.cols() );
+  this->ComputeJacobianWithRespectToParameters(p, jacobian);
+  this->GetAllNonZeroJacobianIndices(nonZeroJacobianIndices);
+}
+
 /** Compute a distance between two affine transforms */
 template< class TScalarType, unsigned int NDimensions >
 typename AffineTransform< TScalarType, NDimensions >::ScalarType
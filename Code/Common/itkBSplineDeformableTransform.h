@@ -143,6 +143,9 @@ public:
   /** Standard Jacobian container. */
   typedef typename Superclass::JacobianType JacobianType;
 
+  /** Indices of the non-zero columns of the Jacobian. */
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+
   /** Standard vector type for this class. */
   typedef Vector< TScalarType,
                   itkGetStaticConstMacro(SpaceDimension) > InputVectorType;
@@ -370,6 +373,19 @@ public:
   /** Compute the Jacobian Matrix of the transformation at one point */
   virtual const JacobianType & GetJacobian(const InputPointType  & point) const;
 
+  /** Compute the columns of the Jacobian of the coefficients whose support
+   * contains the point. Column d * GetNumberOfWeights() + k holds, in row d,
+   * the weight of the k-th coefficient of the support region for the
+   * dimension d. When the support region is not within the grid, the
+   * columns are zero. */
+  virtual void GetNonZeroJacobian(const InputPointType & point,
+                                  JacobianType & jacobian,
+                                  NonZeroJacobianIndicesType & nonZeroJacobianIndices) const;
+
+  /** Return the number of columns returned by GetNonZeroJacobian(). */
+  virtual unsigned long GetNumberOfNonZeroJacobianIndices() const
+  { return m_WeightsFunction->GetNumberOfWeights() * SpaceDimension; }
+
   /** Return the number of parameters that completely define the Transfom */
   virtual unsigned int GetNumberOfParameters(void) const;
 
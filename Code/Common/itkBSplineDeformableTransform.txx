@@ -942,6 +942,81 @@ BSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
     }
 }
 
+// Compute the non-zero columns of the Jacobian
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::GetNonZeroJacobian(const InputPointType & point,
+                     JacobianType & jacobian,
+                     NonZeroJacobianIndicesType & nonZeroJacobianIndices) const
+{
+  // Can only compute Jacobian if parameters are set via
+  // SetParameters or SetParametersByValue
+  if ( m_InputParametersPointer == NULL )
+    {
+    itkExceptionMacro(<< "Cannot compute Jacobian: parameters not set");
+    }
+
+  const unsigned long numberOfWeights = m_WeightsFunction->GetNumberOfWeights();
+  const unsigned long numberOfIndices = numberOfWeights * SpaceDimension;
+
+  jacobian.SetSize(SpaceDimension, numberOfIndices);
+  jacobian.Fill(0.0);
+  nonZeroJacobianIndices.SetSize(numberOfIndices);
+
+  ContinuousIndexType index;
+
+  this->TransformPointToContinuousIndex(point, index);
+
+  // NOTE: if the support region does not lie totally within the grid
+  // we assume zero displacement, and the Jacobian is zero
+  if ( !this->InsideValidRegion(index) )
+    {
+    for ( unsigned long i = 0; i < numberOfIndices; i++ )
+      {
+      nonZeroJacobianIndices[i] = i;
+      }
+    return;
+    }
+
+  // Compute the interpolation weights directly into the first row of
+  // the Jacobian
+  WeightsType weights(jacobian[0], numberOfWeights, false);
+  IndexType   supportIndex;
+
+  m_WeightsFunction->Evaluate(index, weights, supportIndex);
+
+  // Offsets of the coefficients of the support region
+  RegionType supportRegion;
+  supportRegion.SetSize(m_SupportSize);
+  supportRegion.SetIndex(supportIndex);
+
+  const PixelType *basePointer = m_CoefficientImage[0]->GetBufferPointer();
+
+  typedef ImageRegionConstIterator< ImageType > IteratorType;
+  IteratorType  it(m_CoefficientImage[0], supportRegion);
+  unsigned long counter = 0;
+
+  while ( !it.IsAtEnd() )
+    {
+    nonZeroJacobianIndices[counter] = &( it.Value() ) - basePointer;
+    ++counter;
+    ++it;
+    }
+
+  // The same weights act on the coefficients of the other dimensions
+  const unsigned long numberOfParametersPerDimension = this->GetNumberOfParametersPerDimension();
+  for ( unsigned int j = 1; j < SpaceDimension; j++ )
+    {
+    for ( unsigned long k = 0; k < numberOfWeights; k++ )
+      {
+      jacobian(j, j * numberOfWeights + k) = jacobian(0, k);
+      nonZeroJacobianIndices[j * numberOfWeights + k] =
+        nonZeroJacobianIndices[k] + j * numberOfParametersPerDimension;
+      }
+    }
+}
+
 template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
 void
 BSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
@@ -59,6 +59,7 @@ public:
   typedef typename Superclass::ParametersType      ParametersType;
   typedef typename Superclass::ParametersValueType ParametersValueType;
   typedef typename Superclass::JacobianType        JacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
   typedef typename Superclass::ScalarType          ScalarType;
   typedef typename Superclass::InputVectorType     InputVectorType;
   typedef typename Superclass::OutputVectorType    OutputVectorType;
@@ -102,6 +103,13 @@ public:
    * is invertible at this point. */
   const JacobianType & GetJacobian(const InputPointType  & point) const;
 
+  /** Compute the Jacobian at a point into jacobian, which GetJacobian()
+   * does into the transform. Every parameter may act on the point, so all
+   * the columns are returned. */
+  virtual void GetNonZeroJacobian(const InputPointType & point,
+                                  JacobianType & jacobian,
+                                  NonZeroJacobianIndicesType & nonZeroJacobianIndices) const;
+
   /** Get an inverse of this transform. */
   bool GetInverse(Self *inverse) const;
 
@@ -109,6 +117,10 @@ public:
   virtual InverseTransformBasePointer GetInverseTransform() const;
 
 protected:
+  /** Compute the Jacobian of the transformation at a point into jacobian,
+   * which has the size of the Jacobian. */
+  void ComputeJacobianWithRespectToParameters(const InputPointType & p, JacobianType & jacobian) const;
+
   /** Construct an CenteredAffineTransform object */
   CenteredAffineTransform();
 
@@ -122,11 +122,11 @@ CenteredAffineTransform< TScalarType, NDimensions >::SetParameters(const Paramet
   this->Modified();
 }
 
-// Compute the Jacobian in one position
+// Compute the Jacobian in one position into the given matrix
 template< class TScalarType, unsigned int NDimensions >
-const typename CenteredAffineTransform< TScalarType, NDimensions >
-::JacobianType &
-CenteredAffineTransform< TScalarType, NDimensions >::GetJacobian(const InputPointType & p) const
+void
+CenteredAffineTransform< TScalarType, NDimensions >
+::ComputeJacobianWithRespectToParameters(const InputPointType & p, JacobianType & jacobian) const
 {
   // The Jacobian of the affine transform is composed of
   // subblocks of diagonal matrices, each one of them having
@@ -134,7 +134,7 @@ CenteredAffineTransform< TScalarType, NDimensions >::GetJacobian(const InputPoin
   // The block corresponding to the center parameters is
   // composed by ( Identity matrix - Rotation Matrix).
 
-  this->m_Jacobian.Fill(0.0);
+  jacobian.Fill(0.0);
 
   unsigned int blockOffset = 0;
 
@@ -142,7 +142,7 @@ CenteredAffineTransform< TScalarType, NDimensions >::GetJacobian(const InputPoin
     {
     for ( unsigned int dim = 0; dim < SpaceDimension; dim++ )
       {
-      this->m_Jacobian(block, blockOffset + dim) = p[dim];
+      jacobian(block, blockOffset + dim) = p[dim];
       }
     blockOffset += SpaceDimension;
     }
@@ -151,10 +151,10 @@ CenteredAffineTransform< TScalarType, NDimensions >::GetJacobian(const InputPoin
   const MatrixType & matrix = this->GetMatrix();
   for ( unsigned int k = 0; k < SpaceDimension; k++ )
     {
-    this->m_Jacobian(k, blockOffset + k) = 1.0;
+    jacobian(k, blockOffset + k) = 1.0;
     for ( unsigned int dim = 0; dim < SpaceDimension; dim++ )
       {
-      this->m_Jacobian(k, blockOffset + dim) -= matrix[k][dim];
+      jacobian(k, blockOffset + dim) -= matrix[k][dim];
       }
     }
   blockOffset += SpaceDimension;
@@ -162,12 +162,33 @@ CenteredAffineTransform< TScalarType, NDimensions >::GetJacobian(const InputPoin
   // Block associated with the translations
   for ( unsigned int dim = 0; dim < SpaceDimension; dim++ )
     {
-    this->m_Jacobian(dim, blockOffset + dim) = 1.0;
+    jacobian(dim, blockOffset + dim) = 1.0;
     }
+}
 
+// Compute the Jacobian in one position
+template< class TScalarType, unsigned int NDimensions >
+const typename CenteredAffineTransform< TScalarType, NDimensions >::JacobianType &
+CenteredAffineTransform< TScalarType, NDimensions >
+::GetJacobian(const InputPointType & p) const
+{
+  this->ComputeJacobianWithRespectToParameters(p, this->m_Jacobian);
   return this->m_Jacobian;
 }
 
+// Compute the Jacobian in one position, without writing into the transform
+template< class TScalarType, unsigned int NDimensions >
+void
+CenteredAffineTransform< TScalarType, NDimensions >
+::GetNonZeroJacobian(const InputPointType & p,
+                     JacobianType & jacobian,
+                     NonZeroJacobianIndicesType & nonZeroJacobianIndices) const
+{
+  jacobian.SetSize( this->m_Jacobian.rows(), this->m_Jacobian.cols() );
+  this->ComputeJacobianWithRespectToParameters(p, jacobian);
+  this->GetAllNonZeroJacobianIndices(nonZeroJacobianIndices);
+}
+
 // Get an inverse of this transform
 template< class TScalarType, unsigned int NDimensions >
 bool
@@ -29,6 +29,7 @@ namespace itk
 {
 // after use by filter
 bool DataObject:: m_GlobalReleaseDataFlag = false;
+bool DataObject:: m_GlobalReleaseDataWhenConsumedFlag = false;
 
 DataObjectError
 ::DataObjectError():
@@ -134,6 +135,7 @@ DataObject::DataObject():m_UpdateMTime()
   m_Source = 0;
   m_SourceOutputIndex = 0;
   m_ReleaseDataFlag = false;
+  m_ReleaseDataWhenConsumedFlag = false;
 
   // We have to assume that if a user is creating the data on their own,
   // then they will fill it with valid data.
@@ -194,6 +196,94 @@ DataObject
   return ( m_GlobalReleaseDataFlag || m_ReleaseDataFlag );
 }
 
+//----------------------------------------------------------------------------
+void
+DataObject
+::SetGlobalReleaseDataWhenConsumedFlag(bool val)
+{
+  m_GlobalReleaseDataWhenConsumedFlag = val;
+}
+
+//----------------------------------------------------------------------------
+bool
+DataObject
+::GetGlobalReleaseDataWhenConsumedFlag()
+{
+  return m_GlobalReleaseDataWhenConsumedFlag;
+}
+
+//----------------------------------------------------------------------------
+bool
+DataObject
+::ShouldIReleaseDataWhenConsumed() const
+{
+  return ( m_GlobalReleaseDataWhenConsumedFlag || m_ReleaseDataWhenConsumedFlag );
+}
+
+//----------------------------------------------------------------------------
+void
+DataObject
+::ConnectConsumer(const ProcessObject *consumer)
+{
+  ConsumerMapType::iterator it = m_Consumers.find(consumer);
+
+  if ( it == m_Consumers.end() )
+    {
+    ConsumerType newConsumer;
+    newConsumer.NumberOfConnections = 1;
+    // A new consumer has not used the current data yet
+    newConsumer.Consumed = false;
+    m_Consumers[consumer] = newConsumer;
+    }
+  else
+    {
+    it->second.NumberOfConnections++;
+    }
+}
+
+//----------------------------------------------------------------------------
+void
+DataObject
+::DisconnectConsumer(const ProcessObject *consumer)
+{
+  ConsumerMapType::iterator it = m_Consumers.find(consumer);
+
+  if ( it != m_Consumers.end() && --( it->second.NumberOfConnections ) == 0 )
+    {
+    m_Consumers.erase(it);
+    }
+}
+
+//----------------------------------------------------------------------------
+void
+DataObject
+::DataHasBeenConsumed(const ProcessObject *consumer)
+{
+  ConsumerMapType::iterator it = m_Consumers.find(consumer);
+
+  if ( it == m_Consumers.end() )
+    {
+    return;
+    }
+  it->second.Consumed = true;
+
+  // Data without a source cannot be regenerated, so it is never released
+  if ( !this->ShouldIReleaseDataWhenConsumed() || m_DataReleased || !m_Source )
+    {
+    return;
+    }
+  for ( it = m_Consumers.begin(); it != m_Consumers.end(); ++it )
+    {
+    if ( !it->second.Consumed )
+      {
+      return;
+      }
+    }
+
+  itkDebugMacro("releasing data after its last consumer " << consumer);
+  this->ReleaseData();
+}
+
 //----------------------------------------------------------------------------
 // Set the process object that generates this data object.
 //
@@ -213,6 +303,7 @@ DataObject
   // we have disconnected from the pipeline so the new output of the
   // source can copy our original ReleaseDataFlag)
   this->ReleaseDataFlagOff();
+  this->ReleaseDataWhenConsumedFlagOff();
 
   // reset our PipelineMTime (there is now nothing upstream from us)
   m_PipelineMTime = 0;
@@ -310,6 +401,14 @@ DataObject
   os << indent << "Global Release Data: "
      << ( m_GlobalReleaseDataFlag ? "On\n" : "Off\n" );
 
+  os << indent << "Release Data When Consumed: "
+     << ( m_ReleaseDataWhenConsumedFlag ? "On\n" : "Off\n" );
+
+  os << indent << "Global Release Data When Consumed: "
+     << ( m_GlobalReleaseDataWhenConsumedFlag ? "On\n" : "Off\n" );
+
+  os << indent << "Number Of Consumers: " << m_Consumers.size() << std::endl;
+
   os << indent << "PipelineMTime: " << m_PipelineMTime << std::endl;
   os << indent << "UpdateMTime: " << m_UpdateMTime << std::endl;
 }
@@ -412,6 +511,13 @@ DataObject
   m_DataReleased = 0;
   this->Modified();
   m_UpdateMTime.Modified();
+
+  // None of the consumers has used the new data yet
+  for ( ConsumerMapType::iterator it = m_Consumers.begin();
+        it != m_Consumers.end(); ++it )
+    {
+    it->second.Consumed = false;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -25,6 +25,8 @@
 #include "itkWeakPointer.h"
 #include "itkExceptionObject.h"
 
+#include <map>
+
 namespace itk
 {
 class ProcessObject;
@@ -333,6 +335,47 @@ public:
   bool GetDataReleased() const
   { return m_DataReleased; }
 
+  /** Turn on/off a flag to control whether this object's data is released
+   * as soon as every process object using it as an input has executed
+   * since the data was generated. Unlike the ReleaseDataFlag, the data
+   * survives until its last consumer is done, so that a data object
+   * feeding several filters is not regenerated for each of them. Only
+   * data produced by a source is released, since it can be regenerated;
+   * released data is recomputed on the next update that needs it. In a
+   * linear pipeline this keeps about two images alive at a time instead
+   * of one per filter.
+   *
+   * \warning Data read outside of the pipeline after the update (by
+   * the application, or by objects that are not process objects) must
+   * not be released this way. */
+  void SetReleaseDataWhenConsumedFlag(bool flag)
+  {
+    m_ReleaseDataWhenConsumedFlag = flag;
+  }
+
+  itkGetConstReferenceMacro(ReleaseDataWhenConsumedFlag, bool);
+  itkBooleanMacro(ReleaseDataWhenConsumedFlag);
+
+  /** Turn on/off a flag to control whether every object releases its data
+   * once all of its consumers have executed. Being a global flag, it
+   * controls the behavior of all DataObjects and ProcessObjects. */
+  static void SetGlobalReleaseDataWhenConsumedFlag(bool val);
+
+  static bool GetGlobalReleaseDataWhenConsumedFlag();
+
+  static void GlobalReleaseDataWhenConsumedFlagOn()
+  { Self::SetGlobalReleaseDataWhenConsumedFlag(true); }
+  static void GlobalReleaseDataWhenConsumedFlagOff()
+  { Self::SetGlobalReleaseDataWhenConsumedFlag(false); }
+
+  /** Return flag indicating whether data should be released once all of
+   * its consumers have executed. */
+  bool ShouldIReleaseDataWhenConsumed() const;
+
+  /** Number of process objects using this data object as an input. */
+  unsigned int GetNumberOfConsumers() const
+  { return static_cast< unsigned int >( m_Consumers.size() ); }
+
   /** Provides opportunity for the data object to insure internal
    * consistency before access. Also causes owning source/filter (if
    * any) to update itself. The Update() method is composed of
@@ -449,6 +492,11 @@ public:
    * object is actually of the same type as the class on which the Graft()
    * method was invoked. */
   virtual void Graft(const DataObject *) {}
+
+  /** Number of bytes of bulk data (the pixels of an image, for example)
+   * held by this object. The default implementation returns 0. */
+  virtual size_t GetBufferSizeInBytes() const { return 0; }
+
 protected:
   DataObject();
   ~DataObject();
@@ -478,6 +526,22 @@ private:
   /** Static member that controls global data release after use by filter. */
   static bool m_GlobalReleaseDataFlag;
 
+  /** Static member that controls global data release after the last
+   * consumer has executed. */
+  static bool m_GlobalReleaseDataWhenConsumedFlag;
+
+  bool m_ReleaseDataWhenConsumedFlag;
+
+  /** The process objects using this data object as an input. For each
+   * one, the number of its inputs connected to this data object and
+   * whether it has executed since this data was last generated. */
+  struct ConsumerType {
+    unsigned int NumberOfConnections;
+    bool Consumed;
+  };
+  typedef std::map< const ProcessObject *, ConsumerType > ConsumerMapType;
+  ConsumerMapType m_Consumers;
+
   /** Connect the specified process object to the data object. This
    * should only be called from a process object. The second parameter
    * indicates which of the source's outputs corresponds to this data
@@ -494,6 +558,16 @@ private:
    * pipeline (see ConnectSource), then nothing is done. */
   bool DisconnectSource(ProcessObject *s, unsigned long idx) const;
 
+  /** Register/unregister a process object using this data object as an
+   * input. Called only from ProcessObject, once per input slot. */
+  void ConnectConsumer(const ProcessObject *consumer);
+  void DisconnectConsumer(const ProcessObject *consumer);
+
+  /** Inform the data object that one of its consumers has executed.
+   * Called by ProcessObject::UpdateOutputData(). Releases the data if it
+   * should be released when consumed and every consumer is done. */
+  void DataHasBeenConsumed(const ProcessObject *consumer);
+
   /** Friends of DataObject */
   friend class ProcessObject;
   friend class DataObjectError;
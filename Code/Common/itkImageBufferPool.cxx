@@ -0,0 +1,336 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageBufferPool.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "itkImageBufferPool.h"
+#include "itksys/SystemTools.hxx"
+#include <stdlib.h>
+
+namespace itk
+{
+namespace
+{
+// Stored just in front of every aligned buffer handed out by the pool.
+struct BufferHeader {
+  void *Block;       // what malloc() returned
+  size_t BucketSize; // usable bytes behind the aligned pointer
+};
+
+BufferHeader * GetHeader(void *buffer)
+{
+  return reinterpret_cast< BufferHeader * >( buffer ) - 1;
+}
+
+void * AllocateAligned(size_t bucketSize, size_t alignment)
+{
+  char *block = static_cast< char * >(
+    malloc( bucketSize + alignment + sizeof( BufferHeader ) ) );
+  if ( !block )
+    {
+    return 0;
+    }
+  size_t address = reinterpret_cast< size_t >( block + sizeof( BufferHeader ) );
+  address = ( address + alignment - 1 ) & ~( alignment - 1 );
+
+  void *buffer = reinterpret_cast< void * >( address );
+  GetHeader(buffer)->Block = block;
+  GetHeader(buffer)->BucketSize = bucketSize;
+  return buffer;
+}
+
+void FreeAligned(void *buffer)
+{
+  free( GetHeader(buffer)->Block );
+}
+}
+
+ImageBufferPool::Pointer ImageBufferPool:: m_Instance = 0;
+SimpleFastMutexLock ImageBufferPool:: m_InstanceLock;
+volatile unsigned long ImageBufferPool:: m_NumberOfBuffersInUse = 0;
+
+ImageBufferPool::Pointer
+ImageBufferPool
+::GetInstance()
+{
+  m_InstanceLock.Lock();
+  if ( m_Instance.IsNull() )
+    {
+    m_Instance = new ImageBufferPool;
+    // The smart pointer now holds the only reference.
+    m_Instance->UnRegister();
+    }
+  m_InstanceLock.Unlock();
+  return m_Instance;
+}
+
+ImageBufferPool
+::ImageBufferPool()
+{
+  m_CachedBytes = 0;
+  m_NumberOfCachedBuffers = 0;
+  m_NumberOfReusedBuffers = 0;
+  m_Enabled = false;
+  m_MaximumCachedBytes = 256 * 1024 * 1024;
+
+  itksys_stl::string env;
+  if ( itksys::SystemTools::GetEnv("ITK_USE_IMAGE_BUFFER_POOL", env) )
+    {
+    env = itksys::SystemTools::UpperCase(env);
+    m_Enabled = !( env == "0" || env == "OFF" || env == "NO" || env == "FALSE" );
+    }
+  if ( itksys::SystemTools::GetEnv("ITK_IMAGE_BUFFER_POOL_SIZE", env) )
+    {
+    const long megabytes = atol( env.c_str() );
+    if ( megabytes >= 0 )
+      {
+      m_MaximumCachedBytes = static_cast< size_t >( megabytes ) * 1024 * 1024;
+      }
+    }
+}
+
+ImageBufferPool
+::~ImageBufferPool()
+{
+  this->Clear();
+}
+
+void
+ImageBufferPool
+::SetEnabled(bool flag)
+{
+  m_Lock.Lock();
+  m_Enabled = flag;
+  m_Lock.Unlock();
+  this->Modified();
+}
+
+bool
+ImageBufferPool
+::GetEnabled() const
+{
+  m_Lock.Lock();
+  const bool enabled = m_Enabled;
+  m_Lock.Unlock();
+  return enabled;
+}
+
+void
+ImageBufferPool
+::SetMaximumCachedBytes(size_t numberOfBytes)
+{
+  m_Lock.Lock();
+  m_MaximumCachedBytes = numberOfBytes;
+  this->TrimCache(m_MaximumCachedBytes);
+  m_Lock.Unlock();
+  this->Modified();
+}
+
+size_t
+ImageBufferPool
+::GetMaximumCachedBytes() const
+{
+  m_Lock.Lock();
+  const size_t maximum = m_MaximumCachedBytes;
+  m_Lock.Unlock();
+  return maximum;
+}
+
+size_t
+ImageBufferPool
+::ComputeBucketSize(size_t numberOfBytes)
+{
+  // Buckets are spaced by one eighth of the largest power of two not
+  // above the request, and never by less than the alignment.
+  size_t powerOfTwo = 1;
+  while ( powerOfTwo <= numberOfBytes / 2 )
+    {
+    powerOfTwo *= 2;
+    }
+  size_t step = powerOfTwo / 8;
+  if ( step < Alignment )
+    {
+    step = Alignment;
+    }
+  return ( ( numberOfBytes + step - 1 ) / step ) * step;
+}
+
+void *
+ImageBufferPool
+::Allocate(size_t numberOfBytes)
+{
+  const size_t bucketSize = ComputeBucketSize(numberOfBytes > 0 ? numberOfBytes : 1);
+  void *       buffer = 0;
+
+  m_Lock.Lock();
+  BucketMapType::iterator bucket = m_CachedBuffers.find(bucketSize);
+  if ( bucket != m_CachedBuffers.end() && !bucket->second.empty() )
+    {
+    buffer = bucket->second.back();
+    bucket->second.pop_back();
+    m_CachedBytes -= bucketSize;
+    --m_NumberOfCachedBuffers;
+    ++m_NumberOfReusedBuffers;
+    }
+  m_Lock.Unlock();
+
+  if ( !buffer )
+    {
+    buffer = AllocateAligned(bucketSize, Alignment);
+    if ( !buffer )
+      {
+      // Give the cached memory back to the system and try again.
+      this->Clear();
+      buffer = AllocateAligned(bucketSize, Alignment);
+      }
+    if ( !buffer )
+      {
+      // We cannot construct an error string here because we may be out
+      // of memory.  Do not use the exception macro.
+      throw MemoryAllocationError(__FILE__, __LINE__,
+                                  "Failed to allocate memory for image.",
+                                  ITK_LOCATION);
+      }
+    }
+
+  m_Lock.Lock();
+  m_BuffersInUse.insert(buffer);
+  m_NumberOfBuffersInUse = m_BuffersInUse.size();
+  m_Lock.Unlock();
+
+  return buffer;
+}
+
+void
+ImageBufferPool
+::Release(void *buffer)
+{
+  if ( !buffer )
+    {
+    return;
+    }
+
+  const size_t bucketSize = GetHeader(buffer)->BucketSize;
+
+  m_Lock.Lock();
+  if ( m_BuffersInUse.erase(buffer) == 0 )
+    {
+    m_Lock.Unlock();
+    itkExceptionMacro(<< "Buffer " << buffer << " was not allocated by the pool");
+    }
+  m_NumberOfBuffersInUse = m_BuffersInUse.size();
+  if ( m_CachedBytes + bucketSize <= m_MaximumCachedBytes )
+    {
+    m_CachedBuffers[bucketSize].push_back(buffer);
+    m_CachedBytes += bucketSize;
+    ++m_NumberOfCachedBuffers;
+    buffer = 0;
+    }
+  m_Lock.Unlock();
+
+  if ( buffer )
+    {
+    FreeAligned(buffer);
+    }
+}
+
+bool
+ImageBufferPool
+::IsPoolBuffer(const void *buffer) const
+{
+  m_Lock.Lock();
+  const bool found =
+    m_BuffersInUse.find( const_cast< void * >( buffer ) ) != m_BuffersInUse.end();
+  m_Lock.Unlock();
+  return found;
+}
+
+void
+ImageBufferPool
+::Clear()
+{
+  m_Lock.Lock();
+  this->TrimCache(0);
+  m_Lock.Unlock();
+}
+
+void
+ImageBufferPool
+::TrimCache(size_t maximum)
+{
+  BucketMapType::iterator bucket = m_CachedBuffers.begin();
+  while ( m_CachedBytes > maximum && bucket != m_CachedBuffers.end() )
+    {
+    while ( m_CachedBytes > maximum && !bucket->second.empty() )
+      {
+      FreeAligned( bucket->second.back() );
+      bucket->second.pop_back();
+      m_CachedBytes -= bucket->first;
+      --m_NumberOfCachedBuffers;
+      }
+    if ( bucket->second.empty() )
+      {
+      m_CachedBuffers.erase(bucket++);
+      }
+    else
+      {
+      ++bucket;
+      }
+    }
+}
+
+size_t
+ImageBufferPool
+::GetCachedBytes() const
+{
+  m_Lock.Lock();
+  const size_t cached = m_CachedBytes;
+  m_Lock.Unlock();
+  return cached;
+}
+
+unsigned long
+ImageBufferPool
+::GetNumberOfCachedBuffers() const
+{
+  m_Lock.Lock();
+  const unsigned long cached = m_NumberOfCachedBuffers;
+  m_Lock.Unlock();
+  return cached;
+}
+
+unsigned long
+ImageBufferPool
+::GetNumberOfReusedBuffers() const
+{
+  m_Lock.Lock();
+  const unsigned long reused = m_NumberOfReusedBuffers;
+  m_Lock.Unlock();
+  return reused;
+}
+
+void
+ImageBufferPool
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Enabled: " << ( this->GetEnabled() ? "On" : "Off" ) << std::endl;
+  os << indent << "Alignment: " << static_cast< unsigned int >( Alignment ) << std::endl;
+  os << indent << "Maximum Cached Bytes: " << this->GetMaximumCachedBytes() << std::endl;
+  os << indent << "Cached Bytes: " << this->GetCachedBytes() << std::endl;
+  os << indent << "Number Of Cached Buffers: " << this->GetNumberOfCachedBuffers() << std::endl;
+  os << indent << "Number Of Reused Buffers: " << this->GetNumberOfReusedBuffers() << std::endl;
+}
+} // end namespace itk
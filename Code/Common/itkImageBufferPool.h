@@ -0,0 +1,153 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageBufferPool.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkImageBufferPool_h
+#define __itkImageBufferPool_h
+
+#include "itkObject.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace itk
+{
+/** \class ImageBufferPool
+ * \brief Process-wide cache of aligned memory blocks for pixel buffers.
+ *
+ * When enabled, ImportImageContainer (and therefore Image and
+ * VectorImage) obtains its pixel buffers from this pool instead of the
+ * system allocator. Every buffer is aligned on an Alignment byte boundary,
+ * so that the first pixel of an image starts on a cache line and can be
+ * loaded with aligned SIMD instructions.
+ *
+ * Released buffers are not returned to the system immediately. They are
+ * kept in buckets of similar size (a bucket wastes at most one eighth of
+ * the requested size) and handed out again to the next allocation that
+ * falls in the same bucket. A pipeline that is updated repeatedly then
+ * recycles the memory of its intermediate images instead of faulting in
+ * fresh pages on every update. The memory held in the cache is bounded by
+ * MaximumCachedBytes; Clear() returns it all to the system.
+ *
+ * The pool is disabled by default. It is enabled with SetEnabled(), or by
+ * setting the ITK_USE_IMAGE_BUFFER_POOL environment variable to ON; the
+ * cache bound can be set in megabytes with ITK_IMAGE_BUFFER_POOL_SIZE.
+ *
+ * \warning A buffer obtained from the pool must be given back with
+ * Release(), never with delete[]. This matters for applications that take
+ * ownership of an image buffer with
+ * ImportImageContainer::ContainerManageMemoryOff(); IsPoolBuffer() tells
+ * which kind of buffer they hold.
+ *
+ * \ingroup OSSystemObjects
+ */
+class ITKCommon_EXPORT ImageBufferPool:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ImageBufferPool            Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ImageBufferPool, Object);
+
+  /** Return the process-wide instance, creating it on first use. */
+  static Pointer GetInstance();
+
+  /** Alignment, in bytes, of every buffer returned by Allocate(). */
+  itkStaticConstMacro(Alignment, unsigned int, 64);
+
+  /** Set/Get whether ImportImageContainer allocates from the pool.
+   * Buffers already handed out are not affected. */
+  void SetEnabled(bool flag);
+  bool GetEnabled() const;
+  itkBooleanMacro(Enabled);
+
+  /** Set/Get the largest number of bytes kept in the cache. Buffers
+   * released while the cache is full are freed at once. Lowering the
+   * bound frees cached buffers until it is met. */
+  void SetMaximumCachedBytes(size_t numberOfBytes);
+  size_t GetMaximumCachedBytes() const;
+
+  /** Return a buffer of at least numberOfBytes bytes, aligned on
+   * Alignment bytes, reusing a cached buffer when one fits. Throws a
+   * MemoryAllocationError if the memory cannot be obtained. */
+  void * Allocate(size_t numberOfBytes);
+
+  /** Give back a buffer obtained from Allocate(). */
+  void Release(void *buffer);
+
+  /** Whether buffer was obtained from Allocate() and not yet released. */
+  bool IsPoolBuffer(const void *buffer) const;
+
+  /** Whether any buffer obtained from Allocate() is not yet released.
+   * It does not lock nor create the pool, so that the owners of the
+   * buffers only call IsPoolBuffer() when some buffer may be theirs. */
+  static bool HasBuffersInUse()
+  {
+    return m_NumberOfBuffersInUse != 0;
+  }
+
+  /** Free every cached buffer. */
+  void Clear();
+
+  /** Bytes and number of buffers currently held in the cache. */
+  size_t GetCachedBytes() const;
+  unsigned long GetNumberOfCachedBuffers() const;
+
+  /** Number of allocations served from the cache since creation. */
+  unsigned long GetNumberOfReusedBuffers() const;
+
+protected:
+  ImageBufferPool();
+  ~ImageBufferPool();
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+private:
+  ImageBufferPool(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  /** Round a request up to the size of its bucket. */
+  static size_t ComputeBucketSize(size_t numberOfBytes);
+
+  /** Free the cached buffers until at most maximum bytes remain. Must be
+   * called with m_Lock held. */
+  void TrimCache(size_t maximum);
+
+  typedef std::vector< void * >             BufferListType;
+  typedef std::map< size_t, BufferListType > BucketMapType;
+
+  BucketMapType       m_CachedBuffers;
+  std::set< void * >  m_BuffersInUse;
+  size_t              m_CachedBytes;
+  size_t              m_MaximumCachedBytes;
+  unsigned long       m_NumberOfCachedBuffers;
+  unsigned long       m_NumberOfReusedBuffers;
+  bool                m_Enabled;
+  SimpleFastMutexLock m_Lock;
+
+  static Pointer             m_Instance;
+  static SimpleFastMutexLock m_InstanceLock;
+
+  /** Size of m_BuffersInUse, modified with m_Lock held. */
+  static volatile unsigned long m_NumberOfBuffersInUse;
+};
+} // end namespace itk
+
+#endif
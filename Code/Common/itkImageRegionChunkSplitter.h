@@ -0,0 +1,119 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageRegionChunkSplitter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkImageRegionChunkSplitter_h
+#define __itkImageRegionChunkSplitter_h
+
+#include "itkImageRegionSplitter.h"
+
+namespace itk
+{
+/** \class ImageRegionChunkSplitter
+ * \brief Divide a region into slabs made of whole chunks.
+ *
+ * ImageRegionChunkSplitter divides a region along its outermost
+ * dimension, as ImageRegionSplitter does, but cuts it only at the
+ * boundaries of a grid of chunks of ChunkSize pixels whose first chunk
+ * starts at ChunkOrigin. The dimensions the region spans a single
+ * chunk of are not split. The default chunk size of one pixel splits
+ * as ImageRegionSplitter.
+ *
+ * With the chunk size of the file read (ImageIOBase::GetChunkSize()),
+ * such as the tiles or the strips of a TIFF file, each piece a
+ * StreamingImageFilter requests reads whole chunks, and no chunk is
+ * read for two pieces.
+ *
+ * \sa ImageRegionSplitter
+ *
+ * \ingroup ITKSystemObjects
+ * \ingroup DataProcessing
+ */
+template< unsigned int VImageDimension >
+class ITK_EXPORT ImageRegionChunkSplitter:public ImageRegionSplitter< VImageDimension >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ImageRegionChunkSplitter               Self;
+  typedef ImageRegionSplitter< VImageDimension > Superclass;
+  typedef SmartPointer< Self >                   Pointer;
+  typedef SmartPointer< const Self >             ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ImageRegionChunkSplitter, ImageRegionSplitter);
+
+  /** Dimension of the image available at compile time. */
+  itkStaticConstMacro(ImageDimension, unsigned int, VImageDimension);
+
+  /** Index typedef support. An index is used to access pixel values. */
+  typedef typename Superclass::IndexType      IndexType;
+  typedef typename Superclass::IndexValueType IndexValueType;
+
+  /** Size typedef support. A size is used to define region bounds. */
+  typedef typename Superclass::SizeType      SizeType;
+  typedef typename Superclass::SizeValueType SizeValueType;
+
+  /** Region typedef support.   */
+  typedef typename Superclass::RegionType RegionType;
+
+  /** Set/Get the size of the chunks. A size of 0 is taken as 1. */
+  itkSetMacro(ChunkSize, SizeType);
+  itkGetConstReferenceMacro(ChunkSize, SizeType);
+
+  /** Set/Get the index of the first pixel of the first chunk, usually
+   * the index of the largest possible region. Defaults to 0. */
+  itkSetMacro(ChunkOrigin, IndexType);
+  itkGetConstReferenceMacro(ChunkOrigin, IndexType);
+
+  /** How many pieces can the specifed region be split? This is at most
+   * the number of chunks the region spans along the dimension
+   * split. */
+  virtual unsigned int GetNumberOfSplits(const RegionType & region,
+                                         unsigned int requestedNumber);
+
+  /** Get a region definition that represents the ith piece a specified region.
+   * The "numberOfPieces" must be equal to what
+   * GetNumberOfSplits() returns. */
+  virtual RegionType GetSplit(unsigned int i, unsigned int numberOfPieces,
+                              const RegionType & region);
+
+protected:
+  ImageRegionChunkSplitter();
+  ~ImageRegionChunkSplitter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  /** Find the outermost dimension the region spans several chunks of,
+   * and the chunks it spans along it. Returns -1 if the region is in a
+   * single chunk. */
+  int GetSplitAxis(const RegionType & region, IndexValueType & firstChunk,
+                   IndexValueType & numberOfChunks) const;
+
+private:
+  ImageRegionChunkSplitter(const Self &); //purposely not implemented
+  void operator=(const Self &);           //purposely not implemented
+
+  SizeType  m_ChunkSize;
+  IndexType m_ChunkOrigin;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageRegionChunkSplitter.txx"
+#endif
+
+#endif
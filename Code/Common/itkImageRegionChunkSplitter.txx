@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageRegionChunkSplitter.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkImageRegionChunkSplitter_txx
+#define __itkImageRegionChunkSplitter_txx
+
+#include "itkImageRegionChunkSplitter.h"
+
+namespace itk
+{
+/**
+ *
+ */
+template< unsigned int VImageDimension >
+ImageRegionChunkSplitter< VImageDimension >
+::ImageRegionChunkSplitter()
+{
+  m_ChunkSize.Fill(1);
+  m_ChunkOrigin.Fill(0);
+}
+
+/**
+ *
+ */
+template< unsigned int VImageDimension >
+int
+ImageRegionChunkSplitter< VImageDimension >
+::GetSplitAxis(const RegionType & region, IndexValueType & firstChunk,
+               IndexValueType & numberOfChunks) const
+{
+  const IndexType & regionIndex = region.GetIndex();
+  const SizeType &  regionSize = region.GetSize();
+
+  for ( int axis = VImageDimension - 1; axis >= 0; --axis )
+    {
+    const IndexValueType chunk =
+      m_ChunkSize[axis] > 0 ? static_cast< IndexValueType >( m_ChunkSize[axis] ) : 1;
+    const IndexValueType start = regionIndex[axis] - m_ChunkOrigin[axis];
+    const IndexValueType end = start + static_cast< IndexValueType >( regionSize[axis] );
+
+    // chunks containing the first and the last pixels, rounded down
+    const IndexValueType first = start >= 0 ? start / chunk : -( ( chunk - 1 - start ) / chunk );
+    const IndexValueType last = end > 0 ? ( end - 1 ) / chunk : -( ( chunk - end ) / chunk );
+    if ( regionSize[axis] > 0 && last > first )
+      {
+      firstChunk = first;
+      numberOfChunks = last - first + 1;
+      return axis;
+      }
+    }
+  return -1;
+}
+
+/**
+ *
+ */
+template< unsigned int VImageDimension >
+unsigned int
+ImageRegionChunkSplitter< VImageDimension >
+::GetNumberOfSplits(const RegionType & region, unsigned int requestedNumber)
+{
+  IndexValueType firstChunk;
+  IndexValueType numberOfChunks;
+
+  // split on the outermost dimension available
+  if ( this->GetSplitAxis(region, firstChunk, numberOfChunks) < 0 )
+    { // cannot split
+    itkDebugMacro("  Cannot Split");
+    return 1;
+    }
+
+  // determine the actual number of pieces that will be generated
+  int chunksPerPiece = Math::Ceil< int >(numberOfChunks / (double)requestedNumber);
+  int maxPieceUsed = Math::Ceil< int >(numberOfChunks / (double)chunksPerPiece) - 1;
+
+  return maxPieceUsed + 1;
+}
+
+/**
+ *
+ */
+template< unsigned int VImageDimension >
+typename ImageRegionChunkSplitter< VImageDimension >::RegionType
+ImageRegionChunkSplitter< VImageDimension >
+::GetSplit(unsigned int i, unsigned int numberOfPieces,
+           const RegionType & region)
+{
+  RegionType     splitRegion = region;
+  IndexValueType firstChunk;
+  IndexValueType numberOfChunks;
+
+  // split on the outermost dimension available
+  const int splitAxis = this->GetSplitAxis(region, firstChunk, numberOfChunks);
+  if ( splitAxis < 0 )
+    { // cannot split
+    itkDebugMacro("  Cannot Split");
+    return splitRegion;
+    }
+
+  // determine the actual number of pieces that will be generated
+  int chunksPerPiece = Math::Ceil< int >(numberOfChunks / (double)numberOfPieces);
+  int maxPieceUsed = Math::Ceil< int >(numberOfChunks / (double)chunksPerPiece) - 1;
+
+  // Split the region at the chunk boundaries; the first and last pieces
+  // are clipped to the region
+  const IndexValueType chunk =
+    m_ChunkSize[splitAxis] > 0 ? static_cast< IndexValueType >( m_ChunkSize[splitAxis] ) : 1;
+  const IndexValueType regionStart = region.GetIndex(splitAxis);
+  const IndexValueType regionEnd =
+    regionStart + static_cast< IndexValueType >( region.GetSize(splitAxis) );
+  IndexValueType start =
+    m_ChunkOrigin[splitAxis] + ( firstChunk + (int)i * chunksPerPiece ) * chunk;
+  IndexValueType end = start + chunksPerPiece * chunk;
+  if ( (int)i >= maxPieceUsed || end > regionEnd )
+    {
+    // last piece needs to process the "rest" dimension being split
+    end = regionEnd;
+    }
+  if ( start < regionStart )
+    {
+    start = regionStart;
+    }
+
+  // set the split region ivars
+  IndexType splitIndex = splitRegion.GetIndex();
+  SizeType  splitSize = splitRegion.GetSize();
+  splitIndex[splitAxis] = start;
+  splitSize[splitAxis] = static_cast< SizeValueType >( end - start );
+  splitRegion.SetIndex(splitIndex);
+  splitRegion.SetSize(splitSize);
+
+  itkDebugMacro("  Split Piece: " << splitRegion);
+
+  return splitRegion;
+}
+
+/**
+ *
+ */
+template< unsigned int VImageDimension >
+void
+ImageRegionChunkSplitter< VImageDimension >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "ChunkSize: " << m_ChunkSize << std::endl;
+  os << indent << "ChunkOrigin: " << m_ChunkOrigin << std::endl;
+}
+} // end namespace itk
+
+#endif
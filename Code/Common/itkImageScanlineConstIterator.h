@@ -0,0 +1,252 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageScanlineConstIterator.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkImageScanlineConstIterator_h
+#define __itkImageScanlineConstIterator_h
+
+#include "itkImageConstIterator.h"
+#include "itkImageIterator.h"
+
+namespace itk
+{
+/** \class ImageScanlineConstIterator
+ * \brief A multi-dimensional iterator templated over image type that walks a
+ * region of pixels one scanline at a time.
+ *
+ * ImageScanlineConstIterator visits the same pixels, in the same order, as
+ * ImageRegionConstIterator, but leaves the wrapping from one line of the
+ * region to the next to the caller. operator++ only moves to the next pixel
+ * of the current line, without checking for the end of the line, and
+ * NextLine() moves to the first pixel of the next line. The inner loop over
+ * a line is then as cheap as a loop over an array:
+ *
+ * \code
+ *
+ *      it.GoToBegin();
+ *      while ( !it.IsAtEnd() )
+ *        {
+ *        while ( !it.IsAtEndOfLine() )
+ *          {
+ *          value = it.Get();
+ *          ++it;
+ *          }
+ *        it.NextLine();
+ *        }
+ *
+ * \endcode
+ *
+ * A line is the set of pixels of the region whose indices differ only
+ * along the first axis, so its pixels are contiguous in the image buffer.
+ * GetScanlineBegin() and GetScanlineEnd() return pointers to the first pixel
+ * of the current line and one past its last pixel, for code that processes
+ * whole lines at once. These pointers address the pixels of the image only
+ * when the image stores its pixels directly in its buffer (see
+ * PixelBufferTraits); they must not be used with VectorImage or with image
+ * adaptors, whose pixels are reached with Get().
+ *
+ * The iterator must not be incremented past the end of a line; calling
+ * operator++ when IsAtEndOfLine() is true leaves it in an undefined state.
+ *
+ * ImageScanlineConstIterator provides read-only access to image data. It is
+ * the base class for the read/write access ImageScanlineIterator.
+ *
+ * \par MORE INFORMATION
+ * For a complete description of the ITK Image Iterators and their API, please
+ * see the Iterators chapter in the ITK Software Guide.  The ITK Software Guide
+ * is available in print and as a free .pdf download from http://www.itk.org.
+ *
+ * \ingroup ImageIterators
+ *
+ * \sa ImageRegionConstIterator \sa ImageScanlineIterator
+ * \sa ImageLinearConstIteratorWithIndex \sa ImageConstIterator */
+template< typename TImage >
+class ITK_EXPORT ImageScanlineConstIterator:public ImageConstIterator< TImage >
+{
+public:
+  /** Standard class typedef. */
+  typedef ImageScanlineConstIterator   Self;
+  typedef ImageConstIterator< TImage > Superclass;
+
+  /** Dimension of the image the iterator walks.  This constant is needed so
+   * functions that are templated over image iterator type (as opposed to
+   * being templated over pixel type and dimension) can have compile time
+   * access to the dimension of the image that the iterator walks. */
+  itkStaticConstMacro(ImageIteratorDimension, unsigned int,
+                      Superclass::ImageIteratorDimension);
+
+  /** Types inherited from the Superclass */
+  typedef typename Superclass::IndexType             IndexType;
+  typedef typename Superclass::IndexValueType        IndexValueType;
+  typedef typename Superclass::SizeType              SizeType;
+  typedef typename Superclass::SizeValueType         SizeValueType;
+  typedef typename Superclass::OffsetType            OffsetType;
+  typedef typename Superclass::OffsetValueType       OffsetValueType;
+  typedef typename Superclass::RegionType            RegionType;
+  typedef typename Superclass::ImageType             ImageType;
+  typedef typename Superclass::PixelContainer        PixelContainer;
+  typedef typename Superclass::PixelContainerPointer PixelContainerPointer;
+  typedef typename Superclass::InternalPixelType     InternalPixelType;
+  typedef typename Superclass::PixelType             PixelType;
+  typedef typename Superclass::AccessorType          AccessorType;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ImageScanlineConstIterator, ImageConstIterator);
+
+  /** Default constructor. Needed since we provide a cast constructor. */
+  ImageScanlineConstIterator():ImageConstIterator< TImage >()
+  {
+    m_SpanBeginOffset = 0;
+    m_SpanEndOffset = 0;
+  }
+
+  /** Constructor establishes an iterator to walk a particular image and a
+   * particular region of that image. */
+  ImageScanlineConstIterator(const ImageType *ptr,
+                             const RegionType & region):
+    ImageConstIterator< TImage >(ptr, region)
+  {
+    this->GoToBegin();
+  }
+
+  /** Constructor that can be used to cast from an ImageIterator to an
+   * ImageScanlineConstIterator. */
+  ImageScanlineConstIterator(const ImageIterator< TImage > & it)
+  {
+    this->ImageConstIterator< TImage >::operator=(it);
+    this->SetIndex( it.GetIndex() );
+  }
+
+  /** Constructor that can be used to cast from an ImageConstIterator to an
+   * ImageScanlineConstIterator. */
+  ImageScanlineConstIterator(const ImageConstIterator< TImage > & it)
+  {
+    this->ImageConstIterator< TImage >::operator=(it);
+    this->SetIndex( it.GetIndex() );
+  }
+
+  /** Move an iterator to the beginning of the region. "Begin" is
+   * defined as the first pixel in the region. */
+  void GoToBegin()
+  {
+    Superclass::GoToBegin();
+
+    // reset the span offsets
+    m_SpanBeginOffset = this->m_BeginOffset;
+    if ( this->m_BeginOffset == this->m_EndOffset )
+      {
+      m_SpanEndOffset = this->m_BeginOffset;
+      }
+    else
+      {
+      m_SpanEndOffset = this->m_BeginOffset + static_cast< long >( this->m_Region.GetSize()[0] );
+      }
+  }
+
+  /** Move an iterator to the end of the region. "End" is defined as
+   * one pixel past the last pixel of the region. */
+  void GoToEnd()
+  {
+    Superclass::GoToEnd();
+
+    // reset the span offsets
+    m_SpanEndOffset = this->m_EndOffset;
+    m_SpanBeginOffset = this->m_EndOffset;
+  }
+
+  /** Set the index. No bounds checking is performed. This is overridden
+   * from the parent because we have extra ivars.
+   * \sa GetIndex */
+  void SetIndex(const IndexType & ind)
+  {
+    Superclass::SetIndex(ind);
+    m_SpanEndOffset = this->m_Offset + static_cast< long >( this->m_Region.GetSize()[0] )
+                      - ( ind[0] - this->m_Region.GetIndex()[0] );
+    m_SpanBeginOffset = m_SpanEndOffset - static_cast< long >( this->m_Region.GetSize()[0] );
+  }
+
+  /** Move the iterator to the first pixel of the current line. */
+  void GoToBeginOfLine()
+  {
+    this->m_Offset = m_SpanBeginOffset;
+  }
+
+  /** Move the iterator one pixel past the last pixel of the current
+   * line. */
+  void GoToEndOfLine()
+  {
+    this->m_Offset = m_SpanEndOffset;
+  }
+
+  /** Is the iterator one pixel past the last pixel of the current line? */
+  bool IsAtEndOfLine() const
+  {
+    return this->m_Offset >= m_SpanEndOffset;
+  }
+
+  /** Move the iterator to the first pixel of the next line of the
+   * region, or to the end of the region if the current line is the last
+   * one. */
+  void NextLine();
+
+  /** Number of pixels in a line of the region. */
+  SizeValueType GetScanlineLength() const
+  {
+    return this->m_Region.GetSize()[0];
+  }
+
+  /** Pointer to the first pixel of the current line, and one past its
+   * last pixel. Only meaningful for images that store their pixels
+   * directly in their buffer. */
+  const InternalPixelType * GetScanlineBegin() const
+  {
+    return this->m_Buffer + m_SpanBeginOffset;
+  }
+
+  const InternalPixelType * GetScanlineEnd() const
+  {
+    return this->m_Buffer + m_SpanEndOffset;
+  }
+
+  /** Increment (prefix) the iterator along the current line. No check is
+   * made for the end of the line; use NextLine() to move to the next
+   * line.
+   * \sa IsAtEndOfLine() */
+  Self &
+  operator++()
+  {
+    ++this->m_Offset;
+    return *this;
+  }
+
+  /** Decrement (prefix) the iterator along the current line. No check is
+   * made for the beginning of the line. */
+  Self & operator--()
+  {
+    --this->m_Offset;
+    return *this;
+  }
+
+protected:
+  unsigned long m_SpanBeginOffset; // offset to the first pixel of the span (row)
+  unsigned long m_SpanEndOffset;   // one pixel past the end of the span (row)
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageScanlineConstIterator.txx"
+#endif
+
+#endif
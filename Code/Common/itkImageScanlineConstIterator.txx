@@ -0,0 +1,69 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageScanlineConstIterator.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkImageScanlineConstIterator_txx
+#define __itkImageScanlineConstIterator_txx
+
+#include "itkImageScanlineConstIterator.h"
+
+namespace itk
+{
+//----------------------------------------------------------------------------
+// Move to the first pixel of the next line of the region.
+template< class TImage >
+void
+ImageScanlineConstIterator< TImage >
+::NextLine()
+{
+  if ( m_SpanBeginOffset == this->m_EndOffset )
+    {
+    // already at the end of the region
+    this->m_Offset = this->m_EndOffset;
+    return;
+    }
+
+  // Index of the first pixel of the current line
+  IndexType ind =
+    this->m_Image->ComputeIndex( static_cast< OffsetValueType >( m_SpanBeginOffset ) );
+
+  const IndexType & startIndex = this->m_Region.GetIndex();
+  const SizeType &  size = this->m_Region.GetSize();
+
+  // Advance along the slower dimensions, wrapping at the region bounds
+  bool done = true;
+  for ( unsigned int dim = 1; dim < ImageIteratorDimension; ++dim )
+    {
+    if ( ++ind[dim] < startIndex[dim] + static_cast< IndexValueType >( size[dim] ) )
+      {
+      done = false;
+      break;
+      }
+    ind[dim] = startIndex[dim];
+    }
+
+  if ( done )
+    {
+    this->GoToEnd();
+    return;
+    }
+
+  this->m_Offset = this->m_Image->ComputeOffset(ind);
+  m_SpanBeginOffset = this->m_Offset;
+  m_SpanEndOffset = this->m_Offset + static_cast< long >( size[0] );
+}
+} // end namespace itk
+
+#endif
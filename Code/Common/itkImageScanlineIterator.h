@@ -0,0 +1,111 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageScanlineIterator.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkImageScanlineIterator_h
+#define __itkImageScanlineIterator_h
+
+#include "itkImageScanlineConstIterator.h"
+
+namespace itk
+{
+/** \class ImageScanlineIterator
+ * \brief A multi-dimensional iterator templated over image type that walks a
+ * region of pixels one scanline at a time.
+ *
+ * Most of the functionality is inherited from the ImageScanlineConstIterator.
+ * The current class only adds write access to image pixels.
+ *
+ * \par MORE INFORMATION
+ * For a complete description of the ITK Image Iterators and their API, please
+ * see the Iterators chapter in the ITK Software Guide.  The ITK Software Guide
+ * is available in print and as a free .pdf download from http://www.itk.org.
+ *
+ * \ingroup ImageIterators
+ *
+ * \sa ImageScanlineConstIterator \sa ImageRegionIterator */
+template< typename TImage >
+class ITK_EXPORT ImageScanlineIterator:public ImageScanlineConstIterator< TImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ImageScanlineIterator                Self;
+  typedef ImageScanlineConstIterator< TImage > Superclass;
+
+  /** Types inherited from the Superclass */
+  typedef typename Superclass::IndexType             IndexType;
+  typedef typename Superclass::IndexValueType        IndexValueType;
+  typedef typename Superclass::SizeType              SizeType;
+  typedef typename Superclass::SizeValueType         SizeValueType;
+  typedef typename Superclass::OffsetType            OffsetType;
+  typedef typename Superclass::OffsetValueType       OffsetValueType;
+  typedef typename Superclass::RegionType            RegionType;
+  typedef typename Superclass::ImageType             ImageType;
+  typedef typename Superclass::PixelContainer        PixelContainer;
+  typedef typename Superclass::PixelContainerPointer PixelContainerPointer;
+  typedef typename Superclass::InternalPixelType     InternalPixelType;
+  typedef typename Superclass::PixelType             PixelType;
+  typedef typename Superclass::AccessorType          AccessorType;
+
+  /** Default constructor. Needed since we provide a cast constructor. */
+  ImageScanlineIterator();
+
+  /** Constructor establishes an iterator to walk a particular image and a
+   * particular region of that image. */
+  ImageScanlineIterator(ImageType *ptr, const RegionType & region);
+
+  /** Constructor that can be used to cast from an ImageIterator to an
+   * ImageScanlineIterator. */
+  ImageScanlineIterator(const ImageIterator< TImage > & it);
+
+  /** Set the pixel value */
+  void Set(const PixelType & value) const
+  {
+    this->m_PixelAccessorFunctor.Set(*( const_cast< InternalPixelType * >(
+                                          this->m_Buffer + this->m_Offset ) ), value);
+  }
+
+  /** Return a reference to the pixel
+   * This method will provide the fastest access to pixel
+   * data, but it will NOT support ImageAdaptors. */
+  PixelType & Value(void)
+  { return *( const_cast< InternalPixelType * >( this->m_Buffer + this->m_Offset ) ); }
+
+  /** Pointer to the first pixel of the current line, and one past its
+   * last pixel. Only meaningful for images that store their pixels
+   * directly in their buffer. */
+  InternalPixelType * GetScanlineBegin() const
+  {
+    return const_cast< InternalPixelType * >( this->Superclass::GetScanlineBegin() );
+  }
+
+  InternalPixelType * GetScanlineEnd() const
+  {
+    return const_cast< InternalPixelType * >( this->Superclass::GetScanlineEnd() );
+  }
+
+protected:
+  /** the construction from a const iterator is declared protected
+      in order to enforce const correctness. */
+  ImageScanlineIterator(const ImageScanlineConstIterator< TImage > & it);
+  Self & operator=(const ImageScanlineConstIterator< TImage > & it);
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageScanlineIterator.txx"
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageScanlineIterator.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkImageScanlineIterator_txx
+#define __itkImageScanlineIterator_txx
+
+#include "itkImageScanlineIterator.h"
+
+namespace itk
+{
+template< typename TImage >
+ImageScanlineIterator< TImage >
+::ImageScanlineIterator():
+  ImageScanlineConstIterator< TImage >()
+{}
+
+template< typename TImage >
+ImageScanlineIterator< TImage >
+::ImageScanlineIterator(ImageType *ptr, const RegionType & region):
+  ImageScanlineConstIterator< TImage >(ptr, region)
+{}
+
+template< typename TImage >
+ImageScanlineIterator< TImage >
+::ImageScanlineIterator(const ImageIterator< TImage > & it):
+  ImageScanlineConstIterator< TImage >(it)
+{}
+
+template< typename TImage >
+ImageScanlineIterator< TImage >
+::ImageScanlineIterator(const ImageScanlineConstIterator< TImage > & it):
+  ImageScanlineConstIterator< TImage >(it)
+{}
+
+template< typename TImage >
+ImageScanlineIterator< TImage > &
+ImageScanlineIterator< TImage >
+::operator=(const ImageScanlineConstIterator< TImage > & it)
+{
+  this->ImageScanlineConstIterator< TImage >::operator=(it);
+  return *this;
+}
+} // end namespace itk
+
+#endif
@@ -22,6 +22,7 @@
 
 #include "itkProcessObject.h"
 #include "itkImage.h"
+#include "itkSimpleFastMutexLock.h"
 
 namespace itk
 {
@@ -184,9 +185,38 @@ public:
    * an implementation of MakeOutput(). */
   virtual DataObjectPointer MakeOutput(unsigned int idx);
 
+  /** Set/Get whether the default GenerateData() balances the work of
+   * ThreadedGenerateData() dynamically. When off (the default), the output
+   * requested region is split into one piece per thread. When on, it is
+   * split into NumberOfPiecesPerThread pieces per thread which the threads
+   * pull from a shared queue until none is left, so that a thread that
+   * finishes a cheap piece early keeps working instead of idling at the
+   * join.
+   *
+   * ThreadedGenerateData() may then be called several times with the same
+   * threadId, once per piece. This is only valid for filters whose
+   * ThreadedGenerateData() writes nothing but its output region, or
+   * accumulates (rather than overwrites) its per-thread results, which is
+   * why the mode must be requested explicitly for each filter.
+   *
+   * A ProgressReporter created in ThreadedGenerateData() would only cover
+   * one piece, so the reporters do not update the progress in this mode
+   * (see ProcessObject::SetThreadProgressReporting()): it is reported
+   * from the number of pieces completed instead. */
+  itkSetMacro(DynamicMultiThreading, bool);
+  itkGetConstMacro(DynamicMultiThreading, bool);
+  itkBooleanMacro(DynamicMultiThreading);
+
+  /** Set/Get the number of pieces per thread the requested region is
+   * split into when DynamicMultiThreading is on. Larger values balance
+   * better at the cost of more calls to ThreadedGenerateData(). */
+  itkSetClampMacro(NumberOfPiecesPerThread, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfPiecesPerThread, unsigned int);
+
 protected:
   ImageSource();
   virtual ~ImageSource() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
 
   /** A version of GenerateData() specific for image processing
    * filters.  This implementation will split the processing across
@@ -275,14 +305,24 @@ protected:
    * control to ThreadedGenerateData(). */
   static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
 
-  /** Internal structure used for passing image data into the threading library
-    */
+  /** Internal structure used for passing image data into the threading library.
+   * NumberOfPieces is zero unless the pieces are handed out dynamically, in
+   * which case the threads take the next piece from NextPiece under
+   * PieceLock. */
   struct ThreadStruct {
     Pointer Filter;
+    int NumberOfPieces;
+    int NextPiece;
+    int NumberOfCompletedPieces;
+    SimpleFastMutexLock *PieceLock;
+    ThreadStruct():NumberOfPieces(0), NextPiece(0), NumberOfCompletedPieces(0), PieceLock(0) {}
   };
 private:
   ImageSource(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
+
+  bool         m_DynamicMultiThreading;
+  unsigned int m_NumberOfPiecesPerThread;
 };
 } // end namespace itk
 
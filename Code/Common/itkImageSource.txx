@@ -43,6 +43,9 @@ ImageSource< TOutputImage >
   // output bulk data prior to GenerateData() in case that bulk data
   // can be reused (an thus avoid a costly deallocate/allocate cycle).
   this->ReleaseDataBeforeUpdateFlagOff();
+
+  m_DynamicMultiThreading = false;
+  m_NumberOfPiecesPerThread = 8;
 }
 
 /**
@@ -239,14 +242,56 @@ ImageSource< TOutputImage >
   this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
   this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
 
+  // In dynamic mode split the requested region into many pieces up front;
+  // the threads then pull pieces until all have been handed out.
+  SimpleFastMutexLock pieceLock;
+  const int           numberOfThreads = this->GetMultiThreader()->GetNumberOfThreads();
+  const bool          threadProgressReporting = this->GetThreadProgressReporting();
+  if ( m_DynamicMultiThreading && numberOfThreads > 1 )
+    {
+    OutputImageRegionType splitRegion;
+    str.NumberOfPieces = this->SplitRequestedRegion(0,
+                                                    numberOfThreads * m_NumberOfPiecesPerThread,
+                                                    splitRegion);
+    str.PieceLock = &pieceLock;
+    // the progress is reported per piece by ThreaderCallback()
+    this->SetThreadProgressReporting(false);
+    }
+
   // multithread the execution
-  this->GetMultiThreader()->SingleMethodExecute();
+  try
+    {
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+  catch ( ... )
+    {
+    this->SetThreadProgressReporting(threadProgressReporting);
+    throw;
+    }
+  this->SetThreadProgressReporting(threadProgressReporting);
+  if ( str.NumberOfPieces > 0 )
+    {
+    this->UpdateProgress(1.0f);
+    }
 
   // Call a method that can be overridden by a subclass to perform
   // some calculations after all the threads have completed
   this->AfterThreadedGenerateData();
 }
 
+//----------------------------------------------------------------------------
+template< class TOutputImage >
+void
+ImageSource< TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "DynamicMultiThreading: "
+     << ( m_DynamicMultiThreading ? "On" : "Off" ) << std::endl;
+  os << indent << "NumberOfPiecesPerThread: " << m_NumberOfPiecesPerThread << std::endl;
+}
+
 //----------------------------------------------------------------------------
 // The execute method created by the subclass.
 template< class TOutputImage >
@@ -284,14 +329,58 @@ ImageSource< TOutputImage >
   str = (ThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
 
   // execute the actual method with appropriate output region
-  // first find out how many pieces extent can be split into.
   typename TOutputImage::RegionType splitRegion;
+
+  PipelineProfiler *                    profiler = str->Filter->GetActiveProfiler();
+  const PipelineProfiler::TimeStampType start = profiler ? profiler->GetTimeStamp() : 0.0;
+
+  // dynamic mode: keep taking the next unprocessed piece
+  if ( str->NumberOfPieces > 0 )
+    {
+    while ( true )
+      {
+      str->PieceLock->Lock();
+      const int piece = str->NextPiece++;
+      str->PieceLock->Unlock();
+      if ( piece >= str->NumberOfPieces )
+        {
+        break;
+        }
+      str->Filter->SplitRequestedRegion(piece, str->NumberOfPieces,
+                                        splitRegion);
+      str->Filter->ThreadedGenerateData(splitRegion, threadId);
+      ( (MultiThreader::ThreadInfoStruct *)( arg ) )->WorkSize += splitRegion.GetNumberOfPixels();
+
+      str->PieceLock->Lock();
+      const int completedPieces = ++str->NumberOfCompletedPieces;
+      str->PieceLock->Unlock();
+      // only thread 0 should update the progress of the filter
+      if ( threadId == 0 )
+        {
+        str->Filter->UpdateProgress( static_cast< float >( completedPieces ) / str->NumberOfPieces );
+        }
+      }
+    if ( profiler )
+      {
+      profiler->RecordThreadedGenerateData(str->Filter, threadId,
+                                           profiler->GetTimeStamp() - start);
+      }
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  // first find out how many pieces extent can be split into.
   total = str->Filter->SplitRequestedRegion(threadId, threadCount,
                                             splitRegion);
 
   if ( threadId < total )
     {
     str->Filter->ThreadedGenerateData(splitRegion, threadId);
+    ( (MultiThreader::ThreadInfoStruct *)( arg ) )->WorkSize = splitRegion.GetNumberOfPixels();
+    if ( profiler )
+      {
+      profiler->RecordThreadedGenerateData(str->Filter, threadId,
+                                           profiler->GetTimeStamp() - start);
+      }
     }
   // else
   //   {
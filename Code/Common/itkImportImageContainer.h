@@ -36,6 +36,11 @@ namespace itk
  * TElement =
  *    The element type stored in the container.
  *
+ * The memory allocated by the container comes from the system allocator
+ * through new[], or from the ImageBufferPool when that pool is enabled.
+ * In the latter case the buffer is aligned and is recycled for later
+ * allocations when the container releases it.
+ *
  * \ingroup ImageObjects
  * \ingroup IOFilters
  */
@@ -125,7 +130,10 @@ public:
    *  (or ON) makes that this class will take care of memory release.
    *  Setting it to false (or OFF) will prevent the destructor from
    *  deleting the memory buffer. This is desirable only when the data
-   *  is intended to be used by external applications.
+   *  is intended to be used by external applications. A buffer taken over
+   *  this way must be freed with delete[], or with
+   *  ImageBufferPool::Release() if ImageBufferPool::IsPoolBuffer() says it
+   *  was allocated by the pool.
    *  Note that the normal logic of this class set the value of the boolean
    *  flag. This may override your setting if you call this methods prematurely.
    *  \warning Improper use of these methods will result in memory leaks */
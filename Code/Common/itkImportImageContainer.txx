@@ -21,7 +21,9 @@
 #define __itkImportImageContainer_txx
 
 #include "itkImportImageContainer.h"
+#include "itkImageBufferPool.h"
 #include <cstring>
+#include <new>
 #include <stdlib.h>
 #include <string.h>
 
@@ -168,6 +170,41 @@ TElement *ImportImageContainer< TElementIdentifier, TElement >
   // does not do this by default.
   TElement *data;
 
+  // Aligned, recycled memory. The elements are default-initialized
+  // exactly as new TElement[size] would do, which leaves the memory of
+  // scalar pixel types untouched.
+  ImageBufferPool::Pointer pool = ImageBufferPool::GetInstance();
+  if ( pool->GetEnabled() )
+    {
+    // new[] would fail on a size whose byte count overflows
+    if ( static_cast< size_t >( size ) > static_cast< size_t >( -1 ) / sizeof( TElement ) )
+      {
+      throw MemoryAllocationError(__FILE__, __LINE__,
+                                  "Failed to allocate memory for image.",
+                                  ITK_LOCATION);
+      }
+    data = static_cast< TElement * >( pool->Allocate( size * sizeof( TElement ) ) );
+    ElementIdentifier i = 0;
+    try
+      {
+      for ( ; i < size; i++ )
+        {
+        new ( data + i ) TElement;
+        }
+      }
+    catch ( ... )
+      {
+      // as new[] does, destroy the elements built and free the memory
+      while ( i > 0 )
+        {
+        data[--i].~TElement();
+        }
+      pool->Release(data);
+      throw;
+      }
+    return data;
+    }
+
   try
     {
     data = new TElement[size];
@@ -194,7 +231,20 @@ void ImportImageContainer< TElementIdentifier, TElement >
   // Encapsulate all image memory deallocation here
   if ( m_ImportPointer && m_ContainerManageMemory )
     {
-    delete[] m_ImportPointer;
+    // The pool is only looked at while it has buffers handed out
+    if ( ImageBufferPool::HasBuffersInUse()
+         && ImageBufferPool::GetInstance()->IsPoolBuffer(m_ImportPointer) )
+      {
+      for ( ElementIdentifier i = 0; i < m_Capacity; i++ )
+        {
+        m_ImportPointer[i].~TElement();
+        }
+      ImageBufferPool::GetInstance()->Release(m_ImportPointer);
+      }
+    else
+      {
+      delete[] m_ImportPointer;
+      }
     }
   m_ImportPointer = 0;
   m_Capacity = 0;
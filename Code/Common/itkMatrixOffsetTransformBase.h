@@ -106,6 +106,7 @@ public:
 
   /** Jacobian Type   */
   typedef typename Superclass::JacobianType JacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
 
   /** Standard scalar type for this class */
   typedef typename Superclass::ScalarType ScalarType;
@@ -369,6 +370,11 @@ public:
    */
   virtual bool IsLinear() const { return true; }
 protected:
+  /** Compute the Jacobian of the transformation at a point into
+   * jacobian, which has the size of the Jacobian, for the subclasses whose
+   * parameters are those of the matrix and of the translation. */
+  void ComputeJacobianWithRespectToParameters(const InputPointType & p, JacobianType & jacobian) const;
+
   /** Construct an MatrixOffsetTransformBase object
    *
    * This method constructs a new MatrixOffsetTransformBase object and
@@ -415,18 +415,18 @@ MatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
   this->Modified();
 }
 
-// Compute the Jacobian in one position
+// Compute the Jacobian in one position into the given matrix
 template< class TScalarType, unsigned int NInputDimensions,
           unsigned int NOutputDimensions >
-const typename MatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >::JacobianType &
+void
 MatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
-::GetJacobian(const InputPointType & p) const
+::ComputeJacobianWithRespectToParameters(const InputPointType & p, JacobianType & jacobian) const
 {
   // The Jacobian of the affine transform is composed of
   // subblocks of diagonal matrices, each one of them having
   // a constant value in the diagonal.
 
-  this->m_Jacobian.Fill(0.0);
+  jacobian.Fill(0.0);
 
   const InputVectorType v = p - this->GetCenter();
 
@@ -436,7 +436,7 @@ MatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
     {
     for ( unsigned int dim = 0; dim < NOutputDimensions; dim++ )
       {
-      this->m_Jacobian(block, blockOffset + dim) = v[dim];
+      jacobian(block, blockOffset + dim) = v[dim];
       }
 
     blockOffset += NInputDimensions;
@@ -444,9 +444,18 @@ MatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
 
   for ( unsigned int dim = 0; dim < NOutputDimensions; dim++ )
     {
-    this->m_Jacobian(dim, blockOffset + dim) = 1.0;
+    jacobian(dim, blockOffset + dim) = 1.0;
     }
+}
 
+// Compute the Jacobian in one position
+template< class TScalarType, unsigned int NInputDimensions,
+          unsigned int NOutputDimensions >
+const typename MatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >::JacobianType &
+MatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
+::GetJacobian(const InputPointType & p) const
+{
+  this->ComputeJacobianWithRespectToParameters(p, this->m_Jacobian);
   return this->m_Jacobian;
 }
 
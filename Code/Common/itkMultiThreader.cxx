@@ -19,6 +19,8 @@
 =========================================================================*/
 
 #include "itkMultiThreader.h"
+#include "itkThreadPool.h"
+#include "itkSimpleFastMutexLock.h"
 #include "itkObjectFactory.h"
 #include "itksys/SystemTools.hxx"
 #include <stdlib.h>
@@ -53,6 +55,116 @@ int MultiThreader:: m_GlobalMaximumNumberOfThreads = ITK_MAX_THREADS;
 // => Not initialized.
 int MultiThreader:: m_GlobalDefaultNumberOfThreads = 0;
 
+// Initialize static members that control whether new instances use the
+// thread pool. The default is resolved from the environment on first use.
+bool MultiThreader:: m_GlobalDefaultUseThreadPool = true;
+bool MultiThreader:: m_GlobalDefaultUseThreadPoolIsInitialized = false;
+
+// Initialize static member that controls the global concurrency budget : -1
+// => Not initialized.
+int MultiThreader:: m_GlobalConcurrencyBudget = -1;
+
+namespace
+{
+// Number of threads currently running threaded methods in the process.
+int                 s_GlobalNumberOfActiveThreads = 0;
+SimpleFastMutexLock s_GlobalNumberOfActiveThreadsLock;
+
+// Account for the threads of one SingleMethodExecute() or
+// MultipleMethodExecute() call for as long as it is in scope, including
+// when the call exits through an exception.
+class ActiveThreadsGuard
+{
+public:
+  ActiveThreadsGuard(int numberOfThreads):m_NumberOfThreads(numberOfThreads)
+  {
+    s_GlobalNumberOfActiveThreadsLock.Lock();
+    s_GlobalNumberOfActiveThreads += m_NumberOfThreads;
+    s_GlobalNumberOfActiveThreadsLock.Unlock();
+  }
+
+  ~ActiveThreadsGuard()
+  {
+    s_GlobalNumberOfActiveThreadsLock.Lock();
+    s_GlobalNumberOfActiveThreads -= m_NumberOfThreads;
+    s_GlobalNumberOfActiveThreadsLock.Unlock();
+  }
+
+private:
+  int m_NumberOfThreads;
+};
+}
+
+void MultiThreader::SetGlobalConcurrencyBudget(int val)
+{
+  m_GlobalConcurrencyBudget = val;
+
+  if ( m_GlobalConcurrencyBudget < 0 )
+    {
+    m_GlobalConcurrencyBudget = 0;
+    }
+}
+
+int MultiThreader::GetGlobalConcurrencyBudget()
+{
+  if ( m_GlobalConcurrencyBudget < 0 )
+    {
+    m_GlobalConcurrencyBudget = GetGlobalDefaultNumberOfThreads();
+    }
+  return m_GlobalConcurrencyBudget;
+}
+
+int MultiThreader::GetGlobalNumberOfActiveThreads()
+{
+  s_GlobalNumberOfActiveThreadsLock.Lock();
+  const int active = s_GlobalNumberOfActiveThreads;
+  s_GlobalNumberOfActiveThreadsLock.Unlock();
+  return active;
+}
+
+int MultiThreader::GetNumberOfThreadsWithinConcurrencyBudget(int numberOfThreads)
+{
+  const int budget = GetGlobalConcurrencyBudget();
+  const int active = GetGlobalNumberOfActiveThreads();
+
+  // Nothing else is running, or no budget: honor the request.
+  if ( budget == 0 || active == 0 )
+    {
+    return numberOfThreads;
+    }
+
+  int available = budget - active;
+  if ( available < 1 )
+    {
+    available = 1;
+    }
+  return ( numberOfThreads < available ) ? numberOfThreads : available;
+}
+
+void MultiThreader::SetGlobalDefaultUseThreadPool(bool flag)
+{
+  m_GlobalDefaultUseThreadPool = flag;
+  m_GlobalDefaultUseThreadPoolIsInitialized = true;
+}
+
+bool MultiThreader::GetGlobalDefaultUseThreadPool()
+{
+  if ( !m_GlobalDefaultUseThreadPoolIsInitialized )
+    {
+    itksys_stl::string itkUseThreadPoolEnv;
+    if ( itksys::SystemTools::GetEnv("ITK_USE_THREADPOOL",
+                                     itkUseThreadPoolEnv) )
+      {
+      itkUseThreadPoolEnv = itksys::SystemTools::UpperCase(itkUseThreadPoolEnv);
+      m_GlobalDefaultUseThreadPool =
+        !( itkUseThreadPoolEnv == "0" || itkUseThreadPoolEnv == "OFF"
+           || itkUseThreadPoolEnv == "NO" || itkUseThreadPoolEnv == "FALSE" );
+      }
+    m_GlobalDefaultUseThreadPoolIsInitialized = true;
+    }
+  return m_GlobalDefaultUseThreadPool;
+}
+
 void MultiThreader::SetGlobalMaximumNumberOfThreads(int val)
 {
   m_GlobalMaximumNumberOfThreads = val;
@@ -209,6 +321,8 @@ MultiThreader::MultiThreader()
     m_ThreadInfoArray[i].ThreadID           = i;
     m_ThreadInfoArray[i].ActiveFlag         = 0;
     m_ThreadInfoArray[i].ActiveFlagLock     = 0;
+    m_ThreadInfoArray[i].WorkSize           = 0;
+    m_ThreadInfoArray[i].Timing             = 0;
 
     m_MultipleMethod[i]                     = 0;
     m_MultipleData[i]                       = 0;
@@ -216,11 +330,16 @@ MultiThreader::MultiThreader()
     m_SpawnedThreadActiveFlag[i]            = 0;
     m_SpawnedThreadActiveFlagLock[i]        = 0;
     m_SpawnedThreadInfoArray[i].ThreadID    = i;
+    m_SpawnedThreadInfoArray[i].WorkSize    = 0;
+    m_SpawnedThreadInfoArray[i].Timing      = 0;
     }
 
   m_SingleMethod = 0;
   m_SingleData = 0;
   m_NumberOfThreads = this->GetGlobalDefaultNumberOfThreads();
+  m_UseThreadPool = this->GetGlobalDefaultUseThreadPool();
+  m_RecordThreadTimings = false;
+  m_ThreadTimingsJoinTime = 0.0;
 }
 
 MultiThreader::~MultiThreader()
@@ -270,6 +389,33 @@ void MultiThreader::SingleMethodExecute()
     m_NumberOfThreads = m_GlobalMaximumNumberOfThreads;
     }
 
+  // When the pool is in use the workers are persistent and only the
+  // number of outstanding jobs needs to be tracked.
+  ThreadPool::Pointer        threadPool;
+  ThreadPool::JobCounterType pendingJobs;
+  if ( m_UseThreadPool && m_NumberOfThreads > 1 )
+    {
+    threadPool = ThreadPool::GetInstance();
+    }
+
+  ActiveThreadsGuard activeThreads(m_NumberOfThreads);
+
+  // The threads record absolute times, converted to times relative to
+  // the start of this call once they have all finished.
+  double executeStartTime = 0.0;
+  m_ThreadTimings.clear();
+  if ( m_RecordThreadTimings )
+    {
+    m_ThreadTimings.resize(m_NumberOfThreads);
+    executeStartTime = itksys::SystemTools::GetTime();
+    }
+  for ( thread_loop = 0; thread_loop < m_NumberOfThreads; thread_loop++ )
+    {
+    m_ThreadInfoArray[thread_loop].WorkSize = 0;
+    m_ThreadInfoArray[thread_loop].Timing =
+      m_RecordThreadTimings ? &m_ThreadTimings[thread_loop] : 0;
+    }
+
   // Spawn a set of threads through the SingleMethodProxy. Exceptions
   // thrown from a thread will be caught by the SingleMethodProxy. A
   // naive mechanism is in place for determining whether a thread
@@ -281,14 +427,31 @@ void MultiThreader::SingleMethodExecute()
   std::string exceptionDetails;
   try
     {
+    ThreadFunctionType functions[ITK_MAX_THREADS];
+    void *             data[ITK_MAX_THREADS];
     for ( thread_loop = 1; thread_loop < m_NumberOfThreads; thread_loop++ )
       {
       m_ThreadInfoArray[thread_loop].UserData    = m_SingleData;
       m_ThreadInfoArray[thread_loop].NumberOfThreads = m_NumberOfThreads;
       m_ThreadInfoArray[thread_loop].ThreadFunction = m_SingleMethod;
+      functions[thread_loop - 1] = this->SingleMethodProxy;
+      data[thread_loop - 1] = &m_ThreadInfoArray[thread_loop];
+      }
 
-      process_id[thread_loop] =
-        this->DispatchSingleMethodThread(&m_ThreadInfoArray[thread_loop]);
+    // The threads may wait for each other, so the pool is only used if
+    // it can run all of them at once.
+    if ( threadPool.IsNotNull()
+         && !threadPool->TryAssignWork(m_NumberOfThreads - 1, functions, data, &pendingJobs) )
+      {
+      threadPool = 0;
+      }
+    if ( threadPool.IsNull() )
+      {
+      for ( thread_loop = 1; thread_loop < m_NumberOfThreads; thread_loop++ )
+        {
+        process_id[thread_loop] =
+          this->DispatchSingleMethodThread(&m_ThreadInfoArray[thread_loop]);
+        }
       }
     }
   catch ( std::exception & e )
@@ -313,12 +476,26 @@ void MultiThreader::SingleMethodExecute()
     {
     m_ThreadInfoArray[0].UserData = m_SingleData;
     m_ThreadInfoArray[0].NumberOfThreads = m_NumberOfThreads;
+    if ( m_RecordThreadTimings )
+      {
+      m_ThreadTimings[0].StartTime = itksys::SystemTools::GetTime();
+      }
     m_SingleMethod( (void *)( &m_ThreadInfoArray[0] ) );
+    if ( m_RecordThreadTimings )
+      {
+      m_ThreadTimings[0].FinishTime = itksys::SystemTools::GetTime();
+      }
     }
   catch ( ProcessAborted & excp )
     {
     // Need cleanup and rethrow ProcessAborted
     // close down other threads
+    if ( threadPool.IsNotNull() )
+      {
+      threadPool->WaitForJobs(&pendingJobs);
+      m_ThreadTimings.clear();
+      throw excp;
+      }
     for ( thread_loop = 1; thread_loop < m_NumberOfThreads; thread_loop++ )
       {
       try
@@ -328,6 +505,7 @@ void MultiThreader::SingleMethodExecute()
       catch ( ... )
               {}
       }
+    m_ThreadTimings.clear();
     // rethrow
     throw excp;
     }
@@ -348,11 +526,18 @@ void MultiThreader::SingleMethodExecute()
 
   // The parent thread has finished this->SingleMethod() - so now it
   // waits for each of the other processes to exit
+  if ( threadPool.IsNotNull() )
+    {
+    threadPool->WaitForJobs(&pendingJobs);
+    }
   for ( thread_loop = 1; thread_loop < m_NumberOfThreads; thread_loop++ )
     {
     try
       {
-      this->WaitForSingleMethodThread(process_id[thread_loop]);
+      if ( threadPool.IsNull() )
+        {
+        this->WaitForSingleMethodThread(process_id[thread_loop]);
+        }
       if ( m_ThreadInfoArray[thread_loop].ThreadExitCode
            != ThreadInfoStruct::SUCCESS )
         {
@@ -371,8 +556,22 @@ void MultiThreader::SingleMethodExecute()
       }
     }
 
+  if ( m_RecordThreadTimings && !exceptionOccurred )
+    {
+    m_ThreadTimingsJoinTime = itksys::SystemTools::GetTime() - executeStartTime;
+    for ( thread_loop = 0; thread_loop < m_NumberOfThreads; thread_loop++ )
+      {
+      m_ThreadTimings[thread_loop].StartTime -= executeStartTime;
+      m_ThreadTimings[thread_loop].FinishTime -= executeStartTime;
+      m_ThreadTimings[thread_loop].WorkSize = m_ThreadInfoArray[thread_loop].WorkSize;
+      m_ThreadInfoArray[thread_loop].Timing = 0;
+      }
+    this->InvokeEvent( ThreadTimingsEvent() );
+    }
+
   if ( exceptionOccurred )
     {
+    m_ThreadTimings.clear();
     if ( exceptionDetails.empty() )
       {
       itkExceptionMacro("Exception occurred during SingleMethodExecute");
@@ -412,6 +611,52 @@ void MultiThreader::MultipleMethodExecute()
       }
     }
 
+  ActiveThreadsGuard activeThreads(m_NumberOfThreads);
+
+  // Hand the m_NumberOfThreads - 1 additional methods to the persistent
+  // workers of the thread pool, run the first one on the parent thread and
+  // wait for the others to complete.
+  if ( m_UseThreadPool && m_NumberOfThreads > 1 )
+    {
+    ThreadPool::Pointer        threadPool = ThreadPool::GetInstance();
+    ThreadPool::JobCounterType pendingJobs;
+    ThreadFunctionType         functions[ITK_MAX_THREADS];
+    void *                     data[ITK_MAX_THREADS];
+    for ( thread_loop = 1; thread_loop < m_NumberOfThreads; thread_loop++ )
+      {
+      m_ThreadInfoArray[thread_loop].UserData =
+        m_MultipleData[thread_loop];
+      m_ThreadInfoArray[thread_loop].NumberOfThreads = m_NumberOfThreads;
+      functions[thread_loop - 1] = m_MultipleMethod[thread_loop];
+      data[thread_loop - 1] = &m_ThreadInfoArray[thread_loop];
+      }
+
+    // The methods may wait for each other, so they are given threads of
+    // their own below unless the pool can run all of them at once.
+    if ( threadPool->TryAssignWork(m_NumberOfThreads - 1, functions, data, &pendingJobs) )
+      {
+      m_ThreadInfoArray[0].UserData = m_MultipleData[0];
+      m_ThreadInfoArray[0].NumberOfThreads = m_NumberOfThreads;
+      try
+        {
+        ( m_MultipleMethod[0] )( (void *)( &m_ThreadInfoArray[0] ) );
+        }
+      catch ( ... )
+        {
+        // the workers still reference m_ThreadInfoArray
+        try
+          {
+          threadPool->WaitForJobs(&pendingJobs);
+          }
+        catch ( ... )
+          {}
+        throw;
+        }
+      threadPool->WaitForJobs(&pendingJobs);
+      return;
+      }
+    }
+
   // We are using sproc (on SGIs), pthreads(on Suns), _beginthreadex
   // on a PC or a single thread (the default)
 
@@ -652,6 +897,36 @@ void MultiThreader::TerminateThread(int ThreadID)
   m_SpawnedThreadActiveFlagLock[ThreadID] = 0;
 }
 
+double MultiThreader::GetThreadIdleTime() const
+{
+  double idleTime = 0.0;
+  for ( unsigned int i = 0; i < m_ThreadTimings.size(); i++ )
+    {
+    idleTime += m_ThreadTimingsJoinTime - m_ThreadTimings[i].FinishTime;
+    }
+  return idleTime;
+}
+
+double MultiThreader::GetLoadImbalance() const
+{
+  double sum = 0.0;
+  double maximum = 0.0;
+  for ( unsigned int i = 0; i < m_ThreadTimings.size(); i++ )
+    {
+    const double duration = m_ThreadTimings[i].FinishTime - m_ThreadTimings[i].StartTime;
+    sum += duration;
+    if ( duration > maximum )
+      {
+      maximum = duration;
+      }
+    }
+  if ( sum <= 0.0 )
+    {
+    return 1.0;
+    }
+  return maximum * m_ThreadTimings.size() / sum;
+}
+
 // Print method for the multithreader
 void MultiThreader::PrintSelf(std::ostream & os, Indent indent) const
 {
@@ -662,6 +937,14 @@ void MultiThreader::PrintSelf(std::ostream & os, Indent indent) const
      << m_GlobalMaximumNumberOfThreads << std::endl;
   os << indent << "Global Default Number Of Threads: "
      << m_GlobalDefaultNumberOfThreads << std::endl;
+  os << indent << "Use Thread Pool: "
+     << ( m_UseThreadPool ? "On" : "Off" ) << std::endl;
+  os << indent << "Global Default Use Thread Pool: "
+     << ( m_GlobalDefaultUseThreadPool ? "On" : "Off" ) << std::endl;
+  os << indent << "Global Concurrency Budget: "
+     << m_GlobalConcurrencyBudget << std::endl;
+  os << indent << "Record Thread Timings: "
+     << ( m_RecordThreadTimings ? "On" : "Off" ) << std::endl;
 }
 
 ITK_THREAD_RETURN_TYPE
@@ -676,7 +959,15 @@ MultiThreader
   // execute the user specified threader callback, catching any exceptions
   try
     {
+    if ( threadInfoStruct->Timing )
+      {
+      threadInfoStruct->Timing->StartTime = itksys::SystemTools::GetTime();
+      }
     ( *threadInfoStruct->ThreadFunction )(threadInfoStruct);
+    if ( threadInfoStruct->Timing )
+      {
+      threadInfoStruct->Timing->FinishTime = itksys::SystemTools::GetTime();
+      }
     threadInfoStruct->ThreadExitCode = MultiThreader::ThreadInfoStruct::SUCCESS;
     }
   catch ( ProcessAborted & )
@@ -22,6 +22,7 @@
 
 #include "itkObject.h"
 #include "itkMutexLock.h"
+#include <vector>
 
 #ifdef ITK_USE_PTHREADS
 #include <pthread.h>
@@ -95,6 +96,11 @@ typedef int     ThreadProcessIDType;
 #define ITK_THREAD_RETURN_TYPE void
 #endif
 
+/** Invoked by a MultiThreader that records thread timings at the end of
+ * every SingleMethodExecute(). The timings are available from
+ * MultiThreader::GetThreadTimings(). */
+itkEventMacro(ThreadTimingsEvent, AnyEvent)
+
 class ITKCommon_EXPORT MultiThreader:public Object
 {
 public:
@@ -134,6 +140,88 @@ public:
 
   static int  GetGlobalDefaultNumberOfThreads();
 
+  /** Set/Get whether SingleMethodExecute() and MultipleMethodExecute()
+   * dispatch their work onto the process-wide ThreadPool instead of
+   * creating and joining new threads on every call. The threads are only
+   * created when the pool cannot run all of them at once. Defaults to the value
+   * of GetGlobalDefaultUseThreadPool() at construction time. */
+  itkSetMacro(UseThreadPool, bool);
+  itkGetConstMacro(UseThreadPool, bool);
+  itkBooleanMacro(UseThreadPool);
+
+  /** Set/Get the value used to initialize UseThreadPool in the
+   * constructor. Unless set explicitly it is read from the
+   * ITK_USE_THREADPOOL environment variable, and is on when that variable
+   * is not defined. */
+  static void SetGlobalDefaultUseThreadPool(bool flag);
+
+  static bool GetGlobalDefaultUseThreadPool();
+
+  /** Set/Get the number of threads that may run threaded methods at the
+   * same time in the whole process, summed over all MultiThreader
+   * instances. The budget is consulted by ProcessObject before a filter
+   * executes: a filter updated while other threaded methods are running
+   * (nested inside another filter's threads, or from several application
+   * threads at once) only gets the threads left in the budget, and runs
+   * inline on the calling thread when none are left. A filter updated
+   * while nothing else is running always gets the threads it asked for.
+   * Unless set explicitly the budget is GetGlobalDefaultNumberOfThreads().
+   * A value of 0 disables the budget. */
+  static void SetGlobalConcurrencyBudget(int val);
+
+  static int  GetGlobalConcurrencyBudget();
+
+  /** Number of threads currently executing a SingleMethodExecute() or
+   * MultipleMethodExecute() call, over all MultiThreader instances. */
+  static int GetGlobalNumberOfActiveThreads();
+
+  /** Return how many of the requested threads can be used without
+   * exceeding the global concurrency budget. The result is at least 1
+   * and at most numberOfThreads. */
+  static int GetNumberOfThreadsWithinConcurrencyBudget(int numberOfThreads);
+
+  /** Time, in seconds, at which a thread started and finished running the
+   * SingleMethod, relative to the start of SingleMethodExecute(), and the
+   * amount of work it reported in ThreadInfoStruct::WorkSize. */
+  struct ThreadTimingType {
+    double StartTime;
+    double FinishTime;
+    unsigned long WorkSize;
+  };
+  typedef std::vector< ThreadTimingType > ThreadTimingContainerType;
+
+  /** Set/Get whether SingleMethodExecute() records when each thread starts
+   * and finishes. The timings of the last call can be queried with
+   * GetThreadTimings(), and a ThreadTimingsEvent is invoked once they are
+   * available, to quantify how long threads wait for the slowest one at
+   * the join. Off by default. */
+  itkSetMacro(RecordThreadTimings, bool);
+  itkGetConstMacro(RecordThreadTimings, bool);
+  itkBooleanMacro(RecordThreadTimings);
+
+  /** Timings of the threads of the last SingleMethodExecute() call, indexed
+   * by thread id. Empty if RecordThreadTimings was off. */
+  const ThreadTimingContainerType & GetThreadTimings() const
+  {
+    return m_ThreadTimings;
+  }
+
+  /** Time, relative to the start of the last SingleMethodExecute() call, at
+   * which all the threads had finished. */
+  double GetThreadTimingsJoinTime() const
+  {
+    return m_ThreadTimingsJoinTime;
+  }
+
+  /** Time spent by the threads of the last SingleMethodExecute() call
+   * waiting at the join for the slowest thread, summed over the threads. */
+  double GetThreadIdleTime() const;
+
+  /** Ratio of the longest to the mean running time of the threads of the
+   * last SingleMethodExecute() call: 1 when the work was perfectly
+   * balanced, NumberOfThreads when a single thread did all of it. */
+  double GetLoadImbalance() const;
+
   /** Execute the SingleMethod (as define by SetSingleMethod) using
    * m_NumberOfThreads threads. As a side effect the m_NumberOfThreads will be
    * checked against the current m_GlobalMaximumNumberOfThreads and clamped if
@@ -176,7 +264,9 @@ public:
    * SingleMethodExecute or MultipleMethodExecute, and it is 1 for
    * threads created from SpawnThread.  The UserData is the (void
    * *)arg passed into the SetSingleMethod, SetMultipleMethod, or
-   * SpawnThread method. */
+   * SpawnThread method. The WorkSize may be set by the SingleMethod to the
+   * amount of work (e.g. number of pixels) the thread handled; it is
+   * reported in the thread timings. */
 #ifdef ThreadInfoStruct
 #undef ThreadInfoStruct
 #endif
@@ -187,6 +277,10 @@ public:
     MutexLock::Pointer ActiveFlagLock;
     void *UserData;
     ThreadFunctionType ThreadFunction;
+    unsigned long WorkSize;
+    /** Where the thread records its start and finish times; null unless
+     * RecordThreadTimings is on. */
+    ThreadTimingType *Timing;
     enum { SUCCESS, ITK_EXCEPTION, ITK_PROCESS_ABORTED_EXCEPTION, STD_EXCEPTION, UNKNOWN } ThreadExitCode;
   };
 protected:
@@ -242,6 +336,23 @@ private:
    */
   int m_NumberOfThreads;
 
+  /** Whether the threaded methods run on the ThreadPool workers. */
+  bool m_UseThreadPool;
+
+  /** Thread timings of the last SingleMethodExecute(). */
+  bool                      m_RecordThreadTimings;
+  ThreadTimingContainerType m_ThreadTimings;
+  double                    m_ThreadTimingsJoinTime;
+
+  /** Global variable defining the default value of m_UseThreadPool, and
+   *  whether it has been initialized from the environment yet. */
+  static bool m_GlobalDefaultUseThreadPool;
+  static bool m_GlobalDefaultUseThreadPoolIsInitialized;
+
+  /** Global variable defining the maximum number of concurrently active
+   *  threads. Negative until initialized, 0 when unlimited. */
+  static int m_GlobalConcurrencyBudget;
+
   /** Static function used as a "proxy callback" by the MultiThreader.  The
    * threading library will call this routine for each thread, which
    * will delegate the control to the prescribed SingleMethod. This
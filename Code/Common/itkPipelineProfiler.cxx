@@ -0,0 +1,394 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkPipelineProfiler.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "itkPipelineProfiler.h"
+#include "itkProcessObject.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace itk
+{
+namespace
+{
+// Statistics of the per-thread times of a record
+void ComputeThreadStatistics(const PipelineProfiler::FilterRecordType & record,
+                             unsigned int & numberOfThreads,
+                             PipelineProfiler::TimeStampType & mean,
+                             PipelineProfiler::TimeStampType & maximum)
+{
+  numberOfThreads = 0;
+  mean = 0.0;
+  maximum = 0.0;
+  for ( unsigned int i = 0; i < record.ThreadedGenerateDataTimes.size(); i++ )
+    {
+    const PipelineProfiler::TimeStampType t = record.ThreadedGenerateDataTimes[i];
+    if ( t > 0.0 )
+      {
+      numberOfThreads++;
+      mean += t;
+      if ( t > maximum )
+        {
+        maximum = t;
+        }
+      }
+    }
+  if ( numberOfThreads > 0 )
+    {
+    mean /= numberOfThreads;
+    }
+}
+
+std::string EscapeJSON(const std::string & text)
+{
+  std::string escaped;
+  for ( std::string::const_iterator it = text.begin(); it != text.end(); ++it )
+    {
+    if ( *it == '"' || *it == '\\' )
+      {
+      escaped += '\\';
+      }
+    escaped += *it;
+    }
+  return escaped;
+}
+
+std::string EscapeCSV(const std::string & text)
+{
+  if ( text.find_first_of(",\"\n") == std::string::npos )
+    {
+    return text;
+    }
+  std::string escaped = "\"";
+  for ( std::string::const_iterator it = text.begin(); it != text.end(); ++it )
+    {
+    if ( *it == '"' )
+      {
+      escaped += '"';
+      }
+    escaped += *it;
+    }
+  return escaped + "\"";
+}
+}
+
+PipelineProfiler
+::PipelineProfiler()
+{
+  m_Clock = RealTimeClock::New();
+}
+
+PipelineProfiler
+::~PipelineProfiler()
+{}
+
+PipelineProfiler::FilterRecordType &
+PipelineProfiler
+::GetOrCreateRecord(const ProcessObject *filter)
+{
+  RecordIndexMapType::const_iterator it = m_RecordIndices.find(filter);
+  if ( it != m_RecordIndices.end() )
+    {
+    return m_Records[it->second];
+    }
+
+  FilterRecordType record;
+  record.ClassName = filter->GetNameOfClass();
+  std::ostringstream name;
+  name << record.ClassName << " (" << static_cast< const void * >( filter ) << ")";
+  record.Name = name.str();
+  record.NumberOfExecutions = 0;
+  record.GenerateOutputInformationTime = 0.0;
+  record.PropagateRequestedRegionTime = 0.0;
+  record.GenerateDataTime = 0.0;
+  record.OutputBytes = 0;
+
+  m_RecordIndices[filter] = static_cast< unsigned int >( m_Records.size() );
+  m_Records.push_back(record);
+  return m_Records.back();
+}
+
+void
+PipelineProfiler
+::RecordGenerateOutputInformation(const ProcessObject *filter, TimeStampType seconds)
+{
+  m_Lock.Lock();
+  this->GetOrCreateRecord(filter).GenerateOutputInformationTime += seconds;
+  m_Lock.Unlock();
+}
+
+void
+PipelineProfiler
+::RecordPropagateRequestedRegion(const ProcessObject *filter, TimeStampType seconds)
+{
+  m_Lock.Lock();
+  this->GetOrCreateRecord(filter).PropagateRequestedRegionTime += seconds;
+  m_Lock.Unlock();
+}
+
+void
+PipelineProfiler
+::RecordGenerateData(const ProcessObject *filter, TimeStampType seconds,
+                     size_t outputBytes)
+{
+  m_Lock.Lock();
+  FilterRecordType & record = this->GetOrCreateRecord(filter);
+  record.NumberOfExecutions++;
+  record.GenerateDataTime += seconds;
+  record.OutputBytes = outputBytes;
+  m_Lock.Unlock();
+}
+
+void
+PipelineProfiler
+::RecordThreadedGenerateData(const ProcessObject *filter, int threadId,
+                             TimeStampType seconds)
+{
+  if ( threadId < 0 )
+    {
+    return;
+    }
+  m_Lock.Lock();
+  FilterRecordType & record = this->GetOrCreateRecord(filter);
+  if ( record.ThreadedGenerateDataTimes.size() <= static_cast< unsigned int >( threadId ) )
+    {
+    record.ThreadedGenerateDataTimes.resize(threadId + 1, 0.0);
+    }
+  record.ThreadedGenerateDataTimes[threadId] += seconds;
+  m_Lock.Unlock();
+}
+
+void
+PipelineProfiler
+::SetFilterName(const ProcessObject *filter, const std::string & name)
+{
+  m_Lock.Lock();
+  this->GetOrCreateRecord(filter).Name = name;
+  m_Lock.Unlock();
+}
+
+void
+PipelineProfiler
+::ForgetFilter(const ProcessObject *filter)
+{
+  m_Lock.Lock();
+  m_RecordIndices.erase(filter);
+  m_Lock.Unlock();
+}
+
+unsigned int
+PipelineProfiler
+::GetNumberOfRecords() const
+{
+  m_Lock.Lock();
+  const unsigned int numberOfRecords = static_cast< unsigned int >( m_Records.size() );
+  m_Lock.Unlock();
+  return numberOfRecords;
+}
+
+PipelineProfiler::FilterRecordType
+PipelineProfiler
+::GetRecord(unsigned int index) const
+{
+  m_Lock.Lock();
+  if ( index >= m_Records.size() )
+    {
+    m_Lock.Unlock();
+    itkExceptionMacro(<< "No record " << index << ", only " << m_Records.size()
+                      << " filters were profiled");
+    }
+  const FilterRecordType record = m_Records[index];
+  m_Lock.Unlock();
+  return record;
+}
+
+unsigned int
+PipelineProfiler
+::GetRecordIndex(const ProcessObject *filter) const
+{
+  m_Lock.Lock();
+  RecordIndexMapType::const_iterator it = m_RecordIndices.find(filter);
+  const unsigned int index = ( it != m_RecordIndices.end() ) ?
+                             it->second : static_cast< unsigned int >( m_Records.size() );
+  m_Lock.Unlock();
+  return index;
+}
+
+void
+PipelineProfiler
+::Reset()
+{
+  m_Lock.Lock();
+  m_Records.clear();
+  m_RecordIndices.clear();
+  m_Lock.Unlock();
+}
+
+void
+PipelineProfiler
+::Report(std::ostream & os) const
+{
+  m_Lock.Lock();
+  const RecordContainerType records = m_Records;
+  m_Lock.Unlock();
+
+  std::string::size_type nameWidth = 6;
+  for ( unsigned int i = 0; i < records.size(); i++ )
+    {
+    if ( records[i].Name.size() > nameWidth )
+      {
+      nameWidth = records[i].Name.size();
+      }
+    }
+  nameWidth += 2;
+
+  const std::ios::fmtflags flags = os.flags();
+  const std::streamsize    precision = os.precision();
+
+  os << "Pipeline profile of " << records.size() << " filters (times in ms)" << std::endl;
+  os << std::left << std::setw( static_cast< int >( nameWidth ) ) << "Filter" << std::right
+     << std::setw(6) << "Runs"
+     << std::setw(12) << "OutputInfo"
+     << std::setw(12) << "Requested"
+     << std::setw(14) << "GenerateData"
+     << std::setw(9) << "Threads"
+     << std::setw(12) << "ThreadMean"
+     << std::setw(12) << "ThreadMax"
+     << std::setw(12) << "Output MB" << std::endl;
+
+  os << std::fixed << std::setprecision(3);
+  TimeStampType sum = 0.0;
+  unsigned int  slowest = 0;
+  for ( unsigned int i = 0; i < records.size(); i++ )
+    {
+    const FilterRecordType & record = records[i];
+    unsigned int             numberOfThreads;
+    TimeStampType            mean;
+    TimeStampType            maximum;
+    ComputeThreadStatistics(record, numberOfThreads, mean, maximum);
+
+    os << std::left << std::setw( static_cast< int >( nameWidth ) ) << record.Name << std::right
+       << std::setw(6) << record.NumberOfExecutions
+       << std::setw(12) << record.GenerateOutputInformationTime * 1e3
+       << std::setw(12) << record.PropagateRequestedRegionTime * 1e3
+       << std::setw(14) << record.GenerateDataTime * 1e3
+       << std::setw(9) << numberOfThreads
+       << std::setw(12) << mean * 1e3
+       << std::setw(12) << maximum * 1e3
+       << std::setw(12) << record.OutputBytes / ( 1024.0 * 1024.0 ) << std::endl;
+
+    sum += record.GenerateDataTime;
+    if ( record.GenerateDataTime > records[slowest].GenerateDataTime )
+      {
+      slowest = i;
+      }
+    }
+
+  if ( sum > 0.0 )
+    {
+    os << "Longest GenerateData(): " << records[slowest].Name << ", "
+       << records[slowest].GenerateDataTime * 1e3 << " ms ("
+       << 100.0 * records[slowest].GenerateDataTime / sum
+       << "% of the sum over all filters)" << std::endl;
+    }
+
+  os.flags(flags);
+  os.precision(precision);
+}
+
+void
+PipelineProfiler
+::ReportAsJSON(std::ostream & os) const
+{
+  m_Lock.Lock();
+  const RecordContainerType records = m_Records;
+  m_Lock.Unlock();
+
+  const std::streamsize precision = os.precision(9);
+
+  os << "{" << std::endl;
+  os << "  \"filters\": [";
+  for ( unsigned int i = 0; i < records.size(); i++ )
+    {
+    const FilterRecordType & record = records[i];
+    os << ( i ? "," : "" ) << std::endl;
+    os << "    {" << std::endl;
+    os << "      \"name\": \"" << EscapeJSON(record.Name) << "\"," << std::endl;
+    os << "      \"class\": \"" << EscapeJSON(record.ClassName) << "\"," << std::endl;
+    os << "      \"executions\": " << record.NumberOfExecutions << "," << std::endl;
+    os << "      \"generateOutputInformation\": " << record.GenerateOutputInformationTime << ","
+       << std::endl;
+    os << "      \"propagateRequestedRegion\": " << record.PropagateRequestedRegionTime << ","
+       << std::endl;
+    os << "      \"generateData\": " << record.GenerateDataTime << "," << std::endl;
+    os << "      \"threadedGenerateData\": [";
+    for ( unsigned int t = 0; t < record.ThreadedGenerateDataTimes.size(); t++ )
+      {
+      os << ( t ? ", " : "" ) << record.ThreadedGenerateDataTimes[t];
+      }
+    os << "]," << std::endl;
+    os << "      \"outputBytes\": " << record.OutputBytes << std::endl;
+    os << "    }";
+    }
+  os << std::endl << "  ]" << std::endl;
+  os << "}" << std::endl;
+
+  os.precision(precision);
+}
+
+void
+PipelineProfiler
+::ReportAsCSV(std::ostream & os) const
+{
+  m_Lock.Lock();
+  const RecordContainerType records = m_Records;
+  m_Lock.Unlock();
+
+  const std::streamsize precision = os.precision(9);
+
+  os << "name,class,executions,generate_output_information,propagate_requested_region,"
+     << "generate_data,threads,thread_mean,thread_max,output_bytes" << std::endl;
+  for ( unsigned int i = 0; i < records.size(); i++ )
+    {
+    const FilterRecordType & record = records[i];
+    unsigned int             numberOfThreads;
+    TimeStampType            mean;
+    TimeStampType            maximum;
+    ComputeThreadStatistics(record, numberOfThreads, mean, maximum);
+
+    os << EscapeCSV(record.Name) << ","
+       << EscapeCSV(record.ClassName) << ","
+       << record.NumberOfExecutions << ","
+       << record.GenerateOutputInformationTime << ","
+       << record.PropagateRequestedRegionTime << ","
+       << record.GenerateDataTime << ","
+       << numberOfThreads << ","
+       << mean << ","
+       << maximum << ","
+       << record.OutputBytes << std::endl;
+    }
+
+  os.precision(precision);
+}
+
+void
+PipelineProfiler
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfRecords: " << this->GetNumberOfRecords() << std::endl;
+}
+} // end namespace itk
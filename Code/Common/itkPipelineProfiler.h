@@ -0,0 +1,170 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkPipelineProfiler.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkPipelineProfiler_h
+#define __itkPipelineProfiler_h
+
+#include "itkObject.h"
+#include "itkRealTimeClock.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+class ProcessObject;
+
+/** \class PipelineProfiler
+ * \brief Records where the time of a pipeline update is spent, filter by
+ * filter.
+ *
+ * A ProcessObject with a profiler (see ProcessObject::SetProfiler() and
+ * ProcessObject::SetGlobalProfiler()) reports to it, for every execution:
+ *
+ * - the time spent in GenerateOutputInformation(),
+ * - the time spent computing the requested regions
+ *   (EnlargeOutputRequestedRegion(), GenerateOutputRequestedRegion() and
+ *   GenerateInputRequestedRegion()),
+ * - the time spent in GenerateData(),
+ * - for the filters derived from ImageSource, the time each thread spent
+ *   in ThreadedGenerateData(),
+ * - the number of bytes held by the outputs once GenerateData() returns.
+ *
+ * The times of a filter do not include the update of its inputs, except
+ * when the filter runs a mini-pipeline in its GenerateData(); the filters
+ * of the mini-pipeline then appear in the report as well.
+ *
+ * The records are kept in the order the filters were first seen, and can
+ * be printed as a text table with Report(), as JSON with ReportAsJSON() or
+ * as CSV with ReportAsCSV(). Times are in seconds. A filter can be given
+ * a readable name with SetFilterName(); by default it is identified by
+ * its class name and address.
+ *
+ * \code
+ * itk::PipelineProfiler::Pointer profiler = itk::PipelineProfiler::New();
+ * itk::ProcessObject::SetGlobalProfiler( profiler );
+ * writer->Update();
+ * itk::ProcessObject::SetGlobalProfiler( 0 );
+ * profiler->Report( std::cout );
+ * \endcode
+ *
+ * All methods are thread safe.
+ *
+ * \sa TimeProbesCollectorBase MemoryProbesCollectorBase
+ * \ingroup OSSystemObjects
+ */
+class ITKCommon_EXPORT PipelineProfiler:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef PipelineProfiler           Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PipelineProfiler, Object);
+
+  typedef RealTimeClock::TimeStampType TimeStampType;
+
+  /** What is known about one filter instance. */
+  struct FilterRecordType {
+    std::string   Name;
+    std::string   ClassName;
+    unsigned long NumberOfExecutions;
+    TimeStampType GenerateOutputInformationTime;
+    TimeStampType PropagateRequestedRegionTime;
+    TimeStampType GenerateDataTime;
+    /** Time spent in ThreadedGenerateData(), indexed by thread id. */
+    std::vector< TimeStampType > ThreadedGenerateDataTimes;
+    /** Bytes held by the outputs after the last execution. */
+    size_t OutputBytes;
+  };
+
+  /** Current time, in seconds, of the clock used for the records. */
+  TimeStampType GetTimeStamp() const
+  {
+    return m_Clock->GetTimeStamp();
+  }
+
+  /** Record the time spent by a filter in each stage of its update.
+   * Called by ProcessObject and ImageSource. */
+  void RecordGenerateOutputInformation(const ProcessObject *filter, TimeStampType seconds);
+  void RecordPropagateRequestedRegion(const ProcessObject *filter, TimeStampType seconds);
+  void RecordGenerateData(const ProcessObject *filter, TimeStampType seconds,
+                          size_t outputBytes);
+  void RecordThreadedGenerateData(const ProcessObject *filter, int threadId,
+                                  TimeStampType seconds);
+
+  /** Name under which filter appears in the reports. */
+  void SetFilterName(const ProcessObject *filter, const std::string & name);
+
+  /** Called when filter is deleted, so that a new filter created at the
+   * same address gets a record of its own. The record of filter is
+   * kept. */
+  void ForgetFilter(const ProcessObject *filter);
+
+  /** Records, in the order the filters were first seen. */
+  unsigned int GetNumberOfRecords() const;
+  FilterRecordType GetRecord(unsigned int index) const;
+
+  /** Index of the record of filter, or GetNumberOfRecords() if the
+   * filter has not been seen. */
+  unsigned int GetRecordIndex(const ProcessObject *filter) const;
+
+  /** Discard all the records. */
+  void Reset();
+
+  /** Print the records as a table, followed by the filter with the
+   * longest GenerateData(). */
+  void Report(std::ostream & os = std::cout) const;
+
+  /** Print the records as a JSON document. */
+  void ReportAsJSON(std::ostream & os = std::cout) const;
+
+  /** Print the records as comma separated values, one line per filter
+   * after a header line. */
+  void ReportAsCSV(std::ostream & os = std::cout) const;
+
+protected:
+  PipelineProfiler();
+  ~PipelineProfiler();
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+private:
+  PipelineProfiler(const Self &); //purposely not implemented
+  void operator=(const Self &);   //purposely not implemented
+
+  /** Record of filter, created if needed. Must be called with m_Lock
+   * held. */
+  FilterRecordType & GetOrCreateRecord(const ProcessObject *filter);
+
+  typedef std::vector< FilterRecordType >                 RecordContainerType;
+  typedef std::map< const ProcessObject *, unsigned int > RecordIndexMapType;
+
+  RecordContainerType    m_Records;
+  RecordIndexMapType     m_RecordIndices;
+  RealTimeClock::Pointer m_Clock;
+  SimpleFastMutexLock    m_Lock;
+};
+} // end namespace itk
+
+#endif
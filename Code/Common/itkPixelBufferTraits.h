@@ -0,0 +1,65 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkPixelBufferTraits.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkPixelBufferTraits_h
+#define __itkPixelBufferTraits_h
+
+#include "itkMacro.h"
+#include "itkDefaultPixelAccessor.h"
+
+namespace itk
+{
+/** \class PixelBufferTraits
+ * \brief Tells at compile time whether the pixels of an image type can
+ * be read and written directly through its buffer pointer.
+ *
+ * IsDirect is true when the image stores its pixels as an array of
+ * PixelType and accesses them through the DefaultPixelAccessor, as
+ * Image and OrientedImage do. The pixel at offset k of the buffered
+ * region is then GetBufferPointer()[k], and a scanline of a region is a
+ * contiguous array that a filter may process with plain pointers, which
+ * lets the compiler vectorize the loop. IsDirect is false for
+ * VectorImage and for image adaptors, whose pixels must be accessed
+ * through iterators or accessors.
+ *
+ * \ingroup ImageObjects
+ */
+template< class TImage >
+class PixelBufferTraits
+{
+private:
+  template< class T1, class T2 >
+  struct SameType {
+    itkStaticConstMacro(Value, bool, false);
+  };
+
+  template< class T >
+  struct SameType< T, T > {
+    itkStaticConstMacro(Value, bool, true);
+  };
+
+public:
+  typedef typename TImage::PixelType         PixelType;
+  typedef typename TImage::InternalPixelType InternalPixelType;
+  typedef typename TImage::AccessorType      AccessorType;
+
+  itkStaticConstMacro( IsDirect, bool,
+                       ( SameType< PixelType, InternalPixelType >::Value
+                         && SameType< AccessorType, DefaultPixelAccessor< PixelType > >::Value ) );
+};
+} // end namespace itk
+
+#endif
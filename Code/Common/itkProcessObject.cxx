@@ -27,6 +27,8 @@
 
 namespace itk
 {
+PipelineProfiler::Pointer ProcessObject:: m_GlobalProfiler;
+
 /**
  * Instantiate object with no start, end, or progress methods.
  */
@@ -39,6 +41,7 @@ ProcessObject
 
   m_AbortGenerateData = false;
   m_Progress = 0.0f;
+  m_ThreadProgressReporting = true;
   m_Updating = false;
 
   m_Threader = MultiThreader::New();
@@ -84,6 +87,25 @@ ProcessObject
       m_Outputs[idx] = 0;
       }
     }
+
+  // We no longer consume our inputs
+  for ( idx = 0; idx < m_Inputs.size(); ++idx )
+    {
+    if ( m_Inputs[idx] )
+      {
+      m_Inputs[idx]->DisconnectConsumer(this);
+      }
+    }
+
+  // A new filter at the same address must not extend our records
+  if ( m_Profiler )
+    {
+    m_Profiler->ForgetFilter(this);
+    }
+  if ( m_GlobalProfiler )
+    {
+    m_GlobalProfiler->ForgetFilter(this);
+    }
 }
 
 //typedef DataObject *DataObjectPointer;
@@ -100,6 +122,13 @@ ProcessObject
     {
     return;
     }
+  for ( DataObjectPointerArraySizeType idx = num; idx < m_Inputs.size(); ++idx )
+    {
+    if ( m_Inputs[idx] )
+      {
+      m_Inputs[idx]->DisconnectConsumer(this);
+      }
+    }
   m_Inputs.resize(num);
   this->Modified();
 }
@@ -152,13 +181,13 @@ ProcessObject
     {
     if ( !m_Inputs[idx] )
       {
-      m_Inputs[idx] = input;
+      this->ReplaceInput(idx, input);
       return;
       }
     }
 
   this->SetNumberOfInputs( static_cast< int >( m_Inputs.size() + 1 ) );
-  m_Inputs[static_cast< int >( m_Inputs.size() ) - 1] = input;
+  this->ReplaceInput(m_Inputs.size() - 1, input);
 }
 
 /**
@@ -188,6 +217,7 @@ ProcessObject
     }
 
   // Set the position in the m_Inputs containing input to 0
+  input->DisconnectConsumer(this);
   *pos = 0;
 
   // if that was the last input, then shrink the list
@@ -221,7 +251,7 @@ ProcessObject
     this->SetNumberOfInputs(idx + 1);
     }
 
-  m_Inputs[idx] = input;
+  this->ReplaceInput(idx, input);
 
   this->Modified();
 }
@@ -233,7 +263,8 @@ void
 ProcessObject
 ::PushBackInput(const DataObject *input)
 {
-  m_Inputs.push_back( const_cast< DataObject * >( input ) );
+  m_Inputs.push_back(0);
+  this->ReplaceInput( m_Inputs.size() - 1, const_cast< DataObject * >( input ) );
   this->Modified();
 }
 
@@ -246,6 +277,7 @@ ProcessObject
 {
   if ( !m_Inputs.empty() )
     {
+    this->ReplaceInput(m_Inputs.size() - 1, 0);
     m_Inputs.pop_back();
     this->Modified();
     }
@@ -267,7 +299,8 @@ ProcessObject
                       m_Inputs.end() );
 
   // put in the new input in the front
-  m_Inputs[0] = const_cast< DataObject * >( input );
+  m_Inputs[0] = 0;
+  this->ReplaceInput( 0, const_cast< DataObject * >( input ) );
 
   this->Modified();
 }
@@ -281,6 +314,7 @@ ProcessObject
 {
   if ( !m_Inputs.empty() )
     {
+    this->ReplaceInput(0, 0);
     std::copy( m_Inputs.begin() + 1, m_Inputs.end(),
                m_Inputs.begin() );
 
@@ -289,6 +323,25 @@ ProcessObject
     }
 }
 
+/**
+ * Store an input in an existing slot of the input list, and let the
+ * previous and new data objects know who consumes them.
+ */
+void
+ProcessObject
+::ReplaceInput(DataObjectPointerArraySizeType idx, DataObject *input)
+{
+  if ( m_Inputs[idx] )
+    {
+    m_Inputs[idx]->DisconnectConsumer(this);
+    }
+  if ( input )
+    {
+    input->ConnectConsumer(this);
+    }
+  m_Inputs[idx] = input;
+}
+
 void
 ProcessObject
 ::RemoveOutput(DataObject *output)
@@ -374,6 +427,7 @@ ProcessObject
       {
       newOutput->SetRequestedRegion(oldOutput);
       newOutput->SetReleaseDataFlag( oldOutput->GetReleaseDataFlag() );
+      newOutput->SetReleaseDataWhenConsumedFlag( oldOutput->GetReleaseDataWhenConsumedFlag() );
       }
     }
 
@@ -531,6 +585,65 @@ ProcessObject
     }
 }
 
+/**
+ *
+ */
+bool
+ProcessObject
+::GetReleaseDataWhenConsumedFlag() const
+{
+  if ( this->GetOutput(0) )
+    {
+    return this->GetOutput(0)->GetReleaseDataWhenConsumedFlag();
+    }
+  itkWarningMacro(<< "Output doesn't exist!");
+  return false;
+}
+
+/**
+ *
+ */
+void
+ProcessObject
+::SetReleaseDataWhenConsumedFlag(bool val)
+{
+  unsigned int idx;
+
+  for ( idx = 0; idx < m_Outputs.size(); idx++ )
+    {
+    if ( m_Outputs[idx] )
+      {
+      m_Outputs[idx]->SetReleaseDataWhenConsumedFlag(val);
+      }
+    }
+}
+
+/**
+ *
+ */
+void
+ProcessObject
+::SetProfiler(PipelineProfiler *profiler)
+{
+  // The profiler does not change the output, so this does not call
+  // Modified().
+  m_Profiler = profiler;
+}
+
+void
+ProcessObject
+::SetGlobalProfiler(PipelineProfiler *profiler)
+{
+  m_GlobalProfiler = profiler;
+}
+
+PipelineProfiler *
+ProcessObject
+::GetGlobalProfiler()
+{
+  return m_GlobalProfiler.GetPointer();
+}
+
 /**
  *
  */
@@ -587,6 +700,8 @@ ProcessObject
 
   os << indent << "Multithreader: " << std::endl;
   m_Threader->PrintSelf( os, indent.GetNextIndent() );
+
+  os << indent << "Profiler: " << m_Profiler.GetPointer() << std::endl;
 }
 
 /**
@@ -738,7 +853,17 @@ ProcessObject
         }
       }
 
-    this->GenerateOutputInformation();
+    PipelineProfiler *profiler = this->GetActiveProfiler();
+    if ( profiler )
+      {
+      const PipelineProfiler::TimeStampType start = profiler->GetTimeStamp();
+      this->GenerateOutputInformation();
+      profiler->RecordGenerateOutputInformation(this, profiler->GetTimeStamp() - start);
+      }
+    else
+      {
+      this->GenerateOutputInformation();
+      }
 
     /**
      * Keep track of the last time GenerateOutputInformation() was called
@@ -762,6 +887,9 @@ ProcessObject
     return;
     }
 
+  PipelineProfiler *                    profiler = this->GetActiveProfiler();
+  const PipelineProfiler::TimeStampType start = profiler ? profiler->GetTimeStamp() : 0.0;
+
   /**
    * Give the subclass a chance to indicate that it will provide
    * more data then required for the output. This can happen, for
@@ -790,6 +918,11 @@ ProcessObject
    */
   this->GenerateInputRequestedRegion();
 
+  if ( profiler )
+    {
+    profiler->RecordPropagateRequestedRegion(this, profiler->GetTimeStamp() - start);
+    }
+
   /**
    * Now that we know the input requested region, propagate this
    * through all the inputs.
@@ -968,12 +1101,27 @@ ProcessObject
     }
   else
     {
+    /**
+     * If other threaded methods are running while this filter executes
+     * (it is updated from within another filter's threads, or from
+     * several application threads), only use the threads left in the
+     * global concurrency budget so that nested pipelines do not
+     * oversubscribe the processors.
+     */
+    const int requestedNumberOfThreads = m_NumberOfThreads;
+    m_NumberOfThreads =
+      MultiThreader::GetNumberOfThreadsWithinConcurrencyBudget(m_NumberOfThreads);
+
+    PipelineProfiler *                    profiler = this->GetActiveProfiler();
+    const PipelineProfiler::TimeStampType start = profiler ? profiler->GetTimeStamp() : 0.0;
+
     try
       {
       this->GenerateData();
       }
     catch ( ProcessAborted & excp )
       {
+      m_NumberOfThreads = requestedNumberOfThreads;
       this->InvokeEvent( AbortEvent() );
       this->ResetPipeline();
       this->RestoreInputReleaseDataFlags();
@@ -981,10 +1129,32 @@ ProcessObject
       }
     catch ( ExceptionObject & excp )
       {
+      m_NumberOfThreads = requestedNumberOfThreads;
       this->ResetPipeline();
       this->RestoreInputReleaseDataFlags();
       throw excp;
       }
+    catch ( ... )
+      {
+      // std::bad_alloc and the like: only the thread count is restored
+      m_NumberOfThreads = requestedNumberOfThreads;
+      throw;
+      }
+    m_NumberOfThreads = requestedNumberOfThreads;
+
+    if ( profiler )
+      {
+      const PipelineProfiler::TimeStampType elapsed = profiler->GetTimeStamp() - start;
+      size_t                                outputBytes = 0;
+      for ( idx = 0; idx < m_Outputs.size(); ++idx )
+        {
+        if ( m_Outputs[idx] )
+          {
+          outputBytes += m_Outputs[idx]->GetBufferSizeInBytes();
+          }
+        }
+      profiler->RecordGenerateData(this, elapsed, outputBytes);
+      }
     }
 
   /**
@@ -1023,6 +1193,18 @@ ProcessObject
    */
   this->ReleaseInputs();
 
+  /**
+   * Tell the inputs we are done with them. Inputs released when consumed
+   * give back their bulk data once their last consumer has executed.
+   */
+  for ( idx = 0; idx < m_Inputs.size(); ++idx )
+    {
+    if ( m_Inputs[idx] )
+      {
+      m_Inputs[idx]->DataHasBeenConsumed(this);
+      }
+    }
+
   // Mark that we are no longer updating the data in this filter
   m_Updating = false;
 }
@@ -24,6 +24,7 @@
 #include "itkDataObject.h"
 #include "itkMultiThreader.h"
 #include "itkObjectFactory.h"
+#include "itkPipelineProfiler.h"
 #include <vector>
 
 namespace itk
@@ -71,6 +72,14 @@ namespace itk
  * to false and the ReleaseDataBeforeUpdateFlag defaults to true.
  * Some subclasses of ProcessObject, for example ImageSource, use a
  * default setting of false for the ReleaseDataBeforeUpdateFlag.
+ * The ReleaseDataWhenConsumedFlag releases the output data only once
+ * every downstream process object using it has executed, which bounds
+ * the peak memory of long pipelines without regenerating data that
+ * feeds several filters.
+ *
+ * A PipelineProfiler set with SetProfiler(), or for every ProcessObject
+ * with SetGlobalProfiler(), records the time spent in each stage of the
+ * execution of the filter and the size of its outputs.
  *
  * Subclasses of ProcessObject may override 4 of the methods of this class
  * to control how a given filter may interact with the pipeline (dataflow).
@@ -163,6 +172,22 @@ public:
    * the cumulative (not incremental) progress. */
   void UpdateProgress(float amount);
 
+  /** Set/Get whether the ProgressReporter of thread 0 updates the
+   * progress of the filter. On by default. ImageSource turns it off while
+   * DynamicMultiThreading calls ThreadedGenerateData() once per piece,
+   * where each reporter would run from 0 to 1 over a single piece, and
+   * reports the progress from the pieces completed instead. Setting it
+   * does not modify the filter. */
+  void SetThreadProgressReporting(bool flag)
+  {
+    m_ThreadProgressReporting = flag;
+  }
+
+  bool GetThreadProgressReporting() const
+  {
+    return m_ThreadProgressReporting;
+  }
+
   /** Bring this filter up-to-date. Update() checks modified times against
    * last execution times, and re-executes objects if necessary. A side
    * effect of this method is that the whole pipeline may execute
@@ -254,6 +279,17 @@ public:
   void ReleaseDataFlagOn() { this->SetReleaseDataFlag(true); }
   void ReleaseDataFlagOff() { this->SetReleaseDataFlag(false); }
 
+  /** Turn on/off the flags to control whether the bulk data belonging
+   * to the outputs of this ProcessObject are released as soon as every
+   * downstream ProcessObject using them has executed. Default value is
+   * off. \sa DataObject::SetReleaseDataWhenConsumedFlag() */
+  virtual void SetReleaseDataWhenConsumedFlag(bool flag);
+
+  virtual bool GetReleaseDataWhenConsumedFlag() const;
+
+  void ReleaseDataWhenConsumedFlagOn() { this->SetReleaseDataWhenConsumedFlag(true); }
+  void ReleaseDataWhenConsumedFlagOff() { this->SetReleaseDataWhenConsumedFlag(false); }
+
   /** Turn on/off the flags to control whether the bulk data belonging
    * to the outputs of this ProcessObject are released/reallocated
    * during an Update().  In limited memory scenarios, a user may want
@@ -270,7 +306,10 @@ public:
   itkGetConstReferenceMacro(ReleaseDataBeforeUpdateFlag, bool);
   itkBooleanMacro(ReleaseDataBeforeUpdateFlag);
 
-  /** Get/Set the number of threads to create when executing. */
+  /** Get/Set the number of threads to create when executing. While
+   * GenerateData() runs, the value is lowered to fit the
+   * MultiThreader global concurrency budget if other threaded methods are
+   * running at the same time, and restored afterwards. */
   itkSetClampMacro(NumberOfThreads, int, 1, ITK_MAX_THREADS);
   itkGetConstReferenceMacro(NumberOfThreads, int);
 
@@ -278,6 +317,21 @@ public:
   MultiThreader * GetMultiThreader()
   { return m_Threader; }
 
+  /** Set/Get the profiler recording the executions of this
+   * ProcessObject. Setting a profiler does not modify the
+   * ProcessObject. When no profiler is set, the global profiler, if any,
+   * is used. \sa PipelineProfiler */
+  void SetProfiler(PipelineProfiler *profiler);
+
+  PipelineProfiler * GetProfiler() const
+  { return m_Profiler.GetPointer(); }
+
+  /** Set/Get the profiler used by all the ProcessObjects that have no
+   * profiler of their own. None by default. */
+  static void SetGlobalProfiler(PipelineProfiler *profiler);
+
+  static PipelineProfiler * GetGlobalProfiler();
+
   /** An opportunity to deallocate a ProcessObject's bulk data
    *  storage. Some filters may wish to reuse existing bulk data
    *  storage to avoid unnecessary deallocation/allocation
@@ -427,10 +481,20 @@ protected:
 
   /** Time when GenerateOutputInformation was last called. */
   TimeStamp m_OutputInformationMTime;
+
+  /** Profiler to which this ProcessObject reports: its own profiler, or
+   * else the global profiler. Null when profiling is off. */
+  PipelineProfiler * GetActiveProfiler() const
+  { return m_Profiler ? m_Profiler.GetPointer() : m_GlobalProfiler.GetPointer(); }
+
 private:
   ProcessObject(const Self &);  //purposely not implemented
   void operator=(const Self &); //purposely not implemented
 
+  /** Store input in slot idx of m_Inputs, updating the consumers
+   * registered on the previous and new data objects. */
+  void ReplaceInput(DataObjectPointerArraySizeType idx, DataObject *input);
+
   /** An array of the inputs to the filter. */
   DataObjectPointerArray m_Inputs;
   unsigned int           m_NumberOfRequiredInputs;
@@ -445,6 +509,7 @@ private:
   /** These support the progress method and aborting filter execution. */
   bool  m_AbortGenerateData;
   float m_Progress;
+  bool  m_ThreadProgressReporting;
 
   /** Support processing data in multiple threads. Used by subclasses
    * (e.g., ImageSource). */
@@ -454,6 +519,10 @@ private:
   /** Memory management ivars */
   bool m_ReleaseDataBeforeUpdateFlag;
 
+  /** Profiling */
+  PipelineProfiler::Pointer        m_Profiler;
+  static PipelineProfiler::Pointer m_GlobalProfiler;
+
   /** Friends of ProcessObject */
   friend class DataObject;
 };
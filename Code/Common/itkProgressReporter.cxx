@@ -29,7 +29,8 @@ ProgressReporter::ProgressReporter(ProcessObject *filter, int threadId,
   m_ThreadId(threadId),
   m_CurrentPixel(0),
   m_InitialProgress(initialProgress),
-  m_ProgressWeight(progressWeight)
+  m_ProgressWeight(progressWeight),
+  m_ReportProgress( threadId == 0 && filter->GetThreadProgressReporting() )
 {
   float numPixels = numberOfPixels;
   float numUpdates = numberOfUpdates;
@@ -52,7 +53,7 @@ ProgressReporter::ProgressReporter(ProcessObject *filter, int threadId,
 
   // Only thread 0 should update progress. (But all threads need to
   // count pixels so they can check the abort flag.)
-  if ( m_ThreadId == 0 )
+  if ( m_ReportProgress )
     {
     // Set the progress to initial progress.  The filter is just starting.
     m_Filter->UpdateProgress(m_InitialProgress);
@@ -65,7 +66,7 @@ ProgressReporter::ProgressReporter(ProcessObject *filter, int threadId,
 ProgressReporter::~ProgressReporter()
 {
   // Only thread 0 should update progress.
-  if ( m_ThreadId == 0 )
+  if ( m_ReportProgress )
     {
     // Set the progress to the end of its current range.  The filter has
     // finished.
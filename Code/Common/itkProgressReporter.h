@@ -46,6 +46,8 @@ namespace itk
  * \endcode
  *
  * When used in a non-threaded filter, the threadId argument should be 0.
+ * Only the reporter of thread 0 updates the progress, and none does when
+ * ProcessObject::GetThreadProgressReporting() is off.
  *
  * \sa
  * This class is a tool for filter implementers to equip a filter to
@@ -76,7 +78,7 @@ public:
       m_PixelsBeforeUpdate = m_PixelsPerUpdate;
       m_CurrentPixel += m_PixelsPerUpdate;
       // only thread 0 should update the progress of the filter
-      if ( m_ThreadId == 0 )
+      if ( m_ReportProgress )
         {
         m_Filter->UpdateProgress(
           m_CurrentPixel * m_InverseNumberOfPixels * m_ProgressWeight + m_InitialProgress);
@@ -102,6 +104,7 @@ protected:
   unsigned long  m_PixelsBeforeUpdate;
   float          m_InitialProgress;
   float          m_ProgressWeight;
+  bool           m_ReportProgress;
 private:
   ProgressReporter(); //purposely not implemented
 };
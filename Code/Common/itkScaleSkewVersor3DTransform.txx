@@ -252,10 +252,11 @@ ScaleSkewVersor3DTransform< TScalarType >::PrintSelf(std::ostream & os, Indent i
   os << indent << "Skew:        " << m_Skew         << std::endl;
 }
 
-// Set parameters
+// Compute the Jacobian in one position into the given matrix
 template< class TScalarType >
-const typename ScaleSkewVersor3DTransform< TScalarType >::JacobianType &
-ScaleSkewVersor3DTransform< TScalarType >::GetJacobian(const InputPointType & p) const
+void
+ScaleSkewVersor3DTransform< TScalarType >
+::ComputeJacobianWithRespectToParameters(const InputPointType & p, JacobianType & jacobian) const
 {
   typedef typename VersorType::ValueType ValueType;
 
@@ -265,7 +266,7 @@ ScaleSkewVersor3DTransform< TScalarType >::GetJacobian(const InputPointType & p)
   const ValueType vz = this->GetVersor().GetZ();
   const ValueType vw = this->GetVersor().GetW();
 
-  this->m_Jacobian.Fill(0.0);
+  jacobian.Fill(0.0);
 
   const double px = p[0] - this->GetCenter()[0];
   const double py = p[1] - this->GetCenter()[1];
@@ -286,44 +287,65 @@ ScaleSkewVersor3DTransform< TScalarType >::GetJacobian(const InputPointType & p)
   const double vzw = vz * vw;
 
   // compute Jacobian with respect to quaternion parameters
-  this->m_Jacobian[0][0] = 2.0 * ( ( vyw + vxz ) * py + ( vzw - vxy ) * pz )
-                           / vw;
-  this->m_Jacobian[1][0] = 2.0 * ( ( vyw - vxz ) * px   - 2 * vxw   * py + ( vxx - vww ) * pz )
-                           / vw;
-  this->m_Jacobian[2][0] = 2.0 * ( ( vzw + vxy ) * px + ( vww - vxx ) * py   - 2 * vxw   * pz )
-                           / vw;
-
-  this->m_Jacobian[0][1] = 2.0 * ( -2 * vyw  * px + ( vxw + vyz ) * py + ( vww - vyy ) * pz )
-                           / vw;
-  this->m_Jacobian[1][1] = 2.0 * ( ( vxw - vyz ) * px                + ( vzw + vxy ) * pz )
-                           / vw;
-  this->m_Jacobian[2][1] = 2.0 * ( ( vyy - vww ) * px + ( vzw - vxy ) * py   - 2 * vyw   * pz )
-                           / vw;
-
-  this->m_Jacobian[0][2] = 2.0 * ( -2 * vzw  * px + ( vzz - vww ) * py + ( vxw - vyz ) * pz )
-                           / vw;
-  this->m_Jacobian[1][2] = 2.0 * ( ( vww - vzz ) * px   - 2 * vzw   * py + ( vyw + vxz ) * pz )
-                           / vw;
-  this->m_Jacobian[2][2] = 2.0 * ( ( vxw + vyz ) * px + ( vyw - vxz ) * py )
-                           / vw;
-
-  this->m_Jacobian[0][3] = 1.0;
-  this->m_Jacobian[1][4] = 1.0;
-  this->m_Jacobian[2][5] = 1.0;
-
-  this->m_Jacobian[0][6] = px;
-  this->m_Jacobian[1][7] = py;
-  this->m_Jacobian[2][8] = pz;
-
-  this->m_Jacobian[0][9]  = py;
-  this->m_Jacobian[0][10] = pz;
-  this->m_Jacobian[1][11] = px;
-  this->m_Jacobian[1][12] = pz;
-  this->m_Jacobian[2][13] = px;
-  this->m_Jacobian[2][14] = py;
+  jacobian[0][0] = 2.0 * ( ( vyw + vxz ) * py + ( vzw - vxy ) * pz )
+                   / vw;
+  jacobian[1][0] = 2.0 * ( ( vyw - vxz ) * px   - 2 * vxw   * py + ( vxx - vww ) * pz )
+                   / vw;
+  jacobian[2][0] = 2.0 * ( ( vzw + vxy ) * px + ( vww - vxx ) * py   - 2 * vxw   * pz )
+                   / vw;
+
+  jacobian[0][1] = 2.0 * ( -2 * vyw  * px + ( vxw + vyz ) * py + ( vww - vyy ) * pz )
+                   / vw;
+  jacobian[1][1] = 2.0 * ( ( vxw - vyz ) * px                + ( vzw + vxy ) * pz )
+                   / vw;
+  jacobian[2][1] = 2.0 * ( ( vyy - vww ) * px + ( vzw - vxy ) * py   - 2 * vyw   * pz )
+                   / vw;
+
+  jacobian[0][2] = 2.0 * ( -2 * vzw  * px + ( vzz - vww ) * py + ( vxw - vyz ) * pz )
+                   / vw;
+  jacobian[1][2] = 2.0 * ( ( vww - vzz ) * px   - 2 * vzw   * py + ( vyw + vxz ) * pz )
+                   / vw;
+  jacobian[2][2] = 2.0 * ( ( vxw + vyz ) * px + ( vyw - vxz ) * py )
+                   / vw;
+
+  jacobian[0][3] = 1.0;
+  jacobian[1][4] = 1.0;
+  jacobian[2][5] = 1.0;
+
+  jacobian[0][6] = px;
+  jacobian[1][7] = py;
+  jacobian[2][8] = pz;
+
+  jacobian[0][9]  = py;
+  jacobian[0][10] = pz;
+  jacobian[1][11] = px;
+  jacobian[1][12] = pz;
+  jacobian[2][13] = px;
+  jacobian[2][14] = py;
+}
 
+// Compute the Jacobian in one position
+template< class TScalarType >
+const typename ScaleSkewVersor3DTransform< TScalarType >::JacobianType &
+ScaleSkewVersor3DTransform< TScalarType >
+::GetJacobian(const InputPointType & p) const
+{
+  this->ComputeJacobianWithRespectToParameters(p, this->m_Jacobian);
   return this->m_Jacobian;
 }
+
+// Compute the Jacobian in one position, without writing into the transform
+template< class TScalarType >
+void
+ScaleSkewVersor3DTransform< TScalarType >
+::GetNonZeroJacobian(const InputPointType & p,
+                     JacobianType & jacobian,
+                     NonZeroJacobianIndicesType & nonZeroJacobianIndices) const
+{
+  jacobian.SetSize( this->m_Jacobian.rows(), this->m_Jacobian.cols() );
+  this->ComputeJacobianWithRespectToParameters(p, jacobian);
+  this->GetAllNonZeroJacobianIndices(nonZeroJacobianIndices);
+}
 } // namespace
 
 #endif
@@ -65,6 +65,7 @@ public:
   /** Parameters Type   */
   typedef typename Superclass::ParametersType            ParametersType;
   typedef typename Superclass::JacobianType              JacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
   typedef typename Superclass::ScalarType                ScalarType;
   typedef typename Superclass::InputPointType            InputPointType;
   typedef typename Superclass::OutputPointType           OutputPointType;
@@ -119,7 +120,18 @@ public:
    * transform is invertible at this point. */
   const JacobianType & GetJacobian(const InputPointType  & point) const;
 
+  /** Compute the Jacobian at a point into jacobian, which GetJacobian()
+   * does into the transform. Every parameter may act on the point, so all
+   * the columns are returned. */
+  virtual void GetNonZeroJacobian(const InputPointType & point,
+                                  JacobianType & jacobian,
+                                  NonZeroJacobianIndicesType & nonZeroJacobianIndices) const;
+
 protected:
+  /** Compute the Jacobian of the transformation at a point into jacobian,
+   * which has the size of the Jacobian. */
+  void ComputeJacobianWithRespectToParameters(const InputPointType & p, JacobianType & jacobian) const;
+
   ScaleVersor3DTransform();
   ScaleVersor3DTransform(const MatrixType & matrix,
                          const OutputVectorType & offset);
@@ -84,10 +84,18 @@ ITKCommon_EXPORT std::istream &  operator>>(std::istream & in, SmapsRecord & rec
         in.seekg (lastPos, std::ios::beg);
         break;
         }
-      //fill the token with the memory usage N in kB
-      in >> record.m_Tokens[token];
-      std::getline(in, token);
-      if ( token != " kB" || !in.good() ) { itkGenericExceptionMacro(<< "bad size: " << record.m_Tokens[token]); }
+      //fill the token with the memory usage N in kB. Recent kernels add
+      // fields that are not sizes (VmFlags, THPeligible, ...): skip them.
+      std::string value;
+      std::getline(in, value);
+      if ( !in.good() ) { itkGenericExceptionMacro(<< "bad value for " << token << ": " << value); }
+      std::istringstream valueStream(value);
+      SmapsRecord::MemoryLoadType size;
+      std::string                 unit;
+      if ( ( valueStream >> size >> unit ) && unit == "kB" )
+        {
+        record.m_Tokens[token] = size;
+        }
       lastPos = in.tellg();
       }
     }
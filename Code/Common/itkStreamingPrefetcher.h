@@ -0,0 +1,147 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkStreamingPrefetcher.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkStreamingPrefetcher_h
+#define __itkStreamingPrefetcher_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkConditionVariable.h"
+#include "itkMutexLock.h"
+#include "itkThreadPool.h"
+#include "itkNumericTraits.h"
+
+#include <deque>
+#include <vector>
+
+namespace itk
+{
+/** \class StreamingPrefetcher
+ * \brief Updates a pipeline for a sequence of regions, ahead of the
+ * code consuming them.
+ *
+ * The objects that stream a pipeline (StreamingImageFilter,
+ * ImageFileWriter) update their input for one piece, use it, and update
+ * it for the next piece. StreamingPrefetcher does the updates for them.
+ * With NumberOfPiecesInFlight set to 1, GetNextPiece() updates the input
+ * for the next region and returns the input itself, as those objects
+ * always did.
+ *
+ * With a larger NumberOfPiecesInFlight, the input is updated for the
+ * following regions by a thread of the ThreadPool while the previous
+ * pieces are used, so that reading and computing upstream overlap with
+ * the work done on each piece. Up to NumberOfPiecesInFlight pieces exist
+ * at once, counting the one being used and the one being produced: 2
+ * double buffers the pieces. Each piece is returned in an image of its
+ * own that shares the buffer of the input, and the input gets a new
+ * buffer (ReleaseData()) before being updated for a region it does not
+ * hold already. The pipeline upstream only ever runs on one thread at a
+ * time, but its events are invoked from the prefetching thread. When
+ * the ThreadPool has no free thread, the pieces are updated when asked
+ * for, as with a NumberOfPiecesInFlight of 1.
+ *
+ * An exception thrown while updating the input is thrown again by the
+ * GetNextPiece() call that would have returned the piece.
+ *
+ * \ingroup DataProcessing
+ * \ingroup ITKSystemObjects
+ */
+template< class TImage >
+class ITK_EXPORT StreamingPrefetcher:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef StreamingPrefetcher        Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(StreamingPrefetcher, Object);
+
+  typedef TImage                         ImageType;
+  typedef typename ImageType::Pointer    ImagePointer;
+  typedef typename ImageType::RegionType RegionType;
+  typedef std::vector< RegionType >      RegionListType;
+
+  /** Set/Get the pipeline output updated for each region. */
+  itkSetObjectMacro(Input, ImageType);
+  itkGetObjectMacro(Input, ImageType);
+
+  /** Set/Get the largest number of pieces that exist at once. The
+   * default, 1, updates the input for a region when it is asked for. */
+  itkSetClampMacro(NumberOfPiecesInFlight, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfPiecesInFlight, unsigned int);
+
+  /** Start producing the pieces of the regions, in order. A sequence
+   * that was started before is stopped. */
+  void Start(const RegionListType & regions);
+
+  /** Return an image whose buffered region contains the next region, or
+   * a null pointer once every region was returned or Stop() was called.
+   * The image returned before must not be used anymore. */
+  ImagePointer GetNextPiece();
+
+  /** Stop producing pieces, and wait for the update in progress. */
+  void Stop();
+
+protected:
+  StreamingPrefetcher();
+  ~StreamingPrefetcher();
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  /** Update the input for the given region and return the piece. */
+  ImagePointer ProducePiece(const RegionType & region);
+
+  /** Produce the pieces on a pool thread. */
+  void Produce();
+
+  static ITK_THREAD_RETURN_TYPE ProduceCallback(void *arg);
+
+private:
+  StreamingPrefetcher(const Self &); //purposely not implemented
+  void operator=(const Self &);      //purposely not implemented
+
+  ImagePointer   m_Input;
+  unsigned int   m_NumberOfPiecesInFlight;
+  RegionListType m_Regions;
+  unsigned int   m_NextRegion;
+
+  /** State shared with the producing thread, guarded by m_Lock. The
+   * pieces produced and not returned yet are in m_Pieces. */
+  std::deque< ImagePointer > m_Pieces;
+  ImagePointer               m_CurrentPiece;
+  bool                       m_InputShared;
+  bool                       m_Threaded;
+  bool                       m_Producing;
+  bool                       m_Stopping;
+  bool                       m_Failed;
+  ExceptionObject            m_Exception;
+
+  ThreadPool::JobCounterType m_JobCounter;
+  SimpleMutexLock            m_Lock;
+  ConditionVariable::Pointer m_Condition;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkStreamingPrefetcher.txx"
+#endif
+
+#endif
@@ -0,0 +1,252 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkStreamingPrefetcher.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkStreamingPrefetcher_txx
+#define __itkStreamingPrefetcher_txx
+#include "itkStreamingPrefetcher.h"
+
+namespace itk
+{
+template< class TImage >
+StreamingPrefetcher< TImage >
+::StreamingPrefetcher()
+{
+  m_NumberOfPiecesInFlight = 1;
+  m_NextRegion = 0;
+  m_InputShared = false;
+  m_Threaded = false;
+  m_Producing = false;
+  m_Stopping = false;
+  m_Failed = false;
+  m_Condition = ConditionVariable::New();
+}
+
+template< class TImage >
+StreamingPrefetcher< TImage >
+::~StreamingPrefetcher()
+{
+  this->Stop();
+}
+
+template< class TImage >
+void
+StreamingPrefetcher< TImage >
+::Start(const RegionListType & regions)
+{
+  if ( !m_Input )
+    {
+    itkExceptionMacro(<< "No input to update");
+    }
+
+  this->Stop();
+  m_Regions = regions;
+  m_NextRegion = 0;
+  m_InputShared = false;
+  m_Stopping = false;
+  m_Failed = false;
+
+  if ( m_NumberOfPiecesInFlight > 1 && m_Regions.size() > 1 )
+    {
+    m_Threaded = true;
+    m_Producing = true;
+    // The producer waits for the pieces to be consumed, so it must not
+    // queue behind busy workers
+    const ThreadFunctionType function = Self::ProduceCallback;
+    void *                   data = this;
+    if ( !ThreadPool::GetInstance()->TryAssignWork(1, &function, &data, &m_JobCounter) )
+      {
+      // no free thread, or no threads in this build: the pieces are
+      // updated when asked for
+      m_Threaded = false;
+      m_Producing = false;
+      }
+    }
+}
+
+template< class TImage >
+typename StreamingPrefetcher< TImage >::ImagePointer
+StreamingPrefetcher< TImage >
+::GetNextPiece()
+{
+  if ( !m_Threaded )
+    {
+    if ( m_NextRegion >= m_Regions.size() )
+      {
+      return 0;
+      }
+    return this->ProducePiece(m_Regions[m_NextRegion++]);
+    }
+
+  m_Lock.Lock();
+  // the piece returned before is not used anymore
+  ImagePointer previous = m_CurrentPiece;
+  m_CurrentPiece = 0;
+  m_Condition->Broadcast();
+  while ( m_Pieces.empty() && m_Producing )
+    {
+    m_Condition->Wait(&m_Lock);
+    }
+  ImagePointer piece;
+  bool         failed = false;
+  if ( !m_Pieces.empty() )
+    {
+    piece = m_Pieces.front();
+    m_Pieces.pop_front();
+    m_CurrentPiece = piece;
+    m_NextRegion++;
+    }
+  else
+    {
+    failed = m_Failed;
+    }
+  m_Lock.Unlock();
+  previous = 0;
+
+  if ( failed )
+    {
+    ExceptionObject exception = m_Exception;
+    this->Stop();
+    throw exception;
+    }
+  return piece;
+}
+
+template< class TImage >
+void
+StreamingPrefetcher< TImage >
+::Stop()
+{
+  if ( m_Threaded )
+    {
+    m_Lock.Lock();
+    m_Stopping = true;
+    m_Condition->Broadcast();
+    m_Lock.Unlock();
+    ThreadPool::GetInstance()->WaitForJobs(&m_JobCounter);
+    m_Threaded = false;
+    }
+  m_Pieces.clear();
+  m_CurrentPiece = 0;
+  m_NextRegion = m_Regions.size();
+}
+
+template< class TImage >
+typename StreamingPrefetcher< TImage >::ImagePointer
+StreamingPrefetcher< TImage >
+::ProducePiece(const RegionType & region)
+{
+  // The pieces returned before keep the buffer they share with the
+  // input, which is given a new one if it must be updated.
+  if ( m_InputShared && !m_Input->GetBufferedRegion().IsInside(region) )
+    {
+    m_Input->ReleaseData();
+    m_InputShared = false;
+    }
+
+  m_Input->SetRequestedRegion(region);
+  m_Input->PropagateRequestedRegion();
+  m_Input->UpdateOutputData();
+
+  if ( !m_Threaded )
+    {
+    return m_Input;
+    }
+  ImagePointer piece = ImageType::New();
+  piece->Graft(m_Input);
+  m_InputShared = true;
+  return piece;
+}
+
+template< class TImage >
+void
+StreamingPrefetcher< TImage >
+::Produce()
+{
+  for ( unsigned int r = 0; r < m_Regions.size(); r++ )
+    {
+    m_Lock.Lock();
+    while ( !m_Stopping
+            && m_Pieces.size() + ( m_CurrentPiece ? 2 : 1 ) > m_NumberOfPiecesInFlight )
+      {
+      m_Condition->Wait(&m_Lock);
+      }
+    const bool stop = m_Stopping;
+    m_Lock.Unlock();
+    if ( stop )
+      {
+      break;
+      }
+
+    ImagePointer piece;
+    try
+      {
+      piece = this->ProducePiece(m_Regions[r]);
+      }
+    catch ( ExceptionObject & e )
+      {
+      m_Exception = e;
+      m_Failed = true;
+      }
+    catch ( std::exception & e )
+      {
+      m_Exception = ExceptionObject(__FILE__, __LINE__, e.what(), ITK_LOCATION);
+      m_Failed = true;
+      }
+    catch ( ... )
+      {
+      m_Exception = ExceptionObject(__FILE__, __LINE__, "Unknown exception", ITK_LOCATION);
+      m_Failed = true;
+      }
+    if ( m_Failed )
+      {
+      break;
+      }
+
+    m_Lock.Lock();
+    m_Pieces.push_back(piece);
+    m_Condition->Broadcast();
+    m_Lock.Unlock();
+    }
+
+  m_Lock.Lock();
+  m_Producing = false;
+  m_Condition->Broadcast();
+  m_Lock.Unlock();
+}
+
+template< class TImage >
+ITK_THREAD_RETURN_TYPE
+StreamingPrefetcher< TImage >
+::ProduceCallback(void *arg)
+{
+  static_cast< Self * >( arg )->Produce();
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TImage >
+void
+StreamingPrefetcher< TImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Input: " << m_Input.GetPointer() << std::endl;
+  os << indent << "NumberOfPiecesInFlight: " << m_NumberOfPiecesInFlight << std::endl;
+  os << indent << "Number of regions: " << m_Regions.size() << std::endl;
+  os << indent << "Next region: " << m_NextRegion << std::endl;
+}
+} // end namespace itk
+
+#endif
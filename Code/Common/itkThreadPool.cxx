@@ -0,0 +1,356 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkThreadPool.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "itkThreadPool.h"
+
+#ifdef _WIN32
+#include "itkWindows.h"
+#include <process.h>
+#endif
+
+namespace itk
+{
+extern "C"
+{
+typedef void *( *c_void_cast )(void *);
+}
+
+ThreadPool::Pointer ThreadPool:: m_Instance = 0;
+SimpleFastMutexLock ThreadPool:: m_InstanceLock;
+
+ThreadPool::Pointer
+ThreadPool
+::GetInstance()
+{
+  m_InstanceLock.Lock();
+  if ( m_Instance.IsNull() )
+    {
+    m_Instance = new ThreadPool;
+    // The smart pointer now holds the only reference.
+    m_Instance->UnRegister();
+    }
+  m_InstanceLock.Unlock();
+  return m_Instance;
+}
+
+ThreadPool
+::ThreadPool()
+{
+  m_IdleThreads = 0;
+  m_MaximumNumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_Stopping = false;
+  m_WorkAvailable = ConditionVariable::New();
+  m_WorkCompleted = ConditionVariable::New();
+}
+
+ThreadPool
+::~ThreadPool()
+{
+  this->Shutdown();
+}
+
+void
+ThreadPool
+::AssignWork(ThreadFunctionType function, void *data,
+             JobCounterType *counter)
+{
+  ThreadJob job;
+
+  job.Function = function;
+  job.UserData = data;
+  job.Counter  = counter;
+
+  m_Lock.Lock();
+  m_WorkQueue.push_back(job);
+  ++counter->PendingJobs;
+
+  // Workers that were signaled but have not yet dequeued still count as
+  // idle, so only grow when the queue outnumbers every idle worker.
+  if ( m_IdleThreads < static_cast< int >( m_WorkQueue.size() )
+       && static_cast< int >( m_Threads.size() ) < m_MaximumNumberOfThreads )
+    {
+    try
+      {
+      this->AddThread();
+      }
+    catch ( ... )
+      {
+      m_WorkQueue.pop_back();
+      --counter->PendingJobs;
+      m_Lock.Unlock();
+      throw;
+      }
+    }
+  m_WorkAvailable->Signal();
+  m_Lock.Unlock();
+}
+
+bool
+ThreadPool
+::TryAssignWork(unsigned int numberOfJobs, const ThreadFunctionType *functions,
+                void *const *data, JobCounterType *counter)
+{
+  m_Lock.Lock();
+  // The queued jobs are taken by the idle workers first
+  const int missingThreads = static_cast< int >( numberOfJobs ) - m_IdleThreads
+                             + static_cast< int >( m_WorkQueue.size() );
+  if ( missingThreads > m_MaximumNumberOfThreads - static_cast< int >( m_Threads.size() ) )
+    {
+    m_Lock.Unlock();
+    return false;
+    }
+  try
+    {
+    for ( int i = 0; i < missingThreads; i++ )
+      {
+      this->AddThread();
+      }
+    }
+  catch ( ... )
+    {
+    // the workers started are kept idle
+    m_Lock.Unlock();
+    return false;
+    }
+
+  for ( unsigned int i = 0; i < numberOfJobs; i++ )
+    {
+    ThreadJob job;
+    job.Function = functions[i];
+    job.UserData = data[i];
+    job.Counter  = counter;
+    m_WorkQueue.push_back(job);
+    }
+  counter->PendingJobs += numberOfJobs;
+  m_WorkAvailable->Broadcast();
+  m_Lock.Unlock();
+  return true;
+}
+
+void
+ThreadPool
+::WaitForJobs(JobCounterType *counter)
+{
+  m_Lock.Lock();
+  while ( counter->PendingJobs > 0 )
+    {
+    // Rather than wait for a worker, run a queued job of the batch
+    std::deque< ThreadJob >::iterator job = m_WorkQueue.begin();
+    while ( job != m_WorkQueue.end() && job->Counter != counter )
+      {
+      ++job;
+      }
+    if ( job != m_WorkQueue.end() )
+      {
+      const ThreadJob queuedJob = *job;
+      m_WorkQueue.erase(job);
+      this->ExecuteJob(queuedJob);
+      }
+    else
+      {
+      m_WorkCompleted->Wait(&m_Lock);
+      }
+    }
+  const bool      exceptionOccurred = counter->ExceptionOccurred;
+  ExceptionObject exception = counter->Exception;
+  counter->ExceptionOccurred = false;
+  m_Lock.Unlock();
+
+  if ( exceptionOccurred )
+    {
+    throw exception;
+    }
+}
+
+int
+ThreadPool
+::GetNumberOfThreads() const
+{
+  m_Lock.Lock();
+  const int numberOfThreads = static_cast< int >( m_Threads.size() );
+  m_Lock.Unlock();
+  return numberOfThreads;
+}
+
+int
+ThreadPool
+::GetNumberOfIdleThreads() const
+{
+  m_Lock.Lock();
+  const int idleThreads = m_IdleThreads;
+  m_Lock.Unlock();
+  return idleThreads;
+}
+
+void
+ThreadPool
+::AddThread()
+{
+  ThreadProcessIDType threadHandle;
+
+#ifdef ITK_USE_WIN32_THREADS
+  DWORD threadId;
+  threadHandle = (HANDLE)_beginthreadex(0, 0,
+                                        ( unsigned int (__stdcall *)(void *) ) ThreadPool::ThreadExecute,
+                                        ( (void *)this ), 0, (unsigned int *)&threadId);
+  if ( threadHandle == NULL )
+    {
+    itkExceptionMacro("Error in thread creation !!!");
+    }
+#endif
+
+#ifdef ITK_USE_PTHREADS
+  pthread_attr_t attr;
+
+#ifdef ITK_HP_PTHREADS
+  pthread_attr_create(&attr);
+  pthread_create( &threadHandle,
+                  attr, reinterpret_cast< c_void_cast >( ThreadPool::ThreadExecute ),
+                  reinterpret_cast< void * >( this ) );
+#else
+  pthread_attr_init(&attr);
+#if !defined( __CYGWIN__ )
+  pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
+#endif
+  const int threadError =
+    pthread_create( &threadHandle, &attr, reinterpret_cast< c_void_cast >( ThreadPool::ThreadExecute ),
+                    reinterpret_cast< void * >( this ) );
+  pthread_attr_destroy(&attr);
+  if ( threadError != 0 )
+    {
+    itkExceptionMacro(<< "Unable to create a thread.  pthread_create() returned "
+                      << threadError);
+    }
+#endif
+#endif
+
+#ifndef ITK_USE_WIN32_THREADS
+#ifndef ITK_USE_PTHREADS
+  threadHandle = 0;
+  itkExceptionMacro(<< "Cannot add a pool thread in a single threaded environment!");
+#endif
+#endif
+
+  m_Threads.push_back(threadHandle);
+  ++m_IdleThreads;
+}
+
+void
+ThreadPool
+::Shutdown()
+{
+  m_Lock.Lock();
+  m_Stopping = true;
+  m_WorkAvailable->Broadcast();
+  m_Lock.Unlock();
+
+  for ( unsigned int i = 0; i < m_Threads.size(); i++ )
+    {
+#ifdef ITK_USE_WIN32_THREADS
+    WaitForSingleObject(m_Threads[i], INFINITE);
+    CloseHandle(m_Threads[i]);
+#endif
+#ifdef ITK_USE_PTHREADS
+    pthread_join(m_Threads[i], 0);
+#endif
+    }
+  m_Threads.clear();
+}
+
+void
+ThreadPool
+::ExecuteJob(const ThreadJob & job)
+{
+  m_Lock.Unlock();
+
+  // Anything escaping the job must not take the worker down with it: it
+  // is kept for the thread waiting for the batch.
+  bool            exceptionOccurred = false;
+  ExceptionObject exception;
+  try
+    {
+    ( *job.Function )(job.UserData);
+    }
+  catch ( ExceptionObject & e )
+    {
+    exception = e;
+    exceptionOccurred = true;
+    }
+  catch ( std::exception & e )
+    {
+    exception = ExceptionObject(__FILE__, __LINE__, e.what(), ITK_LOCATION);
+    exceptionOccurred = true;
+    }
+  catch ( ... )
+    {
+    exception = ExceptionObject(__FILE__, __LINE__, "Unknown exception", ITK_LOCATION);
+    exceptionOccurred = true;
+    }
+
+  m_Lock.Lock();
+  if ( exceptionOccurred && !job.Counter->ExceptionOccurred )
+    {
+    job.Counter->Exception = exception;
+    job.Counter->ExceptionOccurred = true;
+    }
+  if ( --job.Counter->PendingJobs == 0 )
+    {
+    m_WorkCompleted->Broadcast();
+    }
+}
+
+ITK_THREAD_RETURN_TYPE
+ThreadPool
+::ThreadExecute(void *arg)
+{
+  ThreadPool *pool = reinterpret_cast< ThreadPool * >( arg );
+
+  pool->m_Lock.Lock();
+  while ( true )
+    {
+    while ( pool->m_WorkQueue.empty() && !pool->m_Stopping )
+      {
+      pool->m_WorkAvailable->Wait(&pool->m_Lock);
+      }
+    // Pending work is drained before honoring a shutdown request.
+    if ( pool->m_WorkQueue.empty() )
+      {
+      break;
+      }
+
+    ThreadJob job = pool->m_WorkQueue.front();
+    pool->m_WorkQueue.pop_front();
+    --pool->m_IdleThreads;
+    pool->ExecuteJob(job);
+    ++pool->m_IdleThreads;
+    }
+  --pool->m_IdleThreads;
+  pool->m_Lock.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void
+ThreadPool
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Number Of Threads: " << this->GetNumberOfThreads() << std::endl;
+  os << indent << "Number Of Idle Threads: " << this->GetNumberOfIdleThreads() << std::endl;
+  os << indent << "Maximum Number Of Threads: " << m_MaximumNumberOfThreads << std::endl;
+}
+} // end namespace itk
@@ -0,0 +1,156 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkThreadPool.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkThreadPool_h
+#define __itkThreadPool_h
+
+#include "itkMultiThreader.h"
+#include "itkConditionVariable.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <deque>
+#include <vector>
+
+namespace itk
+{
+/** \class ThreadPool
+ * \brief Process-wide pool of persistent worker threads.
+ *
+ * The ThreadPool keeps a set of worker threads alive for the lifetime of
+ * the process so that MultiThreader::SingleMethodExecute() and
+ * MultiThreader::MultipleMethodExecute() do not have to create and join
+ * system threads on every call.  Work is handed to the pool as a
+ * (ThreadFunctionType, void *) pair, exactly as it would have been handed
+ * to the threading library, and the caller waits on a JobCounter for the
+ * batch of jobs it submitted.
+ *
+ * The pool grows on demand up to MaximumNumberOfThreads workers, by
+ * default the global default number of threads of MultiThreader; beyond
+ * that the jobs queue until a worker is free.  A thread waiting for its
+ * jobs runs those still queued itself, so a worker that submits work of
+ * its own (nested calls) does not deadlock waiting for itself.  Jobs that
+ * must run at the same time, such as the methods of a MultiThreader that
+ * may wait for each other, are handed over with TryAssignWork(), which
+ * only queues them if every one of them gets a worker right away.
+ *
+ * An exception thrown by a job is recorded in the JobCounterType of its
+ * batch and rethrown by WaitForJobs().
+ *
+ * There is a single instance per process, obtained with GetInstance().
+ * The workers are stopped and joined when the process exits.
+ *
+ * \ingroup OSSystemObjects
+ */
+class ITKCommon_EXPORT ThreadPool:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ThreadPool                 Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ThreadPool, Object);
+
+  /** Return the process-wide instance, creating it on first use. */
+  static Pointer GetInstance();
+
+  /** Jobs of one batch that have not completed yet, and the first
+   * exception one of them threw. A batch is waited for with WaitForJobs().
+   * The counter is only modified while the pool lock is held. */
+  struct JobCounterType {
+    JobCounterType():PendingJobs(0), ExceptionOccurred(false) {}
+    int             PendingJobs;
+    bool            ExceptionOccurred;
+    ExceptionObject Exception;
+  };
+
+  /** Queue a job for execution by a worker thread.  The counter is
+   * incremented now and decremented once the job has returned.  A worker
+   * is started if none is idle and the pool is below its maximum size;
+   * otherwise the job waits for a worker to become free. */
+  void AssignWork(ThreadFunctionType function, void *data,
+                  JobCounterType *counter);
+
+  /** Queue numberOfJobs jobs, the function and data of job i being
+   * functions[i] and data[i], only if a worker can start each of them
+   * right away.  Returns false, queuing nothing, if the pool cannot run
+   * them all at once. */
+  bool TryAssignWork(unsigned int numberOfJobs, const ThreadFunctionType *functions,
+                     void *const *data, JobCounterType *counter);
+
+  /** Block the calling thread until every job accounted in the counter
+   * has completed.  Jobs of the counter still queued are run by the
+   * calling thread.  The first exception a job threw is rethrown once
+   * they have all completed. */
+  void WaitForJobs(JobCounterType *counter);
+
+  /** Set/Get the maximum number of worker threads. Workers already
+   * started are kept when it is lowered. */
+  itkSetClampMacro(MaximumNumberOfThreads, int, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(MaximumNumberOfThreads, int);
+
+  /** Number of worker threads currently alive in the pool. */
+  int GetNumberOfThreads() const;
+
+  /** Number of worker threads currently waiting for work. */
+  int GetNumberOfIdleThreads() const;
+
+protected:
+  ThreadPool();
+  ~ThreadPool();
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+private:
+  ThreadPool(const Self &);     //purposely not implemented
+  void operator=(const Self &); //purposely not implemented
+
+  struct ThreadJob {
+    ThreadFunctionType Function;
+    void *UserData;
+    JobCounterType *Counter;
+  };
+
+  /** Start one more worker. Must be called with m_Lock held. */
+  void AddThread();
+
+  /** Run a job outside of the lock, then account for its completion.
+   * Must be called with m_Lock held, which is held again on return. */
+  void ExecuteJob(const ThreadJob & job);
+
+  /** Stop and join every worker. */
+  void Shutdown();
+
+  /** Entry point of every worker thread. */
+  static ITK_THREAD_RETURN_TYPE ThreadExecute(void *arg);
+
+  std::deque< ThreadJob >            m_WorkQueue;
+  std::vector< ThreadProcessIDType > m_Threads;
+  int                                m_IdleThreads;
+  int                                m_MaximumNumberOfThreads;
+  bool                               m_Stopping;
+
+  mutable SimpleMutexLock    m_Lock;
+  ConditionVariable::Pointer m_WorkAvailable;
+  ConditionVariable::Pointer m_WorkCompleted;
+
+  static Pointer             m_Instance;
+  static SimpleFastMutexLock m_InstanceLock;
+};
+} // end namespace itk
+
+#endif
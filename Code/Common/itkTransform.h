@@ -96,6 +96,10 @@ public:
   /** Type of the Jacobian matrix. */
   typedef  Array2D< double > JacobianType;
 
+  /** Type of the indices of the parameters of the non-zero columns of the
+   * Jacobian. */
+  typedef  Array< unsigned long > NonZeroJacobianIndicesType;
+
   /** Standard vector type for this class. */
   typedef Vector< TScalarType, NInputDimensions >  InputVectorType;
   typedef Vector< TScalarType, NOutputDimensions > OutputVectorType;
@@ -220,6 +224,29 @@ public:
     return this->m_Jacobian;
   }
 
+  /** Compute the columns of the Jacobian which may not be zero at a given
+   * input point.
+   *
+   * On return, jacobian has GetNumberOfNonZeroJacobianIndices() columns,
+   * and column k is the column nonZeroJacobianIndices[k] of the Jacobian
+   * returned by GetJacobian(). The other columns of the Jacobian are zero
+   * at this point. Transforms whose parameters only act locally, such as
+   * the BSplineDeformableTransform, only return the few columns of the
+   * parameters of the point, which lets the metrics compute their
+   * derivatives without looping over all the parameters.
+   *
+   * The default copies the whole Jacobian returned by GetJacobian(). The
+   * transforms which override this method compute the columns directly
+   * into jacobian, and the arrays are only reallocated when their size
+   * changes. */
+  virtual void GetNonZeroJacobian(const InputPointType & point,
+                                  JacobianType & jacobian,
+                                  NonZeroJacobianIndicesType & nonZeroJacobianIndices) const;
+
+  /** Return the number of columns returned by GetNonZeroJacobian(). */
+  virtual unsigned long GetNumberOfNonZeroJacobianIndices() const
+  { return this->GetNumberOfParameters(); }
+
   /** Return the number of parameters that completely define the Transfom  */
   virtual unsigned int GetNumberOfParameters(void) const
   { return this->m_Parameters.Size(); }
@@ -267,6 +294,10 @@ protected:
   mutable ParametersType m_FixedParameters;
 
   mutable JacobianType m_Jacobian;
+
+  /** Set the indices of all the parameters, for the transforms whose
+   * Jacobian is dense. */
+  void GetAllNonZeroJacobianIndices(NonZeroJacobianIndicesType & nonZeroJacobianIndices) const;
 private:
   Transform(const Self &);      //purposely not implemented
   void operator=(const Self &); //purposely not implemented
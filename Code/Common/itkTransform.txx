@@ -50,6 +50,41 @@ Transform< TScalarType, NInputDimensions, NOutputDimensions >
   m_Jacobian(dimension, numberOfParameters)
 {}
 
+/**
+ * The whole Jacobian
+ */
+template< class TScalarType,
+          unsigned int NInputDimensions,
+          unsigned int NOutputDimensions >
+void
+Transform< TScalarType, NInputDimensions, NOutputDimensions >
+::GetNonZeroJacobian(const InputPointType & point,
+                     JacobianType & jacobian,
+                     NonZeroJacobianIndicesType & nonZeroJacobianIndices) const
+{
+  jacobian = this->GetJacobian(point);
+  this->GetAllNonZeroJacobianIndices(nonZeroJacobianIndices);
+}
+
+/**
+ * Indices of all the parameters
+ */
+template< class TScalarType,
+          unsigned int NInputDimensions,
+          unsigned int NOutputDimensions >
+void
+Transform< TScalarType, NInputDimensions, NOutputDimensions >
+::GetAllNonZeroJacobianIndices(NonZeroJacobianIndicesType & nonZeroJacobianIndices) const
+{
+  const unsigned long numberOfParameters = this->GetNumberOfParameters();
+
+  nonZeroJacobianIndices.SetSize(numberOfParameters);
+  for ( unsigned long i = 0; i < numberOfParameters; i++ )
+    {
+    nonZeroJacobianIndices[i] = i;
+    }
+}
+
 /**
  * GenerateName
  */
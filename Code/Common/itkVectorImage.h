@@ -282,6 +282,12 @@ public:
    * and then copies over the pixel container. */
   virtual void Graft(const DataObject *data);
 
+  /** Number of bytes allocated for the pixel buffer. */
+  virtual size_t GetBufferSizeInBytes() const
+  {
+    return m_Buffer ? m_Buffer->Capacity() * sizeof( InternalPixelType ) : 0;
+  }
+
   /** Return the Pixel Accessor object */
   AccessorType GetPixelAccessor(void)
   { return AccessorType(m_VectorLength); }
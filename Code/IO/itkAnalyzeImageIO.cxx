@@ -552,6 +552,50 @@ void AnalyzeImageIO::PrintSelf(std::ostream & os, Indent indent) const
   Superclass::PrintSelf(os, indent);
 }
 
+bool AnalyzeImageIO::HasUncompressedImageFile() const
+{
+  if ( GetExtension(m_FileName) == ".img.gz" )
+    {
+    return false;
+    }
+  std::ifstream file(GetImageFileName(m_FileName).c_str(), std::ios::in | std::ios::binary);
+  if ( !file )
+    {
+    return false;
+    }
+  // gzread also reads the gzip files without the .gz extension
+  unsigned char magic[2] = { 0, 0 };
+  file.read(reinterpret_cast< char * >( magic ), 2);
+  return !( magic[0] == 0x1f && magic[1] == 0x8b );
+}
+
+bool AnalyzeImageIO::CanStreamRead()
+{
+  return this->HasUncompressedImageFile();
+}
+
+bool AnalyzeImageIO::CanStreamWrite()
+{
+  return GetExtension(m_FileName) != ".img.gz";
+}
+
+ImageIORegion
+AnalyzeImageIO
+::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const
+{
+  if ( this->HasUncompressedImageFile() )
+    {
+    return Superclass::GenerateStreamableReadRegionFromRequestedRegion(requested);
+    }
+  // a compressed image file is read at once
+  return ImageIOBase::GenerateStreamableReadRegionFromRequestedRegion(requested);
+}
+
+AnalyzeImageIO::SizeType AnalyzeImageIO::GetHeaderSize(void) const
+{
+  return static_cast< SizeType >( fabs(m_Hdr.dime.vox_offset) );
+}
+
 bool AnalyzeImageIO::CanWriteFile(const char *FileNameToWrite)
 {
   std::string filename(FileNameToWrite);
@@ -701,6 +745,16 @@ void AnalyzeImageIO::Read(void *buffer)
 
   /* Returns proper name for cases 1,2,3 */
   std::string ImageFileName = GetImageFileName(m_FileName);
+
+  // The region of an uncompressed image file is read in place
+  if ( this->RequestedToStream() && this->HasUncompressedImageFile() )
+    {
+    std::ifstream file;
+    this->OpenFileForReading( file, ImageFileName.c_str() );
+    this->StreamReadBufferAsBinary(file, buffer);
+    SwapBytesIfNecessary( buffer, m_IORegion.GetNumberOfPixels() * this->GetNumberOfComponents() );
+    return;
+    }
   // NOTE: gzFile operations act just like FILE * operations when the
   // files are not in gzip fromat.This greatly simplifies the
   // following code, and gzFile types are used everywhere. In
@@ -780,7 +834,7 @@ void AnalyzeImageIO::Read(void *buffer)
 
     gzclose(file_p);
     file_p = NULL;
-    SwapBytesIfNecessary( buffer, this->GetImageSizeInPixels() );
+    SwapBytesIfNecessary( buffer, this->GetImageSizeInComponents() );
     }
   catch ( ... )
     {
@@ -1560,6 +1614,49 @@ void
 AnalyzeImageIO
 ::Write(const void *buffer)
 {
+  if ( this->RequestedToStream() )
+    {
+    // a piece of a streamed or pasted image, written in place
+    if ( !this->CanStreamWrite() )
+      {
+      itkExceptionMacro(<< "Can not write a region of the compressed image file of " << m_FileName);
+      }
+    const std::string ImageFileName = GetImageFileName(m_FileName);
+    std::ofstream     file;
+    if ( !itksys::SystemTools::FileExists( GetHeaderFileName(m_FileName).c_str() )
+         || !itksys::SystemTools::FileExists( ImageFileName.c_str() ) )
+      {
+      // write the header, and allocate the image file by writing its
+      // last byte
+      this->WriteImageInformation();
+      this->OpenFileForWriting(file, ImageFileName.c_str(), true);
+      const std::streampos lastByte =
+        static_cast< std::streamoff >( this->GetHeaderSize() + this->GetImageSizeInBytes() - 1 );
+      file.seekp(lastByte, std::ios::beg);
+      file.write("\0", 1);
+      std::string unusedbaseimgname = GetRootName( GetHeaderFileName(m_FileName) );
+      unusedbaseimgname += ".img.gz";
+      itksys::SystemTools::RemoveFile( unusedbaseimgname.c_str() );
+      }
+    else
+      {
+      // the voxels of the file written by the previous pieces, or
+      // pasted into, are at the offset of its header
+      Pointer header = Self::New();
+      header->SetFileName(m_FileName);
+      header->ReadImageInformation();
+      if ( header->GetByteOrder() != m_MachineByteOrder || !header->HasUncompressedImageFile() )
+        {
+        itkExceptionMacro(<< "Can not write a region of " << m_FileName
+                          << ", which is compressed or of another byte order");
+        }
+      this->m_Hdr.dime.vox_offset = header->m_Hdr.dime.vox_offset;
+      this->OpenFileForWriting(file, ImageFileName.c_str(), false);
+      }
+    this->StreamWriteBufferAsBinary(file, buffer);
+    return;
+    }
+
   //Write the image Information before writing data
   this->WriteImageInformation();
 
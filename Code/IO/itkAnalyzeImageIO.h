@@ -34,7 +34,7 @@
 #endif
 
 #include <fstream>
-#include "itkImageIOBase.h"
+#include "itkStreamingImageIOBase.h"
 #include "itkAnalyzeDbh.h"
 
 namespace itk
@@ -89,13 +89,17 @@ namespace itk
    *    - an object file ([basename].obj)
    *      A specially formated file with a mapping between object name and image code used to associate
    *      image voxel locations with a label.  This file is run length encoded to save disk storage.
+   *
+   * The regions of an uncompressed image file are read and written in
+   * place, so that only the region requested is read from, or written
+   * to the image file.
    */
-class ITK_EXPORT AnalyzeImageIO:public ImageIOBase
+class ITK_EXPORT AnalyzeImageIO:public StreamingImageIOBase
 {
 public:
   /** Standard class typedefs. */
   typedef AnalyzeImageIO       Self;
-  typedef ImageIOBase          Superclass;
+  typedef StreamingImageIOBase Superclass;
   typedef SmartPointer< Self > Pointer;
 
   /** Method for creation through the object factory. */
@@ -120,6 +124,15 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer);
 
+  /** Returns true when the image file is uncompressed. */
+  virtual bool CanStreamRead();
+
+  /** Calculate the region of the image that can be efficiently read
+   *  in response to a given requested region: the requested region
+   *  when the image file is uncompressed, otherwise the whole image. */
+  virtual ImageIORegion
+  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const;
+
   /*-------- This part of the interfaces deals with writing data. ----- */
 
   /** Determine if the file can be written with this ImageIO implementation.
@@ -137,6 +150,9 @@ public:
        * that the IORegions has been set properly. */
   virtual void Write(const void *buffer);
 
+  /** Returns true when the image file will be written uncompressed. */
+  virtual bool CanStreamWrite();
+
   /** Return the directions with a correction for the 2D case. */
   virtual std::vector< double > GetDirection(unsigned int i) const;
 
@@ -149,7 +165,13 @@ protected:
   ~AnalyzeImageIO();
   void PrintSelf(std::ostream & os, Indent indent) const;
 
+  /** Returns the offset of the voxels in the image file. */
+  virtual SizeType GetHeaderSize(void) const;
+
 private:
+  /** Returns true when the image file of the file set is uncompressed. */
+  bool HasUncompressedImageFile() const;
+
   /**
     * \enum ValidAnalyzeOrientationFlags
     * Valid Orientation values for objects
@@ -53,6 +53,7 @@
 #include "gdcmRescaler.h"
 #include "gdcmFileMetaInformation.h"
 #include "gdcmImageReader.h"
+#include "gdcmReader.h"
 #include "gdcmImageWriter.h"
 #include "gdcmUIDGenerator.h"
 #include "gdcmAttribute.h"
@@ -344,11 +345,23 @@ bool GDCMImageIO::CanReadFile(const char *filename)
     return true;
     }
 #else
-  gdcm::ImageReader reader;
+  // Only parse the header, up to the Pixel Data: this is called on every
+  // file an ImageFileReader cannot find an ImageIO for from its extension.
+  const gdcm::Tag pixelData(0x7fe0, 0x0010);
+  std::set< gdcm::Tag > skipTags;
+  skipTags.insert(pixelData);
+  gdcm::Reader reader;
   reader.SetFileName(filename);
-  if ( reader.Read() )
+  if ( reader.ReadUpToTag(pixelData, skipTags) )
     {
-    return true;
+    // An image has Rows and Columns, unless it is declared as one
+    const gdcm::DataSet & ds = reader.GetFile().GetDataSet();
+    if ( ( ds.FindDataElement( gdcm::Tag(0x0028, 0x0010) )
+           && ds.FindDataElement( gdcm::Tag(0x0028, 0x0011) ) )
+         || gdcm::MediaStorage::IsImage( reader.GetFile().GetHeader().GetMediaStorage() ) )
+      {
+      return true;
+      }
     }
 #endif
   return false;
@@ -22,21 +22,124 @@
 
 #include "gdcmSerieHelper.h"
 #include "gdcmFile.h"
+#if GDCM_MAJOR_VERSION >= 2
+#include "gdcmDirectory.h"
+#include "gdcmReader.h"
+#include "itkSimpleFastMutexLock.h"
+#include <map>
+#include <set>
+#endif
 
+#include <algorithm>
 #include <vector>
 #include <string>
 
 namespace itk
 {
+#if GDCM_MAJOR_VERSION >= 2
+namespace
+{
+// Gives access to the grouping of the files in series, without the reading
+// of the whole files done by gdcm::SerieHelper::SetDirectory().
+class HeaderSerieHelper:public gdcm::SerieHelper
+{
+public:
+  bool AddHeader(gdcm::FileWithName & header)
+  {
+    return this->AddFile(header);
+  }
+};
+
+// A header parsed, and the state of the file it was parsed from
+struct CachedHeader {
+  long int Modified;
+  unsigned long Length;
+  gdcm::SmartPointer< gdcm::FileWithName > Header;
+};
+
+typedef std::map< std::string, CachedHeader > HeaderCacheType;
+
+HeaderCacheType     HeaderCache;
+SimpleFastMutexLock HeaderCacheLock;
+
+// Parse the header of an image file, stopping in front of the Pixel Data.
+// Returns NULL if the file is not a DICOM image. This is less strict than
+// gdcm::ImageReader, which also checks the Pixel Data.
+gdcm::FileWithName * ReadHeader(const std::string & filename)
+{
+  const gdcm::Tag pixelData(0x7fe0, 0x0010);
+
+  std::set< gdcm::Tag > skipTags;
+  skipTags.insert(pixelData);
+  gdcm::Reader reader;
+  reader.SetFileName( filename.c_str() );
+  if ( !reader.ReadUpToTag(pixelData, skipTags) )
+    {
+    return 0;
+    }
+  // An image has Rows and Columns, unless it is declared as one
+  const gdcm::DataSet & ds = reader.GetFile().GetDataSet();
+  if ( ( !ds.FindDataElement( gdcm::Tag(0x0028, 0x0010) )
+         || !ds.FindDataElement( gdcm::Tag(0x0028, 0x0011) ) )
+       && !gdcm::MediaStorage::IsImage( reader.GetFile().GetHeader().GetMediaStorage() ) )
+    {
+    return 0;
+    }
+  gdcm::FileWithName *header = new gdcm::FileWithName( reader.GetFile() );
+  header->filename = filename;
+  return header;
+}
+
+struct HeaderScanStruct {
+  const gdcm::Directory::FilenamesType *FileNames;
+  std::vector< gdcm::SmartPointer< gdcm::FileWithName > > Headers;
+  std::vector< unsigned int > Jobs;
+  unsigned int NextJob;
+  SimpleFastMutexLock Lock;
+};
+
+// Parse the files of the jobs, until there is none left
+void ReadHeaderJobs(HeaderScanStruct *str)
+{
+  while ( true )
+    {
+    str->Lock.Lock();
+    const unsigned int j = str->NextJob++;
+    str->Lock.Unlock();
+    if ( j >= str->Jobs.size() )
+      {
+      return;
+      }
+    const unsigned int file = str->Jobs[j];
+    str->Headers[file] = ReadHeader( ( *str->FileNames )[file] );
+    }
+}
+
+ITK_THREAD_RETURN_TYPE HeaderScanThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = (MultiThreader::ThreadInfoStruct *)( arg );
+
+  ReadHeaderJobs( (HeaderScanStruct *)( info->UserData ) );
+  return ITK_THREAD_RETURN_VALUE;
+}
+}
+#endif
+
 GDCMSeriesFileNames::GDCMSeriesFileNames()
 {
+#if GDCM_MAJOR_VERSION < 2
   m_SerieHelper = new gdcm::SerieHelper();
+#else
+  m_SerieHelper = new HeaderSerieHelper();
+#endif
   m_InputDirectory = "";
   m_OutputDirectory = "";
   m_UseSeriesDetails = true;
   m_Recursive = false;
   m_LoadSequences = false;
   m_LoadPrivateTags = false;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_UseHeaderCache = false;
 }
 
 GDCMSeriesFileNames::~GDCMSeriesFileNames()
@@ -76,11 +179,113 @@ void GDCMSeriesFileNames::SetInputDirectory(std::string const & name)
   m_SerieHelper->SetUseSeriesDetails(m_UseSeriesDetails);
   m_SerieHelper->SetLoadMode( ( m_LoadSequences ? 0 : gdcm::LD_NOSEQ )
                               | ( m_LoadPrivateTags ? 0 : gdcm::LD_NOSHADOW ) );
-  m_SerieHelper->SetDirectory(name, m_Recursive);
+  this->ScanDirectory(name);
   //as a side effect it also execute
   this->Modified();
 }
 
+void GDCMSeriesFileNames::ScanDirectory(const std::string & name)
+{
+#if GDCM_MAJOR_VERSION < 2
+  m_SerieHelper->SetDirectory(name, m_Recursive);
+#else
+  gdcm::Directory directory;
+  directory.Load(name, m_Recursive);
+  const gdcm::Directory::FilenamesType & filenames = directory.GetFilenames();
+
+  HeaderScanStruct str;
+  str.FileNames = &filenames;
+  str.Headers.resize( filenames.size() );
+  str.NextJob = 0;
+
+  // Only parse the files which are not in the cache, or were modified
+  std::vector< long int >      modified( filenames.size() );
+  std::vector< unsigned long > length( filenames.size() );
+  if ( m_UseHeaderCache )
+    {
+    HeaderCacheLock.Lock();
+    }
+  for ( unsigned int i = 0; i < filenames.size(); i++ )
+    {
+    if ( m_UseHeaderCache )
+      {
+      modified[i] = itksys::SystemTools::ModifiedTime( filenames[i].c_str() );
+      length[i] = itksys::SystemTools::FileLength( filenames[i].c_str() );
+      HeaderCacheType::const_iterator cached = HeaderCache.find(filenames[i]);
+      if ( cached != HeaderCache.end()
+           && cached->second.Modified == modified[i]
+           && cached->second.Length == length[i] )
+        {
+        // the series of this object hold their own copy of the header
+        if ( cached->second.Header )
+          {
+          str.Headers[i] = new gdcm::FileWithName( *cached->second.Header );
+          }
+        continue;
+        }
+      }
+    str.Jobs.push_back(i);
+    }
+  if ( m_UseHeaderCache )
+    {
+    HeaderCacheLock.Unlock();
+    }
+
+  itkDebugMacro(<< "Parsing " << str.Jobs.size() << " of the "
+                << filenames.size() << " files of " << name);
+  const int numberOfThreads = std::min(static_cast< int >( str.Jobs.size() ), m_NumberOfThreads);
+  if ( numberOfThreads > 1 )
+    {
+    MultiThreader::Pointer threader = MultiThreader::New();
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(HeaderScanThreaderCallback, &str);
+    threader->SingleMethodExecute();
+    }
+  else
+    {
+    ReadHeaderJobs(&str);
+    }
+
+  if ( m_UseHeaderCache )
+    {
+    // Files which are not DICOM images are remembered as well
+    HeaderCacheLock.Lock();
+    for ( unsigned int j = 0; j < str.Jobs.size(); j++ )
+      {
+      const unsigned int i = str.Jobs[j];
+      CachedHeader &     cached = HeaderCache[filenames[i]];
+      cached.Modified = modified[i];
+      cached.Length = length[i];
+      cached.Header = 0;
+      if ( str.Headers[i] )
+        {
+        cached.Header = new gdcm::FileWithName( *str.Headers[i] );
+        }
+      }
+    HeaderCacheLock.Unlock();
+    }
+
+  // Group the files in series, in the order of the directory
+  HeaderSerieHelper *helper = static_cast< HeaderSerieHelper * >( m_SerieHelper );
+  for ( unsigned int i = 0; i < filenames.size(); i++ )
+    {
+    if ( str.Headers[i] )
+      {
+      helper->AddHeader(*str.Headers[i]);
+      }
+    }
+#endif
+}
+
+void GDCMSeriesFileNames::ReleaseHeaderCache()
+{
+#if GDCM_MAJOR_VERSION >= 2
+  HeaderCacheLock.Lock();
+  HeaderCache.clear();
+  HeaderCacheLock.Unlock();
+#endif
+}
+
 const SerieUIDContainer & GDCMSeriesFileNames::GetSeriesUIDs()
 {
   m_SeriesUIDs.clear();
@@ -278,6 +483,8 @@ void GDCMSeriesFileNames::PrintSelf(std::ostream & os, Indent indent) const
   os << indent << "InputDirectory: " << m_InputDirectory << std::endl;
   os << indent << "LoadSequences:" << m_LoadSequences << std::endl;
   os << indent << "LoadPrivateTags:" << m_LoadPrivateTags << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "UseHeaderCache: " << m_UseHeaderCache << std::endl;
   if ( m_Recursive )
     {
     os << indent << "Recursive: True" << std::endl;
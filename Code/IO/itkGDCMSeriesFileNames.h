@@ -20,6 +20,7 @@
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 #include "itkExceptionObject.h"
+#include "itkMultiThreader.h"
 #include <vector>
 #include "gdcmSerieHelper.h"
 
@@ -43,6 +44,12 @@ namespace itk
  *    dicom objects, you may want to try calling ->SetUseSeriesDetails(true)
  *    prior to calling SetDirectory().
  *
+ *  With GDCM 2, only the headers of the files are parsed, up to the Pixel
+ *  Data, and the files are parsed on several threads. The headers can be
+ *  kept in a cache shared by all the instances (see SetUseHeaderCache()),
+ *  so that scanning again a directory only parses the files which were
+ *  added or modified since.
+ *
  * \ingroup IOFilters
  *
  */
@@ -167,6 +174,25 @@ public:
   itkSetMacro(LoadPrivateTags, bool);
   itkGetConstMacro(LoadPrivateTags, bool);
   itkBooleanMacro(LoadPrivateTags);
+
+  /** Set/Get the number of threads parsing the headers of the files of the
+   * directory. The default is the global default number of threads of
+   * MultiThreader. */
+  itkSetClampMacro(NumberOfThreads, int, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, int);
+
+  /** Keep the headers parsed in a cache shared by all the instances, and
+   * reuse them for the files whose size and modification time have not
+   * changed since. This makes scanning the same directory again nearly
+   * free, at the cost of keeping the headers in memory until
+   * ReleaseHeaderCache() is called. Defaults to false. */
+  itkSetMacro(UseHeaderCache, bool);
+  itkGetConstMacro(UseHeaderCache, bool);
+  itkBooleanMacro(UseHeaderCache);
+
+  /** Remove all the headers from the cache. */
+  static void ReleaseHeaderCache();
+
 protected:
   GDCMSeriesFileNames();
   ~GDCMSeriesFileNames();
@@ -176,6 +202,10 @@ private:
   GDCMSeriesFileNames(const Self &); //purposely not implemented
   void operator=(const Self &);      //purposely not implemented
 
+  /** Parse the headers of the files of the directory and group them in
+   * series */
+  void ScanDirectory(const std::string & name);
+
   /** Contains the input directory where the DICOM serie is found */
   std::string m_InputDirectory;
 
@@ -196,6 +226,8 @@ private:
   bool m_Recursive;
   bool m_LoadSequences;
   bool m_LoadPrivateTags;
+  int  m_NumberOfThreads;
+  bool m_UseHeaderCache;
 };
 } //namespace ITK
 
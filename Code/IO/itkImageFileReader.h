@@ -141,6 +141,21 @@ public:
   itkSetMacro(UseStreaming, bool);
   itkGetConstReferenceMacro(UseStreaming, bool);
   itkBooleanMacro(UseStreaming);
+
+  /** Set/Get whether the pixels may be memory mapped instead of read.
+   * When on, and the ImageIO can memory map the file
+   * (ImageIOBase::CanMemoryMapRead()), the file holds the pixels of the
+   * output type in the byte order of this machine and the region to read
+   * is one contiguous block of the file, the pixel container of the
+   * output points directly at the mapped file: the pixels are loaded by
+   * the operating system when they are first touched, and nothing is
+   * copied. Otherwise the file is read as usual. The mapping is private,
+   * so modifying the output does not modify the file; the file must not
+   * be truncated or rewritten while the output holds it. Default is
+   * off. */
+  itkSetMacro(UseMemoryMapping, bool);
+  itkGetConstMacro(UseMemoryMapping, bool);
+  itkBooleanMacro(UseMemoryMapping);
 protected:
   ImageFileReader();
   ~ImageFileReader();
@@ -167,10 +182,16 @@ protected:
   std::string m_FileName; // The file to be read
 
   bool m_UseStreaming;
+
+  bool m_UseMemoryMapping;
 private:
   ImageFileReader(const Self &); //purposely not implemented
   void operator=(const Self &);  //purposely not implemented
 
+  /** Point the output at the memory mapped pixels of the file, if
+   * possible. Returns false if the file must be read. */
+  bool MapPixelsIntoOutput();
+
   std::string m_ExceptionMessage;
 
   // The region that the ImageIO class will return when we ask to
@@ -21,6 +21,8 @@
 #include "itkObjectFactory.h"
 #include "itkImageIOFactory.h"
 #include "itkConvertPixelBuffer.h"
+#include "itkMemoryMappedImportImageContainer.h"
+#include "itkPixelBufferTraits.h"
 #include "itkImageRegion.h"
 #include "itkPixelTraits.h"
 #include "itkVectorImage.h"
@@ -38,6 +40,7 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
   m_FileName = "";
   m_UserSpecifiedImageIO = false;
   m_UseStreaming = true;
+  m_UseMemoryMapping = false;
 }
 
 template< class TOutputImage, class ConvertPixelTraits >
@@ -64,6 +67,7 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
   os << indent << "UserSpecifiedImageIO flag: " << m_UserSpecifiedImageIO << "\n";
   os << indent << "m_FileName: " << m_FileName << "\n";
   os << indent << "m_UseStreaming: " << m_UseStreaming << "\n";
+  os << indent << "m_UseMemoryMapping: " << m_UseMemoryMapping << "\n";
 }
 
 template< class TOutputImage, class ConvertPixelTraits >
@@ -352,13 +356,6 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
 {
   typename TOutputImage::Pointer output = this->GetOutput();
 
-  itkDebugMacro (<< "ImageFileReader::GenerateData() \n"
-                 << "Allocating the buffer with the EnlargedRequestedRegion \n"
-                 << output->GetRequestedRegion() << "\n");
-
-  // allocated the output image to the size of the enlarge requested region
-  this->AllocateOutputs();
-
   // Test if the file exists and if it can be opened.
   // An exception will be thrown otherwise, since we can't
   // successfully read the file. We catch the exception because some
@@ -381,6 +378,18 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
   itkDebugMacro (<< "Setting imageIO IORegion to: " << m_ActualIORegion);
   m_ImageIO->SetIORegion(m_ActualIORegion);
 
+  if ( m_UseMemoryMapping && this->MapPixelsIntoOutput() )
+    {
+    return;
+    }
+
+  itkDebugMacro (<< "ImageFileReader::GenerateData() \n"
+                 << "Allocating the buffer with the EnlargedRequestedRegion \n"
+                 << output->GetRequestedRegion() << "\n");
+
+  // allocated the output image to the size of the enlarge requested region
+  this->AllocateOutputs();
+
   char *loadBuffer = 0;
   // the size of the buffer is computed based on the actual number of
   // pixels to be read and the actual size of the pixels to be read
@@ -459,6 +468,83 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
     }
 }
 
+template< class TOutputImage, class ConvertPixelTraits >
+bool
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::MapPixelsIntoOutput()
+{
+  typedef typename TOutputImage::PixelContainer PixelContainerType;
+  typedef MemoryMappedImportImageContainer< typename PixelContainerType::ElementIdentifier,
+                                            typename PixelContainerType::Element >
+  MappedPixelContainerType;
+
+  typename TOutputImage::Pointer output = this->GetOutput();
+
+  // The pixels of the file must be the pixels of the output, byte for byte
+  const size_t pixelSize = m_ImageIO->GetComponentSize() * m_ImageIO->GetNumberOfComponents();
+  if ( !PixelBufferTraits< TOutputImage >::IsDirect
+       || m_ImageIO->GetComponentTypeInfo() != typeid( ITK_TYPENAME ConvertPixelTraits::ComponentType )
+       || m_ImageIO->GetNumberOfComponents() != ConvertPixelTraits::GetNumberOfComponents()
+       || pixelSize != sizeof( OutputImagePixelType )
+       || m_ActualIORegion.GetNumberOfPixels() != output->GetRequestedRegion().GetNumberOfPixels()
+       || m_ActualIORegion.GetNumberOfPixels() == 0
+       || !m_ImageIO->CanMemoryMapRead() )
+    {
+    return false;
+    }
+
+  // The region must be one contiguous block of the file: once a
+  // dimension does not span the whole file, the next ones have size 1
+  ImageIOBase::SizeType offset = 0;
+  ImageIOBase::SizeType stride = 1;
+  bool                  spansFile = true;
+  for ( unsigned int i = 0; i < m_ActualIORegion.GetImageDimension(); i++ )
+    {
+    const ImageIOBase::SizeType fileSize =
+      ( i < m_ImageIO->GetNumberOfDimensions() ) ? m_ImageIO->GetDimensions(i) : 1;
+    const ImageIOBase::SizeType size = m_ActualIORegion.GetSize(i);
+    if ( !spansFile && size != 1 )
+      {
+      return false;
+      }
+    spansFile = ( size == fileSize );
+    offset += m_ActualIORegion.GetIndex(i) * stride;
+    stride *= fileSize;
+    }
+
+  const ImageIOBase::SizeType dataOffset =
+    m_ImageIO->GetPixelDataOffset() + offset * static_cast< ImageIOBase::SizeType >( pixelSize );
+  const ImageIOBase::SizeType numberOfBytes =
+    m_ActualIORegion.GetNumberOfPixels() * static_cast< ImageIOBase::SizeType >( pixelSize );
+  if ( dataOffset % m_ImageIO->GetComponentSize() != 0
+       || static_cast< ImageIOBase::SizeType >( static_cast< size_t >( numberOfBytes ) ) != numberOfBytes )
+    {
+    // misaligned pixels, or too large for the address space
+    return false;
+    }
+
+  MemoryMappedFile::Pointer mappedFile = MemoryMappedFile::New();
+  try
+    {
+    mappedFile->Map(m_ImageIO->GetPixelDataFileName(), dataOffset,
+                    static_cast< size_t >( numberOfBytes ) );
+    }
+  catch ( ExceptionObject & err )
+    {
+    itkDebugMacro(<< "Reading instead of memory mapping: " << err.GetDescription());
+    return false;
+    }
+
+  itkDebugMacro(<< "Memory mapped " << numberOfBytes << " bytes of "
+                << m_ImageIO->GetPixelDataFileName() << " at offset " << dataOffset);
+
+  typename MappedPixelContainerType::Pointer container = MappedPixelContainerType::New();
+  container->SetMemoryMappedFile( mappedFile, m_ActualIORegion.GetNumberOfPixels() );
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->SetPixelContainer(container);
+  return true;
+}
+
 template< class TOutputImage, class ConvertPixelTraits >
 void
 ImageFileReader< TOutputImage, ConvertPixelTraits >
@@ -22,6 +22,7 @@
 #include "itkExceptionObject.h"
 #include "itkSize.h"
 #include "itkImageIORegion.h"
+#include "itkNumericTraits.h"
 
 namespace itk
 {
@@ -149,6 +150,15 @@ public:
   itkSetMacro(NumberOfStreamDivisions, unsigned int);
   itkGetConstReferenceMacro(NumberOfStreamDivisions, unsigned int);
 
+  /** Set/Get the largest number of pieces requested from the upstream
+   * pipeline and not written yet, including the piece being written.
+   * The default, 1, updates the pipeline for a piece once the previous
+   * one is written; with 2 or more, the next pieces are computed on
+   * another thread while the previous ones are written (see
+   * StreamingPrefetcher). */
+  itkSetClampMacro(NumberOfPiecesInFlight, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfPiecesInFlight, unsigned int);
+
   /** Aliased to the Write() method to be consistent with the rest of the
    * pipeline. */
   virtual void Update()
@@ -178,6 +188,9 @@ protected:
   /** Does the real work. */
   void GenerateData(void);
 
+  /** Write the IORegion of image, the input or a piece of it. */
+  void WritePiece(const InputImageType *image);
+
 private:
   ImageFileWriter(const Self &); //purposely not implemented
   void operator=(const Self &);  //purposely not implemented
@@ -190,6 +203,7 @@ private:
 
   ImageIORegion m_PasteIORegion;
   unsigned int  m_NumberOfStreamDivisions;
+  unsigned int  m_NumberOfPiecesInFlight;
   bool          m_UserSpecifiedIORegion;    // track whether the region
                                             // is user specified
   bool m_FactorySpecifiedImageIO;           //track whether the factory
@@ -26,6 +26,7 @@
 #include "itkVectorImage.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
+#include "itkStreamingPrefetcher.h"
 
 namespace itk
 {
@@ -41,6 +42,7 @@ ImageFileWriter< TInputImage >
   m_UserSpecifiedIORegion = false;
   m_UserSpecifiedImageIO = false;
   m_NumberOfStreamDivisions = 1;
+  m_NumberOfPiecesInFlight = 1;
 }
 
 //---------------------------------------------------------
@@ -274,43 +276,56 @@ ImageFileWriter< TInputImage >
                                                               largestIORegion);
 
   /**
-   * Loop over the number of pieces, execute the upstream pipeline on each
-   * piece, and copy the results into the output image.
+   * Determine the pieces, then loop over them, execute the upstream
+   * pipeline on each piece, and write the results. The prefetcher
+   * executes the pipeline, ahead of the writing if pieces may be in
+   * flight.
    */
-  unsigned int piece;
+  typedef StreamingPrefetcher< InputImageType > PrefetcherType;
+  std::vector< ImageIORegion >            streamIORegions(numDivisions);
+  typename PrefetcherType::RegionListType streamRegions(numDivisions);
+  unsigned int                            piece;
 
-  for ( piece = 0;
-        piece < numDivisions && !this->GetAbortGenerateData();
-        piece++ )
+  for ( piece = 0; piece < numDivisions; piece++ )
     {
     // get the actual piece to write
-    ImageIORegion streamIORegion = m_ImageIO->GetSplitRegionForWriting(piece, numDivisions,
-                                                                       pasteIORegion, largestIORegion);
+    streamIORegions[piece] = m_ImageIO->GetSplitRegionForWriting(piece, numDivisions,
+                                                                 pasteIORegion, largestIORegion);
 
     // Check whether the paste region is fully contained inside the
     // largest region or not.
-    if ( !pasteIORegion.IsInside(streamIORegion) )
+    if ( !pasteIORegion.IsInside(streamIORegions[piece]) )
       {
       itkExceptionMacro(
         << "ImageIO returns streamable region that is not fully contain in paste IO region"
         << "Paste IO region: " << pasteIORegion
-        << "Streamable region: " << streamIORegion);
+        << "Streamable region: " << streamIORegions[piece]);
       }
 
-    InputImageRegionType streamRegion;
     ImageIORegionAdaptor< TInputImage::ImageDimension >::
-    Convert( streamIORegion, streamRegion, largestRegion.GetIndex() );
+    Convert( streamIORegions[piece], streamRegions[piece], largestRegion.GetIndex() );
+    }
+
+  typename PrefetcherType::Pointer prefetcher = PrefetcherType::New();
+  prefetcher->SetInput(nonConstInput);
+  prefetcher->SetNumberOfPiecesInFlight(m_NumberOfPiecesInFlight);
+  prefetcher->Start(streamRegions);
+
+  for ( piece = 0;
+        piece < numDivisions && !this->GetAbortGenerateData();
+        piece++ )
+    {
+    ImageIORegion        streamIORegion = streamIORegions[piece];
+    InputImageRegionType streamRegion = streamRegions[piece];
 
     // execute the the upstream pipeline with the requested
     // region for streaming
-    nonConstInput->SetRequestedRegion(streamRegion);
-    nonConstInput->PropagateRequestedRegion();
-    nonConstInput->UpdateOutputData();
+    InputImagePointer pieceImage = prefetcher->GetNextPiece();
 
     // check to see if we tried to stream but got the largest possible region
     if ( piece == 0 && streamRegion != largestRegion )
       {
-      InputImageRegionType bufferedRegion = input->GetBufferedRegion();
+      InputImageRegionType bufferedRegion = pieceImage->GetBufferedRegion();
       if ( bufferedRegion == largestRegion )
         {
         // if so, then just write the entire image
@@ -320,16 +335,18 @@ ImageFileWriter< TInputImage >
         streamRegion = largestRegion;
         ImageIORegionAdaptor< TInputImage::ImageDimension >::
         Convert( streamRegion, streamIORegion, largestRegion.GetIndex() );
+        prefetcher->Stop();
         }
       }
 
     m_ImageIO->SetIORegion(streamIORegion);
 
     // write the data
-    this->GenerateData();
+    this->WritePiece(pieceImage);
 
     this->UpdateProgress( (float)( piece + 1 ) / numDivisions );
     }
+  prefetcher->Stop();
 
   // Notify end event observers
   this->InvokeEvent( EndEvent() );
@@ -344,7 +361,15 @@ void
 ImageFileWriter< TInputImage >
 ::GenerateData(void)
 {
-  const InputImageType *input = this->GetInput();
+  this->WritePiece( this->GetInput() );
+}
+
+//---------------------------------------------------------
+template< class TInputImage >
+void
+ImageFileWriter< TInputImage >
+::WritePiece(const InputImageType *input)
+{
   InputImageRegionType  largestRegion = input->GetLargestPossibleRegion();
   InputImagePointer     cacheImage;
 
@@ -428,6 +453,7 @@ ImageFileWriter< TInputImage >
 
   os << indent << "IO Region: " << m_PasteIORegion << "\n";
   os << indent << "Number of Stream Divisions: " << m_NumberOfStreamDivisions << "\n";
+  os << indent << "Number of Pieces In Flight: " << m_NumberOfPiecesInFlight << "\n";
 
   if ( m_UseCompression )
     {
@@ -36,7 +36,10 @@ ImageIOBase::ImageIOBase():
   m_ComponentType(UNKNOWNCOMPONENTTYPE),
   m_ByteOrder(OrderNotApplicable),
   m_FileType(TypeNotApplicable),
-  m_NumberOfDimensions(0)
+  m_NumberOfDimensions(0),
+  m_CompressionLevel(6),
+  m_NumberOfThreads(1),
+  m_PixelDataOffset(0)
 {
   Reset(false);
 }
@@ -942,30 +945,63 @@ void ImageIOBase::ReadBufferAsASCII(std::istream & is, void *buffer,
     }
 }
 
+namespace
+{
+// Find the outermost dimension of region spanning more than one chunk,
+// and the chunks it spans along it. Returns -1 if the region is a
+// single chunk.
+int GetChunkSplitAxis(const ImageIORegion & region,
+                      const ImageIORegion::SizeType & chunkSize,
+                      ImageIORegion::SizeValueType & chunk,
+                      ImageIORegion::IndexValueType & firstChunk,
+                      ImageIORegion::SizeValueType & numberOfChunks)
+{
+  const ImageIORegion::IndexType & regionIndex = region.GetIndex();
+  const ImageIORegion::SizeType &  regionSize = region.GetSize();
+
+  for ( int axis = region.GetImageDimension() - 1; axis >= 0; --axis )
+    {
+    chunk = 1;
+    if ( static_cast< unsigned int >( axis ) < chunkSize.size() && chunkSize[axis] > 0 )
+      {
+      chunk = chunkSize[axis];
+      }
+    const ImageIORegion::IndexValueType chunkLength =
+      static_cast< ImageIORegion::IndexValueType >( chunk );
+    const ImageIORegion::IndexValueType end =
+      regionIndex[axis] + static_cast< ImageIORegion::IndexValueType >( regionSize[axis] );
+    firstChunk = regionIndex[axis] / chunkLength;
+    numberOfChunks = ( end + chunkLength - 1 ) / chunkLength - firstChunk;
+    if ( numberOfChunks > 1 )
+      {
+      return axis;
+      }
+    }
+  return -1;
+}
+}
+
 unsigned int
 ImageIOBase::GetActualNumberOfSplitsForWritingCanStreamWrite(unsigned int numberOfRequestedSplits,
                                                              const ImageIORegion & pasteRegion) const
 {
-  // Code from ImageRegionSplitter:GetNumberOfSplits
-  int                             splitAxis;
-  const ImageIORegion::SizeType & regionSize = pasteRegion.GetSize();
+  // Code from ImageRegionChunkSplitter:GetNumberOfSplits
+  ImageIORegion::SizeValueType  chunk;
+  ImageIORegion::IndexValueType firstChunk;
+  ImageIORegion::SizeValueType  numberOfChunks;
 
   // split on the outermost dimension available
-  splitAxis = pasteRegion.GetImageDimension() - 1;
-  while ( regionSize[splitAxis] == 1 )
-    {
-    --splitAxis;
-    if ( splitAxis < 0 )
-      { // cannot split
-      itkDebugMacro("  Cannot Split");
-      return 1;
-      }
+  const int splitAxis = GetChunkSplitAxis(pasteRegion, this->GetChunkSize(),
+                                          chunk, firstChunk, numberOfChunks);
+  if ( splitAxis < 0 )
+    { // cannot split
+    itkDebugMacro("  Cannot Split");
+    return 1;
     }
 
   // determine the actual number of pieces that will be generated
-  ImageIORegion::SizeType::value_type range = regionSize[splitAxis];
-  int                                 valuesPerPiece = Math::Ceil< int >( range / double(numberOfRequestedSplits) );
-  int                                 maxPieceUsed = Math::Ceil< int >( range / double(valuesPerPiece) ) - 1;
+  int chunksPerPiece = Math::Ceil< int >( numberOfChunks / double(numberOfRequestedSplits) );
+  int maxPieceUsed = Math::Ceil< int >( numberOfChunks / double(chunksPerPiece) ) - 1;
 
   return maxPieceUsed + 1;
 }
@@ -996,52 +1032,48 @@ ImageIOBase::GetSplitRegionForWritingCanStreamWrite(unsigned int ithPiece,
                                                     unsigned int numberOfActualSplits,
                                                     const ImageIORegion & pasteRegion) const
 {
-  // Code from ImageRegionSplitter:GetSplit
-  int                      splitAxis;
-  ImageIORegion            splitRegion;
-  ImageIORegion::IndexType splitIndex;
-  ImageIORegion::SizeType  splitSize, regionSize;
-
-  // Initialize the splitRegion to the requested region
-  splitRegion = pasteRegion;
-  splitIndex = splitRegion.GetIndex();
-  splitSize = splitRegion.GetSize();
-
-  regionSize = pasteRegion.GetSize();
+  // Code from ImageRegionChunkSplitter:GetSplit
+  ImageIORegion                 splitRegion = pasteRegion;
+  ImageIORegion::SizeValueType  chunk;
+  ImageIORegion::IndexValueType firstChunk;
+  ImageIORegion::SizeValueType  numberOfChunks;
 
   // split on the outermost dimension available
-  splitAxis = pasteRegion.GetImageDimension() - 1;
-  while ( regionSize[splitAxis] == 1 )
-    {
-    --splitAxis;
-    if ( splitAxis < 0 )
-      { // cannot split
-      itkDebugMacro("  Cannot Split");
-      return splitRegion;
-      }
+  const int splitAxis = GetChunkSplitAxis(pasteRegion, this->GetChunkSize(),
+                                          chunk, firstChunk, numberOfChunks);
+  if ( splitAxis < 0 )
+    { // cannot split
+    itkDebugMacro("  Cannot Split");
+    return splitRegion;
     }
 
   // determine the actual number of pieces that will be generated
-  ImageIORegion::SizeType::value_type range = regionSize[splitAxis];
-  int                                 valuesPerPiece = Math::Ceil< int >(range / (double)numberOfActualSplits);
-  int                                 maxPieceUsed = Math::Ceil< int >(range / (double)valuesPerPiece) - 1;
-
-  // Split the region
-  if ( (int)ithPiece < maxPieceUsed )
+  int chunksPerPiece = Math::Ceil< int >(numberOfChunks / (double)numberOfActualSplits);
+  int maxPieceUsed = Math::Ceil< int >(numberOfChunks / (double)chunksPerPiece) - 1;
+
+  // Split the region at the chunk boundaries; the first and last pieces
+  // are clipped to the region
+  const ImageIORegion::IndexValueType chunkLength =
+    static_cast< ImageIORegion::IndexValueType >( chunk );
+  const ImageIORegion::IndexValueType regionStart = pasteRegion.GetIndex(splitAxis);
+  const ImageIORegion::IndexValueType regionEnd =
+    regionStart + static_cast< ImageIORegion::IndexValueType >( pasteRegion.GetSize(splitAxis) );
+  ImageIORegion::IndexValueType start =
+    ( firstChunk + (int)ithPiece * chunksPerPiece ) * chunkLength;
+  ImageIORegion::IndexValueType end = start + chunksPerPiece * chunkLength;
+  if ( (int)ithPiece >= maxPieceUsed || end > regionEnd )
     {
-    splitIndex[splitAxis] += ithPiece * valuesPerPiece;
-    splitSize[splitAxis] = valuesPerPiece;
+    // last piece needs to process the "rest" dimension being split
+    end = regionEnd;
     }
-  if ( (int)ithPiece == maxPieceUsed )
+  if ( start < regionStart )
     {
-    splitIndex[splitAxis] += ithPiece * valuesPerPiece;
-    // last piece needs to process the "rest" dimension being split
-    splitSize[splitAxis] = splitSize[splitAxis] - ithPiece * valuesPerPiece;
+    start = regionStart;
     }
 
   // set the split region ivars
-  splitRegion.SetIndex(splitIndex);
-  splitRegion.SetSize(splitSize);
+  splitRegion.SetIndex(splitAxis, start);
+  splitRegion.SetSize( splitAxis, static_cast< ImageIORegion::SizeValueType >( end - start ) );
 
   itkDebugMacro("  Split Piece: " << splitRegion);
 
@@ -1061,6 +1093,12 @@ ImageIOBase::GetSplitRegionForWriting(unsigned int ithPiece,
   return largestPossibleRegion;
 }
 
+ImageIORegion::SizeType
+ImageIOBase::GetChunkSize() const
+{
+  return ImageIORegion::SizeType();
+}
+
 /** Given a requested region, determine what could be the region that we can
  * read from the file. This is called the streamable region, which will be
  * smaller than the LargestPossibleRegion and greater or equal to the
@@ -1176,6 +1214,8 @@ void ImageIOBase::PrintSelf(std::ostream & os, Indent indent) const
     {
     os << indent << "UseCompression: Off" << std::endl;
     }
+  os << indent << "CompressionLevel: " << m_CompressionLevel << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
   if ( m_UseStreamedReading )
     {
     os << indent << "UseStreamedReading: On" << std::endl;
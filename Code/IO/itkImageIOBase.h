@@ -21,6 +21,7 @@
 #include "itkObjectFactory.h"
 #include "itkIndent.h"
 #include "itkImageIORegion.h"
+#include "itkMultiThreader.h"
 #include "vnl/vnl_vector.h"
 
 #include <string>
@@ -184,6 +185,22 @@ public:
   itkGetConstMacro(UseCompression, bool);
   itkBooleanMacro(UseCompression);
 
+  /** Set/Get the level of the compression, from 0 (none) to 9
+   * (smallest), for the ImageIOs that compress with zlib. The default is
+   * 6, as in zlib. */
+  itkSetClampMacro(CompressionLevel, int, 0, 9);
+  itkGetConstMacro(CompressionLevel, int);
+
+  /** Set/Get the number of threads the ImageIO may use to code the data.
+   * The MetaImage, NRRD and NIfTI ImageIOs compress the data with
+   * ParallelDeflate when it is more than one, which writes another zlib
+   * or gzip stream than the library of the format. The default is 1, so
+   * that the files are written by the library unless the threads are
+   * asked for; ImageIOs whose files do not depend on the number of
+   * threads may raise it. */
+  itkSetClampMacro(NumberOfThreads, int, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, int);
+
   /** Set/Get a boolean to use streaming while reading or not. */
   itkSetMacro(UseStreamedReading, bool);
   itkGetConstMacro(UseStreamedReading, bool);
@@ -299,6 +316,22 @@ public:
     return false;
   }
 
+  /** Determine if the pixel data of the file can be memory mapped
+   * instead of read. True when the whole image is stored uncompressed,
+   * as one block of pixels laid out as Read() would return them and in
+   * the byte order of this machine; the block then starts
+   * GetPixelDataOffset() bytes into GetPixelDataFileName(). Must be
+   * called after ReadImageInformation(). Default is false. */
+  virtual bool CanMemoryMapRead()
+  {
+    return false;
+  }
+
+  /** File holding the pixel data, and offset in bytes of the first pixel
+   * in it. Only meaningful when CanMemoryMapRead() returns true. */
+  itkGetStringMacro(PixelDataFileName);
+  itkGetConstMacro(PixelDataOffset, SizeType);
+
   /** Read the spacing and dimentions of the image.
    * Assumes SetFileName has been called with a valid file name. */
   virtual void ReadImageInformation() = 0;
@@ -357,6 +390,18 @@ public:
   virtual ImageIORegion
   GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const;
 
+  /** Size of the blocks the pixels of the file are stored in, such as
+   * the tiles or strips of a TIFF file or the compressed slabs of a
+   * MetaImage: a region made of whole blocks is read or written without
+   * touching the pixels around it. It has an element per dimension of
+   * the file, or none when the file has no such layout, which is the
+   * default. Valid after ReadImageInformation(), or once the image
+   * information is set for writing.
+   *
+   * The default splitting for writing cuts the pieces along the blocks,
+   * and ImageRegionChunkSplitter does the same for StreamingImageFilter. */
+  virtual ImageIORegion::SizeType GetChunkSize() const;
+
   /** Before this method is called all the configuration will be done,
    * that is Streaming/PasteRegion/Compression/Filename etc
    * If pasting is being used the number of requested splits is for that
@@ -434,12 +479,21 @@ protected:
   /** Should we compress the data? */
   bool m_UseCompression;
 
+  /** Level of the compression and number of threads doing it */
+  int m_CompressionLevel;
+  int m_NumberOfThreads;
+
   /** Should we use streaming for reading */
   bool m_UseStreamedReading;
 
   /** Should we use streaming for writing */
   bool m_UseStreamedWriting;
 
+  /** File and offset of the pixel data, set by the ImageIOs whose
+   * CanMemoryMapRead() may return true. */
+  std::string m_PixelDataFileName;
+  SizeType    m_PixelDataOffset;
+
   /** The region to read or write. The region contains information about the
    * data within the region to read or write. */
   ImageIORegion m_IORegion;
@@ -511,12 +565,14 @@ protected:
   /** Insert an extension to the list of supported extensions for writing. */
   void AddSupportedWriteExtension(const char *extension);
 
-  /** an implementation of ImageRegionSplitter:GetNumberOfSplits
+  /** an implementation of ImageRegionSplitter:GetNumberOfSplits, whose
+   * pieces are made of whole chunks (see GetChunkSize())
    */
   virtual unsigned int GetActualNumberOfSplitsForWritingCanStreamWrite(unsigned int numberOfRequestedSplits,
                                                                        const ImageIORegion & pasteRegion) const;
 
-  /** an implementation of  ImageRegionSplitter:GetSplit
+  /** an implementation of  ImageRegionSplitter:GetSplit, whose pieces
+   * are made of whole chunks (see GetChunkSize())
    */
   virtual ImageIORegion GetSplitRegionForWritingCanStreamWrite(unsigned int ithPiece,
                                                                unsigned int numberOfActualSplits,
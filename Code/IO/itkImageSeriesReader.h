@@ -26,6 +26,7 @@
 #include <string>
 #include "itkMetaDataDictionary.h"
 #include "itkImageFileReader.h"
+#include "itkSimpleFastMutexLock.h"
 
 namespace itk
 {
@@ -156,9 +157,29 @@ public:
   itkSetMacro(UseStreaming, bool);
   itkGetConstReferenceMacro(UseStreaming, bool);
   itkBooleanMacro(UseStreaming);
+
+  /** Set/Get whether the files are read concurrently. When on, up to
+   * NumberOfThreads files (see ProcessObject::SetNumberOfThreads()) are
+   * decoded at the same time, which bounds the memory used by the
+   * decoders, each thread taking the next unread file when it is done
+   * with its current one. Only the files intersecting the requested
+   * region are read, as in the sequential mode.
+   *
+   * In both modes the pixels of a file are decoded directly into their
+   * slab of the output buffer, without an intermediate copy, unless a
+   * pixel type conversion or a larger read than requested is needed.
+   *
+   * Each thread uses its own ImageIO, created by the factory for each
+   * file. The settings of an ImageIO given with SetImageIO() cannot be
+   * carried over to other instances, so the files are read sequentially
+   * with it in that case. Off by default. */
+  itkSetMacro(ParallelReading, bool);
+  itkGetConstMacro(ParallelReading, bool);
+  itkBooleanMacro(ParallelReading);
 protected:
   ImageSeriesReader():m_ImageIO(0), m_ReverseOrder(false),
-    m_UseStreaming(true), m_MetaDataDictionaryArrayUpdate(true) {}
+    m_UseStreaming(true), m_MetaDataDictionaryArrayUpdate(true),
+    m_ParallelReading(false) {}
   ~ImageSeriesReader();
   void PrintSelf(std::ostream & os, Indent indent) const;
 
@@ -194,11 +215,35 @@ private:
 
   int ComputeMovingDimensionIndex(ReaderType *reader);
 
+  /** Read file i of the series into its slab of the output, or only its
+   * meta data if the slab is outside the requested region. The
+   * dictionary of the file is returned in dictionary when needed. */
+  void ReadSlice(int i, ImageIOBase *imageIO, bool needDictionary,
+                 DictionaryRawPointer & dictionary);
+
+  /** Shared state of the threads reading the files. */
+  struct ParallelReadingStruct {
+    Self *Reader;
+    int NumberOfFiles;
+    int NextSlice;
+    int NumberOfCompletedSlices;
+    bool NeedDictionaries;
+    DictionaryArrayType Dictionaries;
+    SimpleFastMutexLock Lock;
+    bool ExceptionOccurred;
+    ExceptionObject Exception;
+  };
+
+  /** Threads take the next unread file until all are read. */
+  static ITK_THREAD_RETURN_TYPE ParallelReadingThreaderCallback(void *arg);
+
   /** Modified time of the MetaDataDictionaryArray */
   TimeStamp m_MetaDataDictionaryArrayMTime;
 
   /** Indicated if the MMDA should be updated */
   bool m_MetaDataDictionaryArrayUpdate;
+
+  bool m_ParallelReading;
 };
 } //namespace ITK
 
@@ -25,8 +25,8 @@
 #include "itkExceptionObject.h"
 #include "itkArray.h"
 #include "vnl/vnl_math.h"
-#include "itkProgressReporter.h"
 #include "itkMetaDataObject.h"
+#include "itkPixelBufferTraits.h"
 
 namespace itk
 {
@@ -68,6 +68,7 @@ void ImageSeriesReader< TOutputImage >
 
   os << indent << "MetaDataDictionaryArrayMTime: " <<  m_MetaDataDictionaryArrayMTime  << std::endl;
   os << indent << "MetaDataDictionaryArrayUpdate: " << m_MetaDataDictionaryArrayUpdate << std::endl;
+  os << indent << "ParallelReading: " << m_ParallelReading << std::endl;
 }
 
 template< class TOutputImage >
@@ -269,32 +270,11 @@ void ImageSeriesReader< TOutputImage >
   TOutputImage *output = this->GetOutput();
 
   ImageRegionType requestedRegion = output->GetRequestedRegion();
-  ImageRegionType largestRegion = output->GetLargestPossibleRegion();
-  ImageRegionType sliceRegionToRequest = output->GetRequestedRegion();
-
-  // Each file must have the same size.
-  SizeType validSize = largestRegion.GetSize();
-
-  // If more than one file is being read, then the input dimension
-  // will be less than the output dimension.  In this case, set
-  // the last dimension that is other than 1 of validSize to 1.  However, if the
-  // input and output have the same number of dimensions, this should
-  // not be done because it will lower the dimension of the output image.
-  if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
-    {
-    validSize[this->m_NumberOfDimensionsInImage] = 1;
-    sliceRegionToRequest.SetSize(this->m_NumberOfDimensionsInImage, 1);
-    sliceRegionToRequest.SetIndex(this->m_NumberOfDimensionsInImage, 0);
-    }
 
   // Allocate the output buffer
   output->SetBufferedRegion(requestedRegion);
   output->Allocate();
 
-  ProgressReporter progress(this, 0,
-                            requestedRegion.GetNumberOfPixels(),
-                            100);
-
   // We utilize the modified time of the output information to
   // know when the meta array needs to be updated, when the output
   // information is updated so should the meta array.
@@ -304,58 +284,220 @@ void ImageSeriesReader< TOutputImage >
     this->m_OutputInformationMTime > this->m_MetaDataDictionaryArrayMTime
     && m_MetaDataDictionaryArrayUpdate;
 
-  ImageRegionIterator< TOutputImage > ot (output, requestedRegion);
-  IndexType                           sliceStartIndex = requestedRegion.GetIndex();
-  const int                           numberOfFiles = static_cast< int >( m_FileNames.size() );
-  for ( int i = 0; i != numberOfFiles; ++i )
+  const int numberOfFiles = static_cast< int >( m_FileNames.size() );
+
+  // The dictionaries are collected per file, then appended in file order
+  DictionaryArrayType dictionaries(numberOfFiles, static_cast< DictionaryRawPointer >( 0 ) );
+
+  int numberOfThreads = this->GetNumberOfThreads();
+  if ( numberOfThreads > numberOfFiles )
+    {
+    numberOfThreads = numberOfFiles;
+    }
+
+  // The ImageIO set by the user is not thread safe and its settings
+  // cannot be given to other instances: it reads every file.
+  if ( !m_ParallelReading || numberOfThreads < 2 || m_ImageIO
+       || TOutputImage::ImageDimension == this->m_NumberOfDimensionsInImage )
     {
-    if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
+    try
       {
-      sliceStartIndex[this->m_NumberOfDimensionsInImage] = i;
+      for ( int i = 0; i != numberOfFiles; ++i )
+        {
+        this->ReadSlice(i, m_ImageIO, needToUpdateMetaDataDictionaryArray, dictionaries[i]);
+        this->UpdateProgress( static_cast< float >( i + 1 ) / numberOfFiles );
+        }
       }
+    catch ( ... )
+      {
+      for ( unsigned int i = 0; i < dictionaries.size(); i++ )
+        {
+        delete dictionaries[i];
+        }
+      throw;
+      }
+    }
+  else
+    {
+    ParallelReadingStruct str;
+    str.Reader = this;
+    str.NumberOfFiles = numberOfFiles;
+    str.NextSlice = 0;
+    str.NumberOfCompletedSlices = 0;
+    str.NeedDictionaries = needToUpdateMetaDataDictionaryArray;
+    str.ExceptionOccurred = false;
+    str.Dictionaries = dictionaries;
+
+    this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+    this->GetMultiThreader()->SetSingleMethod(this->ParallelReadingThreaderCallback, &str);
+    try
+      {
+      this->GetMultiThreader()->SingleMethodExecute();
+      if ( str.ExceptionOccurred )
+        {
+        throw str.Exception;
+        }
+      }
+    catch ( ... )
+      {
+      for ( unsigned int i = 0; i < str.Dictionaries.size(); i++ )
+        {
+        delete str.Dictionaries[i];
+        }
+      throw;
+      }
+    dictionaries = str.Dictionaries;
+    }
 
-    const bool insideRequestedRegion = requestedRegion.IsInside(sliceStartIndex);
-    const int  iFileName = ( m_ReverseOrder ? numberOfFiles - i - 1 : i );
-
-    // check if we need this slice
-    if ( !insideRequestedRegion && !needToUpdateMetaDataDictionaryArray )
+  for ( unsigned int i = 0; i < dictionaries.size(); i++ )
+    {
+    if ( dictionaries[i] )
       {
-      continue;
+      m_MetaDataDictionaryArray.push_back(dictionaries[i]);
       }
+    }
 
-    // configure reader
-    typename ReaderType::Pointer reader = ReaderType::New();
-    reader->SetFileName( m_FileNames[iFileName].c_str() );
-    if ( m_ImageIO )
+  // update the time if we modified the meta array
+  if ( needToUpdateMetaDataDictionaryArray )
+    {
+    m_MetaDataDictionaryArrayMTime.Modified();
+    }
+}
+
+template< class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+ImageSeriesReader< TOutputImage >
+::ParallelReadingThreaderCallback(void *arg)
+{
+  const int threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+
+  ParallelReadingStruct *str =
+    (ParallelReadingStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  while ( true )
+    {
+    str->Lock.Lock();
+    const int slice = str->NextSlice++;
+    const bool stop = ( slice >= str->NumberOfFiles || str->ExceptionOccurred );
+    str->Lock.Unlock();
+    if ( stop )
       {
-      reader->SetImageIO(m_ImageIO);
+      break;
       }
-    reader->SetUseStreaming(m_UseStreaming);
-    reader->GetOutput()->SetRequestedRegion(sliceRegionToRequest);
 
-    // update the data or info
-    if ( !insideRequestedRegion )
+    DictionaryRawPointer dictionary = 0;
+    try
       {
-      reader->UpdateOutputInformation();
+      // each file gets an ImageIO of its own from the factory
+      str->Reader->ReadSlice(slice, 0, str->NeedDictionaries, dictionary);
       }
-    else
+    catch ( ExceptionObject & e )
       {
-      reader->Update();
+      str->Lock.Lock();
+      if ( !str->ExceptionOccurred )
+        {
+        str->ExceptionOccurred = true;
+        str->Exception = e;
+        }
+      str->Lock.Unlock();
+      break;
       }
 
-    // Deep copy the MetaDataDictionary into the array
-    if ( reader->GetImageIO() &&  needToUpdateMetaDataDictionaryArray )
+    str->Lock.Lock();
+    str->Dictionaries[slice] = dictionary;
+    const int numberOfCompletedSlices = ++str->NumberOfCompletedSlices;
+    str->Lock.Unlock();
+
+    // the progress is reported from the thread that executes the filter
+    if ( threadId == 0 )
       {
-      DictionaryRawPointer newDictionary = new DictionaryType;
-      *newDictionary = reader->GetImageIO()->GetMetaDataDictionary();
-      m_MetaDataDictionaryArray.push_back(newDictionary);
+      str->Reader->UpdateProgress( static_cast< float >( numberOfCompletedSlices )
+                                   / str->NumberOfFiles );
       }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TOutputImage >
+void ImageSeriesReader< TOutputImage >
+::ReadSlice(int i, ImageIOBase *imageIO, bool needDictionary,
+            DictionaryRawPointer & dictionary)
+{
+  TOutputImage *output = this->GetOutput();
+
+  const ImageRegionType & requestedRegion = output->GetRequestedRegion();
+  ImageRegionType         largestRegion = output->GetLargestPossibleRegion();
+  ImageRegionType         sliceRegionToRequest = requestedRegion;
+
+  // Each file must have the same size.
+  SizeType validSize = largestRegion.GetSize();
+
+  // The region of the output filled by the file
+  ImageRegionType sliceRegionInOutput = requestedRegion;
 
-    // if we only needed the info continue to next slice
-    if ( !insideRequestedRegion )
+  // If more than one file is being read, then the input dimension
+  // will be less than the output dimension.  In this case, set
+  // the last dimension that is other than 1 of validSize to 1.  However, if the
+  // input and output have the same number of dimensions, this should
+  // not be done because it will lower the dimension of the output image.
+  if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
+    {
+    validSize[this->m_NumberOfDimensionsInImage] = 1;
+    sliceRegionToRequest.SetSize(this->m_NumberOfDimensionsInImage, 1);
+    sliceRegionToRequest.SetIndex(this->m_NumberOfDimensionsInImage, 0);
+    sliceRegionInOutput.SetSize(this->m_NumberOfDimensionsInImage, 1);
+    sliceRegionInOutput.SetIndex(this->m_NumberOfDimensionsInImage, i);
+    }
+
+  const bool insideRequestedRegion = requestedRegion.IsInside( sliceRegionInOutput.GetIndex() );
+  const int  numberOfFiles = static_cast< int >( m_FileNames.size() );
+  const int  iFileName = ( m_ReverseOrder ? numberOfFiles - i - 1 : i );
+
+  // check if we need this slice
+  if ( !insideRequestedRegion && !needDictionary )
+    {
+    return;
+    }
+
+  // configure reader
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( m_FileNames[iFileName].c_str() );
+  if ( imageIO )
+    {
+    reader->SetImageIO(imageIO);
+    }
+  reader->SetUseStreaming(m_UseStreaming);
+  reader->GetOutput()->SetRequestedRegion(sliceRegionToRequest);
+
+  // update the data or info
+  if ( !insideRequestedRegion )
+    {
+    reader->UpdateOutputInformation();
+    }
+  else
+    {
+    // When the slab of the file is contiguous in the output buffer, let
+    // the reader decode into it. The reader keeps this buffer when it
+    // allocates its output with the requested size; if it has to read a
+    // larger region it allocates a buffer of its own, copied below.
+    OutputImagePixelType *slab = 0;
+    if ( PixelBufferTraits< TOutputImage >::IsDirect )
       {
-      continue;
+      bool contiguous = true;
+      for ( unsigned int d = this->m_NumberOfDimensionsInImage + 1; d < TOutputImage::ImageDimension; ++d )
+        {
+        contiguous = contiguous && ( requestedRegion.GetSize(d) == 1 );
+        }
+      if ( contiguous )
+        {
+        slab = output->GetBufferPointer() + output->ComputeOffset( sliceRegionInOutput.GetIndex() );
+        reader->ReleaseDataBeforeUpdateFlagOff();
+        reader->GetOutput()->GetPixelContainer()->SetImportPointer(
+          slab, sliceRegionToRequest.GetNumberOfPixels(), false);
+        }
       }
+    reader->Update();
 
     if ( reader->GetOutput()->GetLargestPossibleRegion().GetSize() != validSize )
       {
@@ -369,24 +511,25 @@ void ImageSeriesReader< TOutputImage >
                          << m_FileNames[m_ReverseOrder ? m_FileNames.size() - 1 : 0].c_str() );
       }
 
-    // set the iterator for this slice
-    ot.SetIndex(sliceStartIndex);
-
-    ImageRegionConstIterator< TOutputImage > it (reader->GetOutput(),
-                                                 sliceRegionToRequest);
-    while ( !it.IsAtEnd() )
+    if ( reader->GetOutput()->GetBufferPointer() != slab )
       {
-      ot.Set( it.Get() );
-      ++it;
-      ++ot;
-      progress.CompletedPixel();
+      ImageRegionConstIterator< TOutputImage > it (reader->GetOutput(),
+                                                   sliceRegionToRequest);
+      ImageRegionIterator< TOutputImage > ot (output, sliceRegionInOutput);
+      while ( !it.IsAtEnd() )
+        {
+        ot.Set( it.Get() );
+        ++it;
+        ++ot;
+        }
       }
     }
 
-  // update the time if we modified the meta array
-  if ( needToUpdateMetaDataDictionaryArray )
+  // Deep copy the MetaDataDictionary
+  if ( reader->GetImageIO() && needDictionary )
     {
-    m_MetaDataDictionaryArrayMTime.Modified();
+    dictionary = new DictionaryType;
+    *dictionary = reader->GetImageIO()->GetMetaDataDictionary();
     }
 }
 
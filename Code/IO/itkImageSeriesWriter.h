@@ -23,6 +23,8 @@
 #include "itkSize.h"
 #include "itkImageRegion.h"
 #include "itkImageFileWriter.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 #include <vector>
 #include <string>
 
@@ -68,6 +70,16 @@ public:
  * the type of file is determined by either the file extension or an
  * ImageIO class if specified.
  *
+ * The input can be streamed: with NumberOfStreamDivisions larger than 1,
+ * the upstream pipeline is updated for slabs of whole slices one after the
+ * other, and the files of a slab are written before the next one is
+ * requested, so that only the slices of a slab or two are in memory. The
+ * files of a slab can be written on several threads: up to NumberOfThreads
+ * files (see ProcessObject::SetNumberOfThreads()) are written at once when
+ * the ImageIO is not set, each file then having an ImageIO of its own
+ * created by the ImageIOFactory. The writer uses a single thread by
+ * default.
+ *
  * \sa ImageFileWriter
  * \sa ImageIOBase
  * \sa ImageSeriesReader
@@ -191,6 +203,24 @@ public:
   itkSetMacro(UseCompression, bool);
   itkGetConstReferenceMacro(UseCompression, bool);
   itkBooleanMacro(UseCompression);
+
+  /** Set/Get the number of pieces to divide the input into. Each piece is
+   * made of whole slices, and the upstream pipeline is executed once per
+   * piece. The actual number of pieces may differ, as the pieces of an
+   * input with several slice dimensions are blocks of the same size. Set
+   * it to the number of files to update the input one slice at a time.
+   * The default, 1, updates the whole input before writing. */
+  itkSetClampMacro(NumberOfStreamDivisions, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfStreamDivisions, unsigned int);
+
+  /** Set/Get the largest number of pieces requested from the upstream
+   * pipeline and not written yet, including the piece being written. With
+   * 2 or more, the next pieces are computed on another thread while the
+   * files of the previous ones are written (see StreamingPrefetcher). The
+   * default is 1. */
+  itkSetClampMacro(NumberOfPiecesInFlight, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfPiecesInFlight, unsigned int);
+
 protected:
   ImageSeriesWriter();
   ~ImageSeriesWriter();
@@ -207,6 +237,42 @@ protected:
 
   //track whether the ImageIO is user specified
   bool m_UserSpecifiedImageIO;
+
+  /** A file to write: the slice of the input, and the ImageIO if the file
+   * has one of its own. */
+  struct SliceJob {
+    InputImageRegionType Region;
+    unsigned int FileNumber;
+    ImageIOBase::Pointer ImageIO;
+  };
+
+  /** Internal structure used for passing the files of a piece to the
+   * threads, which take the next file under Lock until none is left or
+   * writing one failed. */
+  struct SliceWritingStruct {
+    Pointer Writer;
+    const InputImageType *Piece;
+    std::vector< SliceJob > Jobs;
+    unsigned int NextJob;
+    bool Failed;
+    ExceptionObject Exception;
+    SimpleFastMutexLock Lock;
+  };
+
+  /** Static function used as a "callback" by the MultiThreader to write
+   * the files of a piece. */
+  static ITK_THREAD_RETURN_TYPE WriteSlicesThreaderCallback(void *arg);
+
+  /** Write the files of the jobs, until none is left. */
+  void WriteSliceJobs(SliceWritingStruct *str);
+
+  /** Write the slice of a piece of the input to the file fileNumber. */
+  void WriteSlice(const InputImageType *piece, const InputImageRegionType & slice,
+                  unsigned int fileNumber, ImageIOBase *imageIO);
+
+  /** Divide the region written in pieces made of whole slices. */
+  void ComputePieces(const InputImageRegionType & region, std::vector< InputImageRegionType > & pieces);
+
 private:
   ImageSeriesWriter(const Self &); //purposely not implemented
   void operator=(const Self &);    //purposely not implemented
@@ -225,6 +291,9 @@ private:
 
   bool m_UseCompression;
 
+  unsigned int m_NumberOfStreamDivisions;
+  unsigned int m_NumberOfPiecesInFlight;
+
   /** Array of MetaDataDictionary used for passing information to each slice */
   DictionaryArrayRawPointer m_MetaDataDictionaryArray;
 
@@ -22,13 +22,14 @@
 #include "itkImageIOFactory.h"
 #include "itkCommand.h"
 #include "itkIOCommon.h"
-#include "itkProgressReporter.h"
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkMetaDataObject.h"
 #include "itkArray.h"
+#include "itkStreamingPrefetcher.h"
 #include "vnl/algo/vnl_determinant.h"
 #include <stdio.h>
+#include <algorithm>
 namespace itk
 {
 //---------------------------------------------------------
@@ -40,6 +41,9 @@ ImageSeriesWriter< TInputImage, TOutputImage >
   m_StartIndex(1), m_IncrementIndex(1), m_MetaDataDictionaryArray(NULL)
 {
   m_UseCompression = false;
+  m_NumberOfStreamDivisions = 1;
+  m_NumberOfPiecesInFlight = 1;
+  this->SetNumberOfThreads(1);
 }
 
 //---------------------------------------------------------
@@ -99,11 +103,12 @@ ImageSeriesWriter< TInputImage, TOutputImage >
     itkExceptionMacro(<< "No input to writer!");
     }
 
-  // Make sure the data is up-to-date.
+  // Only the information is updated here: WriteFiles() updates the data
+  // piece by piece.
   // NOTE: this const_cast<> is due to the lack of const-correctness
   // of the ProcessObject.
   InputImageType *nonConstImage = const_cast< InputImageType * >( inputImage );
-  nonConstImage->Update();
+  nonConstImage->UpdateOutputInformation();
 
   // Notify start event observers
   this->InvokeEvent( StartEvent() );
@@ -198,15 +203,241 @@ ImageSeriesWriter< TInputImage, TOutputImage >
     itkExceptionMacro(<< "Input image is NULL");
     }
 
-  // We need two regions. One for the input, one for the output.
-  ImageRegion< TInputImage::ImageDimension >  inRegion = inputImage->GetRequestedRegion();
-  ImageRegion< TOutputImage::ImageDimension > outRegion;
+  // The region written, one file per slice of the dimensions beyond the
+  // ones of the output
+  const InputImageRegionType inRegion = inputImage->GetRequestedRegion();
+
+  unsigned int expectedNumberOfFiles = 1;
+  for ( unsigned int n = TOutputImage::ImageDimension; n < TInputImage::ImageDimension; n++ )
+    {
+    expectedNumberOfFiles *= inRegion.GetSize(n);
+    }
+
+  if ( m_FileNames.size() != expectedNumberOfFiles )
+    {
+    itkExceptionMacro(
+      << "The number of filenames passed is " << m_FileNames.size() << " but " << expectedNumberOfFiles
+      << " were expected ");
+    return;
+    }
+
+  itkDebugMacro( << "Number of files to write = " << m_FileNames.size() );
+
+  typedef StreamingPrefetcher< InputImageType > PrefetcherType;
+  typename PrefetcherType::RegionListType pieces;
+  this->ComputePieces(inRegion, pieces);
+
+  // NOTE: this const_cast<> is due to the lack of const-correctness
+  // of the ProcessObject.
+  InputImageType *nonConstImage = const_cast< InputImageType * >( inputImage );
+
+  typename PrefetcherType::Pointer prefetcher = PrefetcherType::New();
+  prefetcher->SetInput(nonConstImage);
+  prefetcher->SetNumberOfPiecesInFlight(m_NumberOfPiecesInFlight);
+  prefetcher->Start(pieces);
+
+  SliceWritingStruct str;
+  str.Writer = this;
+  unsigned int filesWritten = 0;
+  for ( unsigned int p = 0; p < pieces.size() && !this->GetAbortGenerateData(); p++ )
+    {
+    // execute the upstream pipeline for the piece
+    typename InputImageType::Pointer pieceImage = prefetcher->GetNextPiece();
+    const InputImageRegionType &     piece = pieces[p];
+
+    // The slices of the piece, in the order of the files. Several files
+    // are only written at once by ImageIOs of their own.
+    str.Piece = pieceImage;
+    str.Jobs.clear();
+    InputImageRegionType slice = piece;
+    unsigned long        numberOfSlices = 1;
+    for ( unsigned int d = TOutputImage::ImageDimension; d < TInputImage::ImageDimension; d++ )
+      {
+      numberOfSlices *= piece.GetSize(d);
+      slice.SetSize(d, 1);
+      }
+    typename InputImageType::IndexType index = piece.GetIndex();
+    for ( unsigned long s = 0; s < numberOfSlices; s++ )
+      {
+      SliceJob job;
+      slice.SetIndex(index);
+      job.Region = slice;
+      job.FileNumber = 0;
+      for ( int d = TInputImage::ImageDimension - 1; d >= (int)TOutputImage::ImageDimension; d-- )
+        {
+        job.FileNumber = job.FileNumber * inRegion.GetSize(d) + ( index[d] - inRegion.GetIndex(d) );
+        }
+      if ( !m_ImageIO && this->GetNumberOfThreads() > 1 )
+        {
+        job.ImageIO = ImageIOFactory::CreateImageIO(m_FileNames[job.FileNumber].c_str(),
+                                                    ImageIOFactory::WriteMode);
+        }
+      str.Jobs.push_back(job);
+
+      // next slice, the first slice dimension varying the fastest
+      for ( unsigned int d = TOutputImage::ImageDimension; d < TInputImage::ImageDimension; d++ )
+        {
+        if ( ++index[d] < piece.GetIndex(d) + static_cast< long >( piece.GetSize(d) ) )
+          {
+          break;
+          }
+        index[d] = piece.GetIndex(d);
+        }
+      }
+
+    str.NextJob = 0;
+    str.Failed = false;
+    const int numberOfThreads =
+      m_ImageIO ? 1 : std::min( static_cast< int >( str.Jobs.size() ), this->GetNumberOfThreads() );
+    if ( numberOfThreads > 1 )
+      {
+      MultiThreader::Pointer threader = MultiThreader::New();
+      threader->SetNumberOfThreads(numberOfThreads);
+      threader->SetSingleMethod(Self::WriteSlicesThreaderCallback, &str);
+      threader->SingleMethodExecute();
+      }
+    else
+      {
+      this->WriteSliceJobs(&str);
+      }
+    str.Piece = 0;
+    if ( str.Failed )
+      {
+      prefetcher->Stop();
+      throw str.Exception;
+      }
+
+    filesWritten += static_cast< unsigned int >( str.Jobs.size() );
+    this->UpdateProgress( static_cast< float >( filesWritten ) / expectedNumberOfFiles );
+    }
+  prefetcher->Stop();
+
+  // the input was requested the pieces, and not the region written
+  nonConstImage->SetRequestedRegion(inRegion);
+}
+
+//---------------------------------------------------------
+template< class TInputImage, class TOutputImage >
+void
+ImageSeriesWriter< TInputImage, TOutputImage >
+::ComputePieces(const InputImageRegionType & region, std::vector< InputImageRegionType > & pieces)
+{
+  pieces.clear();
+  const unsigned int outputDimension = TOutputImage::ImageDimension;
+  const unsigned int inputDimension = TInputImage::ImageDimension;
+  if ( outputDimension >= inputDimension || region.GetNumberOfPixels() == 0 )
+    {
+    pieces.push_back(region);
+    return;
+    }
+
+  unsigned long numberOfSlices = 1;
+  for ( unsigned int d = outputDimension; d < inputDimension; d++ )
+    {
+    numberOfSlices *= region.GetSize(d);
+    }
+  const unsigned long divisions = std::min(static_cast< unsigned long >( m_NumberOfStreamDivisions ), numberOfSlices);
+  const unsigned long slicesPerPiece = ( numberOfSlices + divisions - 1 ) / divisions;
+
+  // The pieces are blocks of whole rows of the first slice dimensions,
+  // as many as fit in a piece, and of several slices along the next one
+  unsigned int  axis = outputDimension;
+  unsigned long rowSlices = 1;
+  while ( axis < inputDimension - 1 && rowSlices * region.GetSize(axis) <= slicesPerPiece )
+    {
+    rowSlices *= region.GetSize(axis);
+    axis++;
+    }
+  const unsigned long blockSize = std::max(slicesPerPiece / rowSlices, 1UL);
 
+  InputImageRegionType piece = region;
+  for ( unsigned int d = axis + 1; d < inputDimension; d++ )
+    {
+    piece.SetSize(d, 1);
+    }
+  while ( true )
+    {
+    const long end = region.GetIndex(axis) + static_cast< long >( region.GetSize(axis) );
+    piece.SetSize( axis, std::min( blockSize, static_cast< unsigned long >( end - piece.GetIndex(axis) ) ) );
+    pieces.push_back(piece);
+
+    // next block along the axis, then along the outer dimensions
+    unsigned int d = axis;
+    piece.SetIndex( d, piece.GetIndex(d) + static_cast< long >( blockSize ) );
+    while ( piece.GetIndex(d) >= region.GetIndex(d) + static_cast< long >( region.GetSize(d) ) )
+      {
+      piece.SetIndex( d, region.GetIndex(d) );
+      if ( ++d >= inputDimension )
+        {
+        return;
+        }
+      piece.SetIndex( d, piece.GetIndex(d) + 1 );
+      }
+    }
+}
+
+//---------------------------------------------------------
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+ImageSeriesWriter< TInputImage, TOutputImage >
+::WriteSlicesThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = (MultiThreader::ThreadInfoStruct *)( arg );
+  SliceWritingStruct *             str = (SliceWritingStruct *)( info->UserData );
+
+  str->Writer->WriteSliceJobs(str);
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+//---------------------------------------------------------
+template< class TInputImage, class TOutputImage >
+void
+ImageSeriesWriter< TInputImage, TOutputImage >
+::WriteSliceJobs(SliceWritingStruct *str)
+{
+  while ( true )
+    {
+    str->Lock.Lock();
+    const unsigned int j = str->NextJob++;
+    const bool         stop = ( j >= str->Jobs.size() || str->Failed );
+    str->Lock.Unlock();
+    if ( stop )
+      {
+      return;
+      }
+
+    const SliceJob & job = str->Jobs[j];
+    try
+      {
+      this->WriteSlice( str->Piece, job.Region, job.FileNumber,
+                        m_ImageIO ? m_ImageIO.GetPointer() : job.ImageIO.GetPointer() );
+      }
+    catch ( ExceptionObject & e )
+      {
+      str->Lock.Lock();
+      if ( !str->Failed )
+        {
+        str->Failed = true;
+        str->Exception = e;
+        }
+      str->Lock.Unlock();
+      }
+    }
+}
+
+//---------------------------------------------------------
+template< class TInputImage, class TOutputImage >
+void
+ImageSeriesWriter< TInputImage, TOutputImage >
+::WriteSlice(const InputImageType *inputImage, const InputImageRegionType & inRegion,
+             unsigned int slice, ImageIOBase *imageIO)
+{
   // The size of the output will match the input sizes, up to the
   // dimension of the input.
+  ImageRegion< TOutputImage::ImageDimension > outRegion;
   for ( unsigned int i = 0; i < TOutputImage::ImageDimension; i++ )
     {
-    outRegion.SetSize(i, inputImage->GetRequestedRegion().GetSize()[i]);
+    outRegion.SetSize( i, inRegion.GetSize(i) );
     }
 
   // Allocate an image for output and create an iterator for it
@@ -223,7 +454,6 @@ ImageSeriesWriter< TInputImage, TOutputImage >
     {
     origin[i] = inputImage->GetOrigin()[i];
     spacing[i] = inputImage->GetSpacing()[i];
-    outRegion.SetSize(i, inputImage->GetRequestedRegion().GetSize()[i]);
     for ( unsigned int j = 0; j < TOutputImage::ImageDimension; j++ )
       {
       direction[j][i] = inputImage->GetDirection()[j][i];
@@ -246,129 +476,83 @@ ImageSeriesWriter< TInputImage, TOutputImage >
   outputImage->SetSpacing(spacing);
   outputImage->SetDirection(direction);
 
-  Index< TInputImage::ImageDimension > inIndex;
-  Size< TInputImage::ImageDimension >  inSize;
-
-  unsigned long pixelsPerFile = outputImage->GetRequestedRegion().GetNumberOfPixels();
+  ImageRegionConstIterator< InputImageType > it (inputImage, inRegion);
 
-  inSize.Fill(1);
-  for ( unsigned int ns = 0; ns < TOutputImage::ImageDimension; ns++ )
+  // Copy the selected "slice" into the output image.
+  it.GoToBegin();
+  ot.GoToBegin();
+  while ( !ot.IsAtEnd() )
     {
-    inSize[ns] = outRegion.GetSize()[ns];
+    ot.Set( it.Get() );
+    ++it;
+    ++ot;
     }
 
-  unsigned int expectedNumberOfFiles = 1;
-  for ( unsigned int n = TOutputImage::ImageDimension; n < TInputImage::ImageDimension; n++ )
-    {
-    expectedNumberOfFiles *= inRegion.GetSize(n);
-    }
+  typename WriterType::Pointer writer = WriterType::New();
 
-  if ( m_FileNames.size() != expectedNumberOfFiles )
+  writer->UseInputMetaDataDictionaryOff(); // use the dictionary from the
+                                           // ImageIO class
+  writer->SetInput(outputImage);
+
+  if ( imageIO )
     {
-    itkExceptionMacro(
-      << "The number of filenames passed is " << m_FileNames.size() << " but " << expectedNumberOfFiles
-      << " were expected ");
-    return;
+    writer->SetImageIO(imageIO);
     }
 
-  itkDebugMacro( << "Number of files to write = " << m_FileNames.size() );
-
-  ProgressReporter progress(this, 0,
-                            expectedNumberOfFiles,
-                            expectedNumberOfFiles);
-
-  // For each "slice" in the input, copy the region to the output,
-  // build a filename and write the file.
-
-  typename InputImageType::OffsetValueType offset = 0;
-  for ( unsigned int slice = 0; slice < m_FileNames.size(); slice++ )
+  if ( m_MetaDataDictionaryArray )
     {
-    // Select a "slice" of the image.
-    inIndex = inputImage->ComputeIndex(offset);
-    inRegion.SetIndex(inIndex);
-    inRegion.SetSize(inSize);
-
-    ImageRegionConstIterator< InputImageType > it (inputImage, inRegion);
-
-    // Copy the selected "slice" into the output image.
-    it.GoToBegin();
-    ot.GoToBegin();
-    while ( !ot.IsAtEnd() )
-      {
-      ot.Set( it.Get() );
-      ++it;
-      ++ot;
-      }
-
-    typename WriterType::Pointer writer = WriterType::New();
-
-    writer->UseInputMetaDataDictionaryOff(); // use the dictionary from the
-                                             // ImageIO class
-    writer->SetInput(outputImage);
-
     if ( m_ImageIO )
       {
-      writer->SetImageIO(m_ImageIO);
-      }
-
-    if ( m_MetaDataDictionaryArray )
-      {
-      if ( m_ImageIO )
+      if ( slice > m_MetaDataDictionaryArray->size() - 1 )
         {
-        if ( slice > m_MetaDataDictionaryArray->size() - 1 )
-          {
-          itkExceptionMacro (
-            "The slice number: " << slice + 1 << " exceeds the size of the MetaDataDictionaryArray "
-                                 << m_MetaDataDictionaryArray->size() << ".");
-          }
-        DictionaryRawPointer dictionary = ( *m_MetaDataDictionaryArray )[slice];
-        m_ImageIO->SetMetaDataDictionary( ( *dictionary ) );
-        }
-      else
-        {
-        itkExceptionMacro(<< "Attempted to use a MetaDataDictionaryArray without specifying an ImageIO!");
+        itkExceptionMacro (
+          "The slice number: " << slice + 1 << " exceeds the size of the MetaDataDictionaryArray "
+                               << m_MetaDataDictionaryArray->size() << ".");
         }
+      DictionaryRawPointer dictionary = ( *m_MetaDataDictionaryArray )[slice];
+      m_ImageIO->SetMetaDataDictionary( ( *dictionary ) );
       }
     else
       {
-      if ( m_ImageIO )
-        {
-        DictionaryType & dictionary = m_ImageIO->GetMetaDataDictionary();
-
-        typename InputImageType::SpacingType spacing2 = inputImage->GetSpacing();
+      itkExceptionMacro(<< "Attempted to use a MetaDataDictionaryArray without specifying an ImageIO!");
+      }
+    }
+  else
+    {
+    if ( m_ImageIO )
+      {
+      DictionaryType & dictionary = m_ImageIO->GetMetaDataDictionary();
 
-        // origin of the output slice in the
-        // N-Dimensional space of the input image.
-        typename InputImageType::PointType origin2;
+      typename InputImageType::SpacingType spacing2 = inputImage->GetSpacing();
 
-        inputImage->TransformIndexToPhysicalPoint(inIndex, origin2);
+      // origin of the output slice in the
+      // N-Dimensional space of the input image.
+      typename InputImageType::PointType origin2;
 
-        const unsigned int inputImageDimension = TInputImage::ImageDimension;
+      inputImage->TransformIndexToPhysicalPoint(inRegion.GetIndex(), origin2);
 
-        typedef Array< double > DoubleArrayType;
+      const unsigned int inputImageDimension = TInputImage::ImageDimension;
 
-        DoubleArrayType originArray(inputImageDimension);
-        DoubleArrayType spacingArray(inputImageDimension);
+      typedef Array< double > DoubleArrayType;
 
-        for ( unsigned int d = 0; d < inputImageDimension; d++ )
-          {
-          originArray[d]  = origin2[d];
-          spacingArray[d] = spacing2[d];
-          }
+      DoubleArrayType originArray(inputImageDimension);
+      DoubleArrayType spacingArray(inputImageDimension);
 
-        EncapsulateMetaData< DoubleArrayType >(dictionary, ITK_Origin, originArray);
-        EncapsulateMetaData< DoubleArrayType >(dictionary, ITK_Spacing, spacingArray);
-        EncapsulateMetaData<  unsigned int   >(dictionary, ITK_NumberOfDimensions, inputImageDimension);
+      for ( unsigned int d = 0; d < inputImageDimension; d++ )
+        {
+        originArray[d]  = origin2[d];
+        spacingArray[d] = spacing2[d];
         }
-      }
-
-    writer->SetFileName( m_FileNames[slice].c_str() );
-    writer->SetUseCompression(m_UseCompression);
-    writer->Update();
 
-    progress.CompletedPixel();
-    offset += pixelsPerFile;
+      EncapsulateMetaData< DoubleArrayType >(dictionary, ITK_Origin, originArray);
+      EncapsulateMetaData< DoubleArrayType >(dictionary, ITK_Spacing, spacingArray);
+      EncapsulateMetaData<  unsigned int   >(dictionary, ITK_NumberOfDimensions, inputImageDimension);
+      }
     }
+
+  writer->SetFileName( m_FileNames[slice].c_str() );
+  writer->SetUseCompression(m_UseCompression);
+  writer->Update();
 }
 
 //---------------------------------------------------------
@@ -393,6 +577,8 @@ ImageSeriesWriter< TInputImage, TOutputImage >
   os << indent << "IncrementIndex: " << m_IncrementIndex << std::endl;
   os << indent << "SeriesFormat: " << m_SeriesFormat << std::endl;
   os << indent << "MetaDataDictionaryArray: " << m_MetaDataDictionaryArray << std::endl;
+  os << indent << "NumberOfStreamDivisions: " << m_NumberOfStreamDivisions << std::endl;
+  os << indent << "NumberOfPiecesInFlight: " << m_NumberOfPiecesInFlight << std::endl;
 
   if ( m_UseCompression )
     {
@@ -74,6 +74,20 @@ public:
    * that the IORegion has been set properly. */
   virtual void Write(const void *buffer);
 
+  /** LSM files are written at once. */
+  virtual bool CanStreamWrite()
+  {
+    return false;
+  }
+
+  virtual unsigned int GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
+                                                         const ImageIORegion & pasteRegion,
+                                                         const ImageIORegion & largestPossibleRegion)
+  {
+    return ImageIOBase::GetActualNumberOfSplitsForWriting(numberOfRequestedSplits, pasteRegion,
+                                                          largestPossibleRegion);
+  }
+
 protected:
   LSMImageIO();
   ~LSMImageIO();
@@ -0,0 +1,171 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMemoryMappedFile.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "itkMemoryMappedFile.h"
+#include "itksys/SystemTools.hxx"
+
+#if defined( WIN32 ) || defined( _WIN32 )
+  #include <windows.h>
+#else
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <sys/mman.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+namespace itk
+{
+MemoryMappedFile::MemoryMappedFile()
+{
+  m_Data = 0;
+  m_Length = 0;
+  m_MappedAddress = 0;
+  m_MappedLength = 0;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+  this->Unmap();
+}
+
+#if defined( WIN32 ) || defined( _WIN32 )
+
+void MemoryMappedFile::Map(const char *fileName, OffsetType offset, size_t length)
+{
+  this->Unmap();
+
+  HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if ( file == INVALID_HANDLE_VALUE )
+    {
+    itkExceptionMacro(<< "Could not open " << fileName << " for mapping");
+    }
+
+  LARGE_INTEGER fileSize;
+  if ( !GetFileSizeEx(file, &fileSize)
+       || offset < 0 || offset + static_cast< OffsetType >( length ) > fileSize.QuadPart )
+    {
+    CloseHandle(file);
+    itkExceptionMacro(<< fileName << " is too short to map " << length
+                      << " bytes at offset " << offset);
+    }
+
+  // A view must start at a multiple of the allocation granularity
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  const OffsetType alignedOffset = offset - offset % systemInfo.dwAllocationGranularity;
+  const size_t     shift = static_cast< size_t >( offset - alignedOffset );
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  void * address = 0;
+  if ( mapping != NULL )
+    {
+    address = MapViewOfFile( mapping, FILE_MAP_COPY,
+                             static_cast< DWORD >( alignedOffset >> 32 ),
+                             static_cast< DWORD >( alignedOffset & 0xffffffff ),
+                             length + shift );
+    CloseHandle(mapping);
+    }
+  CloseHandle(file);
+  if ( address == 0 )
+    {
+    itkExceptionMacro(<< "Could not map " << fileName << ": "
+                      << itksys::SystemTools::GetLastSystemError() );
+    }
+
+  m_MappedAddress = address;
+  m_MappedLength = length + shift;
+  m_Data = static_cast< char * >( address ) + shift;
+  m_Length = length;
+}
+
+void MemoryMappedFile::Unmap()
+{
+  if ( m_MappedAddress )
+    {
+    UnmapViewOfFile(m_MappedAddress);
+    }
+  m_Data = 0;
+  m_Length = 0;
+  m_MappedAddress = 0;
+  m_MappedLength = 0;
+}
+
+#else
+
+void MemoryMappedFile::Map(const char *fileName, OffsetType offset, size_t length)
+{
+  this->Unmap();
+
+  const int file = open(fileName, O_RDONLY);
+  if ( file < 0 )
+    {
+    itkExceptionMacro(<< "Could not open " << fileName << " for mapping: "
+                      << itksys::SystemTools::GetLastSystemError() );
+    }
+
+  // Touching a page past the end of the file would raise SIGBUS
+  struct stat fileStatus;
+  if ( fstat(file, &fileStatus) != 0
+       || offset < 0 || offset + static_cast< OffsetType >( length ) > fileStatus.st_size )
+    {
+    close(file);
+    itkExceptionMacro(<< fileName << " is too short to map " << length
+                      << " bytes at offset " << offset);
+    }
+
+  // A mapping must start on a page boundary
+  const OffsetType pageSize = sysconf(_SC_PAGESIZE);
+  const OffsetType alignedOffset = offset - offset % pageSize;
+  const size_t     shift = static_cast< size_t >( offset - alignedOffset );
+
+  void *address = mmap(0, length + shift, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       file, alignedOffset);
+  close(file);
+  if ( address == MAP_FAILED )
+    {
+    itkExceptionMacro(<< "Could not map " << fileName << ": "
+                      << itksys::SystemTools::GetLastSystemError() );
+    }
+
+  m_MappedAddress = address;
+  m_MappedLength = length + shift;
+  m_Data = static_cast< char * >( address ) + shift;
+  m_Length = length;
+}
+
+void MemoryMappedFile::Unmap()
+{
+  if ( m_MappedAddress )
+    {
+    munmap(m_MappedAddress, m_MappedLength);
+    }
+  m_Data = 0;
+  m_Length = 0;
+  m_MappedAddress = 0;
+  m_MappedLength = 0;
+}
+
+#endif
+
+void MemoryMappedFile::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Data: " << m_Data << std::endl;
+  os << indent << "Length: " << m_Length << std::endl;
+}
+} // end namespace itk
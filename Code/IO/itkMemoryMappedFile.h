@@ -0,0 +1,96 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMemoryMappedFile.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkMemoryMappedFile_h
+#define __itkMemoryMappedFile_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include <iosfwd>
+
+namespace itk
+{
+/** \class MemoryMappedFile
+ * \brief Maps a range of bytes of a file into memory.
+ *
+ * Map() makes the bytes [offset, offset + length) of a file available at
+ * GetData() without reading them: the operating system loads the pages
+ * of the file when they are first touched. The mapping is private (copy
+ * on write), so the memory may be modified without changing the file.
+ * The mapping is released when the object is destroyed or Unmap() is
+ * called.
+ *
+ * The file must not be truncated while it is mapped.
+ *
+ * \sa MemoryMappedImportImageContainer ImageIOBase::CanMemoryMapRead()
+ * \ingroup IOFilters
+ */
+class ITK_EXPORT MemoryMappedFile:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef MemoryMappedFile           Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MemoryMappedFile, Object);
+
+  typedef std::streamoff OffsetType;
+
+  /** Map length bytes of fileName, starting at offset. Throws an
+   * ExceptionObject if the file cannot be opened, is too short or cannot
+   * be mapped. A previous mapping is released first. */
+  void Map(const char *fileName, OffsetType offset, size_t length);
+
+  /** Release the mapping. */
+  void Unmap();
+
+  /** First mapped byte, or null if nothing is mapped. */
+  void * GetData() const
+  {
+    return m_Data;
+  }
+
+  /** Number of bytes mapped. */
+  size_t GetLength() const
+  {
+    return m_Length;
+  }
+
+protected:
+  MemoryMappedFile();
+  ~MemoryMappedFile();
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+private:
+  MemoryMappedFile(const Self &); //purposely not implemented
+  void operator=(const Self &);   //purposely not implemented
+
+  void * m_Data;
+  size_t m_Length;
+
+  /** The mapping starts on a page boundary, up to m_Data. */
+  void * m_MappedAddress;
+  size_t m_MappedLength;
+};
+} // end namespace itk
+
+#endif
@@ -0,0 +1,95 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMemoryMappedImportImageContainer.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkMemoryMappedImportImageContainer_h
+#define __itkMemoryMappedImportImageContainer_h
+
+#include "itkImportImageContainer.h"
+#include "itkMemoryMappedFile.h"
+
+namespace itk
+{
+/** \class MemoryMappedImportImageContainer
+ * \brief An ImportImageContainer whose elements are the bytes of a
+ * memory mapped file.
+ *
+ * The container keeps the MemoryMappedFile alive for as long as it points
+ * at the mapped memory. When the container allocates a buffer of its own
+ * (for instance when Reserve() grows it) or is initialized, the mapping
+ * is released.
+ *
+ * ImageFileReader puts such a container in its output when
+ * UseMemoryMapping is on and the ImageIO supports it.
+ *
+ * \sa MemoryMappedFile ImageIOBase::CanMemoryMapRead()
+ * \ingroup ImageObjects IOFilters
+ */
+template< typename TElementIdentifier, typename TElement >
+class MemoryMappedImportImageContainer:
+  public ImportImageContainer< TElementIdentifier, TElement >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MemoryMappedImportImageContainer                     Self;
+  typedef ImportImageContainer< TElementIdentifier, TElement > Superclass;
+  typedef SmartPointer< Self >                                 Pointer;
+  typedef SmartPointer< const Self >                           ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MemoryMappedImportImageContainer, ImportImageContainer);
+
+  /** Point the container at the size elements mapped by file. */
+  void SetMemoryMappedFile(MemoryMappedFile *file, TElementIdentifier size)
+  {
+    this->SetImportPointer(static_cast< TElement * >( file->GetData() ), size, false);
+    m_MemoryMappedFile = file;
+  }
+
+  /** The mapping the elements come from, or null once the container
+   * has released it. */
+  const MemoryMappedFile * GetMemoryMappedFile() const
+  {
+    return m_MemoryMappedFile.GetPointer();
+  }
+
+protected:
+  MemoryMappedImportImageContainer() {}
+  ~MemoryMappedImportImageContainer() {}
+
+  void PrintSelf(std::ostream & os, Indent indent) const
+  {
+    Superclass::PrintSelf(os, indent);
+    os << indent << "MemoryMappedFile: " << m_MemoryMappedFile.GetPointer() << std::endl;
+  }
+
+  virtual void DeallocateManagedMemory()
+  {
+    Superclass::DeallocateManagedMemory();
+    m_MemoryMappedFile = 0;
+  }
+
+private:
+  MemoryMappedImportImageContainer(const Self &); //purposely not implemented
+  void operator=(const Self &);                   //purposely not implemented
+
+  MemoryMappedFile::Pointer m_MemoryMappedFile;
+};
+} // end namespace itk
+
+#endif
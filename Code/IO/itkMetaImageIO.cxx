@@ -19,21 +19,269 @@
 #endif
 
 #include <string>
+#include <algorithm>
 #include <stdlib.h>
+#include <string.h>
 #include "itkMetaImageIO.h"
 #include "itkExceptionObject.h"
 #include "itkSpatialOrientation.h"
 #include "itkSpatialOrientationAdapter.h"
 #include "itkMetaDataObject.h"
 #include "itkIOCommon.h"
+#include "itkMultiThreader.h"
+#include "itkParallelDeflate.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itk_zlib.h"
 #include <itksys/SystemTools.hxx>
 
 namespace itk
 {
+namespace
+{
+// With chunked compression the slabs are raw deflate streams ended by a
+// full flush, so that each one can be inflated on its own. Preceded by a
+// zlib header and followed by an empty final block and the Adler-32 of
+// all the data, they form a single zlib stream. The stream is followed by
+// a table giving the compressed size of each slab, the number of slices
+// per slab, the number of slabs and the length of the stream, as little
+// endian 64 bit integers, and by a signature.
+const char          ChunkTableSignature[8] = { 'M', 'E', 'T', 'A', 'C', 'H', 'N', 'K' };
+const unsigned int  ChunkTableTrailerLength = 3 * 8 + 8;
+const unsigned char ZlibHeader[2] = { 0x78, 0x9c };
+const unsigned char EmptyFinalBlock[2] = { 0x03, 0x00 };
+
+// Largest number of bytes given to zlib at once
+const size_t MaximumZlibBlock = 1 << 30;
+
+void WriteUInt64(std::ostream & os, ImageIOBase::SizeType value)
+{
+  unsigned char bytes[8];
+  for ( unsigned int i = 0; i < 8; i++ )
+    {
+    bytes[i] = static_cast< unsigned char >( ( value >> ( 8 * i ) ) & 0xff );
+    }
+  os.write(reinterpret_cast< const char * >( bytes ), 8);
+}
+
+ImageIOBase::SizeType ReadUInt64(const unsigned char *bytes)
+{
+  ImageIOBase::SizeType value = 0;
+  for ( int i = 7; i >= 0; i-- )
+    {
+    value = ( value << 8 ) | bytes[i];
+    }
+  return value;
+}
+
+// Inflate a raw stream ended by a flush into length bytes of data
+bool InflateChunk(const unsigned char *compressed, size_t compressedLength,
+                  unsigned char *data, size_t length)
+{
+  z_stream z;
+  memset( &z, 0, sizeof( z ) );
+  if ( inflateInit2(&z, -MAX_WBITS) != Z_OK )
+    {
+    return false;
+    }
+
+  bool ok = true;
+  while ( ok && length > 0 )
+    {
+    if ( z.avail_in == 0 )
+      {
+      const size_t block = std::min(compressedLength, MaximumZlibBlock);
+      z.next_in = const_cast< unsigned char * >( compressed );
+      z.avail_in = static_cast< uInt >( block );
+      compressed += block;
+      compressedLength -= block;
+      }
+    const size_t available = std::min(length, MaximumZlibBlock);
+    const uInt   input = z.avail_in;
+    z.next_out = data;
+    z.avail_out = static_cast< uInt >( available );
+    const int    result = inflate(&z, Z_SYNC_FLUSH);
+    const size_t produced = available - z.avail_out;
+    data += produced;
+    length -= produced;
+    // the data is short or corrupted when inflate cannot progress
+    ok = ( result == Z_OK || result == Z_BUF_ERROR
+           || ( result == Z_STREAM_END && length == 0 ) )
+         && ( produced > 0 || z.avail_in < input
+              || ( z.avail_in == 0 && compressedLength > 0 ) );
+    }
+
+  inflateEnd(&z);
+  return ok;
+}
+
+// Copy the pixels of the source region that are in the destination
+// region. Returns the number of pixels copied.
+ImageIOBase::SizeType CopyRegionIntersection(const char *source,
+                                             const std::vector< long > & sourceIndex,
+                                             const std::vector< unsigned long > & sourceSize,
+                                             char *destination,
+                                             const std::vector< long > & destinationIndex,
+                                             const std::vector< unsigned long > & destinationSize,
+                                             size_t pixelSize)
+{
+  const unsigned int  nDims = sourceIndex.size();
+  std::vector< long > begin(nDims);
+  std::vector< long > end(nDims);
+  for ( unsigned int d = 0; d < nDims; d++ )
+    {
+    begin[d] = std::max(sourceIndex[d], destinationIndex[d]);
+    end[d] = std::min( sourceIndex[d] + static_cast< long >( sourceSize[d] ),
+                       destinationIndex[d] + static_cast< long >( destinationSize[d] ) );
+    if ( begin[d] >= end[d] )
+      {
+      return 0;
+      }
+    }
+
+  // copy the intersection row by row
+  ImageIOBase::SizeType copied = 0;
+  std::vector< long >   index(begin);
+  while ( true )
+    {
+    ImageIOBase::SizeType sourceOffset = 0;
+    ImageIOBase::SizeType destinationOffset = 0;
+    ImageIOBase::SizeType sourceStride = 1;
+    ImageIOBase::SizeType destinationStride = 1;
+    for ( unsigned int d = 0; d < nDims; d++ )
+      {
+      sourceOffset += ( index[d] - sourceIndex[d] ) * sourceStride;
+      destinationOffset += ( index[d] - destinationIndex[d] ) * destinationStride;
+      sourceStride *= sourceSize[d];
+      destinationStride *= destinationSize[d];
+      }
+    memcpy( destination + destinationOffset * pixelSize, source + sourceOffset * pixelSize,
+            ( end[0] - begin[0] ) * pixelSize );
+    copied += end[0] - begin[0];
+
+    unsigned int d = 1;
+    while ( d < nDims && ++index[d] == end[d] )
+      {
+      index[d] = begin[d];
+      d++;
+      }
+    if ( d >= nDims )
+      {
+      break;
+      }
+    }
+  return copied;
+}
+
+// A slab to compress or decompress. Decompressed slabs that are not
+// entirely in the region read are inflated into a temporary buffer and
+// the part in the region is copied.
+struct ChunkCodingJob {
+  const unsigned char *Input;
+  size_t InputLength;
+  unsigned char *Output;
+  size_t OutputLength;
+  std::vector< unsigned char > Compressed;
+  unsigned long Adler32;
+  std::vector< long > ChunkIndex;
+  std::vector< unsigned long > ChunkSize;
+};
+
+struct ChunkCodingStruct {
+  bool Compress;
+  int Level;
+  std::vector< ChunkCodingJob > Jobs;
+  unsigned int NextJob;
+  bool Failed;
+  SimpleFastMutexLock Lock;
+  // region read, for the slabs decompressed into a temporary buffer
+  char *Buffer;
+  std::vector< long > RegionIndex;
+  std::vector< unsigned long > RegionSize;
+  size_t PixelSize;
+};
+
+ITK_THREAD_RETURN_TYPE ChunkCodingThreaderCallback(void *arg)
+{
+  ChunkCodingStruct *str =
+    (ChunkCodingStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  while ( true )
+    {
+    str->Lock.Lock();
+    const unsigned int j = str->NextJob++;
+    const bool stop = ( j >= str->Jobs.size() || str->Failed );
+    str->Lock.Unlock();
+    if ( stop )
+      {
+      break;
+      }
+
+    ChunkCodingJob & job = str->Jobs[j];
+    bool             ok;
+    if ( str->Compress )
+      {
+      // the full flush lets each slab be inflated on its own
+      job.Adler32 = ParallelDeflate::ComputeAdler32(job.Input, job.InputLength);
+      ok = ParallelDeflate::DeflateBlock(job.Input, job.InputLength, 0, 0, str->Level,
+                                         Z_FULL_FLUSH, job.Compressed);
+      }
+    else if ( job.Output )
+      {
+      ok = InflateChunk(job.Input, job.InputLength, job.Output, job.OutputLength);
+      }
+    else
+      {
+      std::vector< unsigned char > chunk(job.OutputLength);
+      ok = InflateChunk(job.Input, job.InputLength, &chunk[0], job.OutputLength);
+      if ( ok )
+        {
+        CopyRegionIntersection(reinterpret_cast< const char * >( &chunk[0] ),
+                               job.ChunkIndex, job.ChunkSize,
+                               str->Buffer, str->RegionIndex, str->RegionSize,
+                               str->PixelSize);
+        }
+      }
+
+    if ( !ok )
+      {
+      str->Lock.Lock();
+      str->Failed = true;
+      str->Lock.Unlock();
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// Run the jobs on up to the default number of threads. The slabs are
+// coded independently, so the file does not depend on the number of
+// threads. Returns false if one of them failed.
+bool ExecuteChunkCoding(ChunkCodingStruct & str)
+{
+  str.NextJob = 0;
+  str.Failed = false;
+  if ( str.Jobs.empty() )
+    {
+    return true;
+    }
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( std::min( static_cast< int >( str.Jobs.size() ),
+                                          MultiThreader::GetGlobalDefaultNumberOfThreads() ) );
+  threader->SetSingleMethod(ChunkCodingThreaderCallback, &str);
+  threader->SingleMethodExecute();
+  return !str.Failed;
+}
+}
+
 MetaImageIO::MetaImageIO()
 {
   m_FileType = Binary;
   m_SubSamplingFactor = 1;
+  m_CompressionChunkSize = 0;
+  m_CompressedChunkSlices = 0;
+  m_ChunkedWriting.NextChunk = 0;
+  m_ChunkedWriting.Adler32 = 0;
   if ( MET_SystemByteOrderMSB() )
     {
     m_ByteOrder = BigEndian;
@@ -58,6 +306,7 @@ void MetaImageIO::PrintSelf(std::ostream & os, Indent indent) const
   Superclass::PrintSelf(os, indent);
   m_MetaImage.PrintInfo();
   os << indent << "SubSamplingFactor: " << m_SubSamplingFactor << "\n";
+  os << indent << "CompressionChunkSize: " << m_CompressionChunkSize << "\n";
 }
 
 void MetaImageIO::SetDataFileName(const char *filename)
@@ -93,6 +342,8 @@ void MetaImageIO::ReadImageInformation()
                        << itksys::SystemTools::GetLastSystemError() );
     }
 
+  this->ReadCompressedChunkTable();
+
   if ( m_MetaImage.BinaryData() )
     {
     this->SetFileType(Binary);
@@ -855,8 +1106,259 @@ void MetaImageIO::ReadImageInformation()
     }
 }
 
+bool MetaImageIO::CanMemoryMapRead()
+{
+  if ( !m_MetaImage.BinaryData() || m_MetaImage.CompressedData()
+       || m_SubSamplingFactor != 1 )
+    {
+    return false;
+    }
+
+  int elementSize;
+  MET_SizeOfType(m_MetaImage.ElementType(), &elementSize);
+  if ( static_cast< unsigned int >( elementSize ) != this->GetComponentSize()
+       || ( elementSize > 1
+            && m_MetaImage.BinaryDataByteOrderMSB() != MET_SystemByteOrderMSB() ) )
+    {
+    return false;
+    }
+
+  const std::string dataFileName = this->GetElementDataFilePath();
+  const bool        local = ( dataFileName == m_FileName );
+  if ( dataFileName.empty() )
+    {
+    return false;
+    }
+
+  SizeType offset = 0;
+  if ( m_MetaImage.HeaderSize() > 0 )
+    {
+    offset = m_MetaImage.HeaderSize();
+    }
+  else if ( m_MetaImage.HeaderSize() == -1 )
+    {
+    // the data is at the end of the file
+    offset = static_cast< SizeType >( itksys::SystemTools::FileLength( dataFileName.c_str() ) )
+             - static_cast< SizeType >( this->GetImageSizeInBytes() );
+    if ( offset < 0 )
+      {
+      return false;
+      }
+    }
+  else if ( local )
+    {
+    // the data starts right after the ElementDataFile line, which ends
+    // the header
+    std::ifstream file(m_FileName.c_str(), std::ios::in | std::ios::binary);
+    std::string   line;
+    bool          found = false;
+    while ( !found && std::getline(file, line) )
+      {
+      const std::string::size_type start = line.find_first_not_of(" \t");
+      found = ( start != std::string::npos
+                && line.compare(start, 15, "ElementDataFile") == 0 );
+      }
+    if ( !found )
+      {
+      return false;
+      }
+    offset = file.tellg();
+    }
+
+  m_PixelDataFileName = dataFileName;
+  m_PixelDataOffset = offset;
+  return true;
+}
+
+std::string MetaImageIO::GetElementDataFilePath() const
+{
+  // Same rules as MetaImage::ReadStream() for finding the data
+  std::string dataFileName = m_MetaImage.ElementDataFileName();
+  if ( dataFileName == "LOCAL" || dataFileName == "Local" || dataFileName == "local" )
+    {
+    return m_FileName;
+    }
+  if ( dataFileName.compare(0, 4, "LIST") == 0
+       || dataFileName.find('%') != std::string::npos )
+    {
+    return std::string();
+    }
+  char pathName[255];
+  if ( MET_GetFilePath(m_FileName.c_str(), pathName) )
+    {
+    dataFileName = std::string(pathName) + dataFileName;
+    }
+  return dataFileName;
+}
+
+void MetaImageIO::ReadCompressedChunkTable()
+{
+  m_CompressedChunkFileName = "";
+  m_CompressedChunkSlices = 0;
+  m_CompressedChunkOffsets.clear();
+
+  if ( !m_MetaImage.BinaryData() || !m_MetaImage.CompressedData() )
+    {
+    return;
+    }
+  const std::string dataFileName = this->GetElementDataFilePath();
+  std::ifstream     file(dataFileName.c_str(), std::ios::in | std::ios::binary);
+  if ( dataFileName.empty() || !file )
+    {
+    return;
+    }
+
+  file.seekg(0, std::ios::end);
+  const SizeType fileLength = file.tellg();
+  unsigned char  trailer[ChunkTableTrailerLength];
+  if ( fileLength < static_cast< SizeType >( ChunkTableTrailerLength ) )
+    {
+    return;
+    }
+  file.seekg(fileLength - ChunkTableTrailerLength, std::ios::beg);
+  file.read(reinterpret_cast< char * >( trailer ), ChunkTableTrailerLength);
+  if ( !file || memcmp(trailer + 24, ChunkTableSignature, 8) != 0 )
+    {
+    return;
+    }
+
+  // the table must describe slabs of the image this header describes
+  const int      nDims = m_MetaImage.NDims();
+  const SizeType slices = ReadUInt64(trailer);
+  const SizeType numberOfChunks = ReadUInt64(trailer + 8);
+  const SizeType streamLength = ReadUInt64(trailer + 16);
+  const SizeType lastDimension = nDims > 0 ? m_MetaImage.DimSize(nDims - 1) : 0;
+  const SizeType tableStart = fileLength - ChunkTableTrailerLength - 8 * numberOfChunks;
+  if ( slices <= 0 || lastDimension <= 0
+       || numberOfChunks != ( lastDimension + slices - 1 ) / slices
+       || tableStart - streamLength < 0 )
+    {
+    itkWarningMacro(<< "Ignoring the invalid table of the compressed slabs of " << dataFileName);
+    return;
+    }
+
+  std::vector< unsigned char > table(8 * numberOfChunks);
+  file.seekg(tableStart, std::ios::beg);
+  file.read(reinterpret_cast< char * >( &table[0] ), table.size());
+  std::vector< SizeType > offsets(numberOfChunks + 1);
+  offsets[0] = tableStart - streamLength + sizeof( ZlibHeader );
+  for ( SizeType c = 0; c < numberOfChunks; c++ )
+    {
+    offsets[c + 1] = offsets[c] + ReadUInt64(&table[8 * c]);
+    }
+  if ( !file || offsets[numberOfChunks] + sizeof( EmptyFinalBlock ) + 4 != tableStart )
+    {
+    itkWarningMacro(<< "Ignoring the invalid table of the compressed slabs of " << dataFileName);
+    return;
+    }
+
+  m_CompressedChunkFileName = dataFileName;
+  m_CompressedChunkSlices = slices;
+  m_CompressedChunkOffsets.swap(offsets);
+}
+
+void MetaImageIO::ReadCompressedChunks(void *buffer)
+{
+  const unsigned int nDims = m_MetaImage.NDims();
+  const unsigned int last = nDims - 1;
+
+  // region read, and size in bytes of a slice of the file
+  int elementSize;
+  MET_SizeOfType(m_MetaImage.ElementType(), &elementSize);
+  ChunkCodingStruct str;
+  str.Compress = false;
+  str.Buffer = static_cast< char * >( buffer );
+  str.PixelSize = elementSize * m_MetaImage.ElementNumberOfChannels();
+  str.RegionIndex.resize(nDims);
+  str.RegionSize.resize(nDims);
+  SizeType sliceLength = str.PixelSize;
+  bool     wholeSlices = true;
+  for ( unsigned int i = 0; i < nDims; i++ )
+    {
+    str.RegionIndex[i] = 0;
+    str.RegionSize[i] = 1;
+    if ( i < m_IORegion.GetImageDimension() )
+      {
+      str.RegionIndex[i] = m_IORegion.GetIndex()[i];
+      str.RegionSize[i] = m_IORegion.GetSize()[i];
+      }
+    if ( i < last )
+      {
+      sliceLength *= m_MetaImage.DimSize(i);
+      wholeSlices = wholeSlices && str.RegionIndex[i] == 0
+                    && str.RegionSize[i] == static_cast< unsigned long >( m_MetaImage.DimSize(i) );
+      }
+    }
+
+  // read the slabs intersecting the region at once
+  const long          numberOfSlices = m_MetaImage.DimSize(last);
+  const long          firstSlice = str.RegionIndex[last];
+  const long          endSlice = firstSlice + str.RegionSize[last];
+  const unsigned long firstChunk = firstSlice / m_CompressedChunkSlices;
+  const unsigned long endChunk = ( endSlice - 1 ) / m_CompressedChunkSlices + 1;
+
+  std::vector< unsigned char > compressed(
+    m_CompressedChunkOffsets[endChunk] - m_CompressedChunkOffsets[firstChunk]);
+  std::ifstream file(m_CompressedChunkFileName.c_str(), std::ios::in | std::ios::binary);
+  file.seekg(m_CompressedChunkOffsets[firstChunk], std::ios::beg);
+  file.read(reinterpret_cast< char * >( &compressed[0] ), compressed.size());
+  if ( !file )
+    {
+    itkExceptionMacro( "File cannot be read: " << m_CompressedChunkFileName
+                       << std::endl
+                       << "Reason: "
+                       << itksys::SystemTools::GetLastSystemError() );
+    }
+
+  // the slabs entirely in the region are inflated in place
+  for ( unsigned long c = firstChunk; c < endChunk; c++ )
+    {
+    const long chunkFirstSlice = c * m_CompressedChunkSlices;
+    const long chunkEndSlice = std::min(chunkFirstSlice + static_cast< long >( m_CompressedChunkSlices ),
+                                        numberOfSlices);
+    ChunkCodingJob job;
+    job.Input = &compressed[m_CompressedChunkOffsets[c] - m_CompressedChunkOffsets[firstChunk]];
+    job.InputLength = m_CompressedChunkOffsets[c + 1] - m_CompressedChunkOffsets[c];
+    job.OutputLength = ( chunkEndSlice - chunkFirstSlice ) * sliceLength;
+    job.Output = 0;
+    if ( wholeSlices && chunkFirstSlice >= firstSlice && chunkEndSlice <= endSlice )
+      {
+      job.Output = reinterpret_cast< unsigned char * >( str.Buffer )
+                   + ( chunkFirstSlice - firstSlice ) * sliceLength;
+      }
+    else
+      {
+      job.ChunkIndex.assign(nDims, 0);
+      job.ChunkIndex[last] = chunkFirstSlice;
+      job.ChunkSize.resize(nDims);
+      for ( unsigned int i = 0; i < last; i++ )
+        {
+        job.ChunkSize[i] = m_MetaImage.DimSize(i);
+        }
+      job.ChunkSize[last] = chunkEndSlice - chunkFirstSlice;
+      }
+    str.Jobs.push_back(job);
+    }
+
+  if ( !ExecuteChunkCoding(str) )
+    {
+    itkExceptionMacro( "File cannot be read: " << m_CompressedChunkFileName
+                       << std::endl
+                       << "Reason: the compressed data is corrupted" );
+    }
+
+  m_MetaImage.ElementData(buffer, false);
+  m_MetaImage.ElementByteOrderFix( m_IORegion.GetNumberOfPixels() );
+}
+
 void MetaImageIO::Read(void *buffer)
 {
+  if ( !m_CompressedChunkOffsets.empty() && m_SubSamplingFactor == 1 )
+    {
+    this->ReadCompressedChunks(buffer);
+    return;
+    }
+
   const unsigned int nDims = this->GetNumberOfDimensions();
 
   // this will check to see if we are actually streaming
@@ -1402,10 +1904,20 @@ MetaImageIO
     largestRegion.SetSize( i, this->GetDimensions(i) );
     }
 
-  if ( m_UseCompression && ( largestRegion != m_IORegion ) )
+  if ( m_UseCompression && m_CompressionChunkSize > 0 && binaryData )
+    {
+    this->WriteCompressedChunks(buffer);
+    }
+  else if ( m_UseCompression && ( largestRegion != m_IORegion ) )
     {
     std::cout << "Compression in use: cannot stream the file writing" << std::endl;
     }
+  else if ( m_UseCompression && binaryData && !this->GetElementDataFilePath().empty()
+            && this->GetNumberOfThreads() > 1 )
+    {
+    // with several threads the data is compressed by ParallelDeflate
+    this->WriteCompressed(buffer);
+    }
   else if (  largestRegion != m_IORegion )
     {
     int *indexMin = new int[nDims];
@@ -1451,6 +1963,273 @@ MetaImageIO
   delete[] eOrigin;
 }
 
+std::string MetaImageIO::GetCompressedDataFileName() const
+{
+  // The pixels of a file with the data in the header (LOCAL) are written
+  // to a temporary file until the header can be written.
+  std::string dataFileName = m_MetaImage.ElementDataFileName();
+  if ( dataFileName == "LOCAL" || ( dataFileName.empty()
+                                    && itksys::SystemTools::GetFilenameLastExtension(m_FileName) == ".mha" ) )
+    {
+    return m_FileName + ".tmp";
+    }
+  if ( dataFileName.empty() )
+    {
+    dataFileName = itksys::SystemTools::GetFilenameWithoutLastExtension(m_FileName) + ".zraw";
+    }
+  char pathName[255];
+  if ( MET_GetFilePath(m_FileName.c_str(), pathName)
+       && dataFileName.compare(0, strlen(pathName), pathName) != 0 )
+    {
+    dataFileName = std::string(pathName) + dataFileName;
+    }
+  return dataFileName;
+}
+
+void MetaImageIO::WriteHeaderOfCompressedData(const std::string & dataFileName,
+                                              SizeType streamLength)
+{
+  // write the header, followed by the pixels if they are LOCAL
+  m_MetaImage.CompressedDataSize(streamLength);
+  const bool headerWritten = m_MetaImage.Write(m_FileName.c_str(), NULL, false);
+  m_MetaImage.CompressedDataSize(0);
+  if ( headerWritten && dataFileName == m_FileName + ".tmp" )
+    {
+    std::ofstream     header(m_FileName.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+    std::ifstream     data(dataFileName.c_str(), std::ios::in | std::ios::binary);
+    std::vector< char > block(1 << 20);
+    while ( header && data )
+      {
+      data.read( &block[0], block.size() );
+      header.write( &block[0], data.gcount() );
+      }
+    if ( !header )
+      {
+      itkExceptionMacro( "File cannot be written: " << m_FileName
+                         << std::endl
+                         << "Reason: "
+                         << itksys::SystemTools::GetLastSystemError() );
+      }
+    data.close();
+    itksys::SystemTools::RemoveFile( dataFileName.c_str() );
+    }
+  if ( !headerWritten )
+    {
+    itkExceptionMacro( "File cannot be written: " << m_FileName
+                       << std::endl
+                       << "Reason: "
+                       << itksys::SystemTools::GetLastSystemError() );
+    }
+}
+
+void MetaImageIO::WriteCompressed(const void *buffer)
+{
+  const std::string dataFileName = this->GetCompressedDataFileName();
+  std::ofstream     data(dataFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  SizeType          streamLength = 0;
+  if ( !data
+       || !ParallelDeflate::Compress(buffer, this->GetImageSizeInBytes(), data,
+                                     ParallelDeflate::ZlibFormat, this->GetCompressionLevel(),
+                                     this->GetNumberOfThreads(), &streamLength) )
+    {
+    itkExceptionMacro( "File cannot be written: " << dataFileName
+                       << std::endl
+                       << "Reason: "
+                       << itksys::SystemTools::GetLastSystemError() );
+    }
+  data.close();
+  this->WriteHeaderOfCompressedData(dataFileName, streamLength);
+}
+
+void MetaImageIO::WriteCompressedChunks(const void *buffer)
+{
+  const unsigned int nDims = this->GetNumberOfDimensions();
+  const unsigned int last = nDims - 1;
+
+  // region written, and size in bytes of a slice of the file
+  const size_t                 pixelSize = this->GetComponentSize() * this->GetNumberOfComponents();
+  std::vector< long >          regionIndex(nDims);
+  std::vector< unsigned long > regionSize(nDims);
+  SizeType                     sliceLength = pixelSize;
+  bool                         wholeSlices = true;
+  bool                         atOrigin = true;
+  for ( unsigned int i = 0; i < nDims; i++ )
+    {
+    regionIndex[i] = m_IORegion.GetIndex()[i];
+    regionSize[i] = m_IORegion.GetSize()[i];
+    atOrigin = atOrigin && regionIndex[i] == 0;
+    if ( i < last )
+      {
+      sliceLength *= this->GetDimensions(i);
+      wholeSlices = wholeSlices && regionIndex[i] == 0 && regionSize[i] == this->GetDimensions(i);
+      }
+    }
+
+  const long          numberOfSlices = this->GetDimensions(last);
+  const long          chunkSlices = std::min(static_cast< long >( m_CompressionChunkSize ), numberOfSlices);
+  const unsigned long numberOfChunks = ( numberOfSlices + chunkSlices - 1 ) / chunkSlices;
+  const long          firstSlice = regionIndex[last];
+  const long          endSlice = firstSlice + regionSize[last];
+  const unsigned long firstChunk = firstSlice / chunkSlices;
+  const unsigned long endChunk = ( endSlice - 1 ) / chunkSlices + 1;
+
+  // The first piece of a file, at the origin, starts a new file. The
+  // pixels of a file with the data in the header (LOCAL) are written to a
+  // temporary file until the header can be written.
+  ChunkedWritingStruct & writing = m_ChunkedWriting;
+  if ( !writing.Stream.is_open() || writing.FileName != m_FileName
+       || atOrigin || firstChunk < writing.NextChunk )
+    {
+    if ( writing.Stream.is_open() )
+      {
+      writing.Stream.close();
+      }
+    const std::string dataFileName = this->GetCompressedDataFileName();
+    writing.FileName = m_FileName;
+    writing.DataFileName = dataFileName;
+    writing.Stream.clear();
+    writing.Stream.open(dataFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    writing.Stream.write(reinterpret_cast< const char * >( ZlibHeader ), sizeof( ZlibHeader ));
+    writing.NextChunk = 0;
+    writing.Adler32 = adler32(0, Z_NULL, 0);
+    writing.ChunkSizes.clear();
+    writing.PendingChunks.clear();
+    if ( !writing.Stream )
+      {
+      writing.FileName = "";
+      itkExceptionMacro( "File cannot be written: " << dataFileName
+                         << std::endl
+                         << "Reason: "
+                         << itksys::SystemTools::GetLastSystemError() );
+      }
+    }
+
+  // The slabs entirely in the piece are compressed from it if all the
+  // slabs before them are written or complete. The pixels of the piece in
+  // the other slabs are gathered with those received before.
+  ChunkCodingStruct str;
+  str.Compress = true;
+  str.Level = this->GetCompressionLevel();
+  std::vector< unsigned long > pendingChunksUsed;
+  for ( unsigned long c = writing.NextChunk; c < numberOfChunks; c++ )
+    {
+    const long     chunkFirstSlice = c * chunkSlices;
+    const long     chunkEndSlice = std::min(chunkFirstSlice + chunkSlices, numberOfSlices);
+    const SizeType chunkLength = ( chunkEndSlice - chunkFirstSlice ) * sliceLength;
+    const bool     inPiece = wholeSlices && chunkFirstSlice >= firstSlice && chunkEndSlice <= endSlice;
+    const bool     ready = str.Jobs.size() == c - writing.NextChunk;
+    if ( c >= endChunk && !( ready && writing.PendingChunks.count(c) ) )
+      {
+      break;
+      }
+
+    ChunkCodingJob job;
+    job.InputLength = chunkLength;
+    if ( ready && inPiece )
+      {
+      job.Input = static_cast< const unsigned char * >( buffer )
+                  + ( chunkFirstSlice - firstSlice ) * sliceLength;
+      str.Jobs.push_back(job);
+      continue;
+      }
+
+    if ( c >= firstChunk && c < endChunk )
+      {
+      std::pair< SizeType, std::vector< char > > & pending = writing.PendingChunks[c];
+      if ( pending.second.empty() )
+        {
+        pending.first = 0;
+        pending.second.resize(chunkLength);
+        }
+      std::vector< long > chunkIndex(nDims, 0);
+      chunkIndex[last] = chunkFirstSlice;
+      std::vector< unsigned long > chunkSize(nDims);
+      for ( unsigned int i = 0; i < last; i++ )
+        {
+        chunkSize[i] = this->GetDimensions(i);
+        }
+      chunkSize[last] = chunkEndSlice - chunkFirstSlice;
+      pending.first += pixelSize * CopyRegionIntersection(static_cast< const char * >( buffer ),
+                                                          regionIndex, regionSize,
+                                                          &pending.second[0], chunkIndex, chunkSize,
+                                                          pixelSize);
+      }
+
+    std::map< unsigned long, std::pair< SizeType, std::vector< char > > >::iterator pending =
+      writing.PendingChunks.find(c);
+    if ( ready && pending != writing.PendingChunks.end() && pending->second.first == chunkLength )
+      {
+      job.Input = reinterpret_cast< const unsigned char * >( &pending->second.second[0] );
+      str.Jobs.push_back(job);
+      pendingChunksUsed.push_back(c);
+      }
+    }
+
+  // compress the slabs in parallel and append them in order
+  if ( !ExecuteChunkCoding(str) )
+    {
+    itkExceptionMacro( "File cannot be written: " << writing.DataFileName
+                       << std::endl
+                       << "Reason: compression failed" );
+    }
+  for ( unsigned int j = 0; j < str.Jobs.size(); j++ )
+    {
+    const ChunkCodingJob & job = str.Jobs[j];
+    writing.Stream.write(reinterpret_cast< const char * >( &job.Compressed[0] ), job.Compressed.size());
+    writing.Adler32 = adler32_combine(writing.Adler32, job.Adler32, job.InputLength);
+    writing.ChunkSizes.push_back( job.Compressed.size() );
+    }
+  writing.NextChunk += str.Jobs.size();
+  for ( unsigned int j = 0; j < pendingChunksUsed.size(); j++ )
+    {
+    writing.PendingChunks.erase(pendingChunksUsed[j]);
+    }
+
+  if ( writing.NextChunk < numberOfChunks )
+    {
+    if ( !writing.Stream )
+      {
+      writing.FileName = "";
+      itkExceptionMacro( "File cannot be written: " << writing.DataFileName
+                         << std::endl
+                         << "Reason: "
+                         << itksys::SystemTools::GetLastSystemError() );
+      }
+    return;
+    }
+
+  // end the zlib stream, and append the table of the slabs
+  const unsigned char adler32Bytes[4] = {
+    static_cast< unsigned char >( ( writing.Adler32 >> 24 ) & 0xff ),
+    static_cast< unsigned char >( ( writing.Adler32 >> 16 ) & 0xff ),
+    static_cast< unsigned char >( ( writing.Adler32 >> 8 ) & 0xff ),
+    static_cast< unsigned char >( writing.Adler32 & 0xff )
+  };
+  writing.Stream.write(reinterpret_cast< const char * >( EmptyFinalBlock ), sizeof( EmptyFinalBlock ));
+  writing.Stream.write(reinterpret_cast< const char * >( adler32Bytes ), sizeof( adler32Bytes ));
+  SizeType streamLength = sizeof( ZlibHeader ) + sizeof( EmptyFinalBlock ) + sizeof( adler32Bytes );
+  for ( unsigned long c = 0; c < numberOfChunks; c++ )
+    {
+    WriteUInt64(writing.Stream, writing.ChunkSizes[c]);
+    streamLength += writing.ChunkSizes[c];
+    }
+  WriteUInt64(writing.Stream, chunkSlices);
+  WriteUInt64(writing.Stream, numberOfChunks);
+  WriteUInt64(writing.Stream, streamLength);
+  writing.Stream.write(ChunkTableSignature, sizeof( ChunkTableSignature ));
+  writing.Stream.close();
+  writing.FileName = "";
+  if ( writing.Stream.fail() )
+    {
+    itkExceptionMacro( "File cannot be written: " << writing.DataFileName
+                       << std::endl
+                       << "Reason: "
+                       << itksys::SystemTools::GetLastSystemError() );
+    }
+
+  this->WriteHeaderOfCompressedData(writing.DataFileName, streamLength);
+}
+
 /** Given a requested region, determine what could be the region that we can
  * read from the file. This is called the streamable region, which will be
  * smaller than the LargestPossibleRegion and greater or equal to the
@@ -1481,6 +2260,29 @@ MetaImageIO
   return streamableRegion;
 }
 
+ImageIORegion::SizeType
+MetaImageIO::GetChunkSize() const
+{
+  unsigned long slices = 0;
+
+  if ( this->GetUseCompression() )
+    {
+    slices = m_CompressionChunkSize;
+    }
+  else if ( m_MetaImage.CompressedData() && !m_CompressedChunkOffsets.empty() )
+    {
+    slices = m_CompressedChunkSlices;
+    }
+
+  ImageIORegion::SizeType chunkSize;
+  if ( slices > 0 && m_NumberOfDimensions > 0 )
+    {
+    chunkSize.assign(m_Dimensions.begin(), m_Dimensions.begin() + m_NumberOfDimensions);
+    chunkSize[m_NumberOfDimensions - 1] = slices;
+    }
+  return chunkSize;
+}
+
 unsigned int
 MetaImageIO::GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
                                                const ImageIORegion & pasteRegion,
@@ -1488,11 +2290,15 @@ MetaImageIO::GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSpl
 {
   if ( this->GetUseCompression() )
     {
-    // we can not stream or paste with compression
+    // we can not paste with compression, nor stream without chunks
     if ( pasteRegion != largestPossibleRegion )
       {
       itkExceptionMacro( "Pasting and compression is not supported! Can't write:" << this->GetFileName() );
       }
+    else if ( m_CompressionChunkSize > 0 )
+      {
+      return GetActualNumberOfSplitsForWritingCanStreamWrite(numberOfRequestedSplits, pasteRegion);
+      }
     else if ( numberOfRequestedSplits != 1 )
       {
       itkDebugMacro("Requested streaming and compression");
@@ -22,6 +22,8 @@
 #endif
 
 #include <fstream>
+#include <map>
+#include <vector>
 #include "itkImageIOBase.h"
 #include "metaObject.h"
 #include "metaImage.h"
@@ -116,36 +118,56 @@ public:
                            const ImageIORegion & largestPossibleRegion);
 
   /** Determine if the ImageIO can stream reading from this
-   *  file. Only time cannot stream read/write is if compression is used.
-   *  CanRead must be called prior to this function. */
+   *  file. Only time cannot stream read/write is if compression is used
+   *  without chunks. CanRead must be called prior to this function. */
   virtual bool CanStreamRead()
   {
-    if ( m_MetaImage.CompressedData() )
+    if ( m_MetaImage.CompressedData() && m_CompressedChunkOffsets.empty() )
       {
       return false;
       }
     return true;
   }
 
+  /** Determine if the pixel data can be memory mapped: uncompressed
+   * binary data in the byte order of this machine, stored in the header
+   * file (LOCAL) or in a single data file, and no subsampling. */
+  virtual bool CanMemoryMapRead();
+
   /** Determine if the ImageIO can stream writing to this
-   *  file. Only time cannot stream read/write is if compression is used.
-   *  Assumes file passes a CanRead call and its pixels are of the same
-   *  type as the template of the writer. Can verify by first calling
+   *  file. Only time cannot stream read/write is if compression is used
+   *  without chunks. Assumes file passes a CanRead call and its pixels
+   *  are of the same type as the template of the writer. Can verify by first calling
    *  CanRead and then CanStreamRead prior to calling CanStreamWrite. */
   virtual bool CanStreamWrite()
   {
-    if ( this->GetUseCompression() )
+    if ( this->GetUseCompression() && m_CompressionChunkSize == 0 )
       {
       return false;
       }
     return true;
   }
 
+  /** The compressed slabs of the file read, or of the file written
+   * with a CompressionChunkSize. */
+  virtual ImageIORegion::SizeType GetChunkSize() const;
+
   /** Determing the subsampling factor in case
    *  we want a coarse version of the image/
    * \warning this is only used when streaming is on. */
   itkSetMacro(SubSamplingFactor, unsigned int);
   itkGetConstMacro(SubSamplingFactor, unsigned int);
+
+  /** Number of slices of the last dimension compressed together when
+   * UseCompression is on. Each slab of that many slices is deflated
+   * independently and a table of the compressed slabs is stored after the
+   * compressed data, which remains a single zlib stream that other MetaIO
+   * readers inflate as usual. Such a file can be written and read piece
+   * by piece, only the slabs intersecting the region read are
+   * decompressed, and the slabs are compressed and decompressed by
+   * several threads. The default, 0, writes a single compressed stream. */
+  itkSetMacro(CompressionChunkSize, unsigned int);
+  itkGetConstMacro(CompressionChunkSize, unsigned int);
 protected:
   MetaImageIO();
   ~MetaImageIO();
@@ -159,6 +181,55 @@ private:
   void operator=(const Self &); //purposely not implemented
 
   unsigned int m_SubSamplingFactor;
+
+  unsigned int m_CompressionChunkSize;
+
+  /** Path of the file holding the pixel data, or an empty string if the
+   * data is spread over several files. */
+  std::string GetElementDataFilePath() const;
+
+  /** Load the table of the compressed slabs of the file, if it has one. */
+  void ReadCompressedChunkTable();
+
+  /** Decompress the slabs intersecting m_IORegion into buffer. */
+  void ReadCompressedChunks(void *buffer);
+
+  /** Compress the slabs completed by the m_IORegion piece in buffer and
+   * append them to the file; the header is written with the last slab. */
+  void WriteCompressedChunks(const void *buffer);
+
+  /** Compress the whole image in buffer on several threads into a
+   * single zlib stream, and write the file. */
+  void WriteCompressed(const void *buffer);
+
+  /** File the compressed pixels are written to: the data file, or a
+   * temporary file if the data is in the header. */
+  std::string GetCompressedDataFileName() const;
+
+  /** Write the header of the file whose streamLength bytes of compressed
+   * pixels are in dataFileName, and append them if they go in the
+   * header. */
+  void WriteHeaderOfCompressedData(const std::string & dataFileName, SizeType streamLength);
+
+  /** Table of the slabs of the file read: slices per slab, and offset of
+   * each slab in the data file followed by the end of the last one. */
+  std::string             m_CompressedChunkFileName;
+  unsigned long           m_CompressedChunkSlices;
+  std::vector< SizeType > m_CompressedChunkOffsets;
+
+  /** State of the file written piece by piece: the slabs are appended
+   * in order, and the slabs not written yet are gathered in
+   * PendingChunks, with the number of bytes received. */
+  struct ChunkedWritingStruct {
+    std::string FileName;
+    std::string DataFileName;
+    std::ofstream Stream;
+    unsigned long NextChunk;
+    unsigned long Adler32;
+    std::vector< SizeType > ChunkSizes;
+    std::map< unsigned long, std::pair< SizeType, std::vector< char > > > PendingChunks;
+  };
+  ChunkedWritingStruct m_ChunkedWriting;
 };
 } // end namespace itk
 
@@ -22,11 +22,13 @@
 #include "itkMetaDataObject.h"
 #include "itkSpatialOrientationAdapter.h"
 #include "itkNumericTraits.h"
+#include "itkParallelDeflate.h"
 #include <itksys/SystemTools.hxx>
 #include <vnl/vnl_math.h>
 #include "itk_zlib.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <vector>
 
 namespace itk
@@ -403,6 +405,61 @@ NiftiImageIO
   return ValidFileNameFound;
 }
 
+bool
+NiftiImageIO::HasBufferPixelLayout() const
+{
+  const unsigned int numComponents = this->GetNumberOfComponents();
+
+  return numComponents == 1
+         || ( numComponents == 2 && this->GetPixelType() == COMPLEX )
+         || ( numComponents == 3 && this->GetPixelType() == RGB )
+         || ( numComponents == 4 && this->GetPixelType() == RGBA );
+}
+
+namespace
+{
+// True when the data of the image is stored uncompressed in binary, so
+// that it can be read and written in place.
+inline bool IsUncompressedBinary(const nifti_image *nim)
+{
+  return nim->nifti_type != NIFTI_FTYPE_ASCII && !nifti_is_gzfile(nim->iname);
+}
+}
+
+bool
+NiftiImageIO
+::CanStreamRead()
+{
+  nifti_image *header = nifti_image_read(this->GetFileName(), false);
+
+  if ( header == 0 )
+    {
+    return false;
+    }
+  const bool canStreamRead = IsUncompressedBinary(header) && this->HasBufferPixelLayout();
+  nifti_image_free(header);
+  return canStreamRead;
+}
+
+bool
+NiftiImageIO
+::CanStreamWrite()
+{
+  const char *extension = nifti_find_file_extension( this->GetFileName() );
+
+  return extension != 0
+         && strcmp(extension, ".nia") != 0
+         && !nifti_is_gzfile( this->GetFileName() )
+         && this->HasBufferPixelLayout();
+}
+
+NiftiImageIO::SizeType
+NiftiImageIO
+::GetHeaderSize(void) const
+{
+  return this->m_NiftiImage != 0 ? this->m_NiftiImage->iname_offset : 0;
+}
+
 bool
 NiftiImageIO::MustRescale()
 {
@@ -446,7 +503,7 @@ void NiftiImageIO::Read(void *buffer)
   ImageIORegion::SizeType  size = regionToRead.GetSize();
   ImageIORegion::IndexType start = regionToRead.GetIndex();
 
-  int          numElts = 1;
+  size_t       numElts = 1;
   int          _origin[7];
   int          _size[7];
   unsigned int i;
@@ -472,8 +529,11 @@ void NiftiImageIO::Read(void *buffer)
     // other dims out of the way
     _size[6] = _size[5];
     _size[5] = _size[4];
+    _origin[6] = _origin[5];
+    _origin[5] = _origin[4];
     // sizes = x y z t vecsize
     _size[4] = numComponents;
+    _origin[4] = 0;
     }
   // Free memory if any was occupied already (incase of re-using the IO filter).
   if ( this->m_NiftiImage != NULL )
@@ -499,9 +559,49 @@ void NiftiImageIO::Read(void *buffer)
       break;
       }
     }
+  //
+  // read the rows of a subregion of an uncompressed file in place,
+  // directly into the buffer unless the pixels are promoted to float
+  // below
+  if ( i != this->GetNumberOfDimensions()
+       && this->RequestedToStream()
+       && IsUncompressedBinary(this->m_NiftiImage)
+       && this->HasBufferPixelLayout() )
+    {
+    const IOComponentType componentType = this->m_ComponentType;
+    const size_t          numBytes = numElts * this->m_NiftiImage->nbyper;
+    data = buffer;
+    if ( componentType != this->m_OnDiskComponentType )
+      {
+      data = malloc(numBytes);
+      }
+    try
+      {
+      std::ifstream file;
+      this->OpenFileForReading(file, this->m_NiftiImage->iname);
+      this->m_ComponentType = this->m_OnDiskComponentType;
+      this->StreamReadBufferAsBinary(file, data);
+      this->m_ComponentType = componentType;
+      }
+    catch ( ... )
+      {
+      this->m_ComponentType = componentType;
+      if ( data != buffer )
+        {
+        free(data);
+        }
+      throw;
+      }
+    if ( this->m_NiftiImage->swapsize > 1
+         && this->m_NiftiImage->byteorder != nifti_short_order() )
+      {
+      nifti_swap_Nbytes(static_cast< int >( numBytes / this->m_NiftiImage->swapsize ),
+                        this->m_NiftiImage->swapsize, data);
+      }
+    }
   // if all dimensions match requested size, just read in
   // all data as a block
-  if ( i == this->GetNumberOfDimensions() )
+  else if ( i == this->GetNumberOfDimensions() )
     {
     if ( nifti_image_load(this->m_NiftiImage) == -1 )
       {
@@ -537,8 +637,7 @@ void NiftiImageIO::Read(void *buffer)
       * static_cast< unsigned int >( sizeof( float ) );
 
     // Deal with correct management of 64bits platforms
-    const size_t imageSizeInComponents =
-      static_cast< size_t >( this->GetImageSizeInComponents() );
+    const size_t imageSizeInComponents = numElts * numComponents;
 
     //
     // allocate new buffer for floats. Malloc instead of new to
@@ -584,7 +683,7 @@ void NiftiImageIO::Read(void *buffer)
     //
     // we're replacing the data pointer, so if it was allocated
     // in nifti_read_subregion_image, free the old data here
-    if ( data != this->m_NiftiImage->data )
+    if ( data != this->m_NiftiImage->data && data != buffer )
       {
       free(data);
       }
@@ -598,25 +697,28 @@ void NiftiImageIO::Read(void *buffer)
        || this->GetPixelType() == RGBA )
     {
     const size_t NumBytes = numElts * pixelSize;
-    memcpy(buffer, data, NumBytes);
-    //
-    // if read_subregion was called it allocates a buffer that needs to be
-    // freed.
-    if ( data != this->m_NiftiImage->data )
+    if ( data != buffer )
       {
-      free(data);
+      memcpy(buffer, data, NumBytes);
+      //
+      // if read_subregion was called it allocates a buffer that needs to be
+      // freed.
+      if ( data != this->m_NiftiImage->data )
+        {
+        free(data);
+        }
       }
     }
   else
     {
     // otherwise nifti is x y z t vec l m 0, itk is
-    // vec x y z t l m o
+    // vec x y z t l m o, for the region read
     const char *       niftibuf = (const char *)data;
     char *             itkbuf = (char *)buffer;
-    const unsigned int rowdist = this->m_NiftiImage->dim[1];
-    const unsigned int slicedist = rowdist * this->m_NiftiImage->dim[2];
-    const unsigned int volumedist = slicedist * this->m_NiftiImage->dim[3];
-    const unsigned int seriesdist = volumedist * this->m_NiftiImage->dim[4];
+    const unsigned int rowdist = _size[0];
+    const unsigned int slicedist = rowdist * _size[1];
+    const unsigned int volumedist = slicedist * _size[2];
+    const unsigned int seriesdist = volumedist * _size[3];
     //
     // as per ITK bug 0007485
     // NIfTI is lower triangular, ITK is upper triangular.
@@ -635,13 +737,13 @@ void NiftiImageIO::Read(void *buffer)
         vecOrder[i] = i;
         }
       }
-    for ( int t = 0; t < this->m_NiftiImage->dim[4]; t++ )
+    for ( int t = 0; t < _size[3]; t++ )
       {
-      for ( int z = 0; z < this->m_NiftiImage->dim[3]; z++ )
+      for ( int z = 0; z < _size[2]; z++ )
         {
-        for ( int y = 0; y < this->m_NiftiImage->dim[2]; y++ )
+        for ( int y = 0; y < _size[1]; y++ )
           {
-          for ( int x = 0; x < this->m_NiftiImage->dim[1]; x++ )
+          for ( int x = 0; x < _size[0]; x++ )
             {
             for ( unsigned int c = 0; c < numComponents; c++ )
               {
@@ -1902,6 +2004,43 @@ NiftiImageIO::SetNIfTIOrientationFromImageIO(unsigned short int origdims, unsign
   //  this->m_NiftiImage->sform_code = 0;
 }
 
+void
+NiftiImageIO
+::WriteNiftiImage()
+{
+  nifti_image *nim = this->m_NiftiImage;
+  if ( this->GetNumberOfThreads() < 2 || !nifti_is_gzfile(nim->iname)
+       || nim->nifti_type == NIFTI_FTYPE_ASCII )
+    {
+    nifti_image_write(nim);
+    return;
+    }
+
+  // nifti writes the header, the extensions and the padding up to the
+  // data, and the data is appended as a second gzip member, which gzip
+  // readers decompress as the continuation of the first one. The data of
+  // a header/image pair is the only member of the image file.
+  const bool singleFile = ( nim->nifti_type == NIFTI_FTYPE_NIFTI1_1 );
+  znzFile    file = nifti_image_write_hdr_img(nim, singleFile ? 2 : 0, "wb");
+  if ( singleFile )
+    {
+    if ( znz_isnull(file) )
+      {
+      itkExceptionMacro(<< "Could not write " << nim->fname);
+      }
+    znzclose(file);
+    }
+  std::ofstream data( nim->iname, std::ios::out | std::ios::binary
+                      | ( singleFile ? std::ios::app : std::ios::trunc ) );
+  if ( !data
+       || !ParallelDeflate::Compress(nim->data, nifti_get_volsize(nim), data,
+                                     ParallelDeflate::GzipFormat, this->GetCompressionLevel(),
+                                     this->GetNumberOfThreads()) )
+    {
+    itkExceptionMacro(<< "Could not write " << nim->iname);
+    }
+}
+
 /**
  * Write the image Information before writing data
  */
@@ -1911,15 +2050,63 @@ NiftiImageIO
 {
   this->WriteImageInformation();
   unsigned int numComponents = this->GetNumberOfComponents();
-  if ( numComponents == 1
-       || ( numComponents == 2 && this->GetPixelType() == COMPLEX )
-       || ( numComponents == 3 && this->GetPixelType() == RGB )
-       || ( numComponents == 4 && this->GetPixelType() == RGBA ) )
+  if ( this->RequestedToStream() )
+    {
+    // a piece of a streamed or pasted image, written in place
+    if ( !this->CanStreamWrite() )
+      {
+      itkExceptionMacro(<< "Can not write a region of " << this->GetFileName()
+                        << ", only uncompressed binary files of scalar, complex, RGB or RGBA pixels can be streamed");
+      }
+    std::ofstream file;
+    if ( !itksys::SystemTools::FileExists(this->m_NiftiImage->fname)
+         || !itksys::SystemTools::FileExists(this->m_NiftiImage->iname) )
+      {
+      // write the header, and allocate the image file by writing its
+      // last byte
+      nifti_image_write_hdr_img(this->m_NiftiImage, 0, "wb");
+      if ( !itksys::SystemTools::FileExists(this->m_NiftiImage->fname) )
+        {
+        itkExceptionMacro(<< "Could not write " << this->m_NiftiImage->fname);
+        }
+      this->OpenFileForWriting( file, this->m_NiftiImage->iname,
+                                this->m_NiftiImage->nifti_type != NIFTI_FTYPE_NIFTI1_1 );
+      const std::streampos lastByte =
+        static_cast< std::streamoff >( this->GetHeaderSize() + this->GetImageSizeInBytes() - 1 );
+      file.seekp(lastByte, std::ios::beg);
+      file.write("\0", 1);
+      }
+    else
+      {
+      // the data of the file written by the previous pieces, or pasted
+      // into, is at the offset of its header
+      nifti_image *header = nifti_image_read(this->m_NiftiImage->fname, false);
+      if ( header == 0 )
+        {
+        itkExceptionMacro(<< "Could not read the header of " << this->m_NiftiImage->fname);
+        }
+      const bool sameByteOrder = ( header->byteorder == this->m_NiftiImage->byteorder );
+      const bool uncompressed = IsUncompressedBinary(header);
+      this->m_NiftiImage->iname_offset = header->iname_offset;
+      nifti_image_free(header);
+      if ( !sameByteOrder || !uncompressed )
+        {
+        itkExceptionMacro(<< "Can not write a region of " << this->GetFileName()
+                          << ", which is compressed or of another byte order");
+        }
+      this->OpenFileForWriting(file, this->m_NiftiImage->iname, false);
+      }
+    this->StreamWriteBufferAsBinary(file, buffer);
+    }
+  else if ( numComponents == 1
+            || ( numComponents == 2 && this->GetPixelType() == COMPLEX )
+            || ( numComponents == 3 && this->GetPixelType() == RGB )
+            || ( numComponents == 4 && this->GetPixelType() == RGBA ) )
     {
     // Need a const cast here so that we don't have to copy the memory
     // for writing.
     this->m_NiftiImage->data = const_cast< void * >( buffer );
-    nifti_image_write(this->m_NiftiImage);
+    this->WriteNiftiImage();
     this->m_NiftiImage->data = 0; // if left pointing to data buffer
     // nifti_image_free will try and free this memory
     }
@@ -2001,7 +2188,7 @@ NiftiImageIO
     //Need a const cast here so that we don't have to copy the memory for
     //writing.
     this->m_NiftiImage->data = (void *)nifti_buf;
-    nifti_image_write(this->m_NiftiImage);
+    this->WriteNiftiImage();
     this->m_NiftiImage->data = 0; // if left pointing to data buffer
     delete[] nifti_buf;
     }
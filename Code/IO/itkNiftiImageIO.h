@@ -30,7 +30,7 @@
 #endif
 
 #include <fstream>
-#include "itkImageIOBase.h"
+#include "itkStreamingImageIOBase.h"
 #include <nifti1_io.h>
 
 namespace itk
@@ -41,14 +41,20 @@ namespace itk
  * \brief Class that defines how to read Nifti file format.
  * Nifti IMAGE FILE FORMAT - As much information as I can determine from sourceforge.net/projects/Niftilib
  *
+ * The regions of uncompressed binary files (.nii and .hdr/.img) of
+ * scalar, complex, RGB and RGBA pixels are read and written in place,
+ * so that only the region requested is read from, or written to the
+ * file. The regions of the other files are read through the nifti
+ * library, and they are written at once.
+ *
  * \ingroup IOFilters
  */
-class ITK_EXPORT NiftiImageIO:public ImageIOBase
+class ITK_EXPORT NiftiImageIO:public StreamingImageIOBase
 {
 public:
   /** Standard class typedefs. */
   typedef NiftiImageIO         Self;
-  typedef ImageIOBase          Superclass;
+  typedef StreamingImageIOBase Superclass;
   typedef SmartPointer< Self > Pointer;
 
   /** Method for creation through the object factory. */
@@ -73,6 +79,10 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer);
 
+  /** Returns true when the data of the file set is stored uncompressed
+   * in binary, and its pixels are stored as in the buffer. */
+  virtual bool CanStreamRead();
+
   /*-------- This part of the interfaces deals with writing data. ----- */
 
   /** Determine if the file can be written with this ImageIO implementation.
@@ -90,6 +100,10 @@ public:
    * that the IORegions has been set properly. */
   virtual void Write(const void *buffer);
 
+  /** Returns true when the file set will be written uncompressed in
+   * binary, and the pixels are stored as in the buffer. */
+  virtual bool CanStreamWrite();
+
   /** Calculate the region of the image that can be efficiently read
    *  in response to a given requested region. */
   virtual ImageIORegion
@@ -108,9 +122,18 @@ protected:
   void PrintSelf(std::ostream & os, Indent indent) const;
 
   virtual bool GetUseLegacyModeForTwoFileWriting(void) const { return false; }
+
+  /** Returns the offset of the data in the image file. */
+  virtual SizeType GetHeaderSize(void) const;
+
 private:
   bool  MustRescale();
 
+  /** Returns true when the pixels are stored in the file as in the
+   * buffer, that is not for the images of vector pixels, whose
+   * components are stored in separate volumes. */
+  bool  HasBufferPixelLayout() const;
+
   void  DefineHeaderObjectDataType();
 
   void  SetNIfTIOrientationFromImageIO(unsigned short int origdims, unsigned short int dims);
@@ -119,6 +142,10 @@ private:
 
   void  SetImageIOMetadataFromNIfTI();
 
+  /** Write m_NiftiImage and its data, compressing the data on several
+   * threads when the image file is gzipped. */
+  void  WriteNiftiImage();
+
   nifti_image *m_NiftiImage;
 
   double m_RescaleSlope;
@@ -19,10 +19,12 @@
 #endif
 
 #include <string>
+#include <fstream>
 #include "itkNrrdImageIO.h"
 #include "itkMacro.h"
 #include "itkMetaDataObject.h"
 #include "itkIOCommon.h"
+#include "itkParallelDeflate.h"
 
 namespace itk
 {
@@ -793,6 +795,68 @@ void NrrdImageIO::Read(void *buffer)
     }
 }
 
+bool NrrdImageIO::CanMemoryMapRead()
+{
+  Nrrd *       nrrd = nrrdNew();
+  NrrdIoState *nio = nrrdIoStateNew();
+
+  // read the header only, and keep the data file open at the start of
+  // the data (after any line or byte skip)
+  nrrdIoStateSet(nio, nrrdIoStateSkipData, 1);
+  nrrdIoStateSet(nio, nrrdIoStateKeepNrrdDataFileOpen, 1);
+  bool canMap = ( nrrdLoad(nrrd, this->GetFileName(), nio) == 0 );
+  if ( !canMap )
+    {
+    airFree( biffGetDone(NRRD) );
+    }
+
+  // raw data in a single data file
+  canMap = canMap
+           && nio->dataFile
+           && nio->encoding == nrrdEncodingRaw
+           && !nio->dataFNFormat
+           && nio->dataFNArr->len <= 1;
+
+  // laid out as Read() returns it
+  unsigned int rangeAxisIdx[NRRD_DIM_MAX];
+  canMap = canMap
+           && nrrdTypeBlock != nrrd->type
+           && nrrdElementSize(nrrd) == this->GetComponentSize()
+           && static_cast< SizeType >( nrrdElementNumber(nrrd) ) == this->GetImageSizeInComponents()
+           && ( nrrdElementSize(nrrd) == 1 || nio->endian == airMyEndian )
+           && ( nrrdRangeAxesGet(nrrd, rangeAxisIdx) == 0
+                || ( nrrdRangeAxesGet(nrrd, rangeAxisIdx) == 1 && rangeAxisIdx[0] == 0 ) );
+
+  if ( canMap )
+    {
+    std::string dataFileName = this->GetFileName();
+    if ( nio->dataFNArr->len == 1 )
+      {
+      // detached data file, possibly relative to the header
+      dataFileName = nio->dataFN[0];
+      if ( dataFileName == "-" )
+        {
+        canMap = false;
+        }
+      else if ( dataFileName[0] != '/' && airStrlen(nio->path) )
+        {
+        dataFileName = std::string(nio->path) + "/" + dataFileName;
+        }
+      }
+    m_PixelDataFileName = dataFileName;
+    m_PixelDataOffset = ftell(nio->dataFile);
+    canMap = canMap && m_PixelDataOffset >= 0;
+    }
+
+  if ( nio->dataFile )
+    {
+    nio->dataFile = airFclose(nio->dataFile);
+    }
+  nrrdNix(nrrd);
+  nrrdIoStateNix(nio);
+  return canMap;
+}
+
 bool NrrdImageIO::CanWriteFile(const char *name)
 {
   std::string filename = name;
@@ -1042,6 +1106,13 @@ void NrrdImageIO::Write(const void *buffer)
     {
     // this is necessarily gzip-compressed *raw* data
     nio->encoding = nrrdEncodingGzip;
+    nio->zlibLevel = this->GetCompressionLevel();
+    // with several threads only the header is written by nrrdSave, and
+    // the data is compressed by ParallelDeflate
+    if ( this->GetNumberOfThreads() > 1 )
+      {
+      nio->skipData = AIR_TRUE;
+      }
     }
   else
     {
@@ -1083,6 +1154,33 @@ void NrrdImageIO::Write(const void *buffer)
                       << this->GetFileName() << ":\n" << err);
     }
 
+  // Append the compressed data to the header, or write it to the file
+  // named by the detached header, relative to its directory
+  if ( nio->skipData )
+    {
+    std::string dataFileName = this->GetFileName();
+    if ( nio->detachedHeader )
+      {
+      dataFileName = nio->dataFN[0];
+      if ( dataFileName != "-" && dataFileName[0] != '/'
+           && ( dataFileName.size() < 2 || dataFileName[1] != ':' ) )
+        {
+        dataFileName = std::string(nio->path) + "/" + dataFileName;
+        }
+      }
+    std::ofstream data( dataFileName.c_str(), std::ios::out | std::ios::binary
+                        | ( nio->detachedHeader ? std::ios::trunc : std::ios::app ) );
+    if ( !data
+         || !ParallelDeflate::Compress(buffer, this->GetImageSizeInBytes(), data,
+                                       ParallelDeflate::GzipFormat, this->GetCompressionLevel(),
+                                       this->GetNumberOfThreads()) )
+      {
+      nrrd = nrrdNix(nrrd);
+      nio = nrrdIoStateNix(nio);
+      itkExceptionMacro("Write: Error writing " << dataFileName);
+      }
+    }
+
   // Free the nrrd struct but don't touch nrrd->data
   nrrd = nrrdNix(nrrd);
   nio = nrrdIoStateNix(nio);
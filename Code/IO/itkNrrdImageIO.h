@@ -66,6 +66,10 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer);
 
+  /** Raw encoded data in a single data file, attached or detached, with
+   * the non-scalar axis (if any) first can be memory mapped. */
+  virtual bool CanMemoryMapRead();
+
   /** Determine the file type. Returns true if this ImageIO can write the
    * file specified. */
   virtual bool CanWriteFile(const char *);
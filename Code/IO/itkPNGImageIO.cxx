@@ -251,8 +251,7 @@ PNGImageIO::PNGImageIO()
   m_PixelType = SCALAR;
   m_ComponentType = UCHAR;
   m_UseCompression = false;
-  m_CompressionLevel = 4; // Range 0-9; 0 = no file compression, 9 = maximum
-                          // file compression
+  m_CompressionLevel = 4; // faster than the default of ImageIOBase
   m_Spacing[0] = 1.0;
   m_Spacing[1] = 1.0;
 
@@ -266,7 +265,7 @@ PNGImageIO::~PNGImageIO()
 void PNGImageIO::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
-  os << indent << "Compression Level : " << m_CompressionLevel << "\n";
+  os << indent << "Compression Level : " << this->GetCompressionLevel() << "\n";
 }
 
 void PNGImageIO::ReadImageInformation()
@@ -46,11 +46,6 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(PNGImageIO, ImageIOBase);
 
-  /** Set/Get the level of compression for the output images.
-   *  0-9; 0 = none, 9 = maximum. */
-  itkSetMacro(CompressionLevel, int);
-  itkGetConstMacro(CompressionLevel, int);
-
   /*-------- This part of the interface deals with reading data. ------ */
 
   /** Determine the file type. Returns true if this ImageIO can read the
@@ -86,10 +81,6 @@ protected:
   void PrintSelf(std::ostream & os, Indent indent) const;
 
   void WriteSlice(const std::string & fileName, const void *buffer);
-
-  /** Determines the level of compression for written files.
-   *  Range 0-9; 0 = none, 9 = maximum , default = 4 */
-  int m_CompressionLevel;
 private:
   PNGImageIO(const Self &);     //purposely not implemented
   void operator=(const Self &); //purposely not implemented
@@ -0,0 +1,289 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelDeflate.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "itkParallelDeflate.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itk_zlib.h"
+#include <algorithm>
+#include <ostream>
+#include <string.h>
+
+namespace itk
+{
+namespace
+{
+// Largest number of bytes given to zlib at once
+const size_t MaximumZlibBlock = 1 << 30;
+
+// Size of the blocks compressed in parallel, and of the dictionary that
+// primes them
+const size_t BlockLength = 1 << 20;
+const size_t DictionaryLength = 1 << 15;
+
+// Number of blocks per thread compressed before being written, which
+// bounds the memory used
+const unsigned int BlocksPerThread = 4;
+
+struct ParallelDeflateStruct {
+  const unsigned char *Data;
+  size_t Length;
+  size_t FirstBlock;
+  size_t NumberOfBlocks;
+  int Level;
+  bool Gzip;
+  std::vector< std::vector< unsigned char > > Compressed;
+  std::vector< unsigned long > Checksums;
+  size_t NextBlock;
+  bool Failed;
+  SimpleFastMutexLock Lock;
+};
+
+ITK_THREAD_RETURN_TYPE ParallelDeflateThreaderCallback(void *arg)
+{
+  ParallelDeflateStruct *str =
+    (ParallelDeflateStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  while ( true )
+    {
+    str->Lock.Lock();
+    const size_t j = str->NextBlock++;
+    const bool   stop = ( j >= str->Compressed.size() || str->Failed );
+    str->Lock.Unlock();
+    if ( stop )
+      {
+      break;
+      }
+
+    const size_t         block = str->FirstBlock + j;
+    const unsigned char *data = str->Data + block * BlockLength;
+    const size_t         length = std::min(BlockLength, str->Length - block * BlockLength);
+    const size_t         dictionaryLength = block > 0 ? DictionaryLength : 0;
+    const int            flush = block + 1 == str->NumberOfBlocks ? Z_FINISH : Z_SYNC_FLUSH;
+
+    str->Checksums[j] = str->Gzip ? ParallelDeflate::ComputeCRC32(data, length)
+                        : ParallelDeflate::ComputeAdler32(data, length);
+    if ( !ParallelDeflate::DeflateBlock(data, length, data - dictionaryLength, dictionaryLength,
+                                        str->Level, flush, str->Compressed[j]) )
+      {
+      str->Lock.Lock();
+      str->Failed = true;
+      str->Lock.Unlock();
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void WriteBigEndian32(std::ostream & os, unsigned long value)
+{
+  const char bytes[4] = {
+    static_cast< char >( ( value >> 24 ) & 0xff ),
+    static_cast< char >( ( value >> 16 ) & 0xff ),
+    static_cast< char >( ( value >> 8 ) & 0xff ),
+    static_cast< char >( value & 0xff )
+  };
+  os.write(bytes, 4);
+}
+
+void WriteLittleEndian32(std::ostream & os, unsigned long value)
+{
+  const char bytes[4] = {
+    static_cast< char >( value & 0xff ),
+    static_cast< char >( ( value >> 8 ) & 0xff ),
+    static_cast< char >( ( value >> 16 ) & 0xff ),
+    static_cast< char >( ( value >> 24 ) & 0xff )
+  };
+  os.write(bytes, 4);
+}
+}
+
+bool ParallelDeflate::Compress(const void *data, SizeType length, std::ostream & os,
+                               StreamFormatType format, int level, int numberOfThreads,
+                               SizeType *compressedLength)
+{
+  ParallelDeflateStruct str;
+  str.Data = static_cast< const unsigned char * >( data );
+  str.Length = static_cast< size_t >( length );
+  str.Level = level;
+  str.Gzip = ( format == GzipFormat );
+  str.Failed = false;
+
+  str.NumberOfBlocks = std::max( ( str.Length + BlockLength - 1 ) / BlockLength,
+                                 static_cast< size_t >( 1 ) );
+
+  // header
+  SizeType written = 0;
+  if ( str.Gzip )
+    {
+    const char extraFlags = level == 9 ? 2 : ( level == 1 ? 4 : 0 );
+    const char header[10] = { 0x1f, static_cast< char >( 0x8b ), 8, 0, 0, 0, 0, 0, extraFlags, 3 };
+    os.write(header, 10);
+    written += 10;
+    }
+  else
+    {
+    // the level flags are those zlib writes: 78 01, 78 5e, 78 9c or 78 da
+    const unsigned char levelFlags[4] = { 0x01, 0x5e, 0x9c, 0xda };
+    const int           flags = ( level == -1 || level == 6 ) ? 2
+                                : ( level < 2 ? 0 : ( level < 6 ? 1 : 3 ) );
+    const char          header[2] = { 0x78, static_cast< char >( levelFlags[flags] ) };
+    os.write(header, 2);
+    written += 2;
+    }
+
+  // the blocks, compressed by groups
+  uLong checksum = str.Gzip ? crc32(0, Z_NULL, 0) : adler32(0, Z_NULL, 0);
+  if ( numberOfThreads < 2 || str.NumberOfBlocks == 1 )
+    {
+    std::vector< unsigned char > compressed;
+    checksum = str.Gzip ? ComputeCRC32(str.Data, str.Length) : ComputeAdler32(str.Data, str.Length);
+    if ( !DeflateBlock(str.Data, str.Length, 0, 0, level, Z_FINISH, compressed) )
+      {
+      return false;
+      }
+    os.write( reinterpret_cast< const char * >( &compressed[0] ), compressed.size() );
+    written += compressed.size();
+    }
+  else
+    {
+    MultiThreader::Pointer threader = MultiThreader::New();
+    const size_t           blocksPerGroup = numberOfThreads * BlocksPerThread;
+    for ( str.FirstBlock = 0; str.FirstBlock < str.NumberOfBlocks; str.FirstBlock += blocksPerGroup )
+      {
+      const size_t numberOfBlocks = std::min(blocksPerGroup, str.NumberOfBlocks - str.FirstBlock);
+      str.Compressed.assign( numberOfBlocks, std::vector< unsigned char >() );
+      str.Checksums.assign(numberOfBlocks, 0);
+      str.NextBlock = 0;
+      threader->SetNumberOfThreads( std::min( numberOfThreads, static_cast< int >( numberOfBlocks ) ) );
+      threader->SetSingleMethod(ParallelDeflateThreaderCallback, &str);
+      threader->SingleMethodExecute();
+      if ( str.Failed )
+        {
+        return false;
+        }
+
+      for ( size_t j = 0; j < numberOfBlocks; j++ )
+        {
+        const size_t block = str.FirstBlock + j;
+        const z_off_t blockLengthRead = static_cast< z_off_t >(
+          std::min(BlockLength, str.Length - block * BlockLength) );
+        checksum = str.Gzip ? crc32_combine(checksum, str.Checksums[j], blockLengthRead)
+                   : adler32_combine(checksum, str.Checksums[j], blockLengthRead);
+        os.write( reinterpret_cast< const char * >( &str.Compressed[j][0] ), str.Compressed[j].size() );
+        written += str.Compressed[j].size();
+        }
+      }
+    }
+
+  // trailer
+  if ( str.Gzip )
+    {
+    WriteLittleEndian32(os, checksum);
+    WriteLittleEndian32(os, static_cast< unsigned long >( str.Length & 0xffffffffUL ) );
+    written += 8;
+    }
+  else
+    {
+    WriteBigEndian32(os, checksum);
+    written += 4;
+    }
+
+  if ( compressedLength )
+    {
+    *compressedLength = written;
+    }
+  return !os.fail();
+}
+
+bool ParallelDeflate::DeflateBlock(const unsigned char *data, size_t length,
+                                   const unsigned char *dictionary, size_t dictionaryLength,
+                                   int level, int flush, std::vector< unsigned char > & compressed)
+{
+  z_stream z;
+  memset( &z, 0, sizeof( z ) );
+  if ( deflateInit2(&z, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK )
+    {
+    return false;
+    }
+  if ( dictionaryLength > 0
+       && deflateSetDictionary(&z, dictionary, static_cast< uInt >( dictionaryLength ) ) != Z_OK )
+    {
+    deflateEnd(&z);
+    return false;
+    }
+
+  compressed.resize(length / 2 + 1024);
+  size_t produced = 0;
+  bool   ok = true;
+  do
+    {
+    const size_t block = std::min(length, MaximumZlibBlock);
+    z.next_in = const_cast< unsigned char * >( data );
+    z.avail_in = static_cast< uInt >( block );
+    data += block;
+    length -= block;
+    const int blockFlush = length > 0 ? Z_NO_FLUSH : flush;
+    int       result;
+    do
+      {
+      // a flush needs more than 6 bytes to complete
+      if ( compressed.size() - produced < 64 )
+        {
+        compressed.resize(2 * compressed.size());
+        }
+      const size_t available = std::min(compressed.size() - produced, MaximumZlibBlock);
+      z.next_out = &compressed[produced];
+      z.avail_out = static_cast< uInt >( available );
+      result = deflate(&z, blockFlush);
+      ok = ( result != Z_STREAM_ERROR );
+      produced += available - z.avail_out;
+      }
+    while ( ok && ( z.avail_out == 0 || ( blockFlush == Z_FINISH && result != Z_STREAM_END ) ) );
+    }
+  while ( ok && length > 0 );
+
+  deflateEnd(&z);
+  compressed.resize(produced);
+  return ok;
+}
+
+unsigned long ParallelDeflate::ComputeAdler32(const unsigned char *data, size_t length)
+{
+  uLong adler = adler32(0, Z_NULL, 0);
+  while ( length > 0 )
+    {
+    const size_t block = std::min(length, MaximumZlibBlock);
+    adler = adler32( adler, data, static_cast< uInt >( block ) );
+    data += block;
+    length -= block;
+    }
+  return adler;
+}
+
+unsigned long ParallelDeflate::ComputeCRC32(const unsigned char *data, size_t length)
+{
+  uLong crc = crc32(0, Z_NULL, 0);
+  while ( length > 0 )
+    {
+    const size_t block = std::min(length, MaximumZlibBlock);
+    crc = crc32( crc, data, static_cast< uInt >( block ) );
+    data += block;
+    length -= block;
+    }
+  return crc;
+}
+} // end namespace itk
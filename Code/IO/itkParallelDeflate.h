@@ -0,0 +1,71 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelDeflate.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkParallelDeflate_h
+#define __itkParallelDeflate_h
+
+#include "itkMacro.h"
+#include <iosfwd>
+#include <vector>
+
+namespace itk
+{
+/** \class ParallelDeflate
+ * \brief Compresses a buffer into a zlib or gzip stream on several
+ * threads.
+ *
+ * The data is cut into blocks that are deflated at the same time, each
+ * primed with the end of the block before it, as pigz does. The blocks
+ * are byte aligned by a sync flush and written one after the other
+ * between the header and the trailer of the format, whose checksum is
+ * combined from the checksums of the blocks. The result is a single
+ * standard stream that any zlib or gzip reader decompresses; only its
+ * compression ratio is slightly lower than that of a single thread.
+ *
+ * With one thread the data is deflated in one block, as zlib does.
+ *
+ * \ingroup IOFilters
+ */
+class ITK_EXPORT ParallelDeflate
+{
+public:
+  typedef std::streamoff SizeType;
+
+  typedef enum { ZlibFormat, GzipFormat } StreamFormatType;
+
+  /** Compress length bytes of data at level (0 to 9, or -1 for the zlib
+   * default) on numberOfThreads threads, and write the stream to os. The
+   * length of the stream is returned in compressedLength when it is not
+   * null. Returns false if the data could not be compressed or
+   * written. */
+  static bool Compress(const void *data, SizeType length, std::ostream & os,
+                       StreamFormatType format, int level, int numberOfThreads,
+                       SizeType *compressedLength = 0);
+
+  /** Deflate length bytes of data into a raw deflate block ended by
+   * flush (Z_SYNC_FLUSH, Z_FULL_FLUSH or Z_FINISH). The block may back
+   * reference the dictionaryLength bytes before it in dictionary. */
+  static bool DeflateBlock(const unsigned char *data, size_t length,
+                           const unsigned char *dictionary, size_t dictionaryLength,
+                           int level, int flush, std::vector< unsigned char > & compressed);
+
+  /** Checksums of length bytes of data, for any length. */
+  static unsigned long ComputeAdler32(const unsigned char *data, size_t length);
+  static unsigned long ComputeCRC32(const unsigned char *data, size_t length);
+};
+} // end namespace itk
+
+#endif
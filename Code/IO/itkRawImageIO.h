@@ -102,6 +102,10 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer);
 
+  /** Binary data in the byte order of this machine can be memory
+   * mapped; it starts after GetHeaderSize() bytes. */
+  virtual bool CanMemoryMapRead();
+
   /** Set/Get the Data mask. */
   itkGetConstReferenceMacro(ImageMask, unsigned short);
   void SetImageMask(unsigned long val)
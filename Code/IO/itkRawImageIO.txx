@@ -228,6 +228,26 @@ void RawImageIO< TPixel, VImageDimension >
   else if itkReadRawBytesAfterSwappingMacro(double, DOUBLE)
 }
 
+template< class TPixel, unsigned int VImageDimension >
+bool RawImageIO< TPixel, VImageDimension >
+::CanMemoryMapRead()
+{
+  if ( m_FileType != Binary )
+    {
+    return false;
+    }
+  if ( this->GetComponentSize() > 1
+       && ( ( m_ByteOrder == BigEndian && !ByteSwapperType::SystemIsBigEndian() )
+            || ( m_ByteOrder == LittleEndian && !ByteSwapperType::SystemIsLittleEndian() ) ) )
+    {
+    return false;
+    }
+
+  m_PixelDataFileName = m_FileName;
+  m_PixelDataOffset = this->GetHeaderSize();
+  return true;
+}
+
 template< class TPixel, unsigned int VImageDimension >
 bool RawImageIO< TPixel, VImageDimension >
 ::CanWriteFile(const char *fname)
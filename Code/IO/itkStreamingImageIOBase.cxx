@@ -18,6 +18,17 @@
 
 #include <itksys/SystemTools.hxx>
 
+namespace
+{
+// The size of the image in the file along a dimension, which is 1 for
+// the dimensions of the region past those of the file
+inline itk::ImageIORegion::SizeValueType
+GetFileDimension(const itk::ImageIOBase *io, unsigned int i)
+{
+  return i < io->GetNumberOfDimensions() ? io->GetDimensions(i) : 1;
+}
+}
+
 namespace itk
 {
 StreamingImageIOBase::StreamingImageIOBase():
@@ -50,7 +61,7 @@ bool StreamingImageIOBase
     ++movingDirection;
     }
   while ( movingDirection < m_IORegion.GetImageDimension()
-          && m_IORegion.GetSize(movingDirection - 1) == this->GetDimensions(movingDirection - 1) );
+          && m_IORegion.GetSize(movingDirection - 1) == GetFileDimension(this, movingDirection - 1) );
   sizeOfChunk *= this->GetPixelSize();
 
   ImageIORegion::IndexType currentIndex = m_IORegion.GetIndex();
@@ -65,7 +76,7 @@ bool StreamingImageIOBase
       seekPos = seekPos + static_cast< std::streamoff >( subDimensionQuantity
                                                          * this->GetPixelSize()
                                                          * currentIndex[i] );
-      subDimensionQuantity *= this->GetDimensions(i);
+      subDimensionQuantity *= GetFileDimension(this, i);
       }
 
     itkDebugMacro(
@@ -184,7 +195,7 @@ bool StreamingImageIOBase::StreamWriteBufferAsBinary(std::ostream & file, const
     ++movingDirection;
     }
   while ( movingDirection < m_IORegion.GetImageDimension()
-          && m_IORegion.GetSize(movingDirection - 1) == this->GetDimensions(movingDirection - 1) );
+          && m_IORegion.GetSize(movingDirection - 1) == GetFileDimension(this, movingDirection - 1) );
   sizeOfChunk *= this->GetPixelSize();
 
   ImageIORegion::IndexType currentIndex = m_IORegion.GetIndex();
@@ -198,7 +209,7 @@ bool StreamingImageIOBase::StreamWriteBufferAsBinary(std::ostream & file, const
       seekPos = seekPos + static_cast< std::streamoff >( subDimensionQuantity
                                                          * this->GetPixelSize()
                                                          * currentIndex[i] );
-      subDimensionQuantity *= this->GetDimensions(i);
+      subDimensionQuantity *= GetFileDimension(this, i);
       }
 
     file.seekp(dataPos + seekPos, std::ios::beg);
@@ -283,11 +294,11 @@ void StreamingImageIOBase::OpenFileForWriting(std::ofstream & os, const char *fi
   if ( truncate )
     {
     // truncate
-    os.open(m_FileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    os.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
     }
   else
     {
-    os.open(m_FileName.c_str(), std::ios::out | std::ios::binary | std::ios::in);
+    os.open(filename, std::ios::out | std::ios::binary | std::ios::in);
     }
 
   if ( os.fail() )
@@ -311,6 +322,14 @@ StreamingImageIOBase::GetActualNumberOfSplitsForWriting(unsigned int numberOfReq
                                                         const ImageIORegion & pasteRegion,
                                                         const ImageIORegion & largestPossibleRegion)
 {
+  if ( !this->CanStreamWrite() )
+    {
+    // this file can only be written at once
+    return Superclass::GetActualNumberOfSplitsForWriting(numberOfRequestedSplits,
+                                                         pasteRegion,
+                                                         largestPossibleRegion);
+    }
+
   if ( !itksys::SystemTools::FileExists( m_FileName.c_str() ) )
     {
     // file doesn't exits so we don't have potential problems
@@ -73,7 +73,8 @@ public:
   // see super class for documentation
   //
   // Verifies the set file name meets the pasting requirements, then calls
-  // GetActualNumberOfSplitsForWritingCanStreamWrite
+  // GetActualNumberOfSplitsForWritingCanStreamWrite. Files that
+  // CanStreamWrite returns false for are written as the super class does.
   virtual unsigned int GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
                                                          const ImageIORegion & pasteRegion,
                                                          const ImageIORegion & largestPossibleRegion);
@@ -21,10 +21,15 @@
 #include "itkTIFFImageIO.h"
 #include "itkRGBPixel.h"
 #include "itkRGBAPixel.h"
+#include "itkIntTypes.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 #include <itksys/SystemTools.hxx>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <vector>
 
 #include <sys/stat.h>
 
@@ -62,8 +67,11 @@ public:
   unsigned int   m_TileColumns;
   unsigned int   m_TileWidth;
   unsigned int   m_TileHeight;
-  unsigned short m_NumberOfTiles;
+  unsigned int   m_NumberOfTiles;
+  uint32         m_RowsPerStrip;
   unsigned int   m_SubFiles;
+  // directories of the pages of a file with subfiles
+  std::vector< unsigned short > m_PageDirectories;
   unsigned int   m_ResolutionUnit;
   float          m_XResolution;
   float          m_YResolution;
@@ -118,9 +126,11 @@ void TIFFReaderInternal::Clean()
   this->m_TileColumns = 0;
   this->m_TileWidth = 0;
   this->m_TileHeight = 0;
+  this->m_RowsPerStrip = 0;
   this->m_XResolution = 1;
   this->m_YResolution = 1;
   this->m_SubFiles = 0;
+  this->m_PageDirectories.clear();
   this->m_SampleFormat = 1;
   this->m_ResolutionUnit = 1; // none
   this->m_IsOpen = false;
@@ -176,19 +186,19 @@ int TIFFReaderInternal::Initialize()
         }
       }
 
-    // If the number of pages is still zero we look if the image is tiled
-    if ( this->m_NumberOfPages == 0 && TIFFIsTiled(this->m_Image) )
+    if ( TIFFIsTiled(this->m_Image) )
       {
-      this->m_NumberOfTiles = TIFFNumberOfTiles(this->m_Image);
-
       if ( !TIFFGetField(this->m_Image, TIFFTAG_TILEWIDTH, &this->m_TileWidth)
            || !TIFFGetField(this->m_Image, TIFFTAG_TILELENGTH, &this->m_TileHeight) )
         {
         itkGenericExceptionMacro(
           << "Cannot read tile width and tile length from file");
         }
-      else
+
+      // If the number of pages is still zero the tiles are the slices
+      if ( this->m_NumberOfPages == 0 )
         {
+        this->m_NumberOfTiles = TIFFNumberOfTiles(this->m_Image);
         this->m_TileRows = this->m_Height / this->m_TileHeight;
         this->m_TileColumns = this->m_Width / this->m_TileWidth;
         }
@@ -207,6 +217,7 @@ int TIFFReaderInternal::Initialize()
           if ( subfiletype == 0 )
             {
             this->m_SubFiles += 1;
+            this->m_PageDirectories.push_back(page);
             }
           }
         TIFFReadDirectory(this->m_Image);
@@ -242,6 +253,10 @@ int TIFFReaderInternal::Initialize()
       {
       this->m_TileDepth = 0;
       }
+    if ( !TIFFIsTiled(this->m_Image) )
+      {
+      TIFFGetFieldDefaulted(this->m_Image, TIFFTAG_ROWSPERSTRIP, &this->m_RowsPerStrip);
+      }
     }
 
   return 1;
@@ -265,6 +280,39 @@ int TIFFReaderInternal::CanRead()
            && ( this->m_BitsPerSample == 8 || this->m_BitsPerSample == 16 ) );
 }
 
+/** The file being written, which stays open while its pieces are
+ *  streamed */
+class TIFFWriterInternal
+{
+public:
+  TIFFWriterInternal()
+  {
+    this->m_Image = NULL;
+    this->Clean();
+  }
+
+  // Close the file, which writes the directory of the last page
+  void Clean()
+  {
+    if ( this->m_Image )
+      {
+      TIFFClose(this->m_Image);
+      }
+    this->m_Image = NULL;
+    this->m_FileName = "";
+    this->m_Page = 0;
+    this->m_ChunksWritten = 0;
+    this->m_BytesWritten = 0;
+  }
+
+  TIFF *        m_Image;
+  std::string   m_FileName;
+  // page being written, and the tiles or strips written of it
+  unsigned long m_Page;
+  unsigned long m_ChunksWritten;
+  uint64_t      m_BytesWritten;
+};
+
 bool TIFFImageIO::CanReadFile(const char *file)
 {
   // First check the extension
@@ -1272,14 +1320,271 @@ void TIFFImageIO::ReadVolume(void *buffer)
     }
 }
 
+namespace
+{
+// A tile or a strip of a page of the region read
+struct TIFFChunkJob {
+  unsigned short Directory;
+  unsigned long Page;
+  uint32 Chunk;
+};
+
+struct TIFFChunkReadingStruct {
+  std::string FileName;
+  TIFF *Image;
+  std::vector< TIFFChunkJob > Jobs;
+  unsigned int NextJob;
+  bool Failed;
+  SimpleFastMutexLock Lock;
+  // layout of the pages, which must be the same as the first one
+  uint32 Width;
+  uint32 Height;
+  bool Tiled;
+  uint32 ChunkWidth;
+  uint32 ChunkHeight;
+  // region read
+  char *Buffer;
+  long RegionIndex[2];
+  unsigned long RegionSize[2];
+  size_t PixelSize;
+};
+
+// Decode the chunks of the jobs with the handle tif, and copy their
+// intersection with the region. Returns false if one cannot be read.
+bool ReadChunkJobs(TIFF *tif, TIFFChunkReadingStruct *str)
+{
+  std::vector< unsigned char > chunk;
+
+  while ( true )
+    {
+    str->Lock.Lock();
+    const unsigned int j = str->NextJob++;
+    const bool stop = ( j >= str->Jobs.size() || str->Failed );
+    str->Lock.Unlock();
+    if ( stop )
+      {
+      return true;
+      }
+
+    const TIFFChunkJob & job = str->Jobs[j];
+    if ( TIFFCurrentDirectory(tif) != job.Directory && !TIFFSetDirectory(tif, job.Directory) )
+      {
+      return false;
+      }
+
+    uint32 width = 0;
+    uint32 height = 0;
+    uint32 chunkWidth = 0;
+    uint32 chunkHeight = 0;
+    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+    const bool tiled = TIFFIsTiled(tif) != 0;
+    if ( tiled )
+      {
+      TIFFGetField(tif, TIFFTAG_TILEWIDTH, &chunkWidth);
+      TIFFGetField(tif, TIFFTAG_TILELENGTH, &chunkHeight);
+      }
+    else
+      {
+      chunkWidth = width;
+      TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &chunkHeight);
+      chunkHeight = std::min(chunkHeight, height);
+      }
+    if ( width != str->Width || height != str->Height || tiled != str->Tiled
+         || chunkWidth != str->ChunkWidth || chunkHeight != str->ChunkHeight )
+      {
+      return false;
+      }
+
+    // position of the chunk in the page
+    uint32  chunkX;
+    uint32  chunkY;
+    tsize_t decoded;
+    if ( tiled )
+      {
+      const uint32 tilesAcross = ( width + chunkWidth - 1 ) / chunkWidth;
+      chunkX = ( job.Chunk % tilesAcross ) * chunkWidth;
+      chunkY = ( job.Chunk / tilesAcross ) * chunkHeight;
+      chunk.resize( TIFFTileSize(tif) );
+      decoded = TIFFReadEncodedTile(tif, job.Chunk, &chunk[0], chunk.size());
+      }
+    else
+      {
+      chunkX = 0;
+      chunkY = job.Chunk * chunkHeight;
+      chunk.resize( TIFFStripSize(tif) );
+      decoded = TIFFReadEncodedStrip(tif, job.Chunk, &chunk[0], chunk.size());
+      }
+    if ( decoded < 0 )
+      {
+      return false;
+      }
+
+    const long xBegin = std::max(static_cast< long >( chunkX ), str->RegionIndex[0]);
+    const long xEnd = std::min(static_cast< long >( chunkX + chunkWidth ),
+                               str->RegionIndex[0] + static_cast< long >( str->RegionSize[0] ));
+    const long yBegin = std::max(static_cast< long >( chunkY ), str->RegionIndex[1]);
+    const long yEnd = std::min(static_cast< long >( chunkY + chunkHeight ),
+                               str->RegionIndex[1] + static_cast< long >( str->RegionSize[1] ));
+    for ( long y = yBegin; y < yEnd; y++ )
+      {
+      const size_t inOffset = ( y - chunkY ) * static_cast< size_t >( chunkWidth ) + ( xBegin - chunkX );
+      const size_t outOffset =
+        ( job.Page * str->RegionSize[1] + ( y - str->RegionIndex[1] ) ) * str->RegionSize[0]
+        + ( xBegin - str->RegionIndex[0] );
+      memcpy(str->Buffer + outOffset * str->PixelSize, &chunk[inOffset * str->PixelSize],
+             ( xEnd - xBegin ) * str->PixelSize);
+      }
+    }
+}
+
+ITK_THREAD_RETURN_TYPE TIFFChunkReadingThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = (MultiThreader::ThreadInfoStruct *)( arg );
+  TIFFChunkReadingStruct *         str = (TIFFChunkReadingStruct *)( info->UserData );
+
+  // A TIFF handle decodes one chunk at a time: the first thread uses the
+  // handle of the reader, the others open the file again.
+  TIFF *     tif = info->ThreadID == 0 ? str->Image : TIFFOpen(str->FileName.c_str(), "r");
+  const bool ok = tif && ReadChunkJobs(tif, str);
+  if ( tif && tif != str->Image )
+    {
+    TIFFClose(tif);
+    }
+  if ( !ok )
+    {
+    str->Lock.Lock();
+    str->Failed = true;
+    str->Lock.Unlock();
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+}
+
+/** Read the region from the tiles or the strips intersecting it */
+void TIFFImageIO::ReadChunks(void *buffer)
+{
+  const ImageIORegion & region = this->GetIORegion();
+
+  TIFFChunkReadingStruct str;
+  str.FileName = m_FileName;
+  str.Image = m_InternalImage->m_Image;
+  str.Width = m_InternalImage->m_Width;
+  str.Height = m_InternalImage->m_Height;
+  str.Tiled = m_InternalImage->m_TileWidth > 0;
+  if ( str.Tiled )
+    {
+    str.ChunkWidth = m_InternalImage->m_TileWidth;
+    str.ChunkHeight = m_InternalImage->m_TileHeight;
+    }
+  else
+    {
+    str.ChunkWidth = m_InternalImage->m_Width;
+    str.ChunkHeight = std::min(m_InternalImage->m_RowsPerStrip, static_cast< uint32 >( m_InternalImage->m_Height ));
+    }
+  str.Buffer = static_cast< char * >( buffer );
+  str.PixelSize = this->GetComponentSize() * this->GetNumberOfComponents();
+  for ( unsigned int i = 0; i < 2; i++ )
+    {
+    str.RegionIndex[i] = region.GetIndex(i);
+    str.RegionSize[i] = region.GetSize(i);
+    }
+
+  if ( region.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  // A 2D region of a volume is its first page
+  unsigned long firstPage = 0;
+  unsigned long numberOfPages = 1;
+  if ( region.GetImageDimension() > 2 && m_NumberOfDimensions > 2 )
+    {
+    firstPage = region.GetIndex(2);
+    numberOfPages = region.GetSize(2);
+    }
+
+  const uint32 chunksAcross = ( str.Width + str.ChunkWidth - 1 ) / str.ChunkWidth;
+  const uint32 firstColumn = str.RegionIndex[0] / str.ChunkWidth;
+  const uint32 lastColumn = ( str.RegionIndex[0] + str.RegionSize[0] - 1 ) / str.ChunkWidth;
+  const uint32 firstRow = str.RegionIndex[1] / str.ChunkHeight;
+  const uint32 lastRow = ( str.RegionIndex[1] + str.RegionSize[1] - 1 ) / str.ChunkHeight;
+  for ( unsigned long page = 0; page < numberOfPages; page++ )
+    {
+    TIFFChunkJob job;
+    job.Page = page;
+    if ( m_InternalImage->m_SubFiles > 0 )
+      {
+      if ( firstPage + page >= m_InternalImage->m_PageDirectories.size() )
+        {
+        itkExceptionMacro(<< "Page " << firstPage + page << " is not in file " << m_FileName);
+        }
+      job.Directory = m_InternalImage->m_PageDirectories[firstPage + page];
+      }
+    else
+      {
+      job.Directory = static_cast< unsigned short >( firstPage + page );
+      }
+    for ( uint32 row = firstRow; row <= lastRow; row++ )
+      {
+      for ( uint32 column = firstColumn; column <= lastColumn; column++ )
+        {
+        job.Chunk = row * chunksAcross + column;
+        str.Jobs.push_back(job);
+        }
+      }
+    }
+
+  // decode the chunks in parallel
+  str.NextJob = 0;
+  str.Failed = false;
+  const int numberOfThreads = std::min(static_cast< int >( str.Jobs.size() ), this->GetNumberOfThreads());
+  if ( numberOfThreads > 1 )
+    {
+    MultiThreader::Pointer threader = MultiThreader::New();
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(TIFFChunkReadingThreaderCallback, &str);
+    threader->SingleMethodExecute();
+    }
+  else
+    {
+    str.Failed = !ReadChunkJobs(str.Image, &str);
+    }
+
+  if ( str.Failed )
+    {
+    itkExceptionMacro(<< "Cannot read the " << ( str.Tiled ? "tiles" : "strips" )
+                      << " of the region " << region << " from file " << m_FileName);
+    }
+}
+
 void TIFFImageIO::Read(void *buffer)
 {
+  // The file is closed after each read, and opened again for the next
+  // region streamed
+  if ( !m_InternalImage->m_IsOpen )
+    {
+    if ( !this->CanReadFile( m_FileName.c_str() ) )
+      {
+      itkExceptionMacro(<< "Cannot open the file!");
+      return;
+      }
+    }
+
   if ( m_InternalImage->m_Compression == COMPRESSION_OJPEG )
     {
     itkExceptionMacro(<< "This reader cannot read old JPEG compression");
     return;
     }
 
+  if ( m_CanReadChunks )
+    {
+    this->ReadChunks(buffer);
+    m_InternalImage->Clean();
+    return;
+    }
+
   // The IO region should be of dimensions 3 otherwise we read only the first
   // page
   if ( m_InternalImage->m_NumberOfPages > 0 && this->GetIORegion().GetImageDimension() > 2 )
@@ -1373,6 +1678,13 @@ TIFFImageIO::TIFFImageIO()
 
   this->InitializeColors();
   m_InternalImage = new TIFFReaderInternal;
+  m_InternalWriter = new TIFFWriterInternal;
+  m_CanReadChunks = false;
+  m_TileWidth = 0;
+  m_TileHeight = 0;
+
+  // the chunks decoded do not depend on the number of threads
+  this->SetNumberOfThreads( MultiThreader::GetGlobalDefaultNumberOfThreads() );
 
   m_Spacing[0] = 1.0;
   m_Spacing[1] = 1.0;
@@ -1397,12 +1709,16 @@ TIFFImageIO::~TIFFImageIO()
 {
   m_InternalImage->Clean();
   delete m_InternalImage;
+  m_InternalWriter->Clean();
+  delete m_InternalWriter;
 }
 
 void TIFFImageIO::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
   os << indent << "Compression: " << m_Compression << "\n";
+  os << indent << "TileWidth: " << m_TileWidth << "\n";
+  os << indent << "TileHeight: " << m_TileHeight << "\n";
 }
 
 void TIFFImageIO::InitializeColors()
@@ -1542,9 +1858,59 @@ void TIFFImageIO::ReadImageInformation()
     m_Origin[2] = 0.0;
     }
 
+  // the pixels are stored by tiles, or by strips of rows of each page
+  m_ChunkSize.assign(m_NumberOfDimensions, 1);
+  if ( m_InternalImage->m_TileWidth > 0 && m_InternalImage->m_TileHeight > 0 )
+    {
+    m_ChunkSize[0] = m_InternalImage->m_TileWidth;
+    m_ChunkSize[1] = m_InternalImage->m_TileHeight;
+    }
+  else if ( m_InternalImage->m_RowsPerStrip > 0 )
+    {
+    m_ChunkSize[0] = m_Dimensions[0];
+    m_ChunkSize[1] = std::min( static_cast< ImageIORegion::SizeValueType >( m_InternalImage->m_RowsPerStrip ),
+                               static_cast< ImageIORegion::SizeValueType >( m_Dimensions[1] ) );
+    }
+  else
+    {
+    m_ChunkSize.clear();
+    }
+
+  // Grayscale and RGB(A) samples are read as they are stored, a tile or
+  // a strip at a time
+  m_CanReadChunks = !m_ChunkSize.empty()
+                    && m_InternalImage->CanRead()
+                    && m_InternalImage->m_NumberOfTiles == 0
+                    && m_InternalImage->m_Orientation == ORIENTATION_TOPLEFT
+                    && ( ( this->GetFormat() == TIFFImageIO::GRAYSCALE
+                           && m_InternalImage->m_Photometrics == PHOTOMETRIC_MINISBLACK
+                           && m_InternalImage->m_SamplesPerPixel == 1 )
+                         || ( this->GetFormat() == TIFFImageIO::RGB_
+                              && m_InternalImage->m_SamplesPerPixel >= 3 ) );
+
   return;
 }
 
+bool TIFFImageIO::CanStreamRead()
+{
+  return m_CanReadChunks;
+}
+
+ImageIORegion
+TIFFImageIO::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const
+{
+  if ( m_UseStreamedReading && m_CanReadChunks )
+    {
+    return requested;
+    }
+  return Superclass::GenerateStreamableReadRegionFromRequestedRegion(requested);
+}
+
+ImageIORegion::SizeType TIFFImageIO::GetChunkSize() const
+{
+  return m_ChunkSize;
+}
+
 bool TIFFImageIO::CanWriteFile(const char *name)
 {
   std::string filename = name;
@@ -1588,6 +1954,53 @@ bool TIFFImageIO::CanWriteFile(const char *name)
 void TIFFImageIO::WriteImageInformation()
 {}
 
+ImageIORegion::SizeType TIFFImageIO::GetWriteChunkSize()
+{
+  ImageIORegion::SizeType chunkSize(m_NumberOfDimensions, 1);
+
+  if ( m_TileWidth > 0 && m_TileHeight > 0 )
+    {
+    if ( m_TileWidth % 16 != 0 || m_TileHeight % 16 != 0 )
+      {
+      itkExceptionMacro(<< "The size of the tiles must be a multiple of 16: "
+                        << m_TileWidth << "x" << m_TileHeight);
+      }
+    chunkSize[0] = m_TileWidth;
+    chunkSize[1] = m_TileHeight;
+    return chunkSize;
+    }
+
+  // Strips of about 8 kB, as TIFFDefaultStripSize, of multiples of 16
+  // rows with the YCbCr subsampling of JPEG
+  const SizeType rowLength = this->GetComponentSize() * this->GetNumberOfComponents() * m_Dimensions[0];
+  SizeType       rows = std::max(static_cast< SizeType >( 8192 / rowLength ), static_cast< SizeType >( 1 ));
+  if ( m_UseCompression && m_Compression == TIFFImageIO::JPEG )
+    {
+    rows = ( rows + 15 ) / 16 * 16;
+    }
+  chunkSize[0] = m_Dimensions[0];
+  chunkSize[1] = std::min(static_cast< ImageIORegion::SizeValueType >( rows ),
+                          static_cast< ImageIORegion::SizeValueType >( m_Dimensions[1] ));
+  return chunkSize;
+}
+
+unsigned int
+TIFFImageIO::GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
+                                               const ImageIORegion & pasteRegion,
+                                               const ImageIORegion & largestPossibleRegion)
+{
+  if ( pasteRegion != largestPossibleRegion )
+    {
+    itkExceptionMacro( "Pasting is not supported! Can't write:" << this->GetFileName() );
+    }
+
+  // the pieces are made of whole strips or tiles, and of whole pages
+  // when the region has several
+  m_ChunkSize = this->GetWriteChunkSize();
+  return Superclass::GetActualNumberOfSplitsForWriting(numberOfRequestedSplits, pasteRegion,
+                                                       largestPossibleRegion);
+}
+
 void TIFFImageIO::Write(const void *buffer)
 {
   if ( m_NumberOfDimensions == 2 || m_NumberOfDimensions == 3 )
@@ -1650,7 +2063,7 @@ public:
 
 void TIFFImageIO::InternalWrite(const void *buffer)
 {
-  char *outPtr = (char *)buffer;
+  const char *outPtr = static_cast< const char * >( buffer );
 
   unsigned int width, height, page, pages = 1;
 
@@ -1663,7 +2076,6 @@ void TIFFImageIO::InternalWrite(const void *buffer)
 
   int    scomponents = this->GetNumberOfComponents();
   double resolution = -1;
-  uint32 rowsperstrip = ( uint32 ) - 1;
   int    bps;
 
   switch ( this->GetComponentType() )
@@ -1687,168 +2099,269 @@ void TIFFImageIO::InternalWrite(const void *buffer)
 
   int predictor;
 
-  TIFF *tif = TIFFOpen(m_FileName.c_str(), "w");
-  if ( !tif )
+  // The region written is made of whole tiles or strips, and of whole
+  // pages when it has several
+  const ImageIORegion & region = this->GetIORegion();
+  const unsigned long   regionX = region.GetIndex(0);
+  const unsigned long   regionY = region.GetIndex(1);
+  const unsigned long   regionWidth = region.GetSize(0);
+  const unsigned long   regionHeight = region.GetSize(1);
+  unsigned long         firstPage = 0;
+  unsigned long         numberOfPages = 1;
+  if ( m_NumberOfDimensions == 3 )
     {
-    itkExceptionMacro( "Error while trying to open file for writing: "
-                       << this->GetFileName()
-                       << std::endl
-                       << "Reason: "
-                       << itksys::SystemTools::GetLastSystemError() );
+    firstPage = region.GetIndex(2);
+    numberOfPages = region.GetSize(2);
     }
 
-  if ( this->GetComponentType() == SHORT
-       || this->GetComponentType() == CHAR )
+  const bool                    tiled = m_TileWidth > 0 && m_TileHeight > 0;
+  const ImageIORegion::SizeType chunkSize = this->GetWriteChunkSize();
+  const unsigned long           chunkWidth = chunkSize[0];
+  const unsigned long           chunkHeight = chunkSize[1];
+  const unsigned long           chunksAcross = ( width + chunkWidth - 1 ) / chunkWidth;
+  const unsigned long           chunksPerPage = chunksAcross * ( ( height + chunkHeight - 1 ) / chunkHeight );
+  const bool                    wholePage = regionX == 0 && regionY == 0
+                                            && regionWidth == width && regionHeight == height;
+  if ( regionX % chunkWidth != 0 || regionY % chunkHeight != 0
+       || ( ( regionX + regionWidth ) % chunkWidth != 0 && regionX + regionWidth != width )
+       || ( ( regionY + regionHeight ) % chunkHeight != 0 && regionY + regionHeight != height )
+       || ( numberOfPages > 1 && !wholePage ) )
+    {
+    itkExceptionMacro(<< "The region written to " << m_FileName << " is not made of whole "
+                      << ( tiled ? "tiles" : "strips" ) << ": " << region);
+    }
+
+  // Size in bytes of a row of the region, and of a tile or a strip
+  const size_t pixelSize = this->GetComponentSize() * scomponents;
+  const size_t rowLength = pixelSize * regionWidth;
+  const size_t chunkLength = pixelSize * chunkWidth * chunkHeight;
+
+  // Classic TIFF files address their content with 32 bit offsets. The
+  // room left for the tags is generous.
+  const uint64_t classicTIFFMaximumSize = 0xFFFFFFFFUL;
+  const uint64_t tagsSize = 4096 * static_cast< uint64_t >( pages )
+                            + 8 * static_cast< uint64_t >( chunksPerPage ) * pages;
+
+  // The first piece, at the origin, starts a new file
+  TIFFWriterInternal & writing = *m_InternalWriter;
+  if ( !writing.m_Image || writing.m_FileName != m_FileName
+       || ( firstPage == 0 && regionX == 0 && regionY == 0 ) )
+    {
+    writing.Clean();
+
+    // Uncompressed data a little larger than the image, as PackBits may
+    // make, needs a BigTIFF
+    const uint64_t imageSize = static_cast< uint64_t >( pixelSize ) * width * height * pages;
+    const bool     bigTIFF = imageSize + imageSize / 64 + tagsSize > classicTIFFMaximumSize;
+#ifdef TIFF_VERSION_BIG
+    TIFF *tif = TIFFOpen(m_FileName.c_str(), bigTIFF ? "w8" : "w");
+#else
+    if ( bigTIFF && !m_UseCompression )
+      {
+      itkExceptionMacro(<< "Cannot write " << m_FileName << ": a TIFF file is limited to 4 GB, "
+                        << "and the TIFF library does not write BigTIFF files");
+      }
+    TIFF *tif = TIFFOpen(m_FileName.c_str(), "w");
+#endif
+    if ( !tif )
+      {
+      itkExceptionMacro( "Error while trying to open file for writing: "
+                         << this->GetFileName()
+                         << std::endl
+                         << "Reason: "
+                         << itksys::SystemTools::GetLastSystemError() );
+      }
+    writing.m_Image = tif;
+    writing.m_FileName = m_FileName;
+    }
+  else if ( firstPage != writing.m_Page )
     {
-    TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_INT);
+    itkExceptionMacro(<< "The pages of " << m_FileName << " are written in order: page "
+                      << firstPage << " cannot follow page " << writing.m_Page);
     }
+  TIFF *tif = writing.m_Image;
 
   uint32 w = width;
   uint32 h = height;
 
-  if ( m_NumberOfDimensions == 3 )
-    {
-    TIFFCreateDirectory(tif);
-    }
-  for ( page = 0; page < pages; page++ )
+  std::vector< char > chunk(chunkLength);
+  for ( page = firstPage; page < firstPage + numberOfPages; page++ )
     {
-    TIFFSetDirectory(tif, page);
-    TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, w);
-    TIFFSetField(tif, TIFFTAG_IMAGELENGTH, h);
-    TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
-    TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, scomponents);
-    TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bps); // Fix for stype
-    TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-    if ( this->GetComponentType() == SHORT
-         || this->GetComponentType() == CHAR )
+    if ( writing.m_ChunksWritten == 0 )
       {
-      TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_INT);
-      }
-    TIFFSetField(tif, TIFFTAG_SOFTWARE, "InsightToolkit");
+      TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, w);
+      TIFFSetField(tif, TIFFTAG_IMAGELENGTH, h);
+      TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+      TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, scomponents);
+      TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bps); // Fix for stype
+      TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+      if ( this->GetComponentType() == SHORT
+           || this->GetComponentType() == CHAR )
+        {
+        TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_INT);
+        }
+      TIFFSetField(tif, TIFFTAG_SOFTWARE, "InsightToolkit");
 
-    if ( scomponents > 3 )
-      {
-      // if number of scalar components is greater than 3, that means we assume
-      // there is alpha.
-      uint16  extra_samples = scomponents - 3;
-      uint16 *sample_info = new uint16[scomponents - 3];
-      sample_info[0] = EXTRASAMPLE_ASSOCALPHA;
-      int cc;
-      for ( cc = 1; cc < scomponents - 3; cc++ )
+      if ( scomponents > 3 )
         {
-        sample_info[cc] = EXTRASAMPLE_UNSPECIFIED;
+        // if number of scalar components is greater than 3, that means we assume
+        // there is alpha.
+        uint16  extra_samples = scomponents - 3;
+        uint16 *sample_info = new uint16[scomponents - 3];
+        sample_info[0] = EXTRASAMPLE_ASSOCALPHA;
+        int cc;
+        for ( cc = 1; cc < scomponents - 3; cc++ )
+          {
+          sample_info[cc] = EXTRASAMPLE_UNSPECIFIED;
+          }
+        TIFFSetField(tif, TIFFTAG_EXTRASAMPLES, extra_samples,
+                     sample_info);
+        delete[] sample_info;
         }
-      TIFFSetField(tif, TIFFTAG_EXTRASAMPLES, extra_samples,
-                   sample_info);
-      delete[] sample_info;
-      }
 
-    int compression;
+      int compression;
 
-    if ( m_UseCompression )
-      {
-      switch ( m_Compression )
+      if ( m_UseCompression )
         {
-        case TIFFImageIO::PackBits:
-          compression = COMPRESSION_PACKBITS; break;
-        case TIFFImageIO::JPEG:
-          compression = COMPRESSION_JPEG; break;
-        case TIFFImageIO::Deflate:
-          compression = COMPRESSION_DEFLATE; break;
-        case TIFFImageIO::LZW:
-          compression = COMPRESSION_LZW; break;
-        default:
-          compression = COMPRESSION_NONE;
+        switch ( m_Compression )
+          {
+          case TIFFImageIO::PackBits:
+            compression = COMPRESSION_PACKBITS; break;
+          case TIFFImageIO::JPEG:
+            compression = COMPRESSION_JPEG; break;
+          case TIFFImageIO::Deflate:
+            compression = COMPRESSION_DEFLATE; break;
+          case TIFFImageIO::LZW:
+            compression = COMPRESSION_LZW; break;
+          default:
+            compression = COMPRESSION_NONE;
+          }
+        }
+      else
+        {
+        compression = COMPRESSION_NONE;
         }
-      }
-    else
-      {
-      compression = COMPRESSION_NONE;
-      }
 
-    TIFFSetField(tif, TIFFTAG_COMPRESSION, compression); // Fix for compression
+      TIFFSetField(tif, TIFFTAG_COMPRESSION, compression); // Fix for compression
 
-    uint16 photometric = ( scomponents == 1 ) ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB;
+      uint16 photometric = ( scomponents == 1 ) ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB;
 
-    if ( compression == COMPRESSION_JPEG )
-      {
-      TIFFSetField(tif, TIFFTAG_JPEGQUALITY, 75); // Parameter
-      TIFFSetField(tif, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
-      photometric = PHOTOMETRIC_YCBCR;
-      }
-    else if ( compression == COMPRESSION_LZW )
-      {
-      predictor = 2;
-      TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor);
-      itkDebugMacro(<< "LZW compression is patented outside US so it is disabled");
-      }
-    else if ( compression == COMPRESSION_DEFLATE )
-      {
-      predictor = 2;
-      TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor);
-      }
+      if ( compression == COMPRESSION_JPEG )
+        {
+        TIFFSetField(tif, TIFFTAG_JPEGQUALITY, 75); // Parameter
+        TIFFSetField(tif, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
+        photometric = PHOTOMETRIC_YCBCR;
+        }
+      else if ( compression == COMPRESSION_LZW )
+        {
+        predictor = 2;
+        TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor);
+        itkDebugMacro(<< "LZW compression is patented outside US so it is disabled");
+        }
+      else if ( compression == COMPRESSION_DEFLATE )
+        {
+        predictor = 2;
+        TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor);
+        }
 
-    TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, photometric); // Fix for scomponents
+      TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, photometric); // Fix for scomponents
 
-    TIFFSetField( tif,
-                  TIFFTAG_ROWSPERSTRIP,
-                  TIFFDefaultStripSize(tif, rowsperstrip) );
-    if ( resolution > 0 )
-      {
-      TIFFSetField(tif, TIFFTAG_XRESOLUTION, resolution);
-      TIFFSetField(tif, TIFFTAG_YRESOLUTION, resolution);
-      TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, RESUNIT_INCH);
-      }
+      if ( tiled )
+        {
+        TIFFSetField(tif, TIFFTAG_TILEWIDTH, static_cast< uint32 >( chunkWidth ));
+        TIFFSetField(tif, TIFFTAG_TILELENGTH, static_cast< uint32 >( chunkHeight ));
+        }
+      else
+        {
+        TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, static_cast< uint32 >( chunkHeight ));
+        }
+      if ( resolution > 0 )
+        {
+        TIFFSetField(tif, TIFFTAG_XRESOLUTION, resolution);
+        TIFFSetField(tif, TIFFTAG_YRESOLUTION, resolution);
+        TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, RESUNIT_INCH);
+        }
 
-    if ( m_NumberOfDimensions == 3 )
-      {
-      // We are writing single page of the multipage file
-      TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
-      // Set the page number
-      TIFFSetField(tif, TIFFTAG_PAGENUMBER, page, pages);
+      if ( m_NumberOfDimensions == 3 )
+        {
+        // We are writing single page of the multipage file
+        TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
+        // Set the page number
+        TIFFSetField(tif, TIFFTAG_PAGENUMBER, page, pages);
+        }
       }
-    int rowLength; // in bytes
 
-    switch ( this->GetComponentType() )
+    // Copy the tiles or strips of the region, the tiles at the right and
+    // bottom edges padded with zeros, and encode them
+    for ( unsigned long y = regionY; y < regionY + regionHeight; y += chunkHeight )
       {
-      case UCHAR:
-        rowLength = sizeof( unsigned char );
-        break;
-      case USHORT:
-        rowLength = sizeof( unsigned short );
-        break;
-      case CHAR:
-        rowLength = sizeof( char );
-        break;
-      case SHORT:
-        rowLength = sizeof( short );
-        break;
-      default:
-        itkExceptionMacro(
-          << "TIFF supports unsigned/signed char and unsigned/signed short");
-      }
+      const unsigned long rows = std::min(chunkHeight, height - y);
+      for ( unsigned long x = regionX; x < regionX + regionWidth; x += chunkWidth )
+        {
+        const unsigned long columns = std::min(chunkWidth, width - x);
+        const size_t        columnsLength = pixelSize * columns;
+        if ( tiled && ( rows < chunkHeight || columns < chunkWidth ) )
+          {
+          std::fill(chunk.begin(), chunk.end(), 0);
+          }
+        for ( unsigned long row = 0; row < rows; row++ )
+          {
+          memcpy(&chunk[row * pixelSize * chunkWidth],
+                 outPtr + ( y + row - regionY ) * rowLength + ( x - regionX ) * pixelSize,
+                 columnsLength);
+          }
+
+        const uint32 index = static_cast< uint32 >( ( y / chunkHeight ) * chunksAcross + x / chunkWidth );
+        tsize_t      written;
+        toff_t *     byteCounts = NULL;
+        if ( tiled )
+          {
+          written = TIFFWriteEncodedTile(tif, index, &chunk[0], chunkLength);
+          TIFFGetField(tif, TIFFTAG_TILEBYTECOUNTS, &byteCounts);
+          }
+        else
+          {
+          written = TIFFWriteEncodedStrip(tif, index, &chunk[0], rows * columnsLength);
+          TIFFGetField(tif, TIFFTAG_STRIPBYTECOUNTS, &byteCounts);
+          }
+        if ( written < 0 )
+          {
+          writing.Clean();
+          itkExceptionMacro(<< "TIFFImageIO: error out of disk space");
+          }
+        writing.m_ChunksWritten++;
 
-    rowLength *= this->GetNumberOfComponents();
-    rowLength *= width;
+#ifndef TIFF_VERSION_BIG
+        // The compressed data may still exceed the classic TIFF limit
+        writing.m_BytesWritten += byteCounts ? byteCounts[index] : 0;
+        if ( writing.m_BytesWritten + tagsSize > classicTIFFMaximumSize )
+          {
+          writing.Clean();
+          itkExceptionMacro(<< "Cannot write " << m_FileName << ": a TIFF file is limited to 4 GB, "
+                            << "and the TIFF library does not write BigTIFF files");
+          }
+#endif
+        }
+      }
 
-    int row = 0;
-    for ( unsigned int idx2 = 0; idx2 < height; idx2++ )
+    // The directory of a page is written once its data is
+    if ( writing.m_ChunksWritten == chunksPerPage )
       {
-      if ( TIFFWriteScanline(tif, const_cast< char * >( outPtr ), row, 0) < 0 )
+      if ( m_NumberOfDimensions == 3 )
         {
-        itkExceptionMacro(<< "TIFFImageIO: error out of disk space");
-        break;
+        TIFFWriteDirectory(tif);
         }
-      outPtr += rowLength;
-      row++;
+      writing.m_Page++;
+      writing.m_ChunksWritten = 0;
       }
+    outPtr += rowLength * regionHeight;
+    }
 
-    if ( m_NumberOfDimensions == 3 )
-      {
-      TIFFWriteDirectory(tif);
-      }
+  // The file is complete
+  if ( writing.m_Page == pages )
+    {
+    writing.Clean();
     }
-  TIFFClose(tif);
 }
 
 bool TIFFImageIO::CanFindTIFFTag(unsigned int t)
@@ -24,12 +24,28 @@ namespace itk
 {
 //BTX
 class TIFFReaderInternal;
+class TIFFWriterInternal;
 //ETX
 
 /** \class TIFFImageIO
  *
  * \brief ImageIO object for reading and writing TIFF images
  *
+ * Grayscale and RGB(A) files stored by tiles or by strips are read a
+ * region at a time: only the tiles or strips intersecting the region are
+ * decoded, on up to GetNumberOfThreads() threads (by default the global
+ * default number of threads of MultiThreader). The other layouts
+ * (palettes, planar or unusual photometric interpretations) are read
+ * whole.
+ *
+ * The files are written by strips, or by tiles of TileWidth x
+ * TileHeight pixels when both are set. Streamed writing is supported:
+ * the pieces are made of whole strips or tiles and the pages of a
+ * volume are written in order. Pasting a region into an existing file
+ * is not supported. The offsets of classic TIFF files are 32 bits, so a
+ * file larger than 4 GB is written as a BigTIFF when the TIFF library
+ * supports it, and is an error otherwise.
+ *
  * \ingroup IOFilters
  *
  */
@@ -65,6 +81,20 @@ public:
   /** Reads 3D data from tiled tiff. */
   virtual void ReadTiles(void *buffer);
 
+  /** Determine if a region of the file can be read without reading the
+   * rest of it: true for the grayscale and RGB(A) files without
+   * palette. Valid after ReadImageInformation(). */
+  virtual bool CanStreamRead();
+
+  /** Return the requested region when streaming is enabled and the file
+   * can be read a region at a time, and the whole image otherwise. */
+  virtual ImageIORegion
+  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const;
+
+  /** The tiles or the strips of the file read, or of the file written
+   * once the number of pieces to write is known. */
+  virtual ImageIORegion::SizeType GetChunkSize() const;
+
   /*-------- This part of the interfaces deals with writing data. ----- */
 
   /** Determine the file type. Returns true if this ImageIO can read the
@@ -79,6 +109,26 @@ public:
    * that the IORegion has been set properly. */
   virtual void Write(const void *buffer);
 
+  /** The pieces of a file can be written in turn, see
+   * GetActualNumberOfSplitsForWriting(). */
+  virtual bool CanStreamWrite()
+  {
+    return true;
+  }
+
+  /** The pieces are made of whole strips or tiles, and must be written
+   * in order. Pasting is not supported. */
+  virtual unsigned int GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
+                                                         const ImageIORegion & pasteRegion,
+                                                         const ImageIORegion & largestPossibleRegion);
+
+  /** Set/Get the size of the tiles of the files written. The TIFF
+   * format requires multiples of 16. The default of 0 writes strips. */
+  itkSetMacro(TileWidth, unsigned int);
+  itkGetConstMacro(TileWidth, unsigned int);
+  itkSetMacro(TileHeight, unsigned int);
+  itkGetConstMacro(TileHeight, unsigned int);
+
   enum { NOFORMAT, RGB_, GRAYSCALE, PALETTE_RGB, PALETTE_GRAYSCALE, OTHER };
 
   //BTX
@@ -149,7 +199,14 @@ protected:
   // Read and returns the raw bytes of tag t
   void * ReadRawByteFromTag(unsigned int t, short & value_count);
 
+  // Read the region of the tiles or strips of the pages it intersects
+  void ReadChunks(void *buffer);
+
+  // Size of the tiles or strips the file is written with
+  ImageIORegion::SizeType GetWriteChunkSize();
+
   TIFFReaderInternal *m_InternalImage;
+  TIFFWriterInternal *m_InternalWriter;
 
   int m_Compression;
 private:
@@ -161,6 +218,12 @@ private:
   unsigned short *m_ColorBlue;
   int             m_TotalColors;
   unsigned int    m_ImageFormat;
+
+  ImageIORegion::SizeType m_ChunkSize;
+  bool                    m_CanReadChunks;
+
+  unsigned int m_TileWidth;
+  unsigned int m_TileHeight;
 };
 } // end namespace itk
 
@@ -396,6 +396,22 @@ void VTKImageIO::Read(void *buffer)
     }
 }
 
+bool VTKImageIO::CanMemoryMapRead()
+{
+  if ( m_FileType != Binary
+       || ( this->GetComponentSize() > 1 && !ByteSwapper< int >::SystemIsBigEndian() ) )
+    {
+    return false;
+    }
+
+  // The data follows the header
+  std::ifstream file;
+  this->InternalReadImageInformation(file);
+  m_PixelDataFileName = m_FileName;
+  m_PixelDataOffset = file.tellg();
+  return true;
+}
+
 void VTKImageIO::ReadImageInformation()
 {
   std::ifstream file;
@@ -62,6 +62,10 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer);
 
+  /** Binary data can be memory mapped when it does not need to be
+   * swapped: the data of a VTK file is big endian. */
+  virtual bool CanMemoryMapRead();
+
   /*-------- This part of the interfaces deals with writing data. ----- */
 
   /** Determine the file type. Returns true if this ImageIO can read the
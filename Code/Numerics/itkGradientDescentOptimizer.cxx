@@ -21,6 +21,7 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkExceptionObject.h"
+#include "vcl_cmath.h"
 
 namespace itk
 {
@@ -33,6 +34,8 @@ GradientDescentOptimizer
   itkDebugMacro("Constructor");
 
   m_LearningRate = 1.0;
+  m_LearningRateDecayExponent = 0.0;
+  m_LearningRateDecayOffset = 0.0;
   m_NumberOfIterations = 100;
   m_CurrentIteration = 0;
   m_Maximize = false;
@@ -56,6 +59,10 @@ GradientDescentOptimizer
 
   os << indent << "LearningRate: "
      << m_LearningRate << std::endl;
+  os << indent << "LearningRateDecayExponent: "
+     << m_LearningRateDecayExponent << std::endl;
+  os << indent << "LearningRateDecayOffset: "
+     << m_LearningRateDecayOffset << std::endl;
   os << indent << "NunberOfIterations: "
      << m_NumberOfIterations << std::endl;
   os << indent << "Maximize: "
@@ -77,6 +84,22 @@ GradientDescentOptimizer
   os << std::endl;
 }
 
+/**
+ * Learning rate of the current iteration
+ */
+double
+GradientDescentOptimizer
+::GetCurrentLearningRate() const
+{
+  if ( m_LearningRateDecayExponent == 0.0 )
+    {
+    return m_LearningRate;
+    }
+  return m_LearningRate * vcl_pow( ( m_LearningRateDecayOffset + 1.0 )
+                                   / ( m_LearningRateDecayOffset + m_CurrentIteration + 1.0 ),
+                                   m_LearningRateDecayExponent );
+}
+
 /**
  * Start the optimization
  */
@@ -202,11 +225,13 @@ GradientDescentOptimizer
     transformedGradient[j] = m_Gradient[j] / scales[j];
     }
 
+  const double learningRate = this->GetCurrentLearningRate();
+
   ParametersType newPosition(spaceDimension);
   for ( unsigned int j = 0; j < spaceDimension; j++ )
     {
     newPosition[j] = currentPosition[j]
-                     + direction * m_LearningRate * transformedGradient[j];
+                     + direction * learningRate * transformedGradient[j];
     }
 
   this->SetCurrentPosition(newPosition);
@@ -33,7 +33,18 @@ namespace itk
                   \, \frac{\partial f(p_n) }{\partial p_n}
  * \f]
  *
- * The learning rate is a fixed scalar defined via SetLearningRate().
+ * The learning rate is a scalar defined via SetLearningRate(). It is
+ * fixed by default, or decays with the iterations as
+ *
+ * \f[
+ *        \mbox{learningRate} \, \left( \frac{A + 1}{A + n + 1} \right)^\alpha
+ * \f]
+ *
+ * when the LearningRateDecayExponent \f$ \alpha \f$ is not zero, \f$ A \f$
+ * being the LearningRateDecayOffset. The decaying learning rate makes the
+ * optimizer a stochastic gradient descent, converging when the derivatives
+ * are noisy estimates, as those of a metric drawing new random samples at
+ * each evaluation.
  * The optimizer steps through a user defined number of iterations;
  * no convergence checking is done.
  *
@@ -99,6 +110,20 @@ public:
   /** Get the learning rate. */
   itkGetConstReferenceMacro(LearningRate, double);
 
+  /** Set/Get the exponent alpha of the decay of the learning rate with the
+   * iterations. Zero, the default, keeps the learning rate fixed. Values
+   * between 0.5 and 1 give the usual stochastic gradient descent. */
+  itkSetMacro(LearningRateDecayExponent, double);
+  itkGetConstReferenceMacro(LearningRateDecayExponent, double);
+
+  /** Set/Get the number of iterations A after which the learning rate has
+   * decayed by a factor of 2^alpha. Zero by default. */
+  itkSetMacro(LearningRateDecayOffset, double);
+  itkGetConstReferenceMacro(LearningRateDecayOffset, double);
+
+  /** Get the learning rate of the current iteration. */
+  double GetCurrentLearningRate() const;
+
   /** Set the number of iterations. */
   itkSetMacro(NumberOfIterations, unsigned long);
 
@@ -128,6 +153,8 @@ protected:
   bool m_Maximize;
 
   double m_LearningRate;
+  double m_LearningRateDecayExponent;
+  double m_LearningRateDecayOffset;
 private:
   GradientDescentOptimizer(const Self &); //purposely not implemented
   void operator=(const Self &);           //purposely not implemented
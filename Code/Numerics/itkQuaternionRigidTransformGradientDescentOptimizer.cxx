@@ -63,11 +63,13 @@ QuaternionRigidTransformGradientDescentOptimizer
 
   ParametersType currentPosition = this->GetCurrentPosition();
 
+  const double learningRate = this->GetCurrentLearningRate();
+
   // compute new quaternion value
   vnl_quaternion< double > newQuaternion;
   for ( unsigned int j = 0; j < 4; j++ )
     {
-    newQuaternion[j] = currentPosition[j] + direction * m_LearningRate
+    newQuaternion[j] = currentPosition[j] + direction * learningRate
                        * transformedGradient[j];
     }
 
@@ -84,7 +86,7 @@ QuaternionRigidTransformGradientDescentOptimizer
   for ( unsigned int j = 4; j < spaceDimension; j++ )
     {
     newPosition[j] = currentPosition[j]
-                     + direction * m_LearningRate * transformedGradient[j];
+                     + direction * learningRate * transformedGradient[j];
     }
 
   // First invoke the event, so the current position
@@ -29,6 +29,10 @@ void RegisterTests()
   REGISTER_TEST(itkBinaryThinningImageFilterTest );
   REGISTER_TEST(itkDeformableTest );
   REGISTER_TEST(itkGibbsTest );
+  REGISTER_TEST(itkHistogramImageToImageMetricThreadsTest );
+  REGISTER_TEST(itkImageToImageMetricFastSampleEvaluationTest );
+  REGISTER_TEST(itkImageToImageMetricStochasticSamplingTest );
+  REGISTER_TEST(itkImageToImageMetricThreadsTest );
   REGISTER_TEST(itkMRFImageFilterTest );
   REGISTER_TEST(itkMRIBiasFieldCorrectionFilterTest );
   REGISTER_TEST(itkMattesMutualInformationImageToImageMetricTest );
@@ -0,0 +1,292 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkHistogramImageToImageMetricThreadsTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkAffineTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkMutualInformationHistogramImageToImageMetric.h"
+#include "itkNormalizedMutualInformationHistogramImageToImageMetric.h"
+#include "itkCorrelationCoefficientHistogramImageToImageMetric.h"
+#include "itkMeanSquaresHistogramImageToImageMetric.h"
+#include "itkMeanSquaresImageToImageMetric.h"
+
+#include <iostream>
+#include <vector>
+
+/**
+ *  This test computes the joint histogram of the histogram metrics with 1,
+ *  2 and 3 threads, and checks that it is the histogram of the pixels of
+ *  the fixed image whatever the number of threads. It then checks that the
+ *  derivatives computed through the Parzen window agree with the finite
+ *  differences of the metric, and for the mean squares with the derivative
+ *  of MeanSquaresImageToImageMetric.
+ */
+
+namespace
+{
+const unsigned int Dimension = 2;
+
+typedef itk::Image< float, Dimension >            ImageType;
+typedef itk::AffineTransform< double, Dimension > TransformType;
+typedef itk::LinearInterpolateImageFunction< ImageType, double > InterpolatorType;
+
+// A smooth image, shifted by shift pixels along x
+ImageType::Pointer MakeImage(double shift)
+{
+  ImageType::SizeType size = { { 61, 53 } };
+  ImageType::Pointer  image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const double x = it.GetIndex()[0] - shift;
+    const double y = it.GetIndex()[1];
+    it.Set( static_cast< float >( 50.0 + 100.0 * vcl_sin(x / 9.0) * vcl_cos(y / 11.0) + 0.5 * x ) );
+    }
+  return image;
+}
+
+TransformType::ParametersType MakeParameters()
+{
+  TransformType::Pointer transform = TransformType::New();
+  transform->Rotate2D(0.02);
+  TransformType::OutputVectorType translation;
+  translation[0] = 1.3;
+  translation[1] = -0.8;
+  transform->Translate(translation);
+  return transform->GetParameters();
+}
+
+// The joint histogram of the pixels of the fixed image, computed serially
+template< class TMetric >
+bool CheckHistogram(const char *name, const TMetric *metric,
+                    const ImageType *fixedImage, const ImageType *movingImage)
+{
+  typedef typename TMetric::HistogramType HistogramType;
+  const HistogramType *histogram = metric->GetHistogram();
+
+  TransformType::Pointer transform = TransformType::New();
+  transform->SetParameters( MakeParameters() );
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  interpolator->SetInputImage(movingImage);
+
+  // The bins are those of the histogram of the metric
+  std::vector< unsigned long > expected(histogram->Size(), 0);
+  typename HistogramType::IndexType index(2);
+
+  unsigned long count = 0;
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( fixedImage, fixedImage->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    fixedImage->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    const TransformType::OutputPointType mapped = transform->TransformPoint(point);
+    if ( interpolator->IsInsideBuffer(mapped) )
+      {
+      typename HistogramType::MeasurementVectorType sample(2);
+      sample[0] = it.Get();
+      sample[1] = interpolator->Evaluate(mapped);
+      if ( histogram->GetIndex(sample, index) )
+        {
+        expected[histogram->GetInstanceIdentifier(index)]++;
+        }
+      count++;
+      }
+    }
+
+  if ( count != metric->GetNumberOfPixelsCounted() )
+    {
+    std::cerr << name << ": " << metric->GetNumberOfPixelsCounted() << " samples instead of "
+              << count << std::endl;
+    return false;
+    }
+  for ( unsigned long id = 0; id < expected.size(); id++ )
+    {
+    if ( histogram->GetFrequency(id) != expected[id] )
+      {
+      std::cerr << name << ": frequency " << histogram->GetFrequency(id) << " instead of "
+                << expected[id] << " in bin " << id << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template< class TMetric >
+typename TMetric::Pointer MakeMetric(const ImageType *fixedImage, const ImageType *movingImage,
+                                     unsigned int threads)
+{
+  typename TMetric::Pointer metric = TMetric::New();
+  metric->SetFixedImage(fixedImage);
+  metric->SetMovingImage(movingImage);
+  metric->SetTransform( TransformType::New() );
+  metric->SetInterpolator( InterpolatorType::New() );
+  metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  metric->SetNumberOfThreads(threads);
+
+  typename TMetric::HistogramSizeType histogramSize;
+  histogramSize.SetSize(2);
+  histogramSize[0] = 24;
+  histogramSize[1] = 24;
+  metric->SetHistogramSize(histogramSize);
+
+  // Small steps for the matrix
+  typename TMetric::ScalesType scales( TransformType::New()->GetNumberOfParameters() );
+  scales.Fill(100.0);
+  scales[4] = 10.0;
+  scales[5] = 10.0;
+  metric->SetDerivativeStepLengthScales(scales);
+
+  metric->Initialize();
+  return metric;
+}
+
+template< class TMetric >
+bool CheckMetric(const char *name, const ImageType *fixedImage, const ImageType *movingImage,
+                 typename TMetric::DerivativeType & parzenWindowDerivative)
+{
+  const unsigned int                  threads[3] = { 1, 2, 3 };
+  const TransformType::ParametersType parameters = MakeParameters();
+
+  typename TMetric::MeasureType    firstValue = 0.0;
+  typename TMetric::DerivativeType firstDerivative;
+  for ( unsigned int t = 0; t < 3; t++ )
+    {
+    typename TMetric::Pointer metric = MakeMetric< TMetric >(fixedImage, movingImage, threads[t]);
+
+    const typename TMetric::MeasureType value = metric->GetValue(parameters);
+    std::cout << name << " with " << threads[t] << " threads: " << value << std::endl;
+    if ( !CheckHistogram(name, metric.GetPointer(), fixedImage, movingImage) )
+      {
+      return false;
+      }
+
+    metric->UseParzenWindowDerivativeOn();
+    typename TMetric::MeasureType    combinedValue;
+    typename TMetric::DerivativeType derivative;
+    metric->GetValueAndDerivative(parameters, combinedValue, derivative);
+    if ( combinedValue != value )
+      {
+      std::cerr << name << ": GetValueAndDerivative() gives " << combinedValue
+                << " and GetValue() " << value << std::endl;
+      return false;
+      }
+    std::cout << "  Parzen window derivative: " << derivative << std::endl;
+
+    if ( t == 0 )
+      {
+      firstValue = value;
+      firstDerivative = derivative;
+
+      // The derivative of the metric smoothed by the Parzen window is about
+      // in the direction of the finite differences of the metric
+      metric->UseParzenWindowDerivativeOff();
+      typename TMetric::DerivativeType finiteDifference;
+      metric->GetDerivative(parameters, finiteDifference);
+      std::cout << "  Finite difference derivative: " << finiteDifference << std::endl;
+      const double cosine = dot_product(derivative, finiteDifference)
+                            / ( derivative.magnitude() * finiteDifference.magnitude() );
+      if ( !( cosine > 0.9 ) )
+        {
+        std::cerr << name << ": the derivative " << derivative << " is not in the direction of "
+                  << finiteDifference << std::endl;
+        return false;
+        }
+      continue;
+      }
+
+    if ( value != firstValue )
+      {
+      std::cerr << name << ": " << value << " with " << threads[t] << " threads, but "
+                << firstValue << " with one" << std::endl;
+      return false;
+      }
+    for ( unsigned int p = 0; p < derivative.GetSize(); p++ )
+      {
+      if ( vcl_fabs(derivative[p] - firstDerivative[p]) > 1e-10 * ( 1.0 + vcl_fabs(firstDerivative[p]) ) )
+        {
+        std::cerr << name << ": derivative " << derivative << " with " << threads[t]
+                  << " threads, but " << firstDerivative << " with one" << std::endl;
+        return false;
+        }
+      }
+    }
+  parzenWindowDerivative = firstDerivative;
+  return true;
+}
+}
+
+int itkHistogramImageToImageMetricThreadsTest(int, char *[])
+{
+  ImageType::Pointer fixedImage = MakeImage(0.0);
+  ImageType::Pointer movingImage = MakeImage(2.5);
+
+  typedef itk::MutualInformationHistogramImageToImageMetric< ImageType, ImageType >           MIMetricType;
+  typedef itk::NormalizedMutualInformationHistogramImageToImageMetric< ImageType, ImageType > NMIMetricType;
+  typedef itk::CorrelationCoefficientHistogramImageToImageMetric< ImageType, ImageType >      CCMetricType;
+  typedef itk::MeanSquaresHistogramImageToImageMetric< ImageType, ImageType >                 MSMetricType;
+
+  typedef itk::MeanSquaresImageToImageMetric< ImageType, ImageType > MeanSquaresMetricType;
+
+  try
+    {
+    MSMetricType::DerivativeType derivative;
+    if ( !CheckMetric< MIMetricType >("MutualInformationHistogram", fixedImage, movingImage, derivative)
+         || !CheckMetric< NMIMetricType >("NormalizedMutualInformationHistogram", fixedImage, movingImage,
+                                          derivative)
+         || !CheckMetric< CCMetricType >("CorrelationCoefficientHistogram", fixedImage, movingImage,
+                                         derivative)
+         || !CheckMetric< MSMetricType >("MeanSquaresHistogram", fixedImage, movingImage, derivative) )
+      {
+      return EXIT_FAILURE;
+      }
+
+    // The mean squares of the histogram smoothed along the moving
+    // intensities has about the derivative of the mean squares
+    MeanSquaresMetricType::Pointer metric = MeanSquaresMetricType::New();
+    metric->SetFixedImage(fixedImage);
+    metric->SetMovingImage(movingImage);
+    metric->SetTransform( TransformType::New() );
+    metric->SetInterpolator( InterpolatorType::New() );
+    metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+    metric->UseAllPixelsOn();
+    metric->Initialize();
+    MeanSquaresMetricType::DerivativeType expected;
+    metric->GetDerivative(MakeParameters(), expected);
+    std::cout << "MeanSquares derivative: " << expected << std::endl;
+    if ( ( derivative - expected ).magnitude() > 0.05 * expected.magnitude() )
+      {
+      std::cerr << "MeanSquaresHistogram: derivative " << derivative << " instead of about "
+                << expected << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,354 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageToImageMetricFastSampleEvaluationTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkVersorRigid3DTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkMeanSquaresImageToImageMetric.h"
+#include "itkMattesMutualInformationImageToImageMetric.h"
+#include "itkImageRegistrationMethod.h"
+#include "itkVersorRigid3DTransformOptimizer.h"
+#include "itkCommand.h"
+#include "itkTimeProbe.h"
+
+#include <iostream>
+#include <cstdlib>
+
+/**
+ *  This test compares the metrics evaluated with UseFastSampleEvaluation
+ *  to their default evaluation, then times a rigid registration with and
+ *  without it. The first argument is the size of the images, 40 by
+ *  default, the second the number of iterations of the registration. The
+ *  benchmark of a 256^3 registration is
+ *
+ *    itkImageToImageMetricFastSampleEvaluationTest 256 20
+ */
+
+namespace
+{
+const unsigned int Dimension = 3;
+
+typedef itk::Image< float, Dimension >                           ImageType;
+typedef itk::VersorRigid3DTransform< double >                    TransformType;
+typedef itk::LinearInterpolateImageFunction< ImageType, double > InterpolatorType;
+
+// A rigid transform which claims not to be linear, so that the samples are
+// mapped one by one
+class NonLinearTransform:public TransformType
+{
+public:
+  typedef NonLinearTransform               Self;
+  typedef TransformType                    Superclass;
+  typedef itk::SmartPointer< Self >        Pointer;
+  itkNewMacro(Self);
+
+  virtual bool IsLinear() const { return false; }
+};
+
+// A few blobs on smooth waves, of the same extent whatever the size of
+// the image, seen through transform
+ImageType::Pointer MakeImage(unsigned int size, const TransformType *transform)
+{
+  ImageType::SizeType    imageSize;
+  ImageType::PointType   origin;
+  ImageType::SpacingType spacing;
+  imageSize.Fill(size);
+  spacing.Fill(80.0 / size);
+  origin.Fill(-40.0 + 40.0 / size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(imageSize);
+  image->SetOrigin(origin);
+  image->SetSpacing(spacing);
+  image->Allocate();
+
+  const double centers[3][3] = { { -12.0, 5.0, 3.0 }, { 10.0, -8.0, -6.0 }, { 4.0, 14.0, -10.0 } };
+  const double widths[3] = { 7.0, 9.0, 6.0 };
+  const double heights[3] = { 100.0, 70.0, 120.0 };
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    image->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    point = transform->TransformPoint(point);
+
+    double value = 20.0 * vcl_sin(point[0] / 6.0) * vcl_cos(point[1] / 8.0) * vcl_cos(point[2] / 7.0);
+    for ( unsigned int b = 0; b < 3; b++ )
+      {
+      double squaredDistance = 0.0;
+      for ( unsigned int d = 0; d < Dimension; d++ )
+        {
+        squaredDistance += ( point[d] - centers[b][d] ) * ( point[d] - centers[b][d] );
+        }
+      value += heights[b] * vcl_exp( -squaredDistance / ( 2.0 * widths[b] * widths[b] ) );
+      }
+    it.Set( static_cast< float >( value ) );
+    }
+  return image;
+}
+
+// The transform from the fixed to the moving image
+TransformType::Pointer MakeTruth()
+{
+  TransformType::Pointer truth = TransformType::New();
+  TransformType::AxisType axis;
+  axis[0] = 0.2;
+  axis[1] = -0.3;
+  axis[2] = 1.0;
+  truth->SetRotation(axis, 0.06);
+  TransformType::OutputVectorType translation;
+  translation[0] = 2.5;
+  translation[1] = -1.5;
+  translation[2] = 1.2;
+  truth->SetTranslation(translation);
+  return truth;
+}
+
+template< class TMetric >
+void SetSampling(TMetric *metric, unsigned long numberOfPixels)
+{
+  metric->SetNumberOfSpatialSamples(numberOfPixels / 4);
+  metric->ReinitializeSeed(121212);
+}
+
+void SetSampling(itk::MeanSquaresImageToImageMetric< ImageType, ImageType > *metric, unsigned long)
+{
+  metric->UseAllPixelsOn();
+}
+
+// Evaluate the metric at parameters with the default and the fast
+// evaluation, and compare them
+template< class TMetric >
+bool CompareEvaluations(const char *name, const ImageType *fixedImage, const ImageType *movingImage,
+                        bool computeGradient, unsigned int threads)
+{
+  // Half way to the optimum, where the derivative is not small and the
+  // samples are not mapped onto pixels
+  TransformType::ParametersType parameters = MakeTruth()->GetParameters();
+  parameters *= 0.5;
+  typename TMetric::MeasureType    values[3];
+  typename TMetric::DerivativeType derivatives[3];
+  unsigned long                    counts[3];
+
+  // The default evaluation, then the fast one of a linear transform and of
+  // a transform which is not linear
+  for ( unsigned int e = 0; e < 3; e++ )
+    {
+    typename TMetric::Pointer metric = TMetric::New();
+    metric->SetFixedImage(fixedImage);
+    metric->SetMovingImage(movingImage);
+    if ( e < 2 )
+      {
+      metric->SetTransform( TransformType::New() );
+      }
+    else
+      {
+      metric->SetTransform( NonLinearTransform::New() );
+      }
+    metric->SetInterpolator( InterpolatorType::New() );
+    metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+    metric->SetNumberOfThreads(threads);
+    metric->SetComputeGradient(computeGradient);
+    metric->SetUseFastSampleEvaluation(e > 0);
+    SetSampling( metric.GetPointer(), fixedImage->GetBufferedRegion().GetNumberOfPixels() );
+    metric->Initialize();
+
+    values[e] = metric->GetValue(parameters);
+    typename TMetric::MeasureType value;
+    metric->GetValueAndDerivative(parameters, value, derivatives[e]);
+    counts[e] = metric->GetNumberOfPixelsCounted();
+    if ( vcl_fabs(value - values[e]) > 1e-12 * vcl_fabs(value) )
+      {
+      std::cerr << name << ": GetValueAndDerivative() gives " << value
+                << " and GetValue() " << values[e] << std::endl;
+      return false;
+      }
+    }
+
+  std::cout << name << " (ComputeGradient " << computeGradient << ", " << threads << " threads): "
+            << values[0] << " " << derivatives[0] << " default, "
+            << values[1] << " " << derivatives[1] << " fast" << std::endl;
+
+  // The samples are summed in another order, into the float histograms of
+  // MattesMutualInformation
+  for ( unsigned int e = 1; e < 3; e++ )
+    {
+    if ( counts[e] != counts[0] || vcl_fabs(values[e] - values[0]) > 1e-5 * vcl_fabs(values[0]) )
+      {
+      std::cerr.precision(17);
+      std::cerr << name << ": " << values[e] << " over " << counts[e] << " samples instead of "
+                << values[0] << " over " << counts[0] << std::endl;
+      return false;
+      }
+    }
+
+  // The fast evaluation interpolates the gradient instead of taking it at
+  // the nearest pixel
+  const double cosine = dot_product(derivatives[1], derivatives[0])
+                        / ( derivatives[1].magnitude() * derivatives[0].magnitude() );
+  if ( !( cosine > 0.99 )
+       || vcl_fabs( derivatives[1].magnitude() - derivatives[0].magnitude() ) > 0.05 * derivatives[0].magnitude()
+       || ( derivatives[2] - derivatives[1] ).magnitude() > 1e-6 * derivatives[1].magnitude() )
+    {
+    std::cerr << name << ": derivatives " << derivatives[1] << " and " << derivatives[2]
+              << " instead of about " << derivatives[0] << std::endl;
+    return false;
+    }
+  return true;
+}
+
+// Time the iterations of the registration
+class IterationTimer:public itk::Command
+{
+public:
+  typedef IterationTimer            Self;
+  typedef itk::Command              Superclass;
+  typedef itk::SmartPointer< Self > Pointer;
+  itkNewMacro(Self);
+
+  void Execute(itk::Object *caller, const itk::EventObject & event)
+  {
+    this->Execute( (const itk::Object *)caller, event );
+  }
+
+  void Execute(const itk::Object *, const itk::EventObject &)
+  {
+    if ( m_Probe.GetNumberOfStarts() > 0 )
+      {
+      m_Probe.Stop();
+      }
+    m_Probe.Start();
+  }
+
+  itk::TimeProbe m_Probe;
+};
+
+// Register the images with Mattes mutual information, and return the
+// number of iterations per second
+double Register(const ImageType *fixedImage, const ImageType *movingImage, bool fast,
+                unsigned int iterations, TransformType::ParametersType & parameters,
+                unsigned int & iterationsDone)
+{
+  typedef itk::MattesMutualInformationImageToImageMetric< ImageType, ImageType > MetricType;
+  typedef itk::VersorRigid3DTransformOptimizer                                   OptimizerType;
+  typedef itk::ImageRegistrationMethod< ImageType, ImageType >                   RegistrationType;
+
+  MetricType::Pointer metric = MetricType::New();
+  metric->SetNumberOfHistogramBins(50);
+  metric->SetNumberOfSpatialSamples(fixedImage->GetBufferedRegion().GetNumberOfPixels() / 10);
+  metric->ReinitializeSeed(76926294);
+  metric->SetUseFastSampleEvaluation(fast);
+
+  TransformType::Pointer transform = TransformType::New();
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  OptimizerType::ScalesType scales( transform->GetNumberOfParameters() );
+  scales.Fill(1.0);
+  scales[3] = scales[4] = scales[5] = 1.0 / 100.0;
+  optimizer->SetScales(scales);
+  optimizer->SetMaximumStepLength(1.0);
+  optimizer->SetMinimumStepLength(1e-6);
+  optimizer->SetGradientMagnitudeTolerance(1e-12);
+  optimizer->SetNumberOfIterations(iterations);
+  IterationTimer::Pointer timer = IterationTimer::New();
+  optimizer->AddObserver(itk::IterationEvent(), timer);
+
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetMetric(metric);
+  registration->SetOptimizer(optimizer);
+  registration->SetTransform(transform);
+  registration->SetInterpolator( InterpolatorType::New() );
+  registration->SetFixedImage(fixedImage);
+  registration->SetMovingImage(movingImage);
+  registration->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  registration->SetInitialTransformParameters( transform->GetParameters() );
+
+  itk::TimeProbe probe;
+  probe.Start();
+  registration->StartRegistration();
+  probe.Stop();
+
+  parameters = registration->GetLastTransformParameters();
+  iterationsDone = optimizer->GetCurrentIteration();
+  std::cout << ( fast ? "Fast" : "Default" ) << " evaluation: " << iterationsDone << " iterations in "
+            << probe.GetTotal() << " s, " << 1.0 / timer->m_Probe.GetMeanTime() << " iterations/s, "
+            << parameters << std::endl;
+  return 1.0 / timer->m_Probe.GetMeanTime();
+}
+}
+
+int itkImageToImageMetricFastSampleEvaluationTest(int argc, char *argv[])
+{
+  const unsigned int size = ( argc > 1 ) ? atoi(argv[1]) : 40;
+  const unsigned int iterations = ( argc > 2 ) ? atoi(argv[2]) : 30;
+
+  TransformType::Pointer identity = TransformType::New();
+  TransformType::Pointer inverse = TransformType::New();
+  MakeTruth()->GetInverse(inverse);
+  ImageType::Pointer fixedImage = MakeImage(size, identity);
+  ImageType::Pointer movingImage = MakeImage(size, inverse);
+
+  typedef itk::MeanSquaresImageToImageMetric< ImageType, ImageType >             MSMetricType;
+  typedef itk::MattesMutualInformationImageToImageMetric< ImageType, ImageType > MattesMetricType;
+
+  try
+    {
+    if ( !CompareEvaluations< MSMetricType >("MeanSquares", fixedImage, movingImage, true, 1)
+         || !CompareEvaluations< MSMetricType >("MeanSquares", fixedImage, movingImage, false, 3)
+         || !CompareEvaluations< MattesMetricType >("MattesMutualInformation", fixedImage, movingImage, true, 3)
+         || !CompareEvaluations< MattesMetricType >("MattesMutualInformation", fixedImage, movingImage, false, 1) )
+      {
+      return EXIT_FAILURE;
+      }
+
+    TransformType::ParametersType defaultParameters;
+    TransformType::ParametersType fastParameters;
+    unsigned int                  defaultIterations;
+    unsigned int                  fastIterations;
+    const double                  defaultRate = Register(fixedImage, movingImage, false, iterations,
+                                                         defaultParameters, defaultIterations);
+    const double                  fastRate = Register(fixedImage, movingImage, true, iterations,
+                                                      fastParameters, fastIterations);
+    std::cout << "Speed up of the iterations: " << fastRate / defaultRate << std::endl;
+
+    // Both registrations recover the transform
+    const TransformType::ParametersType expected = MakeTruth()->GetParameters();
+    for ( unsigned int p = 0; p < expected.GetSize(); p++ )
+      {
+      const double tolerance = ( p < 3 ) ? 5e-3 : 0.25;
+      if ( vcl_fabs(fastParameters[p] - expected[p]) > tolerance
+           || vcl_fabs(defaultParameters[p] - expected[p]) > tolerance )
+        {
+        std::cerr << "The registration ends at " << fastParameters << " with the fast evaluation, and at "
+                  << defaultParameters << " without, instead of " << expected << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,388 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageToImageMetricStochasticSamplingTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkAffineTransform.h"
+#include "itkBSplineDeformableTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkMeanSquaresImageToImageMetric.h"
+#include "itkMattesMutualInformationImageToImageMetric.h"
+#include "itkGradientDescentOptimizer.h"
+#include "itkImageRegistrationMethod.h"
+#include "itkTimeProbe.h"
+
+#include <iostream>
+#include <cstdlib>
+
+/**
+ *  This test checks that the metrics draw new samples at each
+ *  GetValueAndDerivative() with UseStochasticSampling, reproducibly for a
+ *  seed, and that their derivatives average to the derivative over all
+ *  the pixels. It then registers images deformed by a BSpline transform
+ *  with a decaying learning rate, evaluating all the pixels at each
+ *  iteration, then a few samples drawn at each iteration, and compares the
+ *  times and results of the registrations. The first argument is the size
+ *  of the images, 96 by default, the second the number of iterations of
+ *  the registrations. The benchmark of a 512^2 registration is
+ *
+ *    itkImageToImageMetricStochasticSamplingTest 512 200
+ */
+
+namespace
+{
+const unsigned int Dimension = 2;
+
+typedef itk::Image< float, Dimension >                           ImageType;
+typedef itk::AffineTransform< double, Dimension >                AffineTransformType;
+typedef itk::BSplineDeformableTransform< double, Dimension, 3 >  BSplineTransformType;
+typedef itk::LinearInterpolateImageFunction< ImageType, double > InterpolatorType;
+
+typedef itk::MeanSquaresImageToImageMetric< ImageType, ImageType >             MSMetricType;
+typedef itk::MattesMutualInformationImageToImageMetric< ImageType, ImageType > MattesMetricType;
+
+// A few blobs on smooth waves, of the same extent whatever the size of the
+// image, seen through a smooth deformation of the given amplitude
+ImageType::Pointer MakeImage(unsigned int size, double amplitude)
+{
+  ImageType::SizeType    imageSize;
+  ImageType::SpacingType spacing;
+  imageSize.Fill(size);
+  spacing.Fill(100.0 / size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(imageSize);
+  image->SetSpacing(spacing);
+  image->Allocate();
+
+  const double centers[3][2] = { { 30.0, 40.0 }, { 65.0, 30.0 }, { 50.0, 70.0 } };
+  const double widths[3] = { 9.0, 12.0, 8.0 };
+  const double heights[3] = { 100.0, 70.0, 120.0 };
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    image->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    const double x = point[0] + amplitude * vcl_sin(point[0] / 20.0) * vcl_cos(point[1] / 25.0);
+    const double y = point[1] + amplitude * vcl_cos(point[0] / 30.0) * vcl_sin(point[1] / 15.0);
+
+    double value = 20.0 * vcl_sin(x / 7.0) * vcl_cos(y / 9.0);
+    for ( unsigned int b = 0; b < 3; b++ )
+      {
+      const double squaredDistance = ( x - centers[b][0] ) * ( x - centers[b][0] )
+                                     + ( y - centers[b][1] ) * ( y - centers[b][1] );
+      value += heights[b] * vcl_exp( -squaredDistance / ( 2.0 * widths[b] * widths[b] ) );
+      }
+    it.Set( static_cast< float >( value ) );
+    }
+  return image;
+}
+
+// A BSpline transform of 8 x 8 intervals over the image
+BSplineTransformType::Pointer MakeBSplineTransform(const ImageType *image)
+{
+  BSplineTransformType::Pointer transform = BSplineTransformType::New();
+
+  BSplineTransformType::RegionType::SizeType gridSize;
+  gridSize.Fill(8 + BSplineTransformType::SplineOrder);
+  BSplineTransformType::RegionType region;
+  region.SetSize(gridSize);
+
+  BSplineTransformType::SpacingType spacing;
+  BSplineTransformType::OriginType  origin;
+  for ( unsigned int d = 0; d < Dimension; d++ )
+    {
+    spacing[d] = image->GetSpacing()[d] * ( image->GetBufferedRegion().GetSize()[d] - 1 ) / 8.0;
+    origin[d] = image->GetOrigin()[d] - spacing[d];
+    }
+  transform->SetGridRegion(region);
+  transform->SetGridSpacing(spacing);
+  transform->SetGridOrigin(origin);
+
+  BSplineTransformType::ParametersType parameters( transform->GetNumberOfParameters() );
+  parameters.Fill(0.0);
+  transform->SetParametersByValue(parameters);
+  return transform;
+}
+
+template< class TMetric >
+typename TMetric::Pointer MakeMetric(const ImageType *fixedImage, const ImageType *movingImage,
+                                     typename TMetric::TransformType *transform, unsigned long samples,
+                                     bool stochastic)
+{
+  typename TMetric::Pointer metric = TMetric::New();
+  metric->SetFixedImage(fixedImage);
+  metric->SetMovingImage(movingImage);
+  metric->SetTransform(transform);
+  metric->SetInterpolator( InterpolatorType::New() );
+  metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  metric->SetNumberOfThreads(2);
+  if ( samples > 0 )
+    {
+    metric->SetNumberOfFixedImageSamples(samples);
+    }
+  else
+    {
+    metric->UseAllPixelsOn();
+    }
+  metric->SetUseStochasticSampling(stochastic);
+  metric->ReinitializeSeed(121212);
+  metric->Initialize();
+  return metric;
+}
+
+bool Equal(double value1, const itk::Array< double > & derivative1,
+           double value2, const itk::Array< double > & derivative2)
+{
+  return value1 == value2 && derivative1 == derivative2;
+}
+
+// Check that each evaluation draws new samples, the same after the seed is
+// reinitialized, and that GetValue() evaluates the last samples
+template< class TMetric >
+bool CheckSamples(const char *name, const ImageType *fixedImage, const ImageType *movingImage,
+                  typename TMetric::TransformType *transform)
+{
+  typename TMetric::ParametersType parameters = transform->GetParameters();
+  for ( unsigned int p = 0; p < parameters.GetSize(); p++ )
+    {
+    parameters[p] += 0.01 * ( ( p * 7 ) % 11 ) - 0.04;
+    }
+
+  typename TMetric::MeasureType    values[2][2];
+  typename TMetric::DerivativeType derivatives[2][2];
+  for ( unsigned int r = 0; r < 2; r++ )
+    {
+    typename TMetric::Pointer metric = MakeMetric< TMetric >(fixedImage, movingImage, transform, 500, true);
+    for ( unsigned int e = 0; e < 2; e++ )
+      {
+      metric->GetValueAndDerivative(parameters, values[r][e], derivatives[r][e]);
+      const typename TMetric::MeasureType value = metric->GetValue(parameters);
+      if ( value != values[r][e] )
+        {
+        std::cerr << name << ": GetValue() gives " << value << " after GetValueAndDerivative() gave "
+                  << values[r][e] << std::endl;
+        return false;
+        }
+      }
+    }
+  std::cout << name << ": " << values[0][0] << " then " << values[0][1] << std::endl;
+  if ( Equal(values[0][0], derivatives[0][0], values[0][1], derivatives[0][1]) )
+    {
+    std::cerr << name << ": the second evaluation gives the same " << values[0][1] << std::endl;
+    return false;
+    }
+  for ( unsigned int e = 0; e < 2; e++ )
+    {
+    if ( !Equal(values[0][e], derivatives[0][e], values[1][e], derivatives[1][e]) )
+      {
+      std::cerr << name << ": evaluation " << e << " gives " << values[1][e] << " instead of "
+                << values[0][e] << " with the same seed" << std::endl;
+      return false;
+      }
+    }
+
+  // The samples do not change without stochastic sampling, nor when all
+  // the pixels are used
+  const unsigned long samples[2] = { 500, 0 };
+  const bool          stochastic[2] = { false, true };
+  for ( unsigned int c = 0; c < 2; c++ )
+    {
+    typename TMetric::Pointer metric =
+      MakeMetric< TMetric >(fixedImage, movingImage, transform, samples[c], stochastic[c]);
+    metric->GetValueAndDerivative(parameters, values[0][0], derivatives[0][0]);
+    metric->GetValueAndDerivative(parameters, values[0][1], derivatives[0][1]);
+    if ( !Equal(values[0][0], derivatives[0][0], values[0][1], derivatives[0][1]) )
+      {
+      std::cerr << name << ": " << values[0][1] << " instead of " << values[0][0] << " with "
+                << samples[c] << " samples and UseStochasticSampling " << stochastic[c] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+// The mean of the derivatives over new samples tends to the derivative
+// over all the pixels
+bool CheckMeanDerivative(const ImageType *fixedImage, const ImageType *movingImage, bool fast)
+{
+  AffineTransformType::Pointer       transform = AffineTransformType::New();
+  AffineTransformType::ParametersType parameters = transform->GetParameters();
+  parameters[0] = 1.02;
+  parameters[3] = 0.97;
+  parameters[4] = 1.5;
+  parameters[5] = -2.0;
+
+  MSMetricType::Pointer metric = MakeMetric< MSMetricType >(fixedImage, movingImage, transform, 0, false);
+  MSMetricType::MeasureType    value;
+  MSMetricType::DerivativeType expected;
+  metric->GetValueAndDerivative(parameters, value, expected);
+
+  metric = MSMetricType::New();
+  metric->SetFixedImage(fixedImage);
+  metric->SetMovingImage(movingImage);
+  metric->SetTransform(transform);
+  metric->SetInterpolator( InterpolatorType::New() );
+  metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  metric->SetNumberOfFixedImageSamples(200);
+  metric->SetUseFastSampleEvaluation(fast);
+  metric->UseStochasticSamplingOn();
+  metric->ReinitializeSeed(76926294);
+  metric->Initialize();
+
+  const unsigned int           evaluations = 200;
+  MSMetricType::DerivativeType mean( expected.GetSize() );
+  mean.Fill(0.0);
+  for ( unsigned int e = 0; e < evaluations; e++ )
+    {
+    MSMetricType::DerivativeType derivative;
+    metric->GetValueAndDerivative(parameters, value, derivative);
+    mean += derivative;
+    }
+  mean /= evaluations;
+
+  std::cout << "Mean derivative over " << evaluations << " x 200 samples (UseFastSampleEvaluation " << fast
+            << "): " << mean << ", over all the pixels: " << expected << std::endl;
+  const double cosine = dot_product(mean, expected) / ( mean.magnitude() * expected.magnitude() );
+  if ( !( cosine > 0.98 ) || vcl_fabs( mean.magnitude() - expected.magnitude() ) > 0.1 * expected.magnitude() )
+    {
+    std::cerr << "The mean derivative " << mean << " is not about " << expected << std::endl;
+    return false;
+    }
+  return true;
+}
+
+// Register the images with a BSpline transform and Mattes mutual
+// information, and return the time of the registration
+double Register(const ImageType *fixedImage, const ImageType *movingImage, unsigned long samples,
+                bool stochastic, unsigned int iterations, BSplineTransformType::ParametersType & parameters)
+{
+  typedef itk::GradientDescentOptimizer                        OptimizerType;
+  typedef itk::ImageRegistrationMethod< ImageType, ImageType > RegistrationType;
+
+  MattesMetricType::Pointer metric = MattesMetricType::New();
+  metric->SetNumberOfHistogramBins(32);
+  metric->SetNumberOfSpatialSamples(samples);
+  metric->SetUseStochasticSampling(stochastic);
+  metric->ReinitializeSeed(76926294);
+
+  BSplineTransformType::Pointer transform = MakeBSplineTransform(fixedImage);
+  OptimizerType::Pointer        optimizer = OptimizerType::New();
+  optimizer->SetLearningRate(200.0);
+  optimizer->SetLearningRateDecayExponent(0.602);
+  optimizer->SetLearningRateDecayOffset(iterations / 10.0);
+  optimizer->SetNumberOfIterations(iterations);
+
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetMetric(metric);
+  registration->SetOptimizer(optimizer);
+  registration->SetTransform(transform);
+  registration->SetInterpolator( InterpolatorType::New() );
+  registration->SetFixedImage(fixedImage);
+  registration->SetMovingImage(movingImage);
+  registration->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  registration->SetInitialTransformParameters( transform->GetParameters() );
+
+  itk::TimeProbe probe;
+  probe.Start();
+  registration->StartRegistration();
+  probe.Stop();
+
+  parameters = registration->GetLastTransformParameters();
+  std::cout << ( stochastic ? "New " : "Fixed " ) << samples << " samples: " << iterations
+            << " iterations in " << probe.GetTotal() << " s" << std::endl;
+  return probe.GetTotal();
+}
+
+// Mattes mutual information over all the pixels
+double AllPixelsValue(const ImageType *fixedImage, const ImageType *movingImage,
+                      const BSplineTransformType::ParametersType & parameters)
+{
+  BSplineTransformType::Pointer transform = MakeBSplineTransform(fixedImage);
+  MattesMetricType::Pointer     metric = MattesMetricType::New();
+  metric->SetNumberOfHistogramBins(32);
+  metric->SetFixedImage(fixedImage);
+  metric->SetMovingImage(movingImage);
+  metric->SetTransform(transform);
+  metric->SetInterpolator( InterpolatorType::New() );
+  metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  metric->UseAllPixelsOn();
+  metric->Initialize();
+  return metric->GetValue(parameters);
+}
+}
+
+int itkImageToImageMetricStochasticSamplingTest(int argc, char *argv[])
+{
+  const unsigned int size = ( argc > 1 ) ? atoi(argv[1]) : 96;
+  const unsigned int iterations = ( argc > 2 ) ? atoi(argv[2]) : 100;
+
+  ImageType::Pointer fixedImage = MakeImage(size, 0.0);
+  ImageType::Pointer movingImage = MakeImage(size, 3.0);
+
+  try
+    {
+    BSplineTransformType::Pointer bspline = MakeBSplineTransform(fixedImage);
+    if ( !CheckSamples< MattesMetricType >("MattesMutualInformation", fixedImage, movingImage, bspline)
+         || !CheckSamples< MSMetricType >("MeanSquares", fixedImage, movingImage, AffineTransformType::New())
+         || !CheckMeanDerivative(fixedImage, movingImage, false)
+         || !CheckMeanDerivative(fixedImage, movingImage, true) )
+      {
+      return EXIT_FAILURE;
+      }
+
+    // All the pixels at each iteration, then 2000 new samples at each
+    // iteration
+    const unsigned long                  pixels = fixedImage->GetBufferedRegion().GetNumberOfPixels();
+    BSplineTransformType::ParametersType fullParameters;
+    BSplineTransformType::ParametersType stochasticParameters;
+    const double                         fullTime = Register(fixedImage, movingImage, pixels, false,
+                                                             iterations, fullParameters);
+    const double                         stochasticTime = Register(fixedImage, movingImage, 2000, true,
+                                                                   iterations, stochasticParameters);
+
+    BSplineTransformType::ParametersType identity( fullParameters.GetSize() );
+    identity.Fill(0.0);
+    const double initialValue = AllPixelsValue(fixedImage, movingImage, identity);
+    const double fullValue = AllPixelsValue(fixedImage, movingImage, fullParameters);
+    const double stochasticValue = AllPixelsValue(fixedImage, movingImage, stochasticParameters);
+    std::cout << "Mutual information over all the pixels: " << initialValue << " before, "
+              << fullValue << " after the registration of all the samples, "
+              << stochasticValue << " after the registration of new samples" << std::endl;
+    std::cout << "Speed up: " << fullTime / stochasticTime << std::endl;
+
+    // The registration of new samples improves the metric as much as that
+    // of all the samples
+    if ( !( initialValue - stochasticValue > 0.9 * ( initialValue - fullValue ) ) )
+      {
+      std::cerr << "The registration of new samples only reaches " << stochasticValue << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,279 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageToImageMetricThreadsTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkAffineTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkNormalizedCorrelationImageToImageMetric.h"
+#include "itkMeanReciprocalSquareDifferenceImageToImageMetric.h"
+#include "itkGradientDifferenceImageToImageMetric.h"
+#include "itkMatchCardinalityImageToImageMetric.h"
+
+#include <iostream>
+
+/**
+ *  This test computes the NormalizedCorrelation, MeanReciprocalSquareDifference,
+ *  GradientDifference and MatchCardinality metrics with 1, 2, 3 and 5
+ *  threads, and checks that the values and derivatives do not depend on
+ *  the number of threads. The normalized correlation is also compared to a
+ *  serial computation over the pixels of the fixed image.
+ */
+
+namespace
+{
+const unsigned int Dimension = 2;
+
+typedef itk::Image< double, Dimension >         ImageType;
+typedef itk::Image< unsigned char, Dimension >  LabelImageType;
+typedef itk::AffineTransform< double, Dimension > TransformType;
+
+// A smooth image, shifted by shift pixels along x
+ImageType::Pointer MakeImage(double shift)
+{
+  ImageType::SizeType size = { { 67, 45 } };
+  ImageType::Pointer  image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const double x = it.GetIndex()[0] - shift;
+    const double y = it.GetIndex()[1];
+    it.Set( 50.0 + 100.0 * vcl_sin(x / 5.0) * vcl_cos(y / 7.0) + 0.5 * x );
+    }
+  return image;
+}
+
+// An image of labels, shifted by shift pixels along y
+LabelImageType::Pointer MakeLabelImage(long shift)
+{
+  LabelImageType::SizeType size = { { 67, 45 } };
+  LabelImageType::Pointer  image = LabelImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< LabelImageType > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const long x = it.GetIndex()[0];
+    const long y = it.GetIndex()[1] - shift + 100;
+    it.Set( static_cast< unsigned char >( ( x / 8 + y / 6 ) % 4 ) );
+    }
+  return image;
+}
+
+TransformType::ParametersType MakeParameters()
+{
+  TransformType::Pointer transform = TransformType::New();
+  transform->Rotate2D(0.03);
+  TransformType::OutputVectorType translation;
+  translation[0] = 1.7;
+  translation[1] = -0.6;
+  transform->Translate(translation);
+  return transform->GetParameters();
+}
+
+// Only the normalized correlation can subtract the mean
+template< class TMetric >
+void SetSubtractMean(TMetric *, bool)
+{}
+
+void SetSubtractMean(itk::NormalizedCorrelationImageToImageMetric< ImageType, ImageType > *metric,
+                     bool subtractMean)
+{
+  metric->SetSubtractMean(subtractMean);
+}
+
+// Compute the metric with several numbers of threads, and check that the
+// results are exactly equal to those of one thread.
+template< class TMetric, class TInterpolator >
+bool CheckThreads(const char *name,
+                  const typename TMetric::FixedImageType *fixedImage,
+                  const typename TMetric::MovingImageType *movingImage,
+                  bool withDerivative, bool subtractMean, unsigned long numberOfSamples,
+                  typename TMetric::MeasureType & value)
+{
+  const unsigned int threads[4] = { 1, 2, 3, 5 };
+
+  typename TMetric::DerivativeType firstDerivative;
+  typename TMetric::MeasureType    firstValue = 0.0;
+  unsigned long                    firstCount = 0;
+
+  const TransformType::ParametersType parameters = MakeParameters();
+
+  for ( unsigned int t = 0; t < 4; t++ )
+    {
+    typename TMetric::Pointer metric = TMetric::New();
+    TransformType::Pointer    transform = TransformType::New();
+    metric->SetFixedImage(fixedImage);
+    metric->SetMovingImage(movingImage);
+    metric->SetTransform(transform);
+    metric->SetInterpolator( TInterpolator::New() );
+    metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+    metric->SetNumberOfThreads(threads[t]);
+    SetSubtractMean(metric.GetPointer(), subtractMean);
+    if ( numberOfSamples > 0 )
+      {
+      metric->SetNumberOfFixedImageSamples(numberOfSamples);
+      metric->ReinitializeSeed(76926294);
+      }
+    metric->Initialize();
+
+    typename TMetric::MeasureType    currentValue = metric->GetValue(parameters);
+    typename TMetric::DerivativeType derivative;
+    if ( withDerivative )
+      {
+      typename TMetric::MeasureType combinedValue;
+      metric->GetValueAndDerivative(parameters, combinedValue, derivative);
+      if ( combinedValue != currentValue )
+        {
+        std::cerr << name << ": GetValueAndDerivative() gives " << combinedValue
+                  << " and GetValue() " << currentValue << std::endl;
+        return false;
+        }
+      }
+
+    std::cout << name << " with " << threads[t] << " threads: " << currentValue
+              << " over " << metric->GetNumberOfPixelsCounted() << " samples" << std::endl;
+
+    if ( t == 0 )
+      {
+      firstValue = currentValue;
+      firstDerivative = derivative;
+      firstCount = metric->GetNumberOfPixelsCounted();
+      continue;
+      }
+    if ( currentValue != firstValue || metric->GetNumberOfPixelsCounted() != firstCount )
+      {
+      std::cerr.precision(17);
+      std::cerr << name << ": " << currentValue << " over " << metric->GetNumberOfPixelsCounted()
+                << " samples with " << threads[t] << " threads, but " << firstValue
+                << " over " << firstCount << " samples with one" << std::endl;
+      return false;
+      }
+    for ( unsigned int p = 0; p < derivative.GetSize(); p++ )
+      {
+      if ( derivative[p] != firstDerivative[p] )
+        {
+        std::cerr << name << ": derivative " << derivative << " with " << threads[t]
+                  << " threads, but " << firstDerivative << " with one" << std::endl;
+        return false;
+        }
+      }
+    }
+
+  value = firstValue;
+  return true;
+}
+
+// The normalized correlation over all the pixels of the fixed image
+double SerialNormalizedCorrelation(const ImageType *fixedImage, const ImageType *movingImage)
+{
+  TransformType::Pointer transform = TransformType::New();
+  transform->SetParameters( MakeParameters() );
+
+  typedef itk::LinearInterpolateImageFunction< ImageType, double > InterpolatorType;
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  interpolator->SetInputImage(movingImage);
+
+  double sff = 0.0;
+  double smm = 0.0;
+  double sfm = 0.0;
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( fixedImage, fixedImage->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    fixedImage->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    const TransformType::OutputPointType mapped = transform->TransformPoint(point);
+    if ( interpolator->IsInsideBuffer(mapped) )
+      {
+      const double fixedValue = it.Get();
+      const double movingValue = interpolator->Evaluate(mapped);
+      sff += fixedValue * fixedValue;
+      smm += movingValue * movingValue;
+      sfm += fixedValue * movingValue;
+      }
+    }
+  return -sfm / vcl_sqrt(sff * smm);
+}
+}
+
+int itkImageToImageMetricThreadsTest(int, char *[])
+{
+  ImageType::Pointer      fixedImage = MakeImage(0.0);
+  ImageType::Pointer      movingImage = MakeImage(2.5);
+  LabelImageType::Pointer fixedLabels = MakeLabelImage(0);
+  LabelImageType::Pointer movingLabels = MakeLabelImage(2);
+
+  typedef itk::LinearInterpolateImageFunction< ImageType, double >               InterpolatorType;
+  typedef itk::NearestNeighborInterpolateImageFunction< LabelImageType, double > LabelInterpolatorType;
+
+  typedef itk::NormalizedCorrelationImageToImageMetric< ImageType, ImageType >         NCMetricType;
+  typedef itk::MeanReciprocalSquareDifferenceImageToImageMetric< ImageType, ImageType > MRSDMetricType;
+  typedef itk::GradientDifferenceImageToImageMetric< ImageType, ImageType >            GDMetricType;
+  typedef itk::MatchCardinalityImageToImageMetric< LabelImageType, LabelImageType >    MCMetricType;
+
+  double value;
+  try
+    {
+    if ( !CheckThreads< NCMetricType, InterpolatorType >("NormalizedCorrelation", fixedImage, movingImage,
+                                                         true, false, 0, value) )
+      {
+      return EXIT_FAILURE;
+      }
+    const double expected = SerialNormalizedCorrelation(fixedImage, movingImage);
+    if ( vcl_fabs(value - expected) > 1e-10 )
+      {
+      std::cerr << "NormalizedCorrelation is " << value << " instead of " << expected << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    if ( !CheckThreads< NCMetricType, InterpolatorType >("NormalizedCorrelation subtracting the mean",
+                                                         fixedImage, movingImage, true, true, 0, value)
+         || !CheckThreads< NCMetricType, InterpolatorType >("NormalizedCorrelation of 997 samples",
+                                                            fixedImage, movingImage, true, false, 997, value)
+         || !CheckThreads< MRSDMetricType, InterpolatorType >("MeanReciprocalSquareDifference",
+                                                              fixedImage, movingImage, true, false, 0, value)
+         || !CheckThreads< GDMetricType, InterpolatorType >("GradientDifference",
+                                                            fixedImage, movingImage, false, false, 0, value)
+         || !CheckThreads< MCMetricType, LabelInterpolatorType >("MatchCardinality",
+                                                                 fixedLabels, movingLabels, false, false, 0,
+                                                                 value) )
+      {
+      return EXIT_FAILURE;
+      }
+    if ( value <= 0.0 || value >= 1.0 )
+      {
+      std::cerr << "MatchCardinality is " << value << ", not a fraction of the samples" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
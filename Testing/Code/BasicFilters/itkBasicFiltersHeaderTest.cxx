@@ -112,6 +112,7 @@
 #include "itkExtractOrthogonalSwath2DImageFilter.txx"
 #include "itkFastIncrementalBinaryDilateImageFilter.h"
 #include "itkFlipImageFilter.txx"
+#include "itkFunctorComposition.h"
 #include "itkGaussianImageSource.txx"
 #include "itkGetAverageSliceImageFilter.txx"
 #include "itkGradientAnisotropicDiffusionImageFilter.h"
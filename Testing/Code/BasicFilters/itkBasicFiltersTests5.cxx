@@ -41,4 +41,6 @@ void RegisterTests()
   REGISTER_TEST(itkSimplexMeshWithFloatCoordRepTest);
   REGISTER_TEST(itkReleaseDataFilterTest);
   REGISTER_TEST(itkWarpImageFilterTest2);
+  REGISTER_TEST(itkFunctorCompositionTest);
+  REGISTER_TEST(itkFunctorImageFilterScanlineTest);
 }
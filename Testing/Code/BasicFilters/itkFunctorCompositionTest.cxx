@@ -0,0 +1,200 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkFunctorCompositionTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkFunctorComposition.h"
+#include "itkCastImageFilter.h"
+#include "itkShiftScaleImageFilter.h"
+#include "itkSigmoidImageFilter.h"
+#include "itkMaskImageFilter.h"
+#include "itkRescaleIntensityImageFilter.h"
+#include "itkRandomImageSource.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+
+int itkFunctorCompositionTest(int, char* [] )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< short, Dimension >         InputImageType;
+  typedef itk::Image< unsigned char, Dimension > MaskImageType;
+  typedef itk::Image< float, Dimension >         OutputImageType;
+
+  const double shift = -100.0;
+  const double scale = 0.5;
+  const double alpha = 40.0;
+  const double beta = 10.0;
+
+  // Inputs
+  InputImageType::SizeValueType size[Dimension] = { 64, 64, 64 };
+
+  typedef itk::RandomImageSource< InputImageType > InputSourceType;
+  InputSourceType::Pointer inputSource = InputSourceType::New();
+  inputSource->SetSize( size );
+  inputSource->SetMin( -1000 );
+  inputSource->SetMax( 1000 );
+  inputSource->Update();
+
+  typedef itk::RandomImageSource< MaskImageType > MaskSourceType;
+  MaskSourceType::Pointer maskSource = MaskSourceType::New();
+  maskSource->SetSize( size );
+  maskSource->SetMin( 0 );
+  maskSource->SetMax( 1 );
+  maskSource->Update();
+
+  // Chain of filters: Cast -> ShiftScale -> Sigmoid -> Mask
+  typedef itk::CastImageFilter< InputImageType, OutputImageType > CastFilterType;
+  CastFilterType::Pointer cast = CastFilterType::New();
+  cast->SetInput( inputSource->GetOutput() );
+
+  typedef itk::ShiftScaleImageFilter< OutputImageType, OutputImageType > ShiftScaleFilterType;
+  ShiftScaleFilterType::Pointer shiftScale = ShiftScaleFilterType::New();
+  shiftScale->SetInput( cast->GetOutput() );
+  shiftScale->SetShift( shift );
+  shiftScale->SetScale( scale );
+
+  typedef itk::SigmoidImageFilter< OutputImageType, OutputImageType > SigmoidFilterType;
+  SigmoidFilterType::Pointer sigmoid = SigmoidFilterType::New();
+  sigmoid->SetInput( shiftScale->GetOutput() );
+  sigmoid->SetAlpha( alpha );
+  sigmoid->SetBeta( beta );
+  sigmoid->SetOutputMinimum( 0.0 );
+  sigmoid->SetOutputMaximum( 1.0 );
+
+  typedef itk::MaskImageFilter< OutputImageType, MaskImageType, OutputImageType > MaskFilterType;
+  MaskFilterType::Pointer mask = MaskFilterType::New();
+  mask->SetInput1( sigmoid->GetOutput() );
+  mask->SetInput2( maskSource->GetOutput() );
+
+  // The same chain fused into one functor
+  typedef itk::Functor::Cast< short, float >                          CastType;
+  typedef itk::Functor::IntensityLinearTransform< float, float >      ShiftScaleType;
+  typedef itk::Function::Sigmoid< float, float >                      SigmoidType;
+  typedef itk::Functor::MaskInput< float, unsigned char, float >      MaskType;
+  typedef itk::Functor::UnaryComposition< short, float, CastType, ShiftScaleType >
+    CastShiftScaleType;
+  typedef itk::Functor::UnaryComposition< short, float, CastShiftScaleType, SigmoidType >
+    ChainType;
+  typedef itk::Functor::BinaryComposition< short, unsigned char, float, MaskType, ChainType >
+    ExpressionType;
+
+  typedef itk::BinaryFunctorImageFilter< InputImageType, MaskImageType, OutputImageType,
+                                         ExpressionType > ExpressionFilterType;
+  ExpressionFilterType::Pointer expression = ExpressionFilterType::New();
+  expression->SetInput1( inputSource->GetOutput() );
+  expression->SetInput2( maskSource->GetOutput() );
+
+  ExpressionType expressionFunctor;
+  ShiftScaleType & shiftScaleFunctor =
+    expressionFunctor.GetInput1Functor().GetFirstFunctor().GetSecondFunctor();
+  shiftScaleFunctor.SetFactor( scale );
+  shiftScaleFunctor.SetOffset( shift * scale );
+  SigmoidType & sigmoidFunctor = expressionFunctor.GetInput1Functor().GetSecondFunctor();
+  sigmoidFunctor.SetAlpha( alpha );
+  sigmoidFunctor.SetBeta( beta );
+  sigmoidFunctor.SetOutputMinimum( 0.0 );
+  sigmoidFunctor.SetOutputMaximum( 1.0 );
+
+  if( expressionFunctor == expression->GetFunctor() )
+    {
+    std::cerr << "Compositions with different parameters must differ" << std::endl;
+    return EXIT_FAILURE;
+    }
+  expression->SetFunctor( expressionFunctor );
+  if( !( expressionFunctor == expression->GetFunctor() ) )
+    {
+    std::cerr << "SetFunctor() did not copy the composition" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Both produce the same image
+  itk::TimeProbe chainProbe;
+  itk::TimeProbe expressionProbe;
+  const unsigned int numberOfRuns = 5;
+  for( unsigned int run = 0; run < numberOfRuns; run++ )
+    {
+    cast->Modified();
+    chainProbe.Start();
+    mask->Update();
+    chainProbe.Stop();
+
+    expression->Modified();
+    expressionProbe.Start();
+    expression->Update();
+    expressionProbe.Stop();
+    }
+
+  std::cout << "Cast -> ShiftScale -> Sigmoid -> Mask on " << size[0] << "x" << size[1]
+            << "x" << size[2] << " pixels" << std::endl;
+  std::cout << "  chained filters: " << chainProbe.GetMeanTime() * 1e3 << " ms" << std::endl;
+  std::cout << "  fused functor:   " << expressionProbe.GetMeanTime() * 1e3 << " ms" << std::endl;
+
+  itk::ImageRegionConstIterator< OutputImageType > chainIt( mask->GetOutput(),
+                                                            mask->GetOutput()->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< OutputImageType > expressionIt( expression->GetOutput(),
+                                                                 expression->GetOutput()->GetBufferedRegion() );
+  unsigned long numberOfMaskedPixels = 0;
+  for( chainIt.GoToBegin(), expressionIt.GoToBegin(); !chainIt.IsAtEnd(); ++chainIt, ++expressionIt )
+    {
+    if( vnl_math_abs( chainIt.Get() - expressionIt.Get() ) > 1e-6 )
+      {
+      std::cerr << "Mismatch at " << chainIt.GetIndex() << ": chained filters give "
+                << chainIt.Get() << ", fused functor gives " << expressionIt.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( expressionIt.Get() == 0.0f )
+      {
+      numberOfMaskedPixels++;
+      }
+    }
+  if( numberOfMaskedPixels == 0 )
+    {
+    std::cerr << "The mask was not applied" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A unary composition in a unary functor filter, with an identity stage
+  typedef itk::Functor::Identity< short, float > IdentityType;
+  typedef itk::Functor::UnaryComposition< short, float, IdentityType, SigmoidType >
+    IdentitySigmoidType;
+  typedef itk::UnaryFunctorImageFilter< InputImageType, OutputImageType, IdentitySigmoidType >
+    UnaryExpressionFilterType;
+  UnaryExpressionFilterType::Pointer unaryExpression = UnaryExpressionFilterType::New();
+  unaryExpression->SetInput( inputSource->GetOutput() );
+  unaryExpression->GetFunctor().SetSecondFunctor( sigmoidFunctor );
+  unaryExpression->Update();
+
+  sigmoid->SetInput( cast->GetOutput() );
+  sigmoid->Update();
+
+  itk::ImageRegionConstIterator< OutputImageType > sigmoidIt( sigmoid->GetOutput(),
+                                                              sigmoid->GetOutput()->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< OutputImageType > unaryIt( unaryExpression->GetOutput(),
+                                                            unaryExpression->GetOutput()->GetBufferedRegion() );
+  for( sigmoidIt.GoToBegin(), unaryIt.GoToBegin(); !sigmoidIt.IsAtEnd(); ++sigmoidIt, ++unaryIt )
+    {
+    if( sigmoidIt.Get() != unaryIt.Get() )
+      {
+      std::cerr << "Unary composition mismatch at " << sigmoidIt.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,286 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkFunctorImageFilterScanlineTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkAddImageFilter.h"
+#include "itkMultiplyImageFilter.h"
+#include "itkMaskImageFilter.h"
+#include "itkAbsImageFilter.h"
+#include "itkSqrtImageFilter.h"
+#include "itkExpImageFilter.h"
+#include "itkAbsImageAdaptor.h"
+#include "itkVectorImage.h"
+#include "itkRandomImageSource.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+const unsigned int Dimension = 3;
+typedef itk::Image< float, Dimension >         FloatImageType;
+typedef itk::Image< unsigned char, Dimension > MaskImageType;
+
+/** Applies a unary functor with region iterators, as the functor filters
+ * did before the scanline path. */
+template< class TInputImage, class TOutputImage, class TFunctor >
+void IteratorUnary(const TInputImage *input, TOutputImage *output,
+                   const typename TOutputImage::RegionType & region,
+                   const TFunctor & functor)
+{
+  itk::ImageRegionConstIterator< TInputImage > inputIt(input, region);
+  itk::ImageRegionIterator< TOutputImage >     outputIt(output, region);
+  for ( inputIt.GoToBegin(), outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++inputIt, ++outputIt )
+    {
+    outputIt.Set( functor( inputIt.Get() ) );
+    }
+}
+
+/** Same for a binary functor. */
+template< class TInputImage1, class TInputImage2, class TOutputImage, class TFunctor >
+void IteratorBinary(const TInputImage1 *input1, const TInputImage2 *input2,
+                    TOutputImage *output,
+                    const typename TOutputImage::RegionType & region,
+                    const TFunctor & functor)
+{
+  itk::ImageRegionConstIterator< TInputImage1 > inputIt1(input1, region);
+  itk::ImageRegionConstIterator< TInputImage2 > inputIt2(input2, region);
+  itk::ImageRegionIterator< TOutputImage >      outputIt(output, region);
+  for ( inputIt1.GoToBegin(), inputIt2.GoToBegin(), outputIt.GoToBegin();
+        !outputIt.IsAtEnd(); ++inputIt1, ++inputIt2, ++outputIt )
+    {
+    outputIt.Set( functor( inputIt1.Get(), inputIt2.Get() ) );
+    }
+}
+
+FloatImageType::Pointer AllocateLike(const FloatImageType::RegionType & region)
+{
+  FloatImageType::Pointer image = FloatImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  return image;
+}
+
+bool SameImages(const FloatImageType *filtered, const FloatImageType *reference,
+                const char *name)
+{
+  if ( filtered->GetBufferedRegion() != reference->GetBufferedRegion() )
+    {
+    std::cerr << name << ": wrong buffered region " << filtered->GetBufferedRegion() << std::endl;
+    return false;
+    }
+  itk::ImageRegionConstIterator< FloatImageType > filteredIt( filtered, filtered->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< FloatImageType > referenceIt( reference, reference->GetBufferedRegion() );
+  for ( filteredIt.GoToBegin(), referenceIt.GoToBegin(); !filteredIt.IsAtEnd(); ++filteredIt, ++referenceIt )
+    {
+    const float expected = referenceIt.Get();
+    if ( vnl_math_abs( filteredIt.Get() - expected ) > 1e-6 * ( 1.0 + vnl_math_abs(expected) ) )
+      {
+      std::cerr << name << ": mismatch at " << filteredIt.GetIndex() << ": "
+                << filteredIt.Get() << " instead of " << expected << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+/** Runs a unary filter on the given output region and compares it with
+ * the iterator loop. */
+template< class TFilter >
+bool CheckUnary(const FloatImageType *input, const FloatImageType::RegionType & region,
+                const char *name)
+{
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetInput(input);
+  filter->GetOutput()->SetRequestedRegion(region);
+  filter->Update();
+
+  FloatImageType::Pointer reference = AllocateLike(region);
+  IteratorUnary( input, reference.GetPointer(), region, filter->GetFunctor() );
+  return SameImages(filter->GetOutput(), reference, name);
+}
+
+template< class TFilter, class TInputImage2 >
+bool CheckBinary(const FloatImageType *input1, const TInputImage2 *input2,
+                 const FloatImageType::RegionType & region, const char *name)
+{
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetInput1(input1);
+  filter->SetInput2(input2);
+  filter->GetOutput()->SetRequestedRegion(region);
+  filter->Update();
+
+  FloatImageType::Pointer reference = AllocateLike(region);
+  IteratorBinary( input1, input2, reference.GetPointer(), region, filter->GetFunctor() );
+  return SameImages(filter->GetOutput(), reference, name);
+}
+}
+
+int itkFunctorImageFilterScanlineTest(int, char* [] )
+{
+  // Which image types allow the scanline path
+  typedef itk::VectorImage< float, Dimension >         VectorImageType;
+  typedef itk::AbsImageAdaptor< FloatImageType, float > AdaptorType;
+  if ( !itk::PixelBufferTraits< FloatImageType >::IsDirect
+       || itk::PixelBufferTraits< VectorImageType >::IsDirect
+       || itk::PixelBufferTraits< AdaptorType >::IsDirect )
+    {
+    std::cerr << "PixelBufferTraits::IsDirect is wrong" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::AddImageFilter< FloatImageType, FloatImageType, FloatImageType >      AddFilterType;
+  typedef itk::MultiplyImageFilter< FloatImageType, FloatImageType, FloatImageType > MultiplyFilterType;
+  typedef itk::MaskImageFilter< FloatImageType, MaskImageType, FloatImageType >      MaskFilterType;
+  typedef itk::AbsImageFilter< FloatImageType, FloatImageType >                      AbsFilterType;
+  typedef itk::SqrtImageFilter< FloatImageType, FloatImageType >                     SqrtFilterType;
+  typedef itk::ExpImageFilter< FloatImageType, FloatImageType >                      ExpFilterType;
+  typedef itk::AbsImageFilter< AdaptorType, FloatImageType >                         AdaptorFilterType;
+
+  if ( !AddFilterType::ScanlineFastPath || !MaskFilterType::ScanlineFastPath
+       || !ExpFilterType::ScanlineFastPath || AdaptorFilterType::ScanlineFastPath )
+    {
+    std::cerr << "ScanlineFastPath is wrong" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Inputs: an odd line length so that the vectorized loops have a tail
+  FloatImageType::SizeValueType size[Dimension] = { 61, 40, 30 };
+
+  typedef itk::RandomImageSource< FloatImageType > FloatSourceType;
+  FloatSourceType::Pointer source1 = FloatSourceType::New();
+  source1->SetSize(size);
+  source1->SetMin(-10.0);
+  source1->SetMax(10.0);
+  source1->Update();
+
+  FloatSourceType::Pointer source2 = FloatSourceType::New();
+  source2->SetSize(size);
+  source2->SetMin(0.0);
+  source2->SetMax(5.0);
+  source2->Update();
+
+  typedef itk::RandomImageSource< MaskImageType > MaskSourceType;
+  MaskSourceType::Pointer maskSource = MaskSourceType::New();
+  maskSource->SetSize(size);
+  maskSource->SetMin(0);
+  maskSource->SetMax(1);
+  maskSource->Update();
+
+  const FloatImageType *input1 = source1->GetOutput();
+  const FloatImageType *input2 = source2->GetOutput();
+
+  // The whole image, and a region strictly inside it, whose lines are
+  // not contiguous in the input buffers
+  FloatImageType::RegionType regions[2];
+  regions[0] = input1->GetLargestPossibleRegion();
+  FloatImageType::IndexType subIndex = { { 3, 5, 7 } };
+  FloatImageType::SizeType  subSize = { { 37, 20, 11 } };
+  regions[1].SetIndex(subIndex);
+  regions[1].SetSize(subSize);
+
+  for ( unsigned int r = 0; r < 2; r++ )
+    {
+    std::cout << "Output region " << regions[r].GetIndex() << " " << regions[r].GetSize() << std::endl;
+    if ( !CheckBinary< AddFilterType >(input1, input2, regions[r], "Add")
+         || !CheckBinary< MultiplyFilterType >(input1, input2, regions[r], "Multiply")
+         || !CheckBinary< MaskFilterType >( input1, maskSource->GetOutput(), regions[r], "Mask" )
+         || !CheckUnary< AbsFilterType >(input1, regions[r], "Abs")
+         || !CheckUnary< SqrtFilterType >(input2, regions[r], "Sqrt")
+         || !CheckUnary< ExpFilterType >(input1, regions[r], "Exp") )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Adaptors still go through the iterators
+  AdaptorType::Pointer adaptor = AdaptorType::New();
+  adaptor->SetImage( source1->GetOutput() );
+  AdaptorFilterType::Pointer adaptorFilter = AdaptorFilterType::New();
+  adaptorFilter->SetInput(adaptor);
+  adaptorFilter->Update();
+
+  AbsFilterType::Pointer absFilter = AbsFilterType::New();
+  absFilter->SetInput(input1);
+  absFilter->Update();
+  if ( !SameImages(adaptorFilter->GetOutput(), absFilter->GetOutput(), "Adaptor") )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Throughput of one thread, scanline path against iterator path
+  FloatImageType::SizeValueType benchmarkSize[Dimension] = { 128, 128, 128 };
+  source1->SetSize(benchmarkSize);
+  source1->Update();
+  source2->SetSize(benchmarkSize);
+  source2->Update();
+  const FloatImageType::RegionType benchmarkRegion = input1->GetLargestPossibleRegion();
+  FloatImageType::Pointer iteratorOutput = AllocateLike(benchmarkRegion);
+
+  AddFilterType::Pointer add = AddFilterType::New();
+  add->SetInput1(input1);
+  add->SetInput2(input2);
+  add->SetNumberOfThreads(1);
+
+  SqrtFilterType::Pointer sqrtFilter = SqrtFilterType::New();
+  sqrtFilter->SetInput(input2);
+  sqrtFilter->SetNumberOfThreads(1);
+
+  // first runs allocate the outputs
+  add->Update();
+  sqrtFilter->Update();
+  IteratorBinary( input1, input2, iteratorOutput.GetPointer(), benchmarkRegion, add->GetFunctor() );
+
+  itk::TimeProbe addScanlineProbe;
+  itk::TimeProbe addIteratorProbe;
+  itk::TimeProbe sqrtScanlineProbe;
+  itk::TimeProbe sqrtIteratorProbe;
+  const unsigned int numberOfRuns = 10;
+  for ( unsigned int run = 0; run < numberOfRuns; run++ )
+    {
+    add->Modified();
+    addScanlineProbe.Start();
+    add->Update();
+    addScanlineProbe.Stop();
+
+    addIteratorProbe.Start();
+    IteratorBinary( input1, input2, iteratorOutput.GetPointer(), benchmarkRegion, add->GetFunctor() );
+    addIteratorProbe.Stop();
+
+    sqrtFilter->Modified();
+    sqrtScanlineProbe.Start();
+    sqrtFilter->Update();
+    sqrtScanlineProbe.Stop();
+
+    sqrtIteratorProbe.Start();
+    IteratorUnary( input2, iteratorOutput.GetPointer(), benchmarkRegion, sqrtFilter->GetFunctor() );
+    sqrtIteratorProbe.Stop();
+    }
+
+  const double gigaBytes = benchmarkRegion.GetNumberOfPixels() * sizeof( float ) / 1e9;
+  std::cout << "Single thread throughput on " << benchmarkSize[0] << "x" << benchmarkSize[1]
+            << "x" << benchmarkSize[2] << " float pixels (bytes read and written per second)" << std::endl;
+  std::cout << "  Add  scanline: " << 3 * gigaBytes / addScanlineProbe.GetMeanTime() << " GB/s" << std::endl;
+  std::cout << "  Add  iterator: " << 3 * gigaBytes / addIteratorProbe.GetMeanTime() << " GB/s" << std::endl;
+  std::cout << "  Sqrt scanline: " << 2 * gigaBytes / sqrtScanlineProbe.GetMeanTime() << " GB/s" << std::endl;
+  std::cout << "  Sqrt iterator: " << 2 * gigaBytes / sqrtIteratorProbe.GetMeanTime() << " GB/s" << std::endl;
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
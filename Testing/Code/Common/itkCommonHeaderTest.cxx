@@ -153,6 +153,7 @@
 #include "itkImageAndPathToImageFilter.txx"
 #include "itkImageBase.txx"
 #include "itkImageBoundaryCondition.h"
+#include "itkImageBufferPool.h"
 #include "itkImageConstIterator.txx"
 #include "itkImageConstIteratorWithIndex.txx"
 #include "itkImageContainerInterface.h"
@@ -168,6 +169,7 @@
 #include "itkImageRandomNonRepeatingConstIteratorWithIndex.txx"
 #include "itkImageRandomNonRepeatingIteratorWithIndex.txx"
 #include "itkImageRegion.txx"
+#include "itkImageRegionChunkSplitter.txx"
 #include "itkImageRegionConstIterator.txx"
 #include "itkImageRegionConstIteratorWithIndex.txx"
 #include "itkImageRegionExclusionConstIteratorWithIndex.txx"
@@ -180,6 +182,8 @@
 #include "itkImageRegionSplitter.txx"
 #include "itkImageReverseConstIterator.txx"
 #include "itkImageReverseIterator.txx"
+#include "itkImageScanlineConstIterator.txx"
+#include "itkImageScanlineIterator.txx"
 #include "itkImageSliceConstIteratorWithIndex.txx"
 #include "itkImageSliceIteratorWithIndex.txx"
 #include "itkImageSource.txx"
@@ -286,7 +290,9 @@
 #include "itkPathToPathFilter.txx"
 #include "itkPeriodicBoundaryCondition.txx"
 #include "itkPhasedArray3DSpecialCoordinatesImage.txx"
+#include "itkPipelineProfiler.h"
 #include "itkPixelAccessor.h"
+#include "itkPixelBufferTraits.h"
 #include "itkPixelTraits.h"
 #include "itkPoint.txx"
 #include "itkPointLocator.txx"
@@ -355,6 +361,7 @@
 #include "itkSphereSpatialFunction.txx"
 #include "itkSqrtImageAdaptor.h"
 #include "itkStdStreamLogOutput.h"
+#include "itkStreamingPrefetcher.txx"
 #include "itkSumOfSquaresImageFunction.txx"
 #include "itkSymmetricEigenAnalysis.txx"
 #include "itkSymmetricEllipsoidInteriorExteriorSpatialFunction.txx"
@@ -366,6 +373,7 @@
 #include "itkThinPlateR2LogRSplineKernelTransform.txx"
 #include "itkThinPlateSplineKernelTransform.txx"
 #include "itkThreadLogger.h"
+#include "itkThreadPool.h"
 #include "itkTimeProbe.h"
 #include "itkTimeProbesCollectorBase.h"
 #include "itkTimeStamp.h"
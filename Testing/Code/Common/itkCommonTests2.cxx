@@ -18,7 +18,13 @@ REGISTER_TEST(itkMaximumDecisionRuleTest );
 REGISTER_TEST(itkMaximumRatioDecisionRuleTest );
 REGISTER_TEST(itkNonUniformBSplineTest );
 REGISTER_TEST(itkDifferenceImageFilterTest );
+REGISTER_TEST(itkImageBufferPoolTest );
+REGISTER_TEST(itkReleaseDataWhenConsumedTest );
+REGISTER_TEST(itkImageScanlineIteratorTest );
+REGISTER_TEST(itkPipelineProfilerTest );
+REGISTER_TEST(itkImageSourceDynamicMultiThreadingTest );
 REGISTER_TEST(itkImageToImageFilterTest );
+REGISTER_TEST(itkImageRegionChunkSplitterTest );
 REGISTER_TEST(itkMeanImageFunctionTest );
 REGISTER_TEST(itkMedialNodeCorrespondencesTest );
 REGISTER_TEST(itkMedianImageFunctionTest );
@@ -29,6 +35,8 @@ REGISTER_TEST(itkMeshSourceGraftOutputTest );
 REGISTER_TEST(itkMetaDataDictionaryTest );
 REGISTER_TEST(itkMinimumDecisionRuleTest );
 REGISTER_TEST(itkMultiThreaderTest );
+REGISTER_TEST(itkMultiThreaderConcurrencyBudgetTest );
+REGISTER_TEST(itkMultiThreaderThreadTimingsTest );
 REGISTER_TEST(itkNearestNeighborExtrapolateImageFunctionTest );
 REGISTER_TEST(itkNeighborhoodTest );
 REGISTER_TEST(itkNeighborhoodIteratorTest );
@@ -87,10 +95,12 @@ REGISTER_TEST(itkSTLContainerAdaptorTest );
 REGISTER_TEST(itkStdStreamLogOutputTest );
 REGISTER_TEST(itkThreadDefsTest );
 REGISTER_TEST(itkThreadLoggerTest );
+REGISTER_TEST(itkThreadPoolTest );
 REGISTER_TEST(itkTimeProbesTest );
 REGISTER_TEST(itkTimeStampTest );
 REGISTER_TEST(itkTransformTest );
 REGISTER_TEST(itkTransformFactoryBaseTest );
+REGISTER_TEST(itkTransformNonZeroJacobianTest );
 REGISTER_TEST(itkTransformsSetParametersTest );
 REGISTER_TEST(itkTranslationTransformTest );
 REGISTER_TEST(itkTreeContainerTest );
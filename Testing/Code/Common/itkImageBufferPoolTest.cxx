@@ -0,0 +1,295 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageBufferPoolTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageBufferPool.h"
+#include "itkImage.h"
+#include "itkVectorImage.h"
+#include "itkImportImageContainer.h"
+#include "itkTimeProbe.h"
+#include <complex>
+
+namespace
+{
+typedef itk::Image< float, 3 > ImageType;
+
+ImageType::Pointer CreateImage( unsigned int size )
+{
+  ImageType::SizeType imageSize;
+  imageSize.Fill( size );
+  ImageType::RegionType region;
+  region.SetSize( imageSize );
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  return image;
+}
+
+// An element whose constructor throws once Limit elements exist
+struct ThrowingElement
+{
+  static int Count;
+  static int Limit;
+  ThrowingElement()
+    {
+    if( Count == Limit )
+      {
+      throw std::bad_alloc();
+      }
+    ++Count;
+    }
+  ~ThrowingElement()
+    {
+    --Count;
+    }
+};
+int ThrowingElement::Count = 0;
+int ThrowingElement::Limit = 0;
+
+// Allocate and touch a sequence of images the way repeated pipeline
+// updates do, and return the mean time per iteration.
+double TimeRepeatedAllocations( unsigned int size, unsigned int iterations )
+{
+  itk::TimeProbe probe;
+  probe.Start();
+  for( unsigned int i = 0; i < iterations; i++ )
+    {
+    ImageType::Pointer image = CreateImage( size );
+    image->FillBuffer( static_cast< float >( i ) );
+    }
+  probe.Stop();
+  return probe.GetMeanTime() / iterations;
+}
+}
+
+int itkImageBufferPoolTest(int, char* [])
+{
+  itk::ImageBufferPool::Pointer pool = itk::ImageBufferPool::GetInstance();
+
+  if( pool != itk::ImageBufferPool::GetInstance() )
+    {
+    std::cerr << "GetInstance() must return a single instance" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Disabled pool: images use new[]
+  pool->EnabledOff();
+  {
+  ImageType::Pointer image = CreateImage( 8 );
+  if( pool->IsPoolBuffer( image->GetBufferPointer() ) )
+    {
+    std::cerr << "Disabled pool must not provide image buffers" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( itk::ImageBufferPool::HasBuffersInUse() )
+    {
+    std::cerr << "Disabled pool must not have buffers in use" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+
+  pool->EnabledOn();
+  pool->Clear();
+
+  // Alignment and recycling
+  float * firstBuffer;
+  {
+  ImageType::Pointer image = CreateImage( 33 );
+  firstBuffer = image->GetBufferPointer();
+  if( !pool->IsPoolBuffer( firstBuffer ) )
+    {
+    std::cerr << "Enabled pool must provide image buffers" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( !itk::ImageBufferPool::HasBuffersInUse() )
+    {
+    std::cerr << "The buffer of the image must be in use" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( reinterpret_cast< size_t >( firstBuffer ) % itk::ImageBufferPool::Alignment != 0 )
+    {
+    std::cerr << "Buffer " << firstBuffer << " is not aligned on "
+              << static_cast< unsigned int >( itk::ImageBufferPool::Alignment )
+              << " bytes" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+  if( itk::ImageBufferPool::HasBuffersInUse() )
+    {
+    std::cerr << "No buffer is in use once the image is released" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( pool->GetNumberOfCachedBuffers() != 1 || pool->GetCachedBytes() < 33 * 33 * 33 * sizeof( float ) )
+    {
+    std::cerr << "A released buffer must be kept in the cache" << std::endl;
+    pool->Print( std::cerr );
+    return EXIT_FAILURE;
+    }
+  {
+  const unsigned long reused = pool->GetNumberOfReusedBuffers();
+  ImageType::Pointer image = CreateImage( 33 );
+  if( image->GetBufferPointer() != firstBuffer || pool->GetNumberOfReusedBuffers() != reused + 1 )
+    {
+    std::cerr << "A cached buffer of the same size must be reused" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+
+  // Elements with a constructor are still constructed
+  {
+  typedef itk::Image< std::complex< double >, 2 > ComplexImageType;
+  ComplexImageType::SizeType size;
+  size.Fill( 17 );
+  ComplexImageType::RegionType region;
+  region.SetSize( size );
+  ComplexImageType::Pointer image = ComplexImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  const std::complex< double > * buffer = image->GetBufferPointer();
+  for( unsigned long i = 0; i < region.GetNumberOfPixels(); i++ )
+    {
+    if( buffer[i] != std::complex< double >( 0.0, 0.0 ) )
+      {
+      std::cerr << "std::complex elements were not constructed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // VectorImage shares the same container
+  {
+  typedef itk::VectorImage< short, 2 > VectorImageType;
+  VectorImageType::SizeType size;
+  size.Fill( 10 );
+  VectorImageType::RegionType region;
+  region.SetSize( size );
+  VectorImageType::Pointer image = VectorImageType::New();
+  image->SetRegions( region );
+  image->SetVectorLength( 3 );
+  image->Allocate();
+  if( !pool->IsPoolBuffer( image->GetBufferPointer() ) )
+    {
+    std::cerr << "VectorImage must allocate from the pool" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+
+  // A full cache frees released buffers
+  pool->SetMaximumCachedBytes( 0 );
+  if( pool->GetCachedBytes() != 0 || pool->GetNumberOfCachedBuffers() != 0 )
+    {
+    std::cerr << "Lowering MaximumCachedBytes must trim the cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+  {
+  ImageType::Pointer image = CreateImage( 8 );
+  }
+  if( pool->GetCachedBytes() != 0 )
+    {
+    std::cerr << "Released buffers must not exceed MaximumCachedBytes" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Foreign buffers are rejected
+  {
+  float * foreign = new float[10];
+  bool    caught = false;
+  try
+    {
+    pool->Release( foreign );
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cout << "Caught expected exception: " << excp.GetDescription() << std::endl;
+    caught = true;
+    }
+  delete [] foreign;
+  if( !caught )
+    {
+    std::cerr << "Release() of a foreign buffer must throw" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+
+  // Sizes whose byte count overflows are rejected
+  {
+  typedef itk::ImportImageContainer< unsigned long, double > ContainerType;
+  ContainerType::Pointer container = ContainerType::New();
+  bool                   caught = false;
+  try
+    {
+    container->Reserve( static_cast< unsigned long >( -1 ) / 4 );
+    }
+  catch( itk::MemoryAllocationError & excp )
+    {
+    std::cout << "Caught expected exception: " << excp.GetDescription() << std::endl;
+    caught = true;
+    }
+  if( !caught || itk::ImageBufferPool::HasBuffersInUse() )
+    {
+    std::cerr << "A size overflowing the byte count must throw MemoryAllocationError" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+
+  // A constructor that throws leaves no element alive nor buffer in use
+  {
+  typedef itk::ImportImageContainer< unsigned long, ThrowingElement > ContainerType;
+  ContainerType::Pointer container = ContainerType::New();
+  ThrowingElement::Limit = 50;
+  bool caught = false;
+  try
+    {
+    container->Reserve( 100 );
+    }
+  catch( std::bad_alloc & )
+    {
+    caught = true;
+    }
+  if( !caught || ThrowingElement::Count != 0 || itk::ImageBufferPool::HasBuffersInUse() )
+    {
+    std::cerr << "A throwing element constructor must leave the pool clean, "
+              << ThrowingElement::Count << " elements alive" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+
+  // Cost of repeated pipeline-like allocations with and without recycling
+  const unsigned int size = 128;
+  const unsigned int iterations = 20;
+
+  pool->EnabledOff();
+  const double systemTime = TimeRepeatedAllocations( size, iterations );
+
+  pool->EnabledOn();
+  pool->SetMaximumCachedBytes( 64 * 1024 * 1024 );
+  const double poolTime = TimeRepeatedAllocations( size, iterations );
+
+  std::cout << "Allocate and fill a " << size << "^3 float image" << std::endl;
+  std::cout << "  system allocator: " << systemTime * 1e3 << " ms" << std::endl;
+  std::cout << "  buffer pool:      " << poolTime * 1e3 << " ms" << std::endl;
+
+  pool->Print( std::cout );
+  pool->Clear();
+  pool->EnabledOff();
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
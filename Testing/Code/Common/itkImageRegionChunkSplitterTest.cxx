@@ -0,0 +1,166 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageRegionChunkSplitterTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageRegionChunkSplitter.h"
+
+namespace
+{
+typedef itk::ImageRegionChunkSplitter< 3 > SplitterType;
+typedef SplitterType::RegionType           RegionType;
+
+// Check that the pieces tile the region, and that each starts and ends
+// on a chunk boundary or on the boundary of the region.
+bool CheckPieces(SplitterType *splitter, const RegionType & region, unsigned int requested,
+                 unsigned int expected)
+{
+  const unsigned int numberOfPieces = splitter->GetNumberOfSplits(region, requested);
+  if ( numberOfPieces != expected )
+    {
+    std::cerr << "Region " << region << " split in " << numberOfPieces
+              << " pieces instead of " << expected << std::endl;
+    return false;
+    }
+
+  unsigned long numberOfPixels = 0;
+  for ( unsigned int i = 0; i < numberOfPieces; i++ )
+    {
+    const RegionType piece = splitter->GetSplit(i, numberOfPieces, region);
+    if ( !region.IsInside(piece) )
+      {
+      std::cerr << "Piece " << i << " is outside the region: " << piece << std::endl;
+      return false;
+      }
+    for ( unsigned int d = 0; d < 3; d++ )
+      {
+      const long chunk = splitter->GetChunkSize()[d];
+      const long start = piece.GetIndex(d) - splitter->GetChunkOrigin()[d];
+      const long end = start + static_cast< long >( piece.GetSize(d) );
+      const long regionEnd = region.GetIndex(d) - splitter->GetChunkOrigin()[d]
+                             + static_cast< long >( region.GetSize(d) );
+      if ( ( piece.GetIndex(d) != region.GetIndex(d) && start % chunk != 0 )
+           || ( end != regionEnd && end % chunk != 0 ) )
+        {
+        std::cerr << "Piece " << i << " is not aligned on the chunks: " << piece << std::endl;
+        return false;
+        }
+      }
+    numberOfPixels += piece.GetNumberOfPixels();
+    }
+  if ( numberOfPixels != region.GetNumberOfPixels() )
+    {
+    std::cerr << "The pieces of " << region << " have " << numberOfPixels << " pixels" << std::endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int itkImageRegionChunkSplitterTest(int, char *[])
+{
+  SplitterType::Pointer splitter = SplitterType::New();
+  std::cout << splitter << std::endl;
+
+  RegionType::IndexType index = { { 0, 0, 0 } };
+  RegionType::SizeType  size = { { 100, 64, 30 } };
+  RegionType            region(index, size);
+
+  // Chunks of one pixel: the same pieces as ImageRegionSplitter
+  itk::ImageRegionSplitter< 3 >::Pointer slabSplitter = itk::ImageRegionSplitter< 3 >::New();
+  const unsigned int requested[4] = { 1, 4, 7, 100 };
+  for ( unsigned int r = 0; r < 4; r++ )
+    {
+    const unsigned int numberOfPieces = slabSplitter->GetNumberOfSplits(region, requested[r]);
+    if ( !CheckPieces(splitter, region, requested[r], numberOfPieces) )
+      {
+      return EXIT_FAILURE;
+      }
+    for ( unsigned int i = 0; i < numberOfPieces; i++ )
+      {
+      if ( splitter->GetSplit(i, numberOfPieces, region)
+           != slabSplitter->GetSplit(i, numberOfPieces, region) )
+        {
+        std::cerr << "Piece " << i << " of " << numberOfPieces
+                  << " differs from ImageRegionSplitter" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Slabs of 8 slices: 4 chunks, the last one partial
+  SplitterType::SizeType chunkSize = { { 100, 64, 8 } };
+  splitter->SetChunkSize(chunkSize);
+  if ( !CheckPieces(splitter, region, 2, 2)
+       || !CheckPieces(splitter, region, 3, 2)
+       || !CheckPieces(splitter, region, 10, 4) )
+    {
+    return EXIT_FAILURE;
+    }
+  if ( splitter->GetSplit(1, 2, region).GetIndex(2) != 16 )
+    {
+    std::cerr << "Wrong second piece: " << splitter->GetSplit(1, 2, region) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A region inside a single slab is not split along it, but along the
+  // next dimension spanning several chunks
+  chunkSize[1] = 16;
+  splitter->SetChunkSize(chunkSize);
+  RegionType::IndexType slabIndex = { { 0, 0, 9 } };
+  RegionType::SizeType  slabSize = { { 100, 64, 5 } };
+  RegionType            slab(slabIndex, slabSize);
+  if ( !CheckPieces(splitter, slab, 8, 4)
+       || splitter->GetSplit(2, 4, slab).GetSize(1) != 16
+       || splitter->GetSplit(2, 4, slab).GetSize(2) != 5 )
+    {
+    std::cerr << "Wrong split of " << slab << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Tiles of 32x32 on a grid starting at a non zero index, and a region
+  // starting inside a tile
+  SplitterType::SizeType  tileSize = { { 32, 32, 1 } };
+  SplitterType::IndexType tileOrigin = { { -10, 5, 0 } };
+  splitter->SetChunkSize(tileSize);
+  splitter->SetChunkOrigin(tileOrigin);
+  RegionType::IndexType tiledIndex = { { -10, 20, 0 } };
+  RegionType::SizeType  tiledSize = { { 100, 90, 1 } };
+  RegionType            tiled(tiledIndex, tiledSize);
+  // rows 20 to 109 span the tiles starting at 5, 37, 69 and 101
+  if ( !CheckPieces(splitter, tiled, 2, 2)
+       || !CheckPieces(splitter, tiled, 10, 4)
+       || splitter->GetSplit(0, 4, tiled).GetSize(1) != 17
+       || splitter->GetSplit(3, 4, tiled).GetIndex(1) != 101 )
+    {
+    std::cerr << "Wrong split of " << tiled << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A region in a single chunk is not split
+  RegionType::IndexType tileIndex = { { 0, 40, 0 } };
+  RegionType::SizeType  oneTileSize = { { 10, 10, 1 } };
+  RegionType            oneTile(tileIndex, oneTileSize);
+  if ( !CheckPieces(splitter, oneTile, 4, 1) || splitter->GetSplit(0, 1, oneTile) != oneTile )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
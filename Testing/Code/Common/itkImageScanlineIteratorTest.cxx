@@ -0,0 +1,221 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageScanlineIteratorTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageScanlineIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+int itkImageScanlineIteratorTest(int, char* [] )
+{
+  typedef itk::Image< float, 3 > ImageType;
+
+  ImageType::Pointer image = ImageType::New();
+  ImageType::IndexType start = { { -2, 3, 1 } };
+  ImageType::SizeType  size = { { 17, 9, 6 } };
+  ImageType::RegionType largestRegion(start, size);
+  image->SetRegions(largestRegion);
+  image->Allocate();
+
+  // Number the pixels with the region iterator
+  itk::ImageRegionIterator< ImageType > regionIt( image, largestRegion );
+  float value = 0.0f;
+  for ( regionIt.GoToBegin(); !regionIt.IsAtEnd(); ++regionIt )
+    {
+    regionIt.Set(value++);
+    }
+
+  // The scanline iterator visits the same pixels in the same order, on
+  // the whole image and on a region inside it
+  ImageType::IndexType subStart = { { 1, 4, 2 } };
+  ImageType::SizeType  subSize = { { 5, 3, 4 } };
+  ImageType::RegionType regions[2];
+  regions[0] = largestRegion;
+  regions[1] = ImageType::RegionType(subStart, subSize);
+
+  for ( unsigned int r = 0; r < 2; r++ )
+    {
+    itk::ImageRegionConstIteratorWithIndex< ImageType > referenceIt( image, regions[r] );
+    itk::ImageScanlineConstIterator< ImageType >        it( image, regions[r] );
+
+    unsigned long numberOfLines = 0;
+    referenceIt.GoToBegin();
+    it.GoToBegin();
+    while ( !it.IsAtEnd() )
+      {
+      if ( it.GetScanlineEnd() - it.GetScanlineBegin()
+           != static_cast< long >( it.GetScanlineLength() )
+           || *it.GetScanlineBegin() != it.Get() )
+        {
+        std::cerr << "Wrong scanline pointers at " << it.GetIndex() << std::endl;
+        return EXIT_FAILURE;
+        }
+      while ( !it.IsAtEndOfLine() )
+        {
+        if ( referenceIt.IsAtEnd() || it.Get() != referenceIt.Get()
+             || it.GetIndex() != referenceIt.GetIndex() )
+          {
+          std::cerr << "Scanline iterator at " << it.GetIndex() << " does not match "
+                    << referenceIt.GetIndex() << std::endl;
+          return EXIT_FAILURE;
+          }
+        ++it;
+        ++referenceIt;
+        }
+      it.NextLine();
+      numberOfLines++;
+      }
+    if ( !referenceIt.IsAtEnd() )
+      {
+      std::cerr << "Scanline iterator stopped before the end of the region" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( numberOfLines != regions[r].GetNumberOfPixels() / regions[r].GetSize()[0] )
+      {
+      std::cerr << "Wrong number of lines: " << numberOfLines << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // NextLine() at the end stays at the end
+    it.NextLine();
+    if ( !it.IsAtEnd() )
+      {
+      std::cerr << "NextLine() moved past the end of the region" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Line navigation
+  itk::ImageScanlineIterator< ImageType > it( image, regions[1] );
+  it.GoToEndOfLine();
+  if ( !it.IsAtEndOfLine() )
+    {
+    std::cerr << "GoToEndOfLine() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  it.GoToBeginOfLine();
+  if ( it.GetIndex() != subStart )
+    {
+    std::cerr << "GoToBeginOfLine() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  ImageType::IndexType middle = subStart;
+  middle[0] += 2;
+  middle[1] += 1;
+  it.SetIndex(middle);
+  it.GoToEndOfLine();
+  --it;
+  ImageType::IndexType lastOfLine = middle;
+  lastOfLine[0] = subStart[0] + subSize[0] - 1;
+  if ( it.GetIndex() != lastOfLine )
+    {
+    std::cerr << "SetIndex() did not set the current line: " << it.GetIndex() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Writing through Set() and the scanline pointers
+  for ( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
+    {
+    float *line = it.GetScanlineBegin();
+    for ( float *end = it.GetScanlineEnd(); line != end; ++line )
+      {
+      *line = -1.0f;
+      }
+    it.Set(-2.0f);
+    }
+  itk::ImageRegionConstIteratorWithIndex< ImageType > checkIt( image, largestRegion );
+  for ( checkIt.GoToBegin(); !checkIt.IsAtEnd(); ++checkIt )
+    {
+    float expected = -1.0f;
+    if ( !regions[1].IsInside( checkIt.GetIndex() ) )
+      {
+      expected = static_cast< float >( image->ComputeOffset( checkIt.GetIndex() ) );
+      }
+    else if ( checkIt.GetIndex()[0] == subStart[0] )
+      {
+      expected = -2.0f;
+      }
+    if ( checkIt.Get() != expected )
+      {
+      std::cerr << "Wrong value " << checkIt.Get() << " at " << checkIt.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // An empty region is at its end from the start
+  ImageType::SizeType emptySize = { { 0, 3, 3 } };
+  itk::ImageScanlineConstIterator< ImageType > emptyIt( image, ImageType::RegionType(start, emptySize) );
+  if ( !emptyIt.IsAtEnd() || !emptyIt.IsAtEndOfLine() )
+    {
+    std::cerr << "An empty region must be at its end" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Time to copy a large image with both iterators
+  ImageType::SizeType largeSize = { { 256, 256, 64 } };
+  ImageType::Pointer  large = ImageType::New();
+  large->SetRegions(largeSize);
+  large->Allocate();
+  large->FillBuffer(1.0f);
+  ImageType::Pointer copy = ImageType::New();
+  copy->SetRegions(largeSize);
+  copy->Allocate();
+  copy->FillBuffer(0.0f);
+  const ImageType::RegionType largeRegion = large->GetBufferedRegion();
+
+  itk::TimeProbe regionProbe;
+  itk::TimeProbe scanlineProbe;
+  for ( unsigned int run = 0; run < 10; run++ )
+    {
+    regionProbe.Start();
+    itk::ImageRegionConstIterator< ImageType > regionInIt( large, largeRegion );
+    itk::ImageRegionIterator< ImageType >      regionOutIt( copy, largeRegion );
+    for ( ; !regionOutIt.IsAtEnd(); ++regionInIt, ++regionOutIt )
+      {
+      regionOutIt.Set( regionInIt.Get() );
+      }
+    regionProbe.Stop();
+
+    scanlineProbe.Start();
+    itk::ImageScanlineConstIterator< ImageType > scanlineInIt( large, largeRegion );
+    itk::ImageScanlineIterator< ImageType >      scanlineOutIt( copy, largeRegion );
+    for ( ; !scanlineOutIt.IsAtEnd(); scanlineInIt.NextLine(), scanlineOutIt.NextLine() )
+      {
+      while ( !scanlineOutIt.IsAtEndOfLine() )
+        {
+        scanlineOutIt.Set( scanlineInIt.Get() );
+        ++scanlineInIt;
+        ++scanlineOutIt;
+        }
+      }
+    scanlineProbe.Stop();
+    }
+
+  const double gigaBytes = 2 * largeRegion.GetNumberOfPixels() * sizeof( float ) / 1e9;
+  std::cout << "Copy of " << largeSize << " float pixels (bytes read and written per second)" << std::endl;
+  std::cout << "  ImageRegionIterator:   " << gigaBytes / regionProbe.GetMeanTime() << " GB/s" << std::endl;
+  std::cout << "  ImageScanlineIterator: " << gigaBytes / scanlineProbe.GetMeanTime() << " GB/s" << std::endl;
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageSourceDynamicMultiThreadingTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageSource.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMutexLock.h"
+#include "itkProgressReporter.h"
+#include "itkCommand.h"
+#include "itkTimeProbe.h"
+
+namespace itk
+{
+
+/** Image source whose cost per pixel grows with the row index, so that a
+ * split into one slab per thread leaves most threads idle. Every pixel is
+ * incremented once per call covering it, which lets the test detect
+ * missing and overlapping pieces. */
+template< class TOutputImage >
+class UnevenCostImageSource : public ImageSource< TOutputImage >
+{
+public:
+  typedef UnevenCostImageSource         Self;
+  typedef ImageSource< TOutputImage >   Superclass;
+  typedef SmartPointer< Self >          Pointer;
+  typedef SmartPointer< const Self >    ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(UnevenCostImageSource, ImageSource);
+
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  void SetRegion( const OutputImageRegionType & region )
+    {
+    m_Region = region;
+    this->Modified();
+    }
+
+  unsigned int GetNumberOfCalls() const
+    {
+    return m_NumberOfCalls;
+    }
+
+protected:
+  UnevenCostImageSource()
+    {
+    m_NumberOfCalls = 0;
+    }
+
+  void GenerateOutputInformation()
+    {
+    this->GetOutput()->SetLargestPossibleRegion( m_Region );
+    }
+
+  void BeforeThreadedGenerateData()
+    {
+    this->GetOutput()->FillBuffer( 0 );
+    m_NumberOfCalls = 0;
+    }
+
+  void ThreadedGenerateData( const OutputImageRegionType & region, int threadId )
+    {
+    m_Lock.Lock();
+    m_NumberOfCalls++;
+    m_Lock.Unlock();
+
+    const unsigned int lastAxis = TOutputImage::ImageDimension - 1;
+    ProgressReporter progress( this, threadId, region.GetNumberOfPixels() );
+    ImageRegionIterator< TOutputImage > it( this->GetOutput(), region );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      const long row = it.GetIndex()[lastAxis] - m_Region.GetIndex()[lastAxis];
+      double     work = 0.0;
+      for( long k = 0; k < row * row; k++ )
+        {
+        work += 1.0 / ( k + 1.0 );
+        }
+      // the work is folded into the output so that it is not optimized away
+      it.Set( it.Get() + ( work >= 0.0 ? 1 : 2 ) );
+      progress.CompletedPixel();
+      }
+    }
+
+private:
+  UnevenCostImageSource(const Self &); //purposely not implemented
+  void operator=(const Self &);        //purposely not implemented
+
+  OutputImageRegionType m_Region;
+  unsigned int          m_NumberOfCalls;
+  SimpleMutexLock       m_Lock;
+};
+
+/** Records whether the progress of a filter ever went back, and its
+ * last value. */
+class ProgressChecker : public Command
+{
+public:
+  typedef ProgressChecker      Self;
+  typedef Command              Superclass;
+  typedef SmartPointer< Self > Pointer;
+
+  itkNewMacro(Self);
+
+  void Reset()
+    {
+    m_Progress = 0.0f;
+    m_Decreased = false;
+    }
+
+  float GetProgress() const
+    {
+    return m_Progress;
+    }
+
+  bool GetDecreased() const
+    {
+    return m_Decreased;
+    }
+
+  void Execute( Object * caller, const EventObject & event )
+    {
+    this->Execute( const_cast< const Object * >( caller ), event );
+    }
+
+  void Execute( const Object * caller, const EventObject & )
+    {
+    const ProcessObject * filter = dynamic_cast< const ProcessObject * >( caller );
+    if( filter->GetProgress() < m_Progress )
+      {
+      m_Decreased = true;
+      }
+    m_Progress = filter->GetProgress();
+    }
+
+protected:
+  ProgressChecker()
+    {
+    this->Reset();
+    }
+
+private:
+  float m_Progress;
+  bool  m_Decreased;
+};
+
+} // end namespace itk
+
+
+int itkImageSourceDynamicMultiThreadingTest(int, char* [])
+{
+  typedef itk::Image< unsigned short, 2 >        ImageType;
+  typedef itk::UnevenCostImageSource< ImageType > SourceType;
+
+  ImageType::RegionType region;
+  ImageType::IndexType  index = {{ 3, -5 }};
+  ImageType::SizeType   size = {{ 17, 61 }};
+  region.SetIndex( index );
+  region.SetSize( size );
+
+  const int numberOfThreads = 4;
+
+  SourceType::Pointer source = SourceType::New();
+  source->SetRegion( region );
+  source->SetNumberOfThreads( numberOfThreads );
+
+  if( source->GetDynamicMultiThreading() )
+    {
+    std::cerr << "DynamicMultiThreading must be off by default" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  source->SetNumberOfPiecesPerThread( 0 );
+  if( source->GetNumberOfPiecesPerThread() != 1 )
+    {
+    std::cerr << "NumberOfPiecesPerThread must be clamped to 1" << std::endl;
+    return EXIT_FAILURE;
+    }
+  source->SetNumberOfPiecesPerThread( 10 );
+
+  itk::ProgressChecker::Pointer progress = itk::ProgressChecker::New();
+  source->AddObserver( itk::ProgressEvent(), progress );
+
+  for( unsigned int mode = 0; mode < 2; mode++ )
+    {
+    source->SetDynamicMultiThreading( mode == 1 );
+
+    progress->Reset();
+    itk::TimeProbe probe;
+    probe.Start();
+    source->Modified();
+    source->Update();
+    probe.Stop();
+
+    std::cout << "DynamicMultiThreading " << ( mode ? "On " : "Off" )
+              << ": " << source->GetNumberOfCalls() << " pieces, "
+              << probe.GetMeanTime() << " s" << std::endl;
+
+    // every pixel must have been produced exactly once
+    itk::ImageRegionConstIterator< ImageType > it( source->GetOutput(), region );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      if( it.Get() != 1 )
+        {
+        std::cerr << "Pixel " << it.GetIndex() << " was produced "
+                  << it.Get() << " times" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    // the progress of the whole update goes from 0 to 1 only once
+    if( progress->GetDecreased() || progress->GetProgress() != 1.0f
+        || !source->GetThreadProgressReporting() )
+      {
+      std::cerr << "The progress went back, or ended at " << progress->GetProgress() << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const unsigned int threads = source->GetMultiThreader()->GetNumberOfThreads();
+    if( mode == 0 && source->GetNumberOfCalls() > threads )
+      {
+      std::cerr << "Static mode must call ThreadedGenerateData once per thread" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( mode == 1 && threads > 1 && source->GetNumberOfCalls() <= threads )
+      {
+      std::cerr << "Dynamic mode must split into more pieces than threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  source->Print( std::cout );
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
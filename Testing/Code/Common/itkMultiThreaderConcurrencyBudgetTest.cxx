@@ -0,0 +1,239 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMultiThreaderConcurrencyBudgetTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageSource.h"
+#include "itkImageRegionIterator.h"
+#include "itkMutexLock.h"
+#include <new>
+
+namespace itk
+{
+
+/** Fills its output with a constant and records how many threads it was
+ * allowed to use. */
+template< class TOutputImage >
+class ThreadCountRecordingImageSource : public ImageSource< TOutputImage >
+{
+public:
+  typedef ThreadCountRecordingImageSource Self;
+  typedef ImageSource< TOutputImage >     Superclass;
+  typedef SmartPointer< Self >            Pointer;
+  typedef SmartPointer< const Self >      ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(ThreadCountRecordingImageSource, ImageSource);
+
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  itkGetConstMacro(UsedNumberOfThreads, int);
+
+  /** Make GenerateData() throw std::bad_alloc. */
+  itkSetMacro(ThrowBadAlloc, bool);
+  itkGetConstMacro(ThrowBadAlloc, bool);
+  itkBooleanMacro(ThrowBadAlloc);
+
+  /** Whether every inner filter had its requested number of threads
+   * back after its update. */
+  itkGetConstMacro(InnerNumberOfThreadsRestored, bool);
+
+  /** Inner filter executed from every ThreadedGenerateData() call, or
+   * NULL. The largest thread count granted to it is recorded. */
+  void SetInnerFilter(Self * inner)
+    {
+    m_InnerFilter = inner;
+    }
+
+  int GetInnerNumberOfThreads() const
+    {
+    return m_InnerNumberOfThreads;
+    }
+
+protected:
+  ThreadCountRecordingImageSource()
+    {
+    m_UsedNumberOfThreads = 0;
+    m_InnerNumberOfThreads = 0;
+    m_InnerFilter = 0;
+    m_ThrowBadAlloc = false;
+    m_InnerNumberOfThreadsRestored = true;
+    typename TOutputImage::SizeType size;
+    size.Fill( 16 );
+    m_Region.SetSize( size );
+    }
+
+  void GenerateOutputInformation()
+    {
+    this->GetOutput()->SetLargestPossibleRegion( m_Region );
+    }
+
+  void BeforeThreadedGenerateData()
+    {
+    m_UsedNumberOfThreads = this->GetNumberOfThreads();
+    m_InnerNumberOfThreads = 0;
+    m_InnerNumberOfThreadsRestored = true;
+    if( m_ThrowBadAlloc )
+      {
+      throw std::bad_alloc();
+      }
+    }
+
+  void ThreadedGenerateData( const OutputImageRegionType & region, int )
+    {
+    if( m_InnerFilter )
+      {
+      // Each thread runs its own copy of the inner mini-pipeline.
+      typename Self::Pointer inner = Self::New();
+      inner->SetNumberOfThreads( m_InnerFilter->GetNumberOfThreads() );
+      inner->SetThrowBadAlloc( m_InnerFilter->GetThrowBadAlloc() );
+      try
+        {
+        inner->Update();
+        }
+      catch( std::bad_alloc & )
+        {
+        }
+      m_Lock.Lock();
+      if( inner->GetUsedNumberOfThreads() > m_InnerNumberOfThreads )
+        {
+        m_InnerNumberOfThreads = inner->GetUsedNumberOfThreads();
+        }
+      if( inner->GetNumberOfThreads() != m_InnerFilter->GetNumberOfThreads() )
+        {
+        m_InnerNumberOfThreadsRestored = false;
+        }
+      m_Lock.Unlock();
+      }
+    ImageRegionIterator< TOutputImage > it( this->GetOutput(), region );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      it.Set( 1 );
+      }
+    }
+
+private:
+  ThreadCountRecordingImageSource(const Self &); //purposely not implemented
+  void operator=(const Self &);                  //purposely not implemented
+
+  OutputImageRegionType m_Region;
+  int                   m_UsedNumberOfThreads;
+  int                   m_InnerNumberOfThreads;
+  Self *                m_InnerFilter;
+  bool                  m_ThrowBadAlloc;
+  bool                  m_InnerNumberOfThreadsRestored;
+  SimpleMutexLock       m_Lock;
+};
+
+} // end namespace itk
+
+
+int itkMultiThreaderConcurrencyBudgetTest(int, char* [])
+{
+  typedef itk::Image< unsigned char, 2 >                    ImageType;
+  typedef itk::ThreadCountRecordingImageSource< ImageType > SourceType;
+
+  const int numberOfThreads = 4;
+
+  // Budget setters
+  itk::MultiThreader::SetGlobalConcurrencyBudget( -3 );
+  if( itk::MultiThreader::GetGlobalConcurrencyBudget() != 0 )
+    {
+    std::cerr << "Negative budget must be clamped to 0" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Nothing is running: every request is honored, whatever the budget.
+  itk::MultiThreader::SetGlobalConcurrencyBudget( 2 );
+  if( itk::MultiThreader::GetGlobalNumberOfActiveThreads() != 0 )
+    {
+    std::cerr << "No thread should be active" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( itk::MultiThreader::GetNumberOfThreadsWithinConcurrencyBudget( numberOfThreads )
+      != numberOfThreads )
+    {
+    std::cerr << "An idle process must grant the requested threads" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  SourceType::Pointer inner = SourceType::New();
+  inner->SetNumberOfThreads( numberOfThreads );
+
+  SourceType::Pointer outer = SourceType::New();
+  outer->SetNumberOfThreads( numberOfThreads );
+  outer->SetInnerFilter( inner );
+
+  // With a budget equal to the outer thread count, filters updated from
+  // inside the outer threads must run inline.
+  itk::MultiThreader::SetGlobalConcurrencyBudget( numberOfThreads );
+  outer->Update();
+
+  const int outerThreads = outer->GetMultiThreader()->GetNumberOfThreads();
+  std::cout << "Budget " << numberOfThreads << ": outer " << outer->GetUsedNumberOfThreads()
+            << " threads, inner " << outer->GetInnerNumberOfThreads() << " threads" << std::endl;
+  if( outer->GetUsedNumberOfThreads() != numberOfThreads )
+    {
+    std::cerr << "The outer filter must get its requested threads" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( outerThreads > 1 && outer->GetInnerNumberOfThreads() != 1 )
+    {
+    std::cerr << "Nested filters must run inline when the budget is used up" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( outer->GetNumberOfThreads() != numberOfThreads )
+    {
+    std::cerr << "The requested number of threads must be restored after the update" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The thread count of a nested filter is restored when it throws
+  // something else than an itk::ExceptionObject
+  inner->ThrowBadAllocOn();
+  outer->Modified();
+  outer->Update();
+  inner->ThrowBadAllocOff();
+  if( outerThreads > 1 && !outer->GetInnerNumberOfThreadsRestored() )
+    {
+    std::cerr << "A nested filter that threw std::bad_alloc kept its reduced thread count" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Without a budget the nested filters keep their thread count.
+  itk::MultiThreader::SetGlobalConcurrencyBudget( 0 );
+  outer->Modified();
+  outer->Update();
+  std::cout << "No budget: outer " << outer->GetUsedNumberOfThreads()
+            << " threads, inner " << outer->GetInnerNumberOfThreads() << " threads" << std::endl;
+  if( outer->GetInnerNumberOfThreads() != numberOfThreads )
+    {
+    std::cerr << "Nested filters must not be limited without a budget" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( itk::MultiThreader::GetGlobalNumberOfActiveThreads() != 0 )
+    {
+    std::cerr << "Active thread accounting leaked: "
+              << itk::MultiThreader::GetGlobalNumberOfActiveThreads() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
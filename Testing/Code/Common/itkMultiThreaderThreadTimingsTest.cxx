@@ -0,0 +1,192 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMultiThreaderThreadTimingsTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkMultiThreader.h"
+#include "itkCommand.h"
+#include "itkImageSource.h"
+#include "itkImageRegionIterator.h"
+#include "itksys/SystemTools.hxx"
+
+namespace
+{
+// Thread i spins for (i + 1) units of time and reports i + 1 as its work.
+ITK_THREAD_RETURN_TYPE UnbalancedThreadedMethod(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct *info =
+    static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+  const double unit = *static_cast< double * >( info->UserData );
+
+  const double end = itksys::SystemTools::GetTime() + unit * ( info->ThreadID + 1 );
+  while ( itksys::SystemTools::GetTime() < end )
+    {
+    }
+  info->WorkSize = info->ThreadID + 1;
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+unsigned int s_NumberOfTimingsEvents = 0;
+
+void CountTimingsEvents(itk::Object *, const itk::EventObject &, void *)
+{
+  s_NumberOfTimingsEvents++;
+}
+}
+
+namespace itk
+{
+/** Fills its output with zeros. */
+template< class TOutputImage >
+class TimedImageSource : public ImageSource< TOutputImage >
+{
+public:
+  typedef TimedImageSource            Self;
+  typedef ImageSource< TOutputImage > Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(TimedImageSource, ImageSource);
+
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+protected:
+  TimedImageSource() {}
+
+  void GenerateOutputInformation()
+    {
+    typename TOutputImage::SizeType size;
+    size.Fill( 20 );
+    typename TOutputImage::RegionType region;
+    region.SetSize( size );
+    this->GetOutput()->SetLargestPossibleRegion( region );
+    }
+
+  void ThreadedGenerateData( const OutputImageRegionType & region, int )
+    {
+    ImageRegionIterator< TOutputImage > it( this->GetOutput(), region );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      it.Set( 0 );
+      }
+    }
+
+private:
+  TimedImageSource(const Self &); //purposely not implemented
+  void operator=(const Self &);   //purposely not implemented
+};
+} // end namespace itk
+
+
+int itkMultiThreaderThreadTimingsTest(int, char* [])
+{
+  const int numberOfThreads = 4;
+  double    unit = 0.01;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( UnbalancedThreadedMethod, &unit );
+
+  itk::CStyleCommand::Pointer command = itk::CStyleCommand::New();
+  command->SetCallback( CountTimingsEvents );
+  threader->AddObserver( itk::ThreadTimingsEvent(), command );
+
+  // Nothing is recorded by default
+  threader->SingleMethodExecute();
+  if ( !threader->GetThreadTimings().empty() || s_NumberOfTimingsEvents != 0 )
+    {
+    std::cerr << "Thread timings recorded while RecordThreadTimings is off" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  threader->RecordThreadTimingsOn();
+  threader->SingleMethodExecute();
+  if ( s_NumberOfTimingsEvents != 1 )
+    {
+    std::cerr << "Expected one ThreadTimingsEvent, got " << s_NumberOfTimingsEvents << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const itk::MultiThreader::ThreadTimingContainerType & timings = threader->GetThreadTimings();
+  if ( timings.size() != static_cast< unsigned int >( numberOfThreads ) )
+    {
+    std::cerr << "Expected " << numberOfThreads << " thread timings, got " << timings.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+  for ( int i = 0; i < numberOfThreads; i++ )
+    {
+    const itk::MultiThreader::ThreadTimingType & timing = timings[i];
+    std::cout << "Thread " << i << ": [" << timing.StartTime << ", " << timing.FinishTime
+              << "] s, work " << timing.WorkSize << std::endl;
+    if ( timing.StartTime < 0.0
+         || timing.FinishTime - timing.StartTime < unit * ( i + 1 ) * 0.99
+         || timing.FinishTime > threader->GetThreadTimingsJoinTime()
+         || timing.WorkSize != static_cast< unsigned long >( i + 1 ) )
+      {
+      std::cerr << "Wrong timing for thread " << i << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The threads ran for 1 to 4 units: they idle while the slowest finishes
+  const double imbalance = threader->GetLoadImbalance();
+  const double idleTime = threader->GetThreadIdleTime();
+  std::cout << "Join at " << threader->GetThreadTimingsJoinTime() << " s, imbalance "
+            << imbalance << ", idle time " << idleTime << " s" << std::endl;
+  if ( imbalance <= 1.0 || imbalance > numberOfThreads )
+    {
+    std::cerr << "Wrong load imbalance " << imbalance << ", expected more than 1" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( idleTime <= 0.0 )
+    {
+    std::cerr << "The threads must have waited for the slowest one" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // ImageSource reports the number of pixels of each thread's region
+  typedef itk::Image< float, 3 >             ImageType;
+  typedef itk::TimedImageSource< ImageType > SourceType;
+  SourceType::Pointer source = SourceType::New();
+  source->SetNumberOfThreads( numberOfThreads );
+  source->GetMultiThreader()->RecordThreadTimingsOn();
+  for ( unsigned int dynamic = 0; dynamic < 2; dynamic++ )
+    {
+    source->SetDynamicMultiThreading( dynamic != 0 );
+    source->Update();
+
+    const itk::MultiThreader::ThreadTimingContainerType & sourceTimings =
+      source->GetMultiThreader()->GetThreadTimings();
+    unsigned long numberOfPixels = 0;
+    for ( unsigned int i = 0; i < sourceTimings.size(); i++ )
+      {
+      numberOfPixels += sourceTimings[i].WorkSize;
+      }
+    if ( sourceTimings.empty() || numberOfPixels != 20 * 20 * 20 )
+      {
+      std::cerr << "The threads of ImageSource must report the pixels they generated: "
+                << numberOfPixels << std::endl;
+      return EXIT_FAILURE;
+      }
+    source->Modified();
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,243 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkPipelineProfilerTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkPipelineProfiler.h"
+#include "itkImageSource.h"
+#include "itkImageToImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include <sstream>
+
+namespace itk
+{
+/** Produces a ramp along the first axis. */
+template< class TOutputImage >
+class ProfiledRampImageSource : public ImageSource< TOutputImage >
+{
+public:
+  typedef ProfiledRampImageSource     Self;
+  typedef ImageSource< TOutputImage > Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(ProfiledRampImageSource, ImageSource);
+
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+protected:
+  ProfiledRampImageSource() {}
+
+  void GenerateOutputInformation()
+    {
+    typename TOutputImage::SizeType size;
+    size.Fill( 64 );
+    typename TOutputImage::RegionType region;
+    region.SetSize( size );
+    this->GetOutput()->SetLargestPossibleRegion( region );
+    }
+
+  void ThreadedGenerateData( const OutputImageRegionType & region, int )
+    {
+    ImageRegionIterator< TOutputImage > it( this->GetOutput(), region );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      it.Set( it.GetIndex()[0] );
+      }
+    }
+
+private:
+  ProfiledRampImageSource(const Self &); //purposely not implemented
+  void operator=(const Self &);          //purposely not implemented
+};
+
+/** Applies a polynomial of the given degree to every pixel; its cost
+ * grows with the degree. */
+template< class TImage >
+class ProfiledPolynomialImageFilter : public ImageToImageFilter< TImage, TImage >
+{
+public:
+  typedef ProfiledPolynomialImageFilter        Self;
+  typedef ImageToImageFilter< TImage, TImage > Superclass;
+  typedef SmartPointer< Self >                 Pointer;
+  typedef SmartPointer< const Self >           ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(ProfiledPolynomialImageFilter, ImageToImageFilter);
+
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  itkSetMacro(Degree, unsigned int);
+
+protected:
+  ProfiledPolynomialImageFilter()
+    {
+    m_Degree = 1;
+    }
+
+  void ThreadedGenerateData( const OutputImageRegionType & region, int )
+    {
+    ImageRegionConstIterator< TImage > in( this->GetInput(), region );
+    ImageRegionIterator< TImage >      out( this->GetOutput(), region );
+    for( in.GoToBegin(), out.GoToBegin(); !out.IsAtEnd(); ++in, ++out )
+      {
+      double value = 0.0;
+      for( unsigned int d = 0; d < m_Degree; d++ )
+        {
+        value = value * 0.5 + in.Get();
+        }
+      out.Set( value );
+      }
+    }
+
+private:
+  ProfiledPolynomialImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                //purposely not implemented
+
+  unsigned int m_Degree;
+};
+} // end namespace itk
+
+
+int itkPipelineProfilerTest(int, char* [])
+{
+  typedef itk::Image< float, 3 >                         ImageType;
+  typedef itk::ProfiledRampImageSource< ImageType >       SourceType;
+  typedef itk::ProfiledPolynomialImageFilter< ImageType > FilterType;
+
+  SourceType::Pointer source = SourceType::New();
+  FilterType::Pointer cheap = FilterType::New();
+  cheap->SetInput( source->GetOutput() );
+  cheap->SetDegree( 1 );
+  FilterType::Pointer expensive = FilterType::New();
+  expensive->SetInput( cheap->GetOutput() );
+  expensive->SetDegree( 200 );
+
+  itk::PipelineProfiler::Pointer profiler = itk::PipelineProfiler::New();
+  profiler->SetFilterName( expensive, "expensive" );
+
+  // Profile every filter of the pipeline
+  itk::ProcessObject::SetGlobalProfiler( profiler );
+  expensive->Update();
+  cheap->Modified();
+  expensive->Update();
+  itk::ProcessObject::SetGlobalProfiler( 0 );
+
+  profiler->Report( std::cout );
+
+  if( profiler->GetNumberOfRecords() != 3 )
+    {
+    std::cerr << "Expected 3 records, got " << profiler->GetNumberOfRecords() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const size_t imageBytes = 64 * 64 * 64 * sizeof( float );
+  const itk::ProcessObject * filters[3] = { source, cheap, expensive };
+  const unsigned long executions[3] = { 1, 2, 2 };
+  for( unsigned int i = 0; i < 3; i++ )
+    {
+    const unsigned int index = profiler->GetRecordIndex( filters[i] );
+    if( index >= profiler->GetNumberOfRecords() )
+      {
+      std::cerr << "No record for " << filters[i]->GetNameOfClass() << std::endl;
+      return EXIT_FAILURE;
+      }
+    const itk::PipelineProfiler::FilterRecordType record = profiler->GetRecord( index );
+    if( record.ClassName != filters[i]->GetNameOfClass()
+        || record.NumberOfExecutions != executions[i]
+        || record.OutputBytes != imageBytes
+        || record.GenerateDataTime <= 0.0 )
+      {
+      std::cerr << "Wrong record for " << record.Name << ": " << record.NumberOfExecutions
+                << " executions, " << record.OutputBytes << " output bytes, "
+                << record.GenerateDataTime << " s in GenerateData()" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // every thread spent some time in ThreadedGenerateData()
+    const unsigned int numberOfThreads = filters[i]->GetNumberOfThreads();
+    if( record.ThreadedGenerateDataTimes.empty()
+        || record.ThreadedGenerateDataTimes.size() > numberOfThreads )
+      {
+      std::cerr << "Wrong number of thread times for " << record.Name << ": "
+                << record.ThreadedGenerateDataTimes.size() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the stage to look at first
+  const itk::PipelineProfiler::FilterRecordType expensiveRecord =
+    profiler->GetRecord( profiler->GetRecordIndex( expensive ) );
+  const itk::PipelineProfiler::FilterRecordType cheapRecord =
+    profiler->GetRecord( profiler->GetRecordIndex( cheap ) );
+  if( expensiveRecord.Name != "expensive"
+      || expensiveRecord.GenerateDataTime <= cheapRecord.GenerateDataTime )
+    {
+    std::cerr << "The expensive filter must be the bottleneck" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::ostringstream json;
+  profiler->ReportAsJSON( json );
+  std::cout << json.str();
+  if( json.str().find( "\"name\": \"expensive\"" ) == std::string::npos
+      || json.str().find( "\"threadedGenerateData\": [" ) == std::string::npos )
+    {
+    std::cerr << "Wrong JSON report" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::ostringstream csv;
+  profiler->ReportAsCSV( csv );
+  std::cout << csv.str();
+  unsigned int numberOfLines = 0;
+  for( std::string::size_type pos = 0; ( pos = csv.str().find( '\n', pos ) ) != std::string::npos; pos++ )
+    {
+    numberOfLines++;
+    }
+  if( numberOfLines != 4 || csv.str().find( "expensive,ProfiledPolynomialImageFilter,2," ) == std::string::npos )
+    {
+    std::cerr << "Wrong CSV report" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Profiling one filter only, without the global profiler
+  profiler->Reset();
+  expensive->SetProfiler( profiler );
+  expensive->Modified();
+  expensive->Update();
+  if( profiler->GetNumberOfRecords() != 1
+      || profiler->GetRecordIndex( expensive ) != 0 )
+    {
+    std::cerr << "Only the filter with a profiler must be recorded" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A deleted filter keeps its record
+  expensive = 0;
+  if( profiler->GetNumberOfRecords() != 1 )
+    {
+    std::cerr << "Records must outlive their filters" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,356 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkReleaseDataWhenConsumedTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageSource.h"
+#include "itkImageToImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkCommand.h"
+#include <vector>
+
+namespace itk
+{
+
+/** Produces a constant image and counts its executions. */
+template< class TOutputImage >
+class CountingConstantImageSource : public ImageSource< TOutputImage >
+{
+public:
+  typedef CountingConstantImageSource Self;
+  typedef ImageSource< TOutputImage > Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(CountingConstantImageSource, ImageSource);
+
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  void SetSize( unsigned int size )
+    {
+    typename TOutputImage::SizeType imageSize;
+    imageSize.Fill( size );
+    m_Region.SetSize( imageSize );
+    this->Modified();
+    }
+
+  itkGetConstMacro(NumberOfExecutions, unsigned int);
+
+protected:
+  CountingConstantImageSource()
+    {
+    m_NumberOfExecutions = 0;
+    }
+
+  void GenerateOutputInformation()
+    {
+    this->GetOutput()->SetLargestPossibleRegion( m_Region );
+    }
+
+  void BeforeThreadedGenerateData()
+    {
+    m_NumberOfExecutions++;
+    }
+
+  void ThreadedGenerateData( const OutputImageRegionType & region, int )
+    {
+    ImageRegionIterator< TOutputImage > it( this->GetOutput(), region );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      it.Set( 0 );
+      }
+    }
+
+private:
+  CountingConstantImageSource(const Self &); //purposely not implemented
+  void operator=(const Self &);              //purposely not implemented
+
+  OutputImageRegionType m_Region;
+  unsigned int          m_NumberOfExecutions;
+};
+
+/** Adds one to the sum of its inputs. */
+template< class TImage >
+class IncrementSumImageFilter : public ImageToImageFilter< TImage, TImage >
+{
+public:
+  typedef IncrementSumImageFilter             Self;
+  typedef ImageToImageFilter< TImage, TImage > Superclass;
+  typedef SmartPointer< Self >                Pointer;
+  typedef SmartPointer< const Self >          ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(IncrementSumImageFilter, ImageToImageFilter);
+
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+protected:
+  IncrementSumImageFilter() {}
+
+  void ThreadedGenerateData( const OutputImageRegionType & region, int )
+    {
+    ImageRegionIterator< TImage > out( this->GetOutput(), region );
+    for( out.GoToBegin(); !out.IsAtEnd(); ++out )
+      {
+      out.Set( 1 );
+      }
+    for( unsigned int i = 0; i < this->GetNumberOfInputs(); i++ )
+      {
+      ImageRegionConstIterator< TImage > in( this->GetInput( i ), region );
+      for( in.GoToBegin(), out.GoToBegin(); !out.IsAtEnd(); ++in, ++out )
+        {
+        out.Set( out.Get() + in.Get() );
+        }
+      }
+    }
+
+private:
+  IncrementSumImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);          //purposely not implemented
+};
+
+/** Samples the bytes held by the buffers of a set of images at the end
+ * of every filter execution, and keeps the largest total since Reset(). */
+template< class TImage >
+class PeakImageMemoryCommand : public Command
+{
+public:
+  typedef PeakImageMemoryCommand Self;
+  typedef Command                Superclass;
+  typedef SmartPointer< Self >   Pointer;
+
+  itkNewMacro(Self);
+
+  void AddImage( const TImage * image )
+    {
+    m_Images.push_back( image );
+    }
+
+  void Reset()
+    {
+    m_Peak = 0;
+    }
+
+  /** Largest total, in kilobytes. */
+  double GetPeak() const
+    {
+    return m_Peak;
+    }
+
+  void Execute( Object *, const EventObject & )
+    {
+    double total = 0.0;
+    for( unsigned int i = 0; i < m_Images.size(); i++ )
+      {
+      total += m_Images[i]->GetPixelContainer()->Size()
+               * sizeof( typename TImage::PixelType ) / 1024.0;
+      }
+    if( total > m_Peak )
+      {
+      m_Peak = total;
+      }
+    }
+
+  void Execute( const Object * caller, const EventObject & event )
+    {
+    this->Execute( const_cast< Object * >( caller ), event );
+    }
+
+protected:
+  PeakImageMemoryCommand()
+    {
+    m_Peak = 0.0;
+    }
+
+private:
+  std::vector< const TImage * > m_Images;
+  double                        m_Peak;
+};
+
+} // end namespace itk
+
+
+int itkReleaseDataWhenConsumedTest(int, char* [])
+{
+  typedef itk::Image< float, 3 >                        ImageType;
+  typedef itk::CountingConstantImageSource< ImageType > SourceType;
+  typedef itk::IncrementSumImageFilter< ImageType >     FilterType;
+
+  const unsigned int size = 96;
+  const unsigned int numberOfFilters = 8;
+  const double       imageKiloBytes = size * size * size * sizeof( float ) / 1024.0;
+
+  // Linear chain: source -> f0 -> f1 -> ... -> f7
+  SourceType::Pointer source = SourceType::New();
+  source->SetSize( size );
+
+  typedef itk::PeakImageMemoryCommand< ImageType > SamplerType;
+  SamplerType::Pointer sampler = SamplerType::New();
+  sampler->AddImage( source->GetOutput() );
+  std::vector< FilterType::Pointer > chain;
+  for( unsigned int i = 0; i < numberOfFilters; i++ )
+    {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( i == 0 ? source->GetOutput() : chain.back()->GetOutput() );
+    filter->AddObserver( itk::EndEvent(), sampler );
+    sampler->AddImage( filter->GetOutput() );
+    chain.push_back( filter );
+    }
+
+  if( source->GetOutput()->GetNumberOfConsumers() != 1 )
+    {
+    std::cerr << "The source output must have one consumer" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double peak[2];
+  for( unsigned int mode = 0; mode < 2; mode++ )
+    {
+    itk::DataObject::SetGlobalReleaseDataWhenConsumedFlag( mode == 1 );
+
+    // start each run from an empty pipeline
+    source->GetOutput()->ReleaseData();
+    for( unsigned int i = 0; i < numberOfFilters; i++ )
+      {
+      chain[i]->GetOutput()->ReleaseData();
+      }
+
+    sampler->Reset();
+    chain.back()->Update();
+    peak[mode] = sampler->GetPeak();
+
+    std::cout << "ReleaseDataWhenConsumed " << ( mode ? "On " : "Off" ) << ": peak "
+              << peak[mode] << " KB (" << peak[mode] / imageKiloBytes << " images)"
+              << std::endl;
+
+    itk::ImageRegionConstIterator< ImageType > it( chain.back()->GetOutput(),
+                                                   chain.back()->GetOutput()->GetBufferedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      if( it.Get() != numberOfFilters )
+        {
+        std::cerr << "Wrong output value " << it.Get() << " at " << it.GetIndex() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    // The intermediate results are released only when asked for
+    for( unsigned int i = 0; i + 1 < numberOfFilters; i++ )
+      {
+      if( chain[i]->GetOutput()->GetDataReleased() != ( mode == 1 ) )
+        {
+        std::cerr << "Output of filter " << i << " has the wrong released state" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    if( chain.back()->GetOutput()->GetDataReleased() )
+      {
+      std::cerr << "The output of the last filter has no consumer and must be kept" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Without release every image of the chain is alive at the end; with
+  // release about two of them are.
+  if( peak[0] < numberOfFilters * imageKiloBytes
+      || peak[1] > 4 * imageKiloBytes || peak[1] * 2 > peak[0] )
+    {
+    std::cerr << "Releasing consumed data did not lower the peak memory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Diamond: source feeds two filters that are summed. The source output
+  // must survive until its second consumer has run.
+  itk::DataObject::SetGlobalReleaseDataWhenConsumedFlag( false );
+
+  SourceType::Pointer diamondSource = SourceType::New();
+  diamondSource->SetSize( 8 );
+
+  FilterType::Pointer left = FilterType::New();
+  left->SetInput( diamondSource->GetOutput() );
+  FilterType::Pointer right = FilterType::New();
+  right->SetInput( diamondSource->GetOutput() );
+  FilterType::Pointer sum = FilterType::New();
+  sum->SetInput( 0, left->GetOutput() );
+  sum->SetInput( 1, right->GetOutput() );
+
+  if( diamondSource->GetOutput()->GetNumberOfConsumers() != 2 )
+    {
+    std::cerr << "The diamond source output must have two consumers" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Updating one branch keeps the data needed by the other one
+  diamondSource->ReleaseDataWhenConsumedFlagOn();
+  left->Update();
+  if( diamondSource->GetOutput()->GetDataReleased() )
+    {
+    std::cerr << "Data released before its last consumer executed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  sum->Update();
+  std::cout << "Diamond: source executed " << diamondSource->GetNumberOfExecutions()
+            << " time(s)" << std::endl;
+  if( diamondSource->GetNumberOfExecutions() != 1 )
+    {
+    std::cerr << "The source must not be regenerated for its second consumer" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( !diamondSource->GetOutput()->GetDataReleased() )
+    {
+    std::cerr << "Data must be released once all its consumers executed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( sum->GetOutput()->GetPixel( sum->GetOutput()->GetBufferedRegion().GetIndex() ) != 3 )
+    {
+    std::cerr << "Wrong diamond output" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Released data is regenerated on demand
+  diamondSource->ReleaseDataWhenConsumedFlagOff();
+  right->Modified();
+  sum->Update();
+  if( diamondSource->GetNumberOfExecutions() != 2 || diamondSource->GetOutput()->GetDataReleased() )
+    {
+    std::cerr << "Released data must be regenerated when needed again" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Disconnected consumers are forgotten
+  right->SetInput( left->GetOutput() );
+  if( diamondSource->GetOutput()->GetNumberOfConsumers() != 1
+      || left->GetOutput()->GetNumberOfConsumers() != 2 )
+    {
+    std::cerr << "Consumers were not updated when an input changed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  sum = 0;
+  right = 0;
+  if( left->GetOutput()->GetNumberOfConsumers() != 0 )
+    {
+    std::cerr << "A deleted filter must not remain a consumer" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,342 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkThreadPoolTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkMultiThreader.h"
+#include "itkThreadPool.h"
+#include "itkTimeProbe.h"
+#include "itkMutexLock.h"
+#include <stdlib.h>
+
+namespace itkThreadPoolTestHelpers
+{
+
+struct CounterData
+{
+  itk::SimpleMutexLock Lock;
+  int                  Count;
+};
+
+ITK_THREAD_RETURN_TYPE CountingMethod( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info =
+    static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+  CounterData * data = static_cast< CounterData * >( info->UserData );
+
+  data->Lock.Lock();
+  data->Count++;
+  data->Lock.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+ITK_THREAD_RETURN_TYPE NestedMethod( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info =
+    static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+  CounterData * data = static_cast< CounterData * >( info->UserData );
+
+  // Every outer thread runs a complete inner MultiThreader. With a fixed
+  // size pool this would deadlock once all workers wait for inner jobs.
+  CounterData innerData;
+  innerData.Count = 0;
+  itk::MultiThreader::Pointer inner = itk::MultiThreader::New();
+  inner->SetNumberOfThreads( info->NumberOfThreads );
+  inner->SetSingleMethod( CountingMethod, &innerData );
+  inner->SingleMethodExecute();
+
+  data->Lock.Lock();
+  data->Count += innerData.Count;
+  data->Lock.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+ITK_THREAD_RETURN_TYPE ThrowingMethod( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info =
+    static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+  if( info->ThreadID == info->NumberOfThreads - 1 )
+    {
+    itkGenericExceptionMacro( "Expected exception from the last thread" );
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// A job of the pool itself: counts, and throws when asked to
+struct PoolJobData
+{
+  CounterData * Counter;
+  bool          Throw;
+};
+
+ITK_THREAD_RETURN_TYPE PoolJob( void * arg )
+{
+  PoolJobData * data = static_cast< PoolJobData * >( arg );
+
+  data->Counter->Lock.Lock();
+  data->Counter->Count++;
+  data->Counter->Lock.Unlock();
+
+  if( data->Throw )
+    {
+    itkGenericExceptionMacro( "Expected exception from a pool job" );
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// Queues jobs of its own on the pool and waits for them, from a worker
+ITK_THREAD_RETURN_TYPE NestedPoolJob( void * arg )
+{
+  PoolJobData * data = static_cast< PoolJobData * >( arg );
+
+  itk::ThreadPool::Pointer       pool = itk::ThreadPool::GetInstance();
+  itk::ThreadPool::JobCounterType counter;
+  PoolJobData                    inner[4];
+  for( unsigned int i = 0; i < 4; i++ )
+    {
+    inner[i].Counter = data->Counter;
+    inner[i].Throw = false;
+    pool->AssignWork( PoolJob, &inner[i], &counter );
+    }
+  pool->WaitForJobs( &counter );
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// Time a large number of trivial SingleMethodExecute() calls; this is the
+// threading overhead paid by every ImageSource::GenerateData().
+double TimeSingleMethodExecute( bool useThreadPool, int numberOfThreads,
+                                unsigned int numberOfCalls, bool & ok )
+{
+  CounterData data;
+  data.Count = 0;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetUseThreadPool( useThreadPool );
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( CountingMethod, &data );
+
+  itk::TimeProbe probe;
+  probe.Start();
+  for( unsigned int i = 0; i < numberOfCalls; i++ )
+    {
+    threader->SingleMethodExecute();
+    }
+  probe.Stop();
+
+  const int expected = static_cast< int >( numberOfCalls ) * threader->GetNumberOfThreads();
+  if( data.Count != expected )
+    {
+    std::cerr << "Expected " << expected << " method calls, got " << data.Count << std::endl;
+    ok = false;
+    }
+
+  return probe.GetMeanTime() / numberOfCalls;
+}
+
+} // end of itkThreadPoolTestHelpers
+
+
+int itkThreadPoolTest(int argc, char* argv[])
+{
+  using namespace itkThreadPoolTestHelpers;
+
+  int numberOfThreads = 4;
+  if( argc > 1 )
+    {
+    const int nt = atoi( argv[1] );
+    if( nt > 1 )
+      {
+      numberOfThreads = nt;
+      }
+    }
+  unsigned int numberOfCalls = 1000;
+  if( argc > 2 )
+    {
+    numberOfCalls = atoi( argv[2] );
+    }
+
+  bool ok = true;
+
+  // Let the pool hold a worker for every thread of the threaders below
+  itk::ThreadPool::Pointer pool = itk::ThreadPool::GetInstance();
+  const int maximumNumberOfThreads = pool->GetMaximumNumberOfThreads();
+  if( maximumNumberOfThreads != itk::MultiThreader::GetGlobalDefaultNumberOfThreads() )
+    {
+    std::cerr << "The pool must be limited to the global default number of threads" << std::endl;
+    ok = false;
+    }
+  pool->SetMaximumNumberOfThreads( numberOfThreads - 1 );
+
+  // Overhead per call, with and without the persistent pool
+  const double spawnTime = TimeSingleMethodExecute( false, numberOfThreads, numberOfCalls, ok );
+  const double poolTime  = TimeSingleMethodExecute( true, numberOfThreads, numberOfCalls, ok );
+
+  std::cout << "SingleMethodExecute overhead with " << numberOfThreads << " threads" << std::endl;
+  std::cout << "  spawn per call: " << spawnTime * 1e6 << " us" << std::endl;
+  std::cout << "  thread pool:    " << poolTime * 1e6 << " us" << std::endl;
+  if( poolTime > 0.0 )
+    {
+    std::cout << "  speedup:        " << spawnTime / poolTime << std::endl;
+    }
+
+  if( pool != itk::ThreadPool::GetInstance() )
+    {
+    std::cerr << "ThreadPool::GetInstance() must return a single instance" << std::endl;
+    ok = false;
+    }
+  pool->Print( std::cout );
+
+  // The workers must have been reused rather than created per call
+  const int poolSize = pool->GetNumberOfThreads();
+  if( numberOfThreads > 1 && ( poolSize < 1 || poolSize > numberOfThreads - 1 ) )
+    {
+    std::cerr << "Unexpected pool size " << poolSize << std::endl;
+    ok = false;
+    }
+
+  // Nested execution must complete
+  {
+  CounterData data;
+  data.Count = 0;
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( NestedMethod, &data );
+  threader->SingleMethodExecute();
+  const int expected = threader->GetNumberOfThreads() * threader->GetNumberOfThreads();
+  if( data.Count != expected )
+    {
+    std::cerr << "Nested execution: expected " << expected << " calls, got " << data.Count << std::endl;
+    ok = false;
+    }
+  }
+
+  // MultipleMethodExecute dispatches onto the pool as well
+  {
+  CounterData data;
+  data.Count = 0;
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads( numberOfThreads );
+  for( int i = 0; i < threader->GetNumberOfThreads(); i++ )
+    {
+    threader->SetMultipleMethod( i, CountingMethod, &data );
+    }
+  threader->MultipleMethodExecute();
+  if( data.Count != threader->GetNumberOfThreads() )
+    {
+    std::cerr << "MultipleMethodExecute: expected " << threader->GetNumberOfThreads()
+              << " calls, got " << data.Count << std::endl;
+    ok = false;
+    }
+  }
+
+  // Exceptions thrown on a pool worker are reported to the caller
+  {
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( ThrowingMethod, 0 );
+  bool caught = false;
+  try
+    {
+    threader->SingleMethodExecute();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cout << "Caught expected exception" << std::endl;
+    std::cout << excp << std::endl;
+    caught = true;
+    }
+  if( !caught )
+    {
+    std::cerr << "Exception from a pool worker was not reported" << std::endl;
+    ok = false;
+    }
+  }
+
+  // Jobs queue once the pool has its maximum number of workers, and the
+  // waiting threads run their own queued jobs
+  {
+  pool->SetMaximumNumberOfThreads( 1 );
+  CounterData data;
+  data.Count = 0;
+  itk::ThreadPool::JobCounterType counter;
+  PoolJobData                     jobs[8];
+  for( unsigned int i = 0; i < 8; i++ )
+    {
+    jobs[i].Counter = &data;
+    jobs[i].Throw = false;
+    pool->AssignWork( NestedPoolJob, &jobs[i], &counter );
+    }
+  pool->WaitForJobs( &counter );
+  if( data.Count != 32 )
+    {
+    std::cerr << "Queued jobs: expected 32 calls, got " << data.Count << std::endl;
+    ok = false;
+    }
+  if( pool->GetNumberOfThreads() > numberOfThreads - 1 )
+    {
+    std::cerr << "The pool grew to " << pool->GetNumberOfThreads() << " threads" << std::endl;
+    ok = false;
+    }
+  }
+
+  // An exception thrown by a job is rethrown by WaitForJobs() once the
+  // whole batch is done
+  {
+  CounterData data;
+  data.Count = 0;
+  itk::ThreadPool::JobCounterType counter;
+  PoolJobData                     jobs[4];
+  for( unsigned int i = 0; i < 4; i++ )
+    {
+    jobs[i].Counter = &data;
+    jobs[i].Throw = ( i == 1 );
+    pool->AssignWork( PoolJob, &jobs[i], &counter );
+    }
+  bool caught = false;
+  try
+    {
+    pool->WaitForJobs( &counter );
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cout << "Caught expected exception" << std::endl;
+    std::cout << excp << std::endl;
+    caught = true;
+    }
+  if( !caught || data.Count != 4 )
+    {
+    std::cerr << "Exception from a pool job was not reported after the batch" << std::endl;
+    ok = false;
+    }
+  }
+  pool->SetMaximumNumberOfThreads( maximumNumberOfThreads );
+
+  if( !ok )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
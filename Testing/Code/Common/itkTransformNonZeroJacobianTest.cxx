@@ -0,0 +1,203 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkTransformNonZeroJacobianTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkAffineTransform.h"
+#include "itkCenteredAffineTransform.h"
+#include "itkEuler2DTransform.h"
+#include "itkVersorTransform.h"
+#include "itkVersorRigid3DTransform.h"
+#include "itkSimilarity3DTransform.h"
+#include "itkScaleVersor3DTransform.h"
+#include "itkScaleSkewVersor3DTransform.h"
+#include "itkBSplineDeformableTransform.h"
+
+#include <iostream>
+#include <vector>
+
+/**
+ *  This test checks that the columns returned by GetNonZeroJacobian() are
+ *  those of GetJacobian() for their parameters, and that the other columns
+ *  of the Jacobian are zero.
+ */
+
+namespace
+{
+// Parameters which are not all zero, changing at each parameter
+template< class TTransform >
+void SetParameters(TTransform *transform)
+{
+  typename TTransform::ParametersType parameters = transform->GetParameters();
+  for ( unsigned int i = 0; i < parameters.GetSize(); i++ )
+    {
+    parameters[i] += 0.01 * ( ( i * 7 ) % 11 ) - 0.04;
+    }
+  transform->SetParameters(parameters);
+}
+
+template< class TTransform >
+bool CheckPoint(const char *name, const TTransform *transform,
+                const typename TTransform::InputPointType & point)
+{
+  typedef typename TTransform::JacobianType               JacobianType;
+  typedef typename TTransform::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+
+  JacobianType               nonZeroJacobian;
+  NonZeroJacobianIndicesType nonZeroJacobianIndices;
+  transform->GetNonZeroJacobian(point, nonZeroJacobian, nonZeroJacobianIndices);
+  const JacobianType & jacobian = transform->GetJacobian(point);
+
+  const unsigned int numberOfParameters = transform->GetNumberOfParameters();
+  if ( nonZeroJacobianIndices.GetSize() != transform->GetNumberOfNonZeroJacobianIndices()
+       || nonZeroJacobian.cols() != nonZeroJacobianIndices.GetSize()
+       || nonZeroJacobian.rows() != jacobian.rows() )
+    {
+    std::cerr << name << ": " << nonZeroJacobianIndices.GetSize() << " indices and a "
+              << nonZeroJacobian.rows() << "x" << nonZeroJacobian.cols()
+              << " Jacobian instead of " << transform->GetNumberOfNonZeroJacobianIndices()
+              << " columns" << std::endl;
+    return false;
+    }
+
+  std::vector< bool > returned(numberOfParameters, false);
+  for ( unsigned int k = 0; k < nonZeroJacobianIndices.GetSize(); k++ )
+    {
+    const unsigned long parameter = nonZeroJacobianIndices[k];
+    if ( parameter >= numberOfParameters )
+      {
+      std::cerr << name << ": parameter " << parameter << " out of range" << std::endl;
+      return false;
+      }
+    returned[parameter] = true;
+    for ( unsigned int d = 0; d < jacobian.rows(); d++ )
+      {
+      if ( nonZeroJacobian(d, k) != jacobian(d, parameter) )
+        {
+        std::cerr << name << ": at " << point << ", column " << k << " of parameter " << parameter
+                  << " has " << nonZeroJacobian(d, k) << " instead of " << jacobian(d, parameter)
+                  << " in row " << d << std::endl;
+        return false;
+        }
+      }
+    }
+  for ( unsigned int p = 0; p < numberOfParameters; p++ )
+    {
+    for ( unsigned int d = 0; d < jacobian.rows() && !returned[p]; d++ )
+      {
+      if ( jacobian(d, p) != 0.0 )
+        {
+        std::cerr << name << ": at " << point << ", the column of parameter " << p
+                  << " is not zero but is not returned" << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+template< class TTransform >
+bool CheckTransform(const char *name, TTransform *transform)
+{
+  typename TTransform::InputPointType point;
+  for ( unsigned int i = 0; i < 5; i++ )
+    {
+    for ( unsigned int d = 0; d < TTransform::InputSpaceDimension; d++ )
+      {
+      point[d] = 3.0 * i - 2.0 * d + 1.5;
+      }
+    if ( !CheckPoint(name, transform, point) )
+      {
+      return false;
+      }
+    }
+  std::cout << name << ": " << transform->GetNumberOfNonZeroJacobianIndices() << " of "
+            << transform->GetNumberOfParameters() << " parameters" << std::endl;
+  return true;
+}
+
+template< class TTransform >
+bool CheckLinearTransform(const char *name)
+{
+  typename TTransform::Pointer transform = TTransform::New();
+  SetParameters( transform.GetPointer() );
+  return CheckTransform( name, transform.GetPointer() );
+}
+}
+
+int itkTransformNonZeroJacobianTest(int, char *[])
+{
+  if ( !CheckLinearTransform< itk::AffineTransform< double, 2 > >("AffineTransform 2D")
+       || !CheckLinearTransform< itk::AffineTransform< double, 3 > >("AffineTransform 3D")
+       || !CheckLinearTransform< itk::CenteredAffineTransform< double, 2 > >("CenteredAffineTransform")
+       || !CheckLinearTransform< itk::Euler2DTransform< double > >("Euler2DTransform")
+       || !CheckLinearTransform< itk::VersorTransform< double > >("VersorTransform")
+       || !CheckLinearTransform< itk::VersorRigid3DTransform< double > >("VersorRigid3DTransform")
+       || !CheckLinearTransform< itk::Similarity3DTransform< double > >("Similarity3DTransform")
+       || !CheckLinearTransform< itk::ScaleVersor3DTransform< double > >("ScaleVersor3DTransform")
+       || !CheckLinearTransform< itk::ScaleSkewVersor3DTransform< double > >("ScaleSkewVersor3DTransform") )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A BSplineDeformableTransform, of which only the coefficients of the
+  // support region of a point act on it
+  typedef itk::BSplineDeformableTransform< double, 2, 3 > BSplineTransformType;
+  BSplineTransformType::Pointer bspline = BSplineTransformType::New();
+
+  BSplineTransformType::RegionType region;
+  BSplineTransformType::SizeType   size = { { 9, 8 } };
+  region.SetSize(size);
+  BSplineTransformType::SpacingType spacing;
+  spacing[0] = 2.5;
+  spacing[1] = 3.0;
+  BSplineTransformType::OriginType origin;
+  origin[0] = -4.0;
+  origin[1] = -5.0;
+  bspline->SetGridRegion(region);
+  bspline->SetGridSpacing(spacing);
+  bspline->SetGridOrigin(origin);
+
+  BSplineTransformType::ParametersType parameters( bspline->GetNumberOfParameters() );
+  parameters.Fill(0.0);
+  bspline->SetParametersByValue(parameters);
+  SetParameters( bspline.GetPointer() );
+
+  if ( !CheckTransform("BSplineDeformableTransform", bspline.GetPointer()) )
+    {
+    return EXIT_FAILURE;
+    }
+  if ( bspline->GetNumberOfNonZeroJacobianIndices() != 2 * 16 )
+    {
+    std::cerr << "BSplineDeformableTransform: " << bspline->GetNumberOfNonZeroJacobianIndices()
+              << " non-zero columns instead of 32" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Outside the grid, the Jacobian is zero
+  BSplineTransformType::InputPointType outside;
+  outside[0] = 100.0;
+  outside[1] = -50.0;
+  if ( !CheckPoint("BSplineDeformableTransform", bspline.GetPointer(), outside) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,192 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkGDCMSeriesFileNamesTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkGDCMImageIO.h"
+#include "itkGDCMSeriesFileNames.h"
+#include "itkImageFileWriter.h"
+#include "itkImageSeriesReader.h"
+#include "itkMetaDataObject.h"
+#include <itksys/SystemTools.hxx>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+typedef itk::Image< unsigned short, 3 > ImageType;
+
+// An ImageIO writing the slices of a new MR series, which have a position
+itk::GDCMImageIO::Pointer MakeSeriesIO()
+{
+  itk::GDCMImageIO::Pointer dicomIO = itk::GDCMImageIO::New();
+  itk::MetaDataDictionary & dict = dicomIO->GetMetaDataDictionary();
+  itk::EncapsulateMetaData< std::string >(dict, "0002|0002", "1.2.840.10008.5.1.4.1.1.4");
+  itk::EncapsulateMetaData< std::string >(dict, "0008|0060", "MR");
+  return dicomIO;
+}
+
+// Write a slice of one pixel thick at position z, whose pixels are all
+// equal to value
+void WriteSlice(itk::GDCMImageIO *dicomIO, const std::string & filename,
+                unsigned long width, double z, unsigned short value)
+{
+  ImageType::Pointer      image = ImageType::New();
+  ImageType::SizeType     size = { { width, width, 1 } };
+  ImageType::PointType    origin;
+  origin[0] = -10.0;
+  origin[1] = 20.0;
+  origin[2] = z;
+  image->SetRegions(size);
+  image->SetOrigin(origin);
+  image->Allocate();
+  image->FillBuffer(value);
+
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetImageIO(dicomIO);
+  writer->SetFileName(filename);
+  writer->UseInputMetaDataDictionaryOff();
+  writer->Update();
+}
+
+// Scan the directory, and check that it has numberOfSeries series, and that
+// the files of the series of firstFile are ordered along z
+bool CheckScan(const std::string & directory, bool useCache, unsigned int numberOfSeries,
+               const std::string & firstFile, unsigned int numberOfFiles)
+{
+  itk::GDCMSeriesFileNames::Pointer scanner = itk::GDCMSeriesFileNames::New();
+  scanner->SetNumberOfThreads(3);
+  scanner->SetUseHeaderCache(useCache);
+  scanner->SetInputDirectory(directory);
+
+  const itk::SerieUIDContainer & uids = scanner->GetSeriesUIDs();
+  if ( uids.size() != numberOfSeries )
+    {
+    std::cerr << "Found " << uids.size() << " series instead of " << numberOfSeries << std::endl;
+    return false;
+    }
+
+  itk::FilenamesContainer fileNames;
+  for ( unsigned int s = 0; s < uids.size() && fileNames.empty(); s++ )
+    {
+    const itk::FilenamesContainer & series = scanner->GetFileNames(uids[s]);
+    if ( std::find(series.begin(), series.end(), firstFile) != series.end() )
+      {
+      fileNames = series;
+      }
+    }
+  if ( fileNames.size() != numberOfFiles || fileNames[0] != firstFile )
+    {
+    std::cerr << "Wrong series of " << fileNames.size() << " files starting with "
+              << ( fileNames.empty() ? std::string() : fileNames[0] ) << std::endl;
+    return false;
+    }
+
+  // The value of the pixels of a slice is its position
+  typedef itk::ImageSeriesReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileNames(fileNames);
+  reader->SetImageIO( itk::GDCMImageIO::New() );
+  reader->Update();
+  ImageType *   image = reader->GetOutput();
+  unsigned long previous = 0;
+  for ( unsigned int i = 0; i < fileNames.size(); i++ )
+    {
+    ImageType::IndexType index = { { 0, 0, i } };
+    const unsigned long  value = image->GetPixel(index);
+    if ( i > 0 && value <= previous )
+      {
+      std::cerr << "Slice " << i << " (" << fileNames[i] << ") is out of order" << std::endl;
+      return false;
+      }
+    previous = value;
+    }
+  return true;
+}
+}
+
+int main(int argc, char *argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " OutputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = argv[1];
+  itksys::SystemTools::RemoveADirectory( directory.c_str() );
+  itksys::SystemTools::MakeDirectory( directory.c_str() );
+
+  try
+    {
+    // Two series, written out of order, and a file which is not DICOM
+    itk::GDCMImageIO::Pointer first = MakeSeriesIO();
+    for ( unsigned int i = 0; i < 6; i++ )
+      {
+      const unsigned short z = ( i * 5 ) % 6;
+      std::ostringstream   filename;
+      filename << directory << "/a" << i << ".dcm";
+      WriteSlice(first, filename.str(), 8, 2.0 * z, z + 1);
+      }
+    itk::GDCMImageIO::Pointer second = MakeSeriesIO();
+    for ( unsigned int i = 0; i < 3; i++ )
+      {
+      std::ostringstream filename;
+      filename << directory << "/b" << i << ".dcm";
+      WriteSlice(second, filename.str(), 8, 3.0 - i, 3 - i);
+      }
+    std::ofstream text( ( directory + "/notes.txt" ).c_str() );
+    text << "Not a DICOM file" << std::endl;
+    text.close();
+
+    // a1.dcm is the slice at z=10, a0.dcm the one at z=0
+    itk::GDCMSeriesFileNames::ReleaseHeaderCache();
+    if ( !CheckScan(directory, false, 2, directory + "/a0.dcm", 6)
+         || !CheckScan(directory, true, 2, directory + "/a0.dcm", 6)
+         || !CheckScan(directory, true, 2, directory + "/b2.dcm", 3)
+         || !CheckScan(directory, true, 2, directory + "/a0.dcm", 6) )
+      {
+      return EXIT_FAILURE;
+      }
+
+    // Files which changed are parsed again: a0.dcm moves to the second
+    // series, with a description making it larger, and a new slice is
+    // added before the others of the first one
+    itk::EncapsulateMetaData< std::string >(second->GetMetaDataDictionary(), "0008|103e",
+                                            "Slice moved to the second series");
+    WriteSlice(second, directory + "/a0.dcm", 8, 4.0, 4);
+    WriteSlice(first, directory + "/a6.dcm", 8, -2.0, 1);
+    if ( !CheckScan(directory, true, 2, directory + "/a6.dcm", 6)
+         || !CheckScan(directory, true, 2, directory + "/b2.dcm", 4)
+         || !CheckScan(directory, false, 2, directory + "/b2.dcm", 4) )
+      {
+      return EXIT_FAILURE;
+      }
+    itk::GDCMSeriesFileNames::ReleaseHeaderCache();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -58,6 +58,8 @@
 #include "itkJPEGImageIOFactory.h"
 #include "itkLSMImageIO.h"
 #include "itkLSMImageIOFactory.h"
+#include "itkMemoryMappedFile.h"
+#include "itkMemoryMappedImportImageContainer.h"
 #include "itkMetaImageIO.h"
 #include "itkMetaImageIOFactory.h"
 #include "itkMvtSunf.h"
@@ -66,6 +68,7 @@
 #include "itkNrrdImageIO.h"
 #include "itkNrrdImageIOFactory.h"
 #include "itkNumericSeriesFileNames.h"
+#include "itkParallelDeflate.h"
 #include "itkPNGImageIO.h"
 #include "itkPNGImageIOFactory.h"
 #include "Ge4xHdr.h"
@@ -79,6 +82,7 @@
 #include "itkSpatialObjectWriter.txx"
 #include "itkStimulateImageIO.h"
 #include "itkStimulateImageIOFactory.h"
+#include "itkStreamingImageIOBase.h"
 #include "itkTIFFImageIO.h"
 #include "itkTIFFImageIOFactory.h"
 #include "itkTransformFileReader.h"
@@ -47,6 +47,7 @@ void RegisterTests()
   REGISTER_TEST(itkGiplImageIOTest);
   REGISTER_TEST(itkImageFileReaderStreamingTest);
   REGISTER_TEST(itkImageFileReaderStreamingTest2);
+  REGISTER_TEST(itkImageFileReaderMemoryMappingTest);
   REGISTER_TEST(itkImageFileReaderTest1);
   REGISTER_TEST(itkImageFileReaderDimensionsTest);
   REGISTER_TEST(itkImageFileWriterTest);
@@ -57,7 +58,9 @@ void RegisterTests()
   REGISTER_TEST(itkImageFileWriterStreamingTest2);
   REGISTER_TEST(itkImageFileWriterStreamingPastingCompressingTest1);
   REGISTER_TEST(itkImageSeriesReaderDimensionsTest);
+  REGISTER_TEST(itkImageSeriesReaderParallelReadingTest);
   REGISTER_TEST(itkImageSeriesWriterTest);
+  REGISTER_TEST(itkImageSeriesWriterStreamingTest);
   REGISTER_TEST(itkImageReadDICOMSeriesWriteTest);
   REGISTER_TEST(itkImageIOBaseTest);
   REGISTER_TEST(itkImageIOFileNameExtensionsTests);
@@ -67,6 +70,7 @@ void RegisterTests()
   REGISTER_TEST(itkJPEGImageIOTest);
   REGISTER_TEST(itkMatrixImageWriteReadTest);
   REGISTER_TEST(itkMeshSpatialObjectIOTest);
+  REGISTER_TEST(itkMetaImageChunkedCompressionTest);
   REGISTER_TEST(itkMetaImageIOTest);
   REGISTER_TEST(itkMetaImageStreamingIOTest);
   REGISTER_TEST(itkMetaImageStreamingWriterIOTest);
@@ -84,6 +88,7 @@ void RegisterTests()
   REGISTER_TEST(itkNrrdCovariantVectorImageReadTest);
   REGISTER_TEST(itkNrrdCovariantVectorImageReadWriteTest);
   REGISTER_TEST(itkNumericSeriesFileNamesTest);
+  REGISTER_TEST(itkParallelDeflateTest);
   REGISTER_TEST(itkPolygonGroupSpatialObjectXMLFileTest);
   REGISTER_TEST(itkPNGImageIOTest);
   REGISTER_TEST(itkVTKImageIOTest);
@@ -93,6 +98,7 @@ void RegisterTests()
   REGISTER_TEST(itkRawImageIOTest3);
   REGISTER_TEST(itkRawImageIOTest4);
   REGISTER_TEST(itkRawImageIOTest5);
+  REGISTER_TEST(itkStreamingPiecesInFlightTest);
   REGISTER_TEST(itkVectorImageReadWriteTest);
   REGISTER_TEST(itkReadWriteImageWithDictionaryTest);
   REGISTER_TEST(itkReadWriteSpatialObjectTest);
@@ -118,6 +124,7 @@ void RegisterTests()
   REGISTER_TEST(testMetaCommand);
   REGISTER_TEST(itkGEImageIOFactoryTest);
   REGISTER_TEST(itkTIFFImageIOTest);
+  REGISTER_TEST(itkTIFFImageIOTest2);
   REGISTER_TEST(itkTransformIOTest);
   REGISTER_TEST(itkImageIODirection2DTest);
   REGISTER_TEST(itkImageIODirection3DTest);
@@ -134,4 +141,5 @@ void RegisterTests()
   REGISTER_TEST(itkNiftiImageIOTest9);
   REGISTER_TEST(itkNiftiImageIOTest10);
   REGISTER_TEST(itkNiftiImageIOTest11);
+  REGISTER_TEST(itkNiftiImageIOTest12);
 }
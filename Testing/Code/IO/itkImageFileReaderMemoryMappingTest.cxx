@@ -0,0 +1,281 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageFileReaderMemoryMappingTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMemoryMappedImportImageContainer.h"
+#include "itkRawImageIO.h"
+#include "itkByteSwapper.h"
+#include <fstream>
+
+namespace
+{
+template< class TPixel >
+TPixel TestValue(long x, long y, long z)
+{
+  return static_cast< TPixel >( ( x + 5 * y + 11 * z ) % 127 );
+}
+
+template< class TImage >
+typename TImage::Pointer MakeImage()
+{
+  typename TImage::SizeType size;
+  size[0] = 40;
+  size[1] = 30;
+  size[2] = 20;
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const typename TImage::IndexType & index = it.GetIndex();
+    it.Set( TestValue< typename TImage::PixelType >(index[0], index[1], index[2]) );
+    }
+  return image;
+}
+
+template< class TImage >
+bool CheckImage(const TImage *image, const std::string & description)
+{
+  typedef typename TImage::PixelType PixelType;
+  itk::ImageRegionConstIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const typename TImage::IndexType & index = it.GetIndex();
+    if ( it.Get() != TestValue< PixelType >(index[0], index[1], index[2]) )
+      {
+      std::cerr << description << ": wrong value " << static_cast< double >( it.Get() )
+                << " at " << index << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template< class TImage >
+bool IsMemoryMapped(const TImage *image)
+{
+  typedef typename TImage::PixelContainer PixelContainerType;
+  typedef itk::MemoryMappedImportImageContainer< typename PixelContainerType::ElementIdentifier,
+                                                 typename PixelContainerType::Element >
+  MappedPixelContainerType;
+  const MappedPixelContainerType *container =
+    dynamic_cast< const MappedPixelContainerType * >( image->GetPixelContainer() );
+  return container && container->GetMemoryMappedFile();
+}
+
+// Read fileName with and without memory mapping, over region if given,
+// and check that the mapping is used when expected.
+template< class TImage >
+bool ReadAndCheck(const std::string & fileName, bool expectMapping,
+                  itk::ImageIOBase *imageIO = 0,
+                  const typename TImage::RegionType *region = 0)
+{
+  for ( unsigned int mapping = 0; mapping < 2; mapping++ )
+    {
+    typedef itk::ImageFileReader< TImage > ReaderType;
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(fileName);
+    if ( imageIO )
+      {
+      reader->SetImageIO(imageIO);
+      }
+    reader->SetUseMemoryMapping( mapping != 0 );
+    if ( region )
+      {
+      reader->UpdateOutputInformation();
+      reader->GetOutput()->SetRequestedRegion(*region);
+      }
+    reader->Update();
+
+    const std::string description = fileName + ( mapping ? " (memory mapping)" : " (reading)" );
+    if ( !CheckImage( reader->GetOutput(), description ) )
+      {
+      return false;
+      }
+    if ( region && !reader->GetOutput()->GetBufferedRegion().IsInside(*region) )
+      {
+      std::cerr << description << ": the requested region was not read" << std::endl;
+      return false;
+      }
+    const bool mapped = IsMemoryMapped( reader->GetOutput() );
+    if ( mapped != ( mapping && expectMapping ) )
+      {
+      std::cerr << description << ": the pixels are " << ( mapped ? "" : "not " )
+                << "memory mapped" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkImageFileReaderMemoryMappingTest(int argc, char* argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = argv[1];
+
+  typedef itk::Image< short, 3 >         ShortImageType;
+  typedef itk::Image< float, 3 >         FloatImageType;
+  typedef itk::Image< unsigned char, 3 > UCharImageType;
+
+  ShortImageType::Pointer shortImage = MakeImage< ShortImageType >();
+  FloatImageType::Pointer floatImage = MakeImage< FloatImageType >();
+  UCharImageType::Pointer ucharImage = MakeImage< UCharImageType >();
+
+  typedef itk::ImageFileWriter< ShortImageType > ShortWriterType;
+  typedef itk::ImageFileWriter< FloatImageType > FloatWriterType;
+  typedef itk::ImageFileWriter< UCharImageType > UCharWriterType;
+  ShortWriterType::Pointer shortWriter = ShortWriterType::New();
+  shortWriter->SetInput(shortImage);
+  FloatWriterType::Pointer floatWriter = FloatWriterType::New();
+  floatWriter->SetInput(floatImage);
+  UCharWriterType::Pointer ucharWriter = UCharWriterType::New();
+  ucharWriter->SetInput(ucharImage);
+
+  // MetaImage with the data in a data file, and in the header file. The
+  // pixels stored after a header of arbitrary length are only mapped
+  // when they are aligned, which bytes always are.
+  const std::string mhdFileName = directory + "/ImageFileReaderMemoryMapping.mhd";
+  shortWriter->SetFileName(mhdFileName);
+  shortWriter->Update();
+  const std::string floatMHDFileName = directory + "/ImageFileReaderMemoryMappingFloat.mhd";
+  floatWriter->SetFileName(floatMHDFileName);
+  floatWriter->Update();
+  const std::string mhaFileName = directory + "/ImageFileReaderMemoryMapping.mha";
+  ucharWriter->SetFileName(mhaFileName);
+  ucharWriter->Update();
+  if ( !ReadAndCheck< ShortImageType >(mhdFileName, true)
+       || !ReadAndCheck< FloatImageType >(floatMHDFileName, true)
+       || !ReadAndCheck< UCharImageType >(mhaFileName, true) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A slab of the file is mapped at its offset; other regions are read
+  ShortImageType::RegionType region = shortImage->GetLargestPossibleRegion();
+  region.SetIndex(2, 5);
+  region.SetSize(2, 6);
+  if ( !ReadAndCheck< ShortImageType >(mhdFileName, true, 0, &region) )
+    {
+    return EXIT_FAILURE;
+    }
+  region.SetIndex(0, 3);
+  region.SetSize(0, 10);
+  if ( !ReadAndCheck< ShortImageType >(mhdFileName, false, 0, &region) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A conversion of the pixel type needs a read
+  if ( !ReadAndCheck< FloatImageType >(mhdFileName, false) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Compressed data cannot be mapped
+  const std::string compressedFileName = directory + "/ImageFileReaderMemoryMappingCompressed.mha";
+  ucharWriter->SetFileName(compressedFileName);
+  ucharWriter->UseCompressionOn();
+  ucharWriter->Update();
+  ucharWriter->UseCompressionOff();
+  if ( !ReadAndCheck< UCharImageType >(compressedFileName, false) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // NRRD with raw encoding, detached and attached
+  const std::string nhdrFileName = directory + "/ImageFileReaderMemoryMapping.nhdr";
+  shortWriter->SetFileName(nhdrFileName);
+  shortWriter->Update();
+  const std::string nrrdFileName = directory + "/ImageFileReaderMemoryMapping.nrrd";
+  ucharWriter->SetFileName(nrrdFileName);
+  ucharWriter->Update();
+  if ( !ReadAndCheck< ShortImageType >(nhdrFileName, true)
+       || !ReadAndCheck< UCharImageType >(nrrdFileName, true) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // VTK binary data is big endian, so only bytes map on every machine
+  const bool bigEndian = itk::ByteSwapper< short >::SystemIsBigEndian();
+  const std::string vtkFileName = directory + "/ImageFileReaderMemoryMapping.vtk";
+  ucharWriter->SetFileName(vtkFileName);
+  ucharWriter->Update();
+  if ( !ReadAndCheck< UCharImageType >(vtkFileName, true) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Raw data after a header of 100 bytes
+  const std::string rawFileName = directory + "/ImageFileReaderMemoryMappingWithHeader.raw";
+  {
+  std::ofstream rawFile(rawFileName.c_str(), std::ios::out | std::ios::binary);
+  const std::string header(100, 'h');
+  rawFile.write( header.c_str(), header.size() );
+  rawFile.write( reinterpret_cast< const char * >( shortImage->GetBufferPointer() ),
+                 shortImage->GetBufferedRegion().GetNumberOfPixels() * sizeof( short ) );
+  }
+  typedef itk::RawImageIO< short, 3 > RawImageIOType;
+  RawImageIOType::Pointer rawIO = RawImageIOType::New();
+  rawIO->SetFileDimensionality(3);
+  for ( unsigned int i = 0; i < 3; i++ )
+    {
+    rawIO->SetDimensions( i, shortImage->GetBufferedRegion().GetSize()[i] );
+    }
+  rawIO->SetHeaderSize(100);
+  if ( bigEndian )
+    {
+    rawIO->SetByteOrderToBigEndian();
+    }
+  else
+    {
+    rawIO->SetByteOrderToLittleEndian();
+    }
+  if ( !ReadAndCheck< ShortImageType >(rawFileName, true, rawIO) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // The mapping is private: modifying the output leaves the file alone
+  typedef itk::ImageFileReader< ShortImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(mhdFileName);
+  reader->UseMemoryMappingOn();
+  reader->Update();
+  ShortImageType::Pointer mapped = reader->GetOutput();
+  mapped->DisconnectPipeline();
+  mapped->FillBuffer(-1);
+  if ( !ReadAndCheck< ShortImageType >(mhdFileName, true) )
+    {
+    std::cerr << "Writing to the mapped pixels modified the file" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,244 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageSeriesReaderParallelReadingTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageSeriesReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMetaImageIO.h"
+#include "itkRawImageIO.h"
+#include "itkTimeProbe.h"
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+const unsigned int NumberOfSlices = 24;
+
+// Value of pixel (x, y) of slice z of the series
+template< class TPixel >
+TPixel SeriesValue(long x, long y, long z)
+{
+  return static_cast< TPixel >( ( x + 3 * y + 7 * z ) % 251 );
+}
+
+// Check that image holds the series on its buffered region
+template< class TImage >
+bool CheckSeries(const TImage *image, const char *description)
+{
+  typedef typename TImage::PixelType PixelType;
+  itk::ImageRegionConstIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const typename TImage::IndexType & index = it.GetIndex();
+    if ( it.Get() != SeriesValue< PixelType >(index[0], index[1], index[2]) )
+      {
+      std::cerr << description << ": wrong value " << it.Get() << " at " << index << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkImageSeriesReaderParallelReadingTest(int argc, char* argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::Image< short, 2 > SliceType;
+  typedef itk::Image< short, 3 > ImageType;
+  typedef itk::Image< float, 3 > FloatImageType;
+
+  // Write the slices of the series
+  SliceType::Pointer slice = SliceType::New();
+  SliceType::SizeType sliceSize;
+  sliceSize[0] = 96;
+  sliceSize[1] = 80;
+  slice->SetRegions(sliceSize);
+  slice->Allocate();
+
+  typedef itk::ImageFileWriter< SliceType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(slice);
+
+  std::vector< std::string > fileNames;
+  for ( unsigned int z = 0; z < NumberOfSlices; z++ )
+    {
+    itk::ImageRegionIteratorWithIndex< SliceType > it( slice, slice->GetBufferedRegion() );
+    for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      it.Set( SeriesValue< short >(it.GetIndex()[0], it.GetIndex()[1], z) );
+      }
+    slice->Modified();
+
+    std::ostringstream fileName;
+    fileName << argv[1] << "/ImageSeriesReaderParallelReading" << z << ".mha";
+    fileNames.push_back( fileName.str() );
+    writer->SetFileName( fileNames.back() );
+    writer->Update();
+    }
+
+  // Read the whole series sequentially and in parallel
+  typedef itk::ImageSeriesReader< ImageType > ReaderType;
+  itk::TimeProbe probes[2];
+  for ( unsigned int parallel = 0; parallel < 2; parallel++ )
+    {
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileNames(fileNames);
+    reader->SetNumberOfThreads(4);
+    reader->SetParallelReading( parallel != 0 );
+    probes[parallel].Start();
+    reader->Update();
+    probes[parallel].Stop();
+
+    const char *mode = parallel ? "parallel reading" : "sequential reading";
+    if ( reader->GetOutput()->GetBufferedRegion().GetSize()[2] != NumberOfSlices
+         || !CheckSeries( reader->GetOutput(), mode ) )
+      {
+      std::cerr << "Wrong series with " << mode << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( reader->GetMetaDataDictionaryArray()->size() != NumberOfSlices )
+      {
+      std::cerr << "Expected one dictionary per file with " << mode << ", got "
+                << reader->GetMetaDataDictionaryArray()->size() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  std::cout << "Sequential reading: " << probes[0].GetMeanTime() << " s, parallel reading: "
+            << probes[1].GetMeanTime() << " s" << std::endl;
+
+  // Pixel type conversion, with a given ImageIO
+  typedef itk::ImageSeriesReader< FloatImageType > FloatReaderType;
+  FloatReaderType::Pointer floatReader = FloatReaderType::New();
+  floatReader->SetFileNames(fileNames);
+  floatReader->SetImageIO( itk::MetaImageIO::New() );
+  floatReader->SetNumberOfThreads(3);
+  floatReader->ParallelReadingOn();
+  floatReader->Update();
+  if ( !CheckSeries( floatReader->GetOutput(), "conversion to float" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Raw files, big endian after a header: the settings of the given
+  // ImageIO apply to every file
+  std::vector< std::string > rawFileNames;
+  for ( unsigned int z = 0; z < NumberOfSlices; z++ )
+    {
+    std::ostringstream fileName;
+    fileName << argv[1] << "/ImageSeriesReaderParallelReading" << z << ".raw";
+    rawFileNames.push_back( fileName.str() );
+    std::ofstream file( rawFileNames.back().c_str(), std::ios::out | std::ios::binary );
+    const std::string header(64, 'h');
+    file.write( header.data(), header.size() );
+    for ( unsigned int y = 0; y < sliceSize[1]; y++ )
+      {
+      for ( unsigned int x = 0; x < sliceSize[0]; x++ )
+        {
+        const short value = SeriesValue< short >(x, y, z);
+        const char  bytes[2] = { static_cast< char >( ( value >> 8 ) & 0xff ),
+                                 static_cast< char >( value & 0xff ) };
+        file.write(bytes, 2);
+        }
+      }
+    }
+
+  typedef itk::RawImageIO< short, 2 > RawImageIOType;
+  RawImageIOType::Pointer rawIO = RawImageIOType::New();
+  rawIO->SetFileDimensionality(2);
+  rawIO->SetDimensions(0, sliceSize[0]);
+  rawIO->SetDimensions(1, sliceSize[1]);
+  rawIO->SetHeaderSize(64);
+  rawIO->SetByteOrderToBigEndian();
+
+  ReaderType::Pointer rawReader = ReaderType::New();
+  rawReader->SetFileNames(rawFileNames);
+  rawReader->SetImageIO(rawIO);
+  rawReader->SetNumberOfThreads(4);
+  rawReader->ParallelReadingOn();
+  rawReader->Update();
+  if ( rawReader->GetOutput()->GetBufferedRegion().GetSize()[2] != NumberOfSlices
+       || !CheckSeries( rawReader->GetOutput(), "raw files" ) )
+    {
+    std::cerr << "Wrong series read with a RawImageIO" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Only the files intersecting the requested region are read
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileNames(fileNames);
+  reader->SetNumberOfThreads(4);
+  reader->ParallelReadingOn();
+  reader->MetaDataDictionaryArrayUpdateOff();
+  reader->UpdateOutputInformation();
+  ImageType::RegionType requestedRegion = reader->GetOutput()->GetLargestPossibleRegion();
+  requestedRegion.SetIndex(0, 10);
+  requestedRegion.SetSize(0, 50);
+  requestedRegion.SetIndex(1, 5);
+  requestedRegion.SetSize(1, 30);
+  requestedRegion.SetIndex(2, 7);
+  requestedRegion.SetSize(2, 11);
+  reader->GetOutput()->SetRequestedRegion(requestedRegion);
+  reader->Update();
+  if ( reader->GetOutput()->GetBufferedRegion() != requestedRegion
+       || !CheckSeries( reader->GetOutput(), "streamed region" ) )
+    {
+    std::cerr << "Wrong streamed region " << reader->GetOutput()->GetBufferedRegion() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A file of the wrong size is reported
+  SliceType::SizeType wrongSize;
+  wrongSize[0] = 40;
+  wrongSize[1] = 40;
+  slice->SetRegions(wrongSize);
+  slice->Allocate();
+  slice->FillBuffer(0);
+  writer->SetFileName( fileNames[NumberOfSlices / 2] );
+  writer->Update();
+
+  ReaderType::Pointer failingReader = ReaderType::New();
+  failingReader->SetFileNames(fileNames);
+  failingReader->SetNumberOfThreads(4);
+  failingReader->ParallelReadingOn();
+  bool caught = false;
+  try
+    {
+    failingReader->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cout << "Expected exception: " << e.GetDescription() << std::endl;
+    caught = true;
+    }
+  if ( !caught )
+    {
+    std::cerr << "A file of the wrong size must make the reader throw" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
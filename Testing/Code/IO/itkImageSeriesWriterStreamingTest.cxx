@@ -0,0 +1,242 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkImageSeriesWriterStreamingTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageSeriesWriter.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkNumericSeriesFileNames.h"
+#include "itkPNGImageIO.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkCommand.h"
+
+namespace
+{
+typedef itk::Image< unsigned char, 2 > SliceType;
+typedef itk::Image< unsigned char, 3 > VolumeType;
+typedef itk::Image< unsigned char, 4 > SeriesType;
+
+template< class TIndex >
+unsigned char IndexValue(const TIndex & index)
+{
+  long value = 0;
+  for ( unsigned int i = 0; i < TIndex::GetIndexDimension(); i++ )
+    {
+    value = value * 7 + index[i] * ( i + 1 );
+    }
+  return static_cast< unsigned char >( value );
+}
+
+template< class TImage >
+typename TImage::Pointer MakeImage(const typename TImage::SizeType & size)
+{
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    it.Set( IndexValue( it.GetIndex() ) );
+    }
+  return image;
+}
+
+// Records the number of slices of each region the reader is updated for
+class RegionRecorder:public itk::Command
+{
+public:
+  typedef RegionRecorder          Self;
+  typedef itk::Command            Superclass;
+  typedef itk::SmartPointer< Self > Pointer;
+  itkNewMacro(Self);
+
+  void Execute(itk::Object *caller, const itk::EventObject &)
+  {
+    itk::ImageFileReader< VolumeType > *reader =
+      dynamic_cast< itk::ImageFileReader< VolumeType > * >( caller );
+    if ( reader )
+      {
+      m_Slices.push_back( reader->GetOutput()->GetRequestedRegion().GetSize(2) );
+      }
+  }
+
+  void Execute(const itk::Object *, const itk::EventObject &)
+  {}
+
+  std::vector< unsigned long > m_Slices;
+};
+
+// Check the files against the slices of image, the file number varying
+// with the slice dimensions as the pixels of the image do
+template< class TImage >
+bool CheckFiles(const TImage *image, const std::vector< std::string > & fileNames)
+{
+  typename TImage::IndexType index;
+  index.Fill(0);
+  const typename TImage::SizeType & size = image->GetLargestPossibleRegion().GetSize();
+  for ( unsigned int f = 0; f < fileNames.size(); f++ )
+    {
+    typedef itk::ImageFileReader< SliceType > ReaderType;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(fileNames[f]);
+    reader->Update();
+
+    itk::ImageRegionIteratorWithIndex< SliceType > it( reader->GetOutput(),
+                                                       reader->GetOutput()->GetBufferedRegion() );
+    for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      index[0] = it.GetIndex()[0];
+      index[1] = it.GetIndex()[1];
+      if ( it.Get() != image->GetPixel(index) )
+        {
+        std::cerr << fileNames[f] << ": wrong value at " << it.GetIndex() << std::endl;
+        return false;
+        }
+      }
+
+    // next slice
+    for ( unsigned int d = 2; d < TImage::ImageDimension; d++ )
+      {
+      if ( ++index[d] < static_cast< long >( size[d] ) )
+        {
+        break;
+        }
+      index[d] = 0;
+      }
+    }
+  return true;
+}
+}
+
+int itkImageSeriesWriterStreamingTest(int argc, char *argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " OutputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string prefix = std::string(argv[1]) + "/itkImageSeriesWriterStreamingTest";
+
+  // A volume read from a MetaImage file, which can be read by slabs
+  VolumeType::SizeType volumeSize = { { 24, 20, 13 } };
+  VolumeType::Pointer  volume = MakeImage< VolumeType >(volumeSize);
+  typedef itk::ImageFileWriter< VolumeType > VolumeWriterType;
+  VolumeWriterType::Pointer volumeWriter = VolumeWriterType::New();
+  volumeWriter->SetInput(volume);
+  volumeWriter->SetFileName(prefix + ".mha");
+  volumeWriter->Update();
+
+  typedef itk::ImageSeriesWriter< VolumeType, SliceType > SeriesWriterType;
+  typedef itk::ImageFileReader< VolumeType >              VolumeReaderType;
+  itk::NumericSeriesFileNames::Pointer names = itk::NumericSeriesFileNames::New();
+  names->SetStartIndex(0);
+  names->SetEndIndex(volumeSize[2] - 1);
+  names->SetIncrementIndex(1);
+  names->SetSeriesFormat(prefix + "%02d.png");
+
+  // Slabs of 3 slices written on 3 threads, then slices one at a time
+  // with an ImageIO set
+  const unsigned int divisions[2] = { 5, 13 };
+  const unsigned int expectedSlices[2] = { 3, 1 };
+  for ( unsigned int t = 0; t < 2; t++ )
+    {
+    VolumeReaderType::Pointer reader = VolumeReaderType::New();
+    reader->SetFileName(prefix + ".mha");
+    reader->UseStreamingOn();
+    RegionRecorder::Pointer recorder = RegionRecorder::New();
+    reader->AddObserver(itk::StartEvent(), recorder);
+
+    SeriesWriterType::Pointer writer = SeriesWriterType::New();
+    writer->SetInput( reader->GetOutput() );
+    writer->SetFileNames( names->GetFileNames() );
+    writer->SetNumberOfStreamDivisions(divisions[t]);
+    if ( t == 0 )
+      {
+      writer->SetNumberOfThreads(3);
+      writer->SetNumberOfPiecesInFlight(2);
+      }
+    else
+      {
+      writer->SetImageIO( itk::PNGImageIO::New() );
+      }
+    try
+      {
+      writer->Update();
+      }
+    catch ( itk::ExceptionObject & e )
+      {
+      std::cerr << e << std::endl;
+      return EXIT_FAILURE;
+      }
+    std::cout << writer;
+
+    const unsigned int expectedPieces = ( volumeSize[2] + expectedSlices[t] - 1 ) / expectedSlices[t];
+    if ( recorder->m_Slices.size() != expectedPieces )
+      {
+      std::cerr << "The input was updated " << recorder->m_Slices.size() << " times instead of "
+                << expectedPieces << std::endl;
+      return EXIT_FAILURE;
+      }
+    for ( unsigned int p = 0; p < recorder->m_Slices.size(); p++ )
+      {
+      if ( recorder->m_Slices[p] > expectedSlices[t] )
+        {
+        std::cerr << "Piece " << p << " has " << recorder->m_Slices[p] << " slices" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    if ( reader->GetOutput()->GetRequestedRegion() != reader->GetOutput()->GetLargestPossibleRegion() )
+      {
+      std::cerr << "The requested region of the input is not restored" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( !CheckFiles< VolumeType >(volume, names->GetFileNames()) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Several slice dimensions: the pieces are blocks of them
+  SeriesType::SizeType  seriesSize = { { 6, 5, 4, 3 } };
+  SeriesType::Pointer   series = MakeImage< SeriesType >(seriesSize);
+  typedef itk::ImageSeriesWriter< SeriesType, SliceType > SeriesOfSeriesWriterType;
+  SeriesOfSeriesWriterType::Pointer seriesWriter = SeriesOfSeriesWriterType::New();
+  names->SetEndIndex(seriesSize[2] * seriesSize[3] - 1);
+  names->SetSeriesFormat(prefix + "Series%02d.png");
+  seriesWriter->SetInput(series);
+  seriesWriter->SetFileNames( names->GetFileNames() );
+  seriesWriter->SetNumberOfStreamDivisions(5);
+  seriesWriter->SetNumberOfThreads(2);
+  try
+    {
+    seriesWriter->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( !CheckFiles< SeriesType >(series, names->GetFileNames()) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
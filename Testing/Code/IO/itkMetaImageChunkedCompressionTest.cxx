@@ -0,0 +1,283 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMetaImageChunkedCompressionTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMetaImageIO.h"
+#include "metaImage.h"
+#include <itksys/SystemTools.hxx>
+
+namespace
+{
+typedef itk::Image< short, 3 > ImageType;
+
+short TestValue(long x, long y, long z)
+{
+  return static_cast< short >( ( x + 7 * y + 13 * z ) % 50 - 20 );
+}
+
+bool CheckImage(const ImageType *image, const std::string & description)
+{
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    if ( it.Get() != TestValue(index[0], index[1], index[2]) )
+      {
+      std::cerr << description << ": wrong value " << it.Get() << " at " << index << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+// Read region of fileName, or the whole image if region is null
+bool ReadAndCheck(const std::string & fileName, bool expectStreaming,
+                  const ImageType::RegionType *region = 0)
+{
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->UpdateOutputInformation();
+  if ( region )
+    {
+    reader->GetOutput()->SetRequestedRegion(*region);
+    }
+  reader->Update();
+
+  const std::string description = fileName + ( region ? " (region)" : "" );
+  if ( !CheckImage(reader->GetOutput(), description) )
+    {
+    return false;
+    }
+  if ( reader->GetImageIO()->CanStreamRead() != expectStreaming )
+    {
+    std::cerr << description << ": the file can" << ( expectStreaming ? "not" : "" )
+              << " be read by pieces" << std::endl;
+    return false;
+    }
+  if ( reader->GetImageIO()->GetChunkSize().empty() == expectStreaming )
+    {
+    std::cerr << description << ": wrong chunk size" << std::endl;
+    return false;
+    }
+  if ( region && expectStreaming && reader->GetOutput()->GetBufferedRegion() != *region )
+    {
+    std::cerr << description << ": read " << reader->GetOutput()->GetBufferedRegion()
+              << " instead of the requested region" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+// Inflate fileName with MetaIO only
+bool CheckWithMetaIO(const std::string & fileName)
+{
+  MetaImage metaImage;
+  if ( !metaImage.Read(fileName.c_str(), true) )
+    {
+    std::cerr << "MetaIO cannot read " << fileName << std::endl;
+    return false;
+    }
+  const short *data = static_cast< const short * >( metaImage.ElementData() );
+  for ( long z = 0; z < metaImage.DimSize(2); z++ )
+    {
+    for ( long y = 0; y < metaImage.DimSize(1); y++ )
+      {
+      for ( long x = 0; x < metaImage.DimSize(0); x++ )
+        {
+        if ( *data++ != TestValue(x, y, z) )
+          {
+          std::cerr << "MetaIO reads a wrong value at " << x << " " << y << " " << z
+                    << " in " << fileName << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkMetaImageChunkedCompressionTest(int argc, char* argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = argv[1];
+
+  // 21 slices, so that the last slab of 4 slices is shorter
+  ImageType::SizeType size;
+  size[0] = 40;
+  size[1] = 30;
+  size[2] = 21;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    it.Set( TestValue(it.GetIndex()[0], it.GetIndex()[1], it.GetIndex()[2]) );
+    }
+
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+
+  // Source of the streamed writing: an uncompressed file read by pieces
+  const std::string sourceFileName = directory + "/MetaImageChunkedCompressionSource.mha";
+  writer->SetFileName(sourceFileName);
+  writer->Update();
+
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer source = ReaderType::New();
+  source->SetFileName(sourceFileName);
+
+  // Compressed by slabs of 4 slices, written in pieces of whole slabs,
+  // with the data in the header and in a data file
+  const std::string mhaFileName = directory + "/MetaImageChunkedCompression.mha";
+  const std::string mhdFileName = directory + "/MetaImageChunkedCompression.mhd";
+  const char *      fileNames[2] = { mhaFileName.c_str(), mhdFileName.c_str() };
+  for ( unsigned int f = 0; f < 2; f++ )
+    {
+    itk::MetaImageIO::Pointer metaIO = itk::MetaImageIO::New();
+    metaIO->SetCompressionChunkSize(4);
+    WriterType::Pointer streamingWriter = WriterType::New();
+    streamingWriter->SetInput( source->GetOutput() );
+    streamingWriter->SetImageIO(metaIO);
+    streamingWriter->SetFileName(fileNames[f]);
+    streamingWriter->UseCompressionOn();
+    streamingWriter->SetNumberOfStreamDivisions(6);
+    streamingWriter->Update();
+
+    itk::ImageIORegion::SizeType chunkSize = metaIO->GetChunkSize();
+    if ( chunkSize.size() != 3 || chunkSize[0] != size[0] || chunkSize[1] != size[1]
+         || chunkSize[2] != 4 )
+      {
+      std::cerr << "Wrong chunk size for writing" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // 4 pieces of the 6 slabs are 3 pieces of 2 slabs
+    itk::ImageIORegion largestRegion(3);
+    for ( unsigned int d = 0; d < 3; d++ )
+      {
+      largestRegion.SetSize(d, size[d]);
+      }
+    const unsigned int numberOfPieces =
+      metaIO->GetActualNumberOfSplitsForWriting(4, largestRegion, largestRegion);
+    const itk::ImageIORegion lastPiece =
+      metaIO->GetSplitRegionForWriting(2, numberOfPieces, largestRegion, largestRegion);
+    if ( numberOfPieces != 3 || lastPiece.GetIndex(2) != 16 || lastPiece.GetSize(2) != 5 )
+      {
+      std::cerr << "The pieces written are not made of whole slabs" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    if ( source->GetOutput()->GetBufferedRegion().GetSize()[2] == size[2] )
+      {
+      std::cerr << "The source was not read by pieces" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( itksys::SystemTools::FileExists( ( std::string(fileNames[f]) + ".tmp" ).c_str() ) )
+      {
+      std::cerr << "The temporary file of " << fileNames[f] << " was not removed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if ( !itksys::SystemTools::FileExists( ( directory + "/MetaImageChunkedCompression.zraw" ).c_str() ) )
+    {
+    std::cerr << "No data file for " << mhdFileName << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The whole image written at once, compressed by slabs of 1 slice
+  const std::string wholeFileName = directory + "/MetaImageChunkedCompressionWhole.mha";
+  itk::MetaImageIO::Pointer metaIO = itk::MetaImageIO::New();
+  metaIO->SetCompressionChunkSize(1);
+  writer->SetImageIO(metaIO);
+  writer->SetFileName(wholeFileName);
+  writer->UseCompressionOn();
+  writer->Update();
+
+  // A single compressed stream, which cannot be read by pieces
+  const std::string classicFileName = directory + "/MetaImageChunkedCompressionClassic.mha";
+  writer->SetImageIO( itk::MetaImageIO::New() );
+  writer->SetFileName(classicFileName);
+  writer->Update();
+
+  ImageType::RegionType region = image->GetLargestPossibleRegion();
+  region.SetIndex(0, 5);
+  region.SetSize(0, 20);
+  region.SetIndex(1, 3);
+  region.SetSize(1, 25);
+  region.SetIndex(2, 6);
+  region.SetSize(2, 11);
+  ImageType::RegionType slab = image->GetLargestPossibleRegion();
+  slab.SetIndex(2, 8);
+  slab.SetSize(2, 13);
+
+  for ( unsigned int f = 0; f < 3; f++ )
+    {
+    const std::string fileName = f < 2 ? fileNames[f] : wholeFileName.c_str();
+    if ( !ReadAndCheck(fileName, true)
+         || !ReadAndCheck(fileName, true, &region)
+         || !ReadAndCheck(fileName, true, &slab)
+         || !CheckWithMetaIO(fileName) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  if ( !ReadAndCheck(classicFileName, false) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Pasting is not possible with compression
+  itk::ImageIORegion pasteRegion(3);
+  pasteRegion.SetSize(0, 10);
+  pasteRegion.SetSize(1, 10);
+  pasteRegion.SetSize(2, 10);
+  writer->SetImageIO(metaIO);
+  writer->SetFileName(mhaFileName);
+  writer->SetIORegion(pasteRegion);
+  bool caught = false;
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cout << "Expected exception: " << e.GetDescription() << std::endl;
+    caught = true;
+    }
+  if ( !caught )
+    {
+    std::cerr << "Pasting into a compressed file must throw" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,327 @@
+/*=========================================================================
+
+Program:   Insight Segmentation & Registration Toolkit
+Module:    itkNiftiImageIOTest3.cxx
+Language:  C++
+Date:      $Date$
+Version:   $Revision$
+
+Copyright (c) Insight Software Consortium. All rights reserved.
+See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkNiftiImageIOTest.h"
+#include "itkAnalyzeImageIO.h"
+#include "itkExtractImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+namespace
+{
+typedef itk::Image< short, 4 > SeriesType;
+typedef itk::Image< short, 3 > VolumeType;
+
+const unsigned int TimePoint = 3;
+
+short SeriesValue(long x, long y, long z, long t)
+{
+  return static_cast< short >( x + 20 * y - 300 * z + 1000 * t );
+}
+
+SeriesType::Pointer MakeSeries(short shift)
+{
+  SeriesType::SizeType size = { { 20, 16, 6, 5 } };
+  SeriesType::Pointer  series = SeriesType::New();
+  series->SetRegions(size);
+  series->Allocate();
+  itk::ImageRegionIteratorWithIndex< SeriesType > it( series, series->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const SeriesType::IndexType & index = it.GetIndex();
+    it.Set( SeriesValue(index[0], index[1], index[2], index[3]) + shift );
+    }
+  return series;
+}
+
+SeriesType::RegionType TimePointRegion(const SeriesType::RegionType & largest, unsigned int t)
+{
+  SeriesType::RegionType region = largest;
+  region.SetIndex(3, t);
+  region.SetSize(3, 1);
+  return region;
+}
+
+// Check the pixels of the image against the series, those of the time
+// point pasted being shifted.
+template< class TImage >
+bool CheckPixels(const TImage *image, long t, long pastedTimePoint, short shift, const std::string & name)
+{
+  itk::ImageRegionConstIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const typename TImage::IndexType & index = it.GetIndex();
+    if ( TImage::ImageDimension > 3 )
+      {
+      t = index[3];
+      }
+    const double expected = SeriesValue(index[0], index[1], index[2], t) + ( t == pastedTimePoint ? shift : 0 );
+    if ( it.Get() != expected )
+      {
+      std::cerr << name << ": " << it.Get() << " instead of " << expected
+                << " at " << index << " of time point " << t << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+// Read one time point of the series, and check that only the time point
+// was read when the file is read by regions.
+bool ReadTimePoint(const std::string & fileName, itk::ImageIOBase *imageIO, bool streamed,
+                   bool readsRegions)
+{
+  typedef itk::ImageFileReader< SeriesType >                ReaderType;
+  typedef itk::ExtractImageFilter< SeriesType, VolumeType > ExtractType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  if ( imageIO )
+    {
+    reader->SetImageIO(imageIO);
+    }
+  reader->UpdateOutputInformation();
+  const SeriesType::RegionType largest = reader->GetOutput()->GetLargestPossibleRegion();
+  SeriesType::RegionType       extraction = TimePointRegion(largest, TimePoint);
+  extraction.SetSize(3, 0);
+
+  ExtractType::Pointer extract = ExtractType::New();
+  extract->SetInput( reader->GetOutput() );
+  extract->SetExtractionRegion(extraction);
+  extract->Update();
+
+  const SeriesType::RegionType expected = readsRegions ? TimePointRegion(largest, TimePoint) : largest;
+  if ( reader->GetOutput()->GetBufferedRegion() != expected )
+    {
+    std::cerr << fileName << ": read " << reader->GetOutput()->GetBufferedRegion()
+              << " instead of " << expected << std::endl;
+    return false;
+    }
+  if ( reader->GetImageIO()->CanStreamRead() != streamed )
+    {
+    std::cerr << fileName << ": CanStreamRead() is not " << streamed << std::endl;
+    return false;
+    }
+  return CheckPixels< VolumeType >(extract->GetOutput(), TimePoint, -1, 0, fileName);
+}
+
+// Write the series at once, read a time point, write it in pieces and
+// paste a time point into the file written. The files that can not be
+// streamed are written at once, and NIfTI reads the regions of those too.
+bool TestStreaming(const std::string & prefix, const std::string & extension,
+                   itk::ImageIOBase *imageIO, bool streamed, bool readsRegions)
+{
+  typedef itk::ImageFileWriter< SeriesType > WriterType;
+
+  const std::string fileName = prefix + extension;
+  const std::string streamedFileName = prefix + "Pieces" + extension;
+
+  SeriesType::Pointer series = MakeSeries(0);
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(series);
+  writer->SetFileName(fileName);
+  if ( imageIO )
+    {
+    writer->SetImageIO(imageIO);
+    }
+  writer->Update();
+  if ( !ReadTimePoint(fileName, imageIO, streamed, readsRegions) )
+    {
+    return false;
+    }
+
+  WriterType::Pointer streamingWriter = WriterType::New();
+  streamingWriter->SetInput(series);
+  streamingWriter->SetFileName(streamedFileName);
+  streamingWriter->SetNumberOfStreamDivisions(4);
+  if ( imageIO )
+    {
+    streamingWriter->SetImageIO(imageIO);
+    }
+  streamingWriter->Update();
+  if ( streamingWriter->GetImageIO()->CanStreamWrite() != streamed )
+    {
+    std::cerr << streamedFileName << ": CanStreamWrite() is not " << streamed << std::endl;
+    return false;
+    }
+  if ( !CheckPixels< SeriesType >(ReadImage< SeriesType >(streamedFileName), 0, -1, 0, streamedFileName) )
+    {
+    return false;
+    }
+
+  if ( streamed )
+    {
+    // the time point pasted is read from a file, as the writer writes
+    // the whole image when its input is not streamed
+    const std::string   shiftedFileName = prefix + "Shifted" + extension;
+    const short         shift = 7;
+    SeriesType::Pointer shifted = MakeSeries(shift);
+    WriterType::Pointer shiftedWriter = WriterType::New();
+    shiftedWriter->SetInput(shifted);
+    shiftedWriter->SetFileName(shiftedFileName);
+    if ( imageIO )
+      {
+      shiftedWriter->SetImageIO(imageIO);
+      }
+    shiftedWriter->Update();
+
+    typedef itk::ImageFileReader< SeriesType > ReaderType;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(shiftedFileName);
+    WriterType::Pointer pastingWriter = WriterType::New();
+    pastingWriter->SetInput( reader->GetOutput() );
+    pastingWriter->SetFileName(streamedFileName);
+    if ( imageIO )
+      {
+      pastingWriter->SetImageIO(imageIO);
+      }
+    const SeriesType::RegionType pasted = TimePointRegion(shifted->GetLargestPossibleRegion(), 1);
+    itk::ImageIORegion           ioRegion(4);
+    itk::ImageIORegionAdaptor< 4 >::Convert( pasted, ioRegion, shifted->GetLargestPossibleRegion().GetIndex() );
+    pastingWriter->SetIORegion(ioRegion);
+    pastingWriter->Update();
+    if ( !CheckPixels< SeriesType >(ReadImage< SeriesType >(streamedFileName), 0, 1, shift,
+                                    streamedFileName + " pasted") )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+// A scaled series is read as float, and the vector images are read by
+// regions as well.
+bool TestScaledAndVectorRegions(const std::string & prefix)
+{
+  typedef itk::Image< float, 4 >                  FloatSeriesType;
+  typedef itk::ImageFileReader< FloatSeriesType > FloatReaderType;
+
+  const std::string scaledFileName = prefix + "Scaled.nii";
+  SeriesType::Pointer series = MakeSeries(0);
+  WriteImage< SeriesType >(series, scaledFileName);
+  nifti_image *nim = nifti_image_read(scaledFileName.c_str(), 1);
+  nim->scl_slope = 2;
+  nim->scl_inter = 1;
+  nifti_image_write(nim);
+  nifti_image_free(nim);
+
+  FloatReaderType::Pointer reader = FloatReaderType::New();
+  reader->SetFileName(scaledFileName);
+  reader->UpdateOutputInformation();
+  const FloatSeriesType::RegionType timePoint =
+    TimePointRegion(reader->GetOutput()->GetLargestPossibleRegion(), TimePoint);
+  reader->GetOutput()->SetRequestedRegion(timePoint);
+  reader->Update();
+  if ( reader->GetOutput()->GetBufferedRegion() != timePoint )
+    {
+    std::cerr << scaledFileName << ": read " << reader->GetOutput()->GetBufferedRegion() << std::endl;
+    return false;
+    }
+  itk::ImageRegionConstIteratorWithIndex< FloatSeriesType > it(reader->GetOutput(), timePoint);
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const FloatSeriesType::IndexType & index = it.GetIndex();
+    if ( it.Get() != 2.0f * SeriesValue(index[0], index[1], index[2], index[3]) + 1.0f )
+      {
+      std::cerr << scaledFileName << ": " << it.Get() << " at " << index << std::endl;
+      return false;
+      }
+    }
+
+  typedef itk::Vector< float, 3 >                 VectorType;
+  typedef itk::Image< VectorType, 3 >             VectorImageType;
+  typedef itk::ImageFileReader< VectorImageType > VectorReaderType;
+
+  const std::string         vectorFileName = prefix + "Vector.nii";
+  VectorImageType::SizeType size = { { 7, 6, 5 } };
+  VectorImageType::Pointer  vectors = VectorImageType::New();
+  vectors->SetRegions(size);
+  vectors->Allocate();
+  itk::ImageRegionIteratorWithIndex< VectorImageType > vit( vectors, vectors->GetBufferedRegion() );
+  for ( vit.GoToBegin(); !vit.IsAtEnd(); ++vit )
+    {
+    VectorType v;
+    for ( unsigned int c = 0; c < 3; c++ )
+      {
+      v[c] = vit.GetIndex()[0] + 10 * vit.GetIndex()[1] + 100 * vit.GetIndex()[2] + 1000 * c;
+      }
+    vit.Set(v);
+    }
+  WriteImage< VectorImageType >(vectors, vectorFileName);
+
+  VectorImageType::IndexType  regionIndex = { { 2, 1, 3 } };
+  VectorImageType::SizeType   regionSize = { { 4, 3, 2 } };
+  VectorImageType::RegionType region(regionIndex, regionSize);
+  VectorReaderType::Pointer   vectorReader = VectorReaderType::New();
+  vectorReader->SetFileName(vectorFileName);
+  vectorReader->UpdateOutputInformation();
+  vectorReader->GetOutput()->SetRequestedRegion(region);
+  vectorReader->Update();
+  if ( vectorReader->GetOutput()->GetBufferedRegion() != region )
+    {
+    std::cerr << vectorFileName << ": read " << vectorReader->GetOutput()->GetBufferedRegion() << std::endl;
+    return false;
+    }
+  itk::ImageRegionConstIteratorWithIndex< VectorImageType > rit(vectorReader->GetOutput(), region);
+  for ( rit.GoToBegin(); !rit.IsAtEnd(); ++rit )
+    {
+    if ( rit.Get() != vectors->GetPixel( rit.GetIndex() ) )
+      {
+      std::cerr << vectorFileName << ": " << rit.Get() << " at " << rit.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+//
+// test the streamed reading and writing of NIfTI and Analyze files
+int itkNiftiImageIOTest12(int ac, char *av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "Usage: " << av[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string prefix = std::string(av[1]) + "/";
+
+  try
+    {
+    if ( !TestStreaming(prefix + "NiftiStreaming", ".nii", 0, true, true)
+         || !TestStreaming(prefix + "NiftiStreaming", ".hdr", 0, true, true)
+         || !TestStreaming(prefix + "NiftiStreamingCompressed", ".nii.gz", 0, false, true)
+         || !TestStreaming(prefix + "AnalyzeStreaming", ".hdr", itk::AnalyzeImageIO::New(), true, true)
+         || !TestStreaming(prefix + "AnalyzeStreamingCompressed", ".img.gz", itk::AnalyzeImageIO::New(),
+                           false, false)
+         || !TestScaledAndVectorRegions(prefix + "NiftiStreaming") )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,203 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelDeflateTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMetaImageIO.h"
+#include "itkNiftiImageIO.h"
+#include "itkNrrdImageIO.h"
+#include "itkParallelDeflate.h"
+#include "itk_zlib.h"
+#include <sstream>
+#include <string.h>
+
+namespace
+{
+typedef itk::Image< short, 3 > ImageType;
+
+short TestValue(long x, long y, long z)
+{
+  return static_cast< short >( ( x * y + 3 * z ) % 200 - 100 );
+}
+
+// Inflate a zlib or gzip stream of length bytes, checking its checksum
+bool Inflate(const std::string & stream, bool gzip, size_t length,
+             std::vector< unsigned char > & data)
+{
+  z_stream z;
+  memset( &z, 0, sizeof( z ) );
+  if ( inflateInit2(&z, gzip ? 16 + MAX_WBITS : MAX_WBITS) != Z_OK )
+    {
+    return false;
+    }
+  data.resize(length + 1);
+  z.next_in = reinterpret_cast< Bytef * >( const_cast< char * >( stream.data() ) );
+  z.avail_in = static_cast< uInt >( stream.size() );
+  z.next_out = &data[0];
+  z.avail_out = static_cast< uInt >( data.size() );
+  const int result = inflate(&z, Z_FINISH);
+  const bool ok = ( result == Z_STREAM_END && z.total_out == length && z.avail_in == 0 );
+  inflateEnd(&z);
+  data.resize(length);
+  return ok;
+}
+
+bool CheckCompress(const std::vector< unsigned char > & data, bool gzip, int level, int threads)
+{
+  std::ostringstream                  os;
+  itk::ParallelDeflate::SizeType      compressedLength = 0;
+  itk::ParallelDeflate::StreamFormatType format =
+    gzip ? itk::ParallelDeflate::GzipFormat : itk::ParallelDeflate::ZlibFormat;
+  if ( !itk::ParallelDeflate::Compress(data.empty() ? 0 : &data[0], data.size(), os,
+                                       format, level, threads, &compressedLength) )
+    {
+    std::cerr << "Compression failed" << std::endl;
+    return false;
+    }
+
+  const std::string stream = os.str();
+  std::vector< unsigned char > inflated;
+  if ( static_cast< size_t >( compressedLength ) != stream.size()
+       || !Inflate(stream, gzip, data.size(), inflated) || inflated != data )
+    {
+    std::cerr << ( gzip ? "Gzip" : "Zlib" ) << " stream of " << data.size()
+              << " bytes compressed at level " << level << " with " << threads
+              << " threads does not inflate back" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+template< class TImageIO >
+bool WriteAndRead(const ImageType *image, const std::string & fileName, int level, int threads)
+{
+  typename TImageIO::Pointer imageIO = TImageIO::New();
+  imageIO->SetCompressionLevel(level);
+  imageIO->SetNumberOfThreads(threads);
+
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetImageIO(imageIO);
+  writer->SetFileName(fileName);
+  writer->UseCompressionOn();
+  writer->Update();
+
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->Update();
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( reader->GetOutput(),
+                                                          reader->GetOutput()->GetLargestPossibleRegion() );
+  if ( reader->GetOutput()->GetLargestPossibleRegion() != image->GetLargestPossibleRegion() )
+    {
+    std::cerr << fileName << ": wrong size" << std::endl;
+    return false;
+    }
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    if ( it.Get() != TestValue(index[0], index[1], index[2]) )
+      {
+      std::cerr << fileName << " written with " << threads << " threads: wrong value "
+                << it.Get() << " at " << index << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkParallelDeflateTest(int argc, char* argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = argv[1];
+
+  // The libraries of the formats write the files unless threads are asked
+  // for
+  if ( itk::MetaImageIO::New()->GetNumberOfThreads() != 1
+       || itk::NrrdImageIO::New()->GetNumberOfThreads() != 1
+       || itk::NiftiImageIO::New()->GetNumberOfThreads() != 1 )
+    {
+    std::cerr << "The ImageIOs compress on several threads by default" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Streams of several blocks, of one block, and empty
+  std::vector< unsigned char > data(5 * ( 1 << 20 ) + 12345);
+  for ( size_t i = 0; i < data.size(); i++ )
+    {
+    data[i] = static_cast< unsigned char >( ( i * i / 7 + i / 1000 ) % 251 );
+    }
+  std::vector< unsigned char > small(data.begin(), data.begin() + 1000);
+  std::vector< unsigned char > empty;
+  const int threads[3] = { 1, 2, 4 };
+  for ( unsigned int gzip = 0; gzip < 2; gzip++ )
+    {
+    for ( unsigned int t = 0; t < 3; t++ )
+      {
+      if ( !CheckCompress(data, gzip != 0, 6, threads[t])
+           || !CheckCompress(data, gzip != 0, t == 0 ? 1 : 9, threads[t])
+           || !CheckCompress(small, gzip != 0, 6, threads[t])
+           || !CheckCompress(empty, gzip != 0, 6, threads[t]) )
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Images of more than one block
+  ImageType::SizeType size;
+  size[0] = 128;
+  size[1] = 128;
+  size[2] = 40;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    it.Set( TestValue(it.GetIndex()[0], it.GetIndex()[1], it.GetIndex()[2]) );
+    }
+
+  for ( unsigned int t = 0; t < 3; t++ )
+    {
+    const int level = t == 0 ? 1 : 9;
+    if ( !WriteAndRead< itk::MetaImageIO >(image, directory + "/ParallelDeflate.mha", level, threads[t])
+         || !WriteAndRead< itk::MetaImageIO >(image, directory + "/ParallelDeflate.mhd", level, threads[t])
+         || !WriteAndRead< itk::NrrdImageIO >(image, directory + "/ParallelDeflate.nrrd", level, threads[t])
+         || !WriteAndRead< itk::NrrdImageIO >(image, directory + "/ParallelDeflate.nhdr", level, threads[t])
+         || !WriteAndRead< itk::NiftiImageIO >(image, directory + "/ParallelDeflate.nii.gz", level, threads[t])
+         || !WriteAndRead< itk::NiftiImageIO >(image, directory + "/ParallelDeflate.hdr.gz", level, threads[t]) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkStreamingPiecesInFlightTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkShiftScaleImageFilter.h"
+#include "itkStreamingImageFilter.h"
+
+namespace
+{
+typedef itk::Image< short, 3 > ImageType;
+
+short TestValue(long x, long y, long z)
+{
+  return static_cast< short >( ( x * y + 3 * z ) % 200 - 100 );
+}
+
+// Copies its input, and fails for the requested regions that reach the
+// slice FailingSlice.
+class FailingFilter:public itk::ImageToImageFilter< ImageType, ImageType >
+{
+public:
+  typedef FailingFilter                                   Self;
+  typedef itk::ImageToImageFilter< ImageType, ImageType > Superclass;
+  typedef itk::SmartPointer< Self >                       Pointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(FailingFilter, ImageToImageFilter);
+
+  itkSetMacro(FailingSlice, long);
+
+protected:
+  FailingFilter() { m_FailingSlice = 1000; }
+
+  void GenerateData()
+  {
+    ImageType::Pointer output = this->GetOutput();
+    output->SetBufferedRegion( output->GetRequestedRegion() );
+    output->Allocate();
+
+    const ImageType::RegionType & region = output->GetRequestedRegion();
+    if ( region.GetIndex()[2] + static_cast< long >( region.GetSize()[2] ) > m_FailingSlice )
+      {
+      itkExceptionMacro(<< "Slice " << m_FailingSlice << " is not available");
+      }
+    itk::ImageRegionConstIteratorWithIndex< ImageType > in(this->GetInput(), region);
+    itk::ImageRegionIteratorWithIndex< ImageType >      out(output, region);
+    for ( ; !in.IsAtEnd(); ++in, ++out )
+      {
+      out.Set( in.Get() );
+      }
+  }
+
+private:
+  long m_FailingSlice;
+};
+
+bool CheckImage(const ImageType *image, int shift, const char *name)
+{
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    if ( it.Get() != TestValue(index[0], index[1], index[2]) + shift )
+      {
+      std::cerr << name << ": wrong value " << it.Get() << " at " << index << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkStreamingPiecesInFlightTest(int argc, char* argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string inputFileName = std::string(argv[1]) + "/StreamingPiecesInFlight.mha";
+  const std::string outputFileName = std::string(argv[1]) + "/StreamingPiecesInFlightOut.mha";
+
+  ImageType::SizeType size;
+  size[0] = 64;
+  size[1] = 48;
+  size[2] = 30;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    it.Set( TestValue(it.GetIndex()[0], it.GetIndex()[1], it.GetIndex()[2]) );
+    }
+
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(inputFileName);
+  writer->Update();
+
+  typedef itk::ImageFileReader< ImageType >                  ReaderType;
+  typedef itk::ShiftScaleImageFilter< ImageType, ImageType > ShiftType;
+  typedef itk::StreamingImageFilter< ImageType, ImageType >  StreamerType;
+
+  try
+    {
+    // Streamed through a pipeline that streams, and one that does not
+    for ( unsigned int inFlight = 1; inFlight <= 3; inFlight++ )
+      {
+      ReaderType::Pointer reader = ReaderType::New();
+      reader->SetFileName(inputFileName);
+      reader->UseStreamingOn();
+      ShiftType::Pointer shift = ShiftType::New();
+      shift->SetInput( reader->GetOutput() );
+      shift->SetShift(5);
+      StreamerType::Pointer streamer = StreamerType::New();
+      streamer->SetInput( shift->GetOutput() );
+      streamer->SetNumberOfStreamDivisions(7);
+      streamer->SetNumberOfPiecesInFlight(inFlight);
+      streamer->Update();
+      if ( !CheckImage(streamer->GetOutput(), 5, "StreamingImageFilter") )
+        {
+        std::cerr << "with " << inFlight << " pieces in flight" << std::endl;
+        return EXIT_FAILURE;
+        }
+
+      ShiftType::Pointer memoryShift = ShiftType::New();
+      memoryShift->SetInput(image);
+      memoryShift->SetShift(-3);
+      StreamerType::Pointer memoryStreamer = StreamerType::New();
+      memoryStreamer->SetInput( memoryShift->GetOutput() );
+      memoryStreamer->SetNumberOfStreamDivisions(5);
+      memoryStreamer->SetNumberOfPiecesInFlight(inFlight);
+      memoryStreamer->Update();
+      if ( !CheckImage(memoryStreamer->GetOutput(), -3, "StreamingImageFilter from memory") )
+        {
+        std::cerr << "with " << inFlight << " pieces in flight" << std::endl;
+        return EXIT_FAILURE;
+        }
+
+      // Streamed writing
+      WriterType::Pointer streamingWriter = WriterType::New();
+      streamingWriter->SetInput( shift->GetOutput() );
+      streamingWriter->SetFileName(outputFileName);
+      streamingWriter->SetNumberOfStreamDivisions(6);
+      streamingWriter->SetNumberOfPiecesInFlight(inFlight);
+      streamingWriter->Update();
+
+      ReaderType::Pointer outputReader = ReaderType::New();
+      outputReader->SetFileName(outputFileName);
+      outputReader->Update();
+      if ( !CheckImage(outputReader->GetOutput(), 5, "ImageFileWriter") )
+        {
+        std::cerr << "with " << inFlight << " pieces in flight" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // An exception upstream reaches the caller
+  for ( unsigned int inFlight = 1; inFlight <= 3; inFlight++ )
+    {
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(inputFileName);
+    reader->UseStreamingOn();
+    FailingFilter::Pointer failing = FailingFilter::New();
+    failing->SetInput( reader->GetOutput() );
+    failing->SetFailingSlice(20);
+
+    StreamerType::Pointer streamer = StreamerType::New();
+    streamer->SetInput( failing->GetOutput() );
+    streamer->SetNumberOfStreamDivisions(10);
+    streamer->SetNumberOfPiecesInFlight(inFlight);
+
+    WriterType::Pointer failingWriter = WriterType::New();
+    failingWriter->SetInput( failing->GetOutput() );
+    failingWriter->SetFileName(outputFileName);
+    failingWriter->SetNumberOfStreamDivisions(10);
+    failingWriter->SetNumberOfPiecesInFlight(inFlight);
+
+    bool caught = false;
+    try
+      {
+      streamer->Update();
+      }
+    catch ( itk::ExceptionObject & e )
+      {
+      std::cout << "Caught expected exception: " << e.GetDescription() << std::endl;
+      caught = true;
+      }
+    try
+      {
+      failingWriter->Update();
+      caught = false;
+      }
+    catch ( itk::ExceptionObject & e )
+      {
+      std::cout << "Caught expected exception: " << e.GetDescription() << std::endl;
+      }
+    if ( !caught )
+      {
+      std::cerr << "Upstream exception not thrown with " << inFlight << " pieces in flight" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
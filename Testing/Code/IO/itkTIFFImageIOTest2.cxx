@@ -0,0 +1,281 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkTIFFImageIOTest2.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkTIFFImageIO.h"
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkRGBPixel.h"
+
+namespace
+{
+typedef itk::Image< unsigned char, 2 >                   GrayImageType;
+typedef itk::Image< itk::RGBPixel< unsigned char >, 2 >  RGBImageType;
+typedef itk::Image< unsigned short, 3 >                  VolumeType;
+
+// Set the pixel from the value of its index, different for each component
+template< class TPixel >
+void SetTestValue(TPixel & pixel, long value)
+{
+  pixel = static_cast< TPixel >( value );
+}
+
+void SetTestValue(itk::RGBPixel< unsigned char > & pixel, long value)
+{
+  pixel[0] = static_cast< unsigned char >( value );
+  pixel[1] = static_cast< unsigned char >( value + 85 );
+  pixel[2] = static_cast< unsigned char >( value * 3 );
+}
+
+template< class TIndex >
+long IndexValue(const TIndex & index)
+{
+  long value = 0;
+  for ( unsigned int i = 0; i < TIndex::GetIndexDimension(); i++ )
+    {
+    value = value * 131 + index[i] * ( i + 1 );
+    }
+  return value;
+}
+
+template< class TImage >
+typename TImage::Pointer MakeImage(const typename TImage::SizeType & size)
+{
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    typename TImage::PixelType pixel;
+    SetTestValue( pixel, IndexValue( it.GetIndex() ) );
+    it.Set(pixel);
+    }
+  return image;
+}
+
+template< class TImage >
+bool CheckImage(const TImage *image, const std::string & name)
+{
+  itk::ImageRegionConstIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    typename TImage::PixelType expected;
+    SetTestValue( expected, IndexValue( it.GetIndex() ) );
+    if ( it.Get() != expected )
+      {
+      std::cerr << name << ": wrong value " << it.Get() << " at " << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+// A reader that streams from the file, with its own TIFFImageIO
+template< class TImage >
+typename itk::ImageFileReader< TImage >::Pointer
+MakeReader(const std::string & fileName, int numberOfThreads)
+{
+  itk::TIFFImageIO::Pointer tiffIO = itk::TIFFImageIO::New();
+  tiffIO->SetNumberOfThreads(numberOfThreads);
+  typename itk::ImageFileReader< TImage >::Pointer reader = itk::ImageFileReader< TImage >::New();
+  reader->SetFileName(fileName);
+  reader->SetImageIO(tiffIO);
+  reader->UseStreamingOn();
+  return reader;
+}
+
+// Write the image at once, then write it again in pieces read from the
+// first file, and read a region of each file. Only the region must be
+// read from the files.
+template< class TImage >
+bool TestLayout(const typename TImage::SizeType & size, const typename TImage::RegionType & region,
+                const std::string & fileName, unsigned int tileWidth, unsigned int tileHeight,
+                bool compress)
+{
+  typedef itk::ImageFileWriter< TImage >                         WriterType;
+  typedef itk::RegionOfInterestImageFilter< TImage, TImage >     ROIType;
+
+  const std::string streamedFileName = fileName + "Pieces.tif";
+  const std::string name = fileName + ".tif";
+
+  typename TImage::Pointer image = MakeImage< TImage >(size);
+
+  itk::TIFFImageIO::Pointer tiffIO = itk::TIFFImageIO::New();
+  tiffIO->SetTileWidth(tileWidth);
+  tiffIO->SetTileHeight(tileHeight);
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(name);
+  writer->SetImageIO(tiffIO);
+  writer->SetUseCompression(compress);
+  writer->Update();
+
+  typename itk::ImageFileReader< TImage >::Pointer streamedReader = MakeReader< TImage >(name, 3);
+  typename WriterType::Pointer streamingWriter = WriterType::New();
+  itk::TIFFImageIO::Pointer streamingIO = itk::TIFFImageIO::New();
+  streamingIO->SetTileWidth(tileWidth);
+  streamingIO->SetTileHeight(tileHeight);
+  streamingWriter->SetInput( streamedReader->GetOutput() );
+  streamingWriter->SetFileName(streamedFileName);
+  streamingWriter->SetImageIO(streamingIO);
+  streamingWriter->SetUseCompression(compress);
+  streamingWriter->SetNumberOfStreamDivisions(4);
+  streamingWriter->Update();
+  if ( streamedReader->GetOutput()->GetBufferedRegion() == streamedReader->GetOutput()->GetLargestPossibleRegion() )
+    {
+    std::cerr << name << ": the pieces written are not streamed" << std::endl;
+    return false;
+    }
+
+  const std::string files[2] = { name, streamedFileName };
+  for ( unsigned int f = 0; f < 2; f++ )
+    {
+    for ( int numberOfThreads = 1; numberOfThreads <= 4; numberOfThreads += 3 )
+      {
+      typename itk::ImageFileReader< TImage >::Pointer reader = MakeReader< TImage >(files[f], numberOfThreads);
+      reader->Update();
+      if ( !CheckImage< TImage >(reader->GetOutput(), files[f]) )
+        {
+        return false;
+        }
+
+      typename itk::ImageFileReader< TImage >::Pointer regionReader =
+        MakeReader< TImage >(files[f], numberOfThreads);
+      typename ROIType::Pointer roi = ROIType::New();
+      roi->SetInput( regionReader->GetOutput() );
+      roi->SetRegionOfInterest(region);
+      roi->Update();
+      if ( regionReader->GetOutput()->GetBufferedRegion() != region )
+        {
+        std::cerr << files[f] << ": read " << regionReader->GetOutput()->GetBufferedRegion()
+                  << " instead of " << region << std::endl;
+        return false;
+        }
+      if ( !CheckImage< TImage >(regionReader->GetOutput(), files[f] + " region") )
+        {
+        return false;
+        }
+      }
+    }
+
+  return true;
+}
+}
+
+int itkTIFFImageIOTest2(int argc, char *argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string prefix = std::string(argv[1]) + "/itkTIFFImageIOTest2";
+
+  GrayImageType::SizeType   graySize = { { 300, 170 } };
+  GrayImageType::IndexType  grayIndex = { { 37, 50 } };
+  GrayImageType::SizeType   grayRegionSize = { { 100, 61 } };
+  GrayImageType::RegionType grayRegion(grayIndex, grayRegionSize);
+
+  RGBImageType::SizeType   rgbSize = { { 130, 90 } };
+  RGBImageType::IndexType  rgbIndex = { { 64, 3 } };
+  RGBImageType::SizeType   rgbRegionSize = { { 66, 40 } };
+  RGBImageType::RegionType rgbRegion(rgbIndex, rgbRegionSize);
+
+  VolumeType::SizeType   volumeSize = { { 70, 50, 4 } };
+  VolumeType::IndexType  volumeIndex = { { 10, 20, 1 } };
+  VolumeType::SizeType   volumeRegionSize = { { 33, 30, 2 } };
+  VolumeType::RegionType volumeRegion(volumeIndex, volumeRegionSize);
+
+  try
+    {
+    if ( !TestLayout< GrayImageType >(graySize, grayRegion, prefix + "Strips", 0, 0, false)
+         || !TestLayout< GrayImageType >(graySize, grayRegion, prefix + "Tiles", 64, 32, false)
+         || !TestLayout< GrayImageType >(graySize, grayRegion, prefix + "PackBitsTiles", 48, 16, true)
+         || !TestLayout< RGBImageType >(rgbSize, rgbRegion, prefix + "RGBStrips", 0, 0, true)
+         || !TestLayout< RGBImageType >(rgbSize, rgbRegion, prefix + "RGBTiles", 32, 32, false)
+         || !TestLayout< VolumeType >(volumeSize, volumeRegion, prefix + "Pages", 0, 0, true)
+         || !TestLayout< VolumeType >(volumeSize, volumeRegion, prefix + "TiledPages", 16, 16, false) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Pasting, and tiles the format does not allow, are errors
+  typedef itk::ImageFileWriter< GrayImageType > WriterType;
+  GrayImageType::Pointer image = MakeImage< GrayImageType >(graySize);
+  itk::TIFFImageIO::Pointer tiffIO = itk::TIFFImageIO::New();
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetImageIO(tiffIO);
+  writer->SetFileName(prefix + "Error.tif");
+
+  itk::ImageIORegion pasteRegion(2);
+  pasteRegion.SetSize(0, 10);
+  pasteRegion.SetSize(1, 10);
+  writer->SetIORegion(pasteRegion);
+  bool caught = false;
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cout << "Caught expected exception: " << e.GetDescription() << std::endl;
+    caught = true;
+    }
+  if ( !caught )
+    {
+    std::cerr << "Pasting did not throw" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetImageIO(tiffIO);
+  writer->SetFileName(prefix + "Error.tif");
+  tiffIO->SetTileWidth(20);
+  tiffIO->SetTileHeight(16);
+  caught = false;
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cout << "Caught expected exception: " << e.GetDescription() << std::endl;
+    caught = true;
+    }
+  if ( !caught )
+    {
+    std::cerr << "Tiles of 20x16 did not throw" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
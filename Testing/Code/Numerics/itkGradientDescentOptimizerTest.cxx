@@ -178,6 +178,45 @@ int itkGradientDescentOptimizerTest(int, char* [] )
       pass = false;
     }
 
+  // Run again with a learning rate decaying with the iterations
+  itkOptimizer->SetLearningRate( 0.2 );
+  itkOptimizer->SetLearningRateDecayExponent( 0.602 );
+  itkOptimizer->SetLearningRateDecayOffset( 10.0 );
+  itkOptimizer->SetNumberOfIterations( 100 );
+
+  try
+    {
+    itkOptimizer->StartOptimization();
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cout << "Exception thrown ! " << std::endl;
+    std::cout << "An error ocurred during Optimization" << std::endl;
+    std::cout << "Location    = " << e.GetLocation()    << std::endl;
+    std::cout << "Description = " << e.GetDescription() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  finalPosition = itkOptimizer->GetCurrentPosition();
+  std::cout << "Solution with a decaying learning rate = (";
+  std::cout << finalPosition[0] << "," ;
+  std::cout << finalPosition[1] << ")" << std::endl;
+
+  for( unsigned int j = 0; j < 2; j++ )
+    {
+    if( vnl_math_abs( finalPosition[j] - trueParameters[j] ) > 0.01 )
+      pass = false;
+    }
+
+  // After the last iteration, the learning rate is that of iteration 100
+  const double expectedLearningRate = 0.2 * vcl_pow( 11.0 / 111.0, 0.602 );
+  std::cout << "CurrentLearningRate: " << itkOptimizer->GetCurrentLearningRate() << std::endl;
+  if( vnl_math_abs( itkOptimizer->GetCurrentLearningRate() - expectedLearningRate ) > 1e-12 )
+    {
+    std::cout << "The learning rate is not " << expectedLearningRate << std::endl;
+    pass = false;
+    }
+
   // Exercise various member functions.
   std::cout << "Maximize: " << itkOptimizer->GetMaximize() << std::endl;
   std::cout << "LearningRate: " << itkOptimizer->GetLearningRate();
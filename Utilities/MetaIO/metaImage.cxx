@@ -1568,7 +1568,8 @@ WriteStream(METAIO_STREAM::ofstream * _stream,
   m_WriteStream = _stream;
 
   unsigned char * compressedElementData = NULL;
-  if(m_BinaryData && m_CompressedData && !strstr(m_ElementDataFileName, "%"))
+  if(_writeElements
+     && m_BinaryData && m_CompressedData && !strstr(m_ElementDataFileName, "%"))
     // compressed & !slice/file
     {
     int elementSize;
@@ -265,6 +265,13 @@ class METAIO_EXPORT MetaObject
       void  CompressedData(bool _compressedData);
       bool  CompressedData(void) const;
 
+      //    CompressedDataSize(...)
+      //       Optional Field
+      //       Number of bytes of compressed data, written in the header
+      //       when positive
+      void  CompressedDataSize(METAIO_STL::streamoff _compressedDataSize);
+      METAIO_STL::streamoff  CompressedDataSize(void) const;
+
 
       virtual void Clear(void);
 
@@ -67,8 +67,26 @@ namespace gdcm
   template <typename TDE, typename TSwap>
   std::istream &DataSet::ReadUpToTag(std::istream &is, const Tag &t, const std::set<Tag> & skiptags) {
     DataElement de;
-    while( !is.eof() && de.template ReadOrSkip<TDE,TSwap>(is, skiptags) )
+    // When the last tag is also skipped (eg. Pixel Data when only the header
+    // is wanted), stop in front of it instead of reading its value:
+    const bool skiplast = skiptags.count( t ) != 0;
+    while( !is.eof() )
       {
+      if( skiplast )
+        {
+        const std::streampos pos = is.tellg();
+        if( pos != std::streampos(-1) )
+          {
+          Tag next;
+          if( next.template Read<TSwap>(is) && t <= next && skiptags.count( next ) != 0 )
+            {
+            break;
+            }
+          is.clear();
+          is.seekg( pos, std::ios::beg );
+          }
+        }
+      if( !de.template ReadOrSkip<TDE,TSwap>(is, skiptags) ) break;
       // If tag read was in skiptags then we should NOT add it:
       if( skiptags.count( de.GetTag() ) == 0 )
         InsertDataElement( de );